@@ -11,46 +11,59 @@
 #endif
 
 #include "mpegsound.h"
+#include "mpegsound_locals.h"
 
 void Mpegtoraw::computebuffer_2(REAL *fraction,REAL buffer[2][CALCBUFFERSIZE])
 {
   REAL p0,p1,p2,p3,p4,p5,p6,p7,p8,p9,pa,pb,pc,pd,pe,pf;
   REAL q0,q1,q2,q3,q4,q5,q6,q7,q8,q9,qa,qb,qc,qd,qe,qf;
   REAL *out1,*out2;
+  REAL prefix[32];
 
   out1=buffer[currentcalcbuffer]+calcbufferoffset;
   out2=buffer[currentcalcbuffer^1]+calcbufferoffset;
 #define OUT1(v,t) out1[(32-(v))*16]   =(-(out1[(v)*16]=t))
 #define OUT2(v)   out2[(96-(v)-32)*16]=out2[((v)-32)*16]
+#define PREFIX(a) q0=(a)[ 0];q1=(a)[ 1];q2=(a)[ 2];q3=(a)[ 3]; \
+                  q4=(a)[ 4];q5=(a)[ 5];q6=(a)[ 6];q7=(a)[ 7]; \
+                  q8=(a)[ 8];q9=(a)[ 9];qa=(a)[10];qb=(a)[11]; \
+                  qc=(a)[12];qd=(a)[13];qe=(a)[14];qf=(a)[15]
 
-  // compute new values via a fast cosine transform:
-  /*  {
-    register REAL *x=fraction;
-
-    p0=x[ 0]+x[31];p1=x[ 1]+x[30];p2=x[ 2]+x[29];p3=x[ 3]+x[28];
-    p4=x[ 4]+x[27];p5=x[ 5]+x[26];p6=x[ 6]+x[25];p7=x[ 7]+x[24];
-    p8=x[ 8]+x[23];p9=x[ 9]+x[22];pa=x[10]+x[21];pb=x[11]+x[20];
-    pc=x[12]+x[19];pd=x[13]+x[18];pe=x[14]+x[17];pf=x[15]+x[16];
-  }
-
-  q0=p0+pf;q1=p1+pe;q2=p2+pd;q3=p3+pc;
-  q4=p4+pb;q5=p5+pa;q6=p6+p9;q7=p7+p8;
-  q8=hcos_32[0]*(p0-pf);q9=hcos_32[1]*(p1-pe);
-  qa=hcos_32[2]*(p2-pd);qb=hcos_32[3]*(p3-pc);
-  qc=hcos_32[4]*(p4-pb);qd=hcos_32[5]*(p5-pa);
-  qe=hcos_32[6]*(p6-p9);qf=hcos_32[7]*(p7-p8); */
+  // the SIMD kernels compute the first two stages for both halves at once
+  if(synthesiskernel>=SK_SSE)computeprefix_simd(fraction,prefix,true);
 
+  // compute new values via a fast cosine transform:
+  if(synthesiskernel<SK_SSE)
   {
-    register REAL *x=fraction;
-
-    q0=x[ 0]+x[15];q1=x[ 1]+x[14];q2=x[ 2]+x[13];q3=x[ 3]+x[12];
-    q4=x[ 4]+x[11];q5=x[ 5]+x[10];q6=x[ 6]+x[ 9];q7=x[ 7]+x[ 8];
-
-    q8=hcos_32[0]*(x[ 0]-x[15]);q9=hcos_32[1]*(x[ 1]-x[14]);
-    qa=hcos_32[2]*(x[ 2]-x[13]);qb=hcos_32[3]*(x[ 3]-x[12]);
-    qc=hcos_32[4]*(x[ 4]-x[11]);qd=hcos_32[5]*(x[ 5]-x[10]);
-    qe=hcos_32[6]*(x[ 6]-x[ 9]);qf=hcos_32[7]*(x[ 7]-x[ 8]);
+    /*  {
+      register REAL *x=fraction;
+
+      p0=x[ 0]+x[31];p1=x[ 1]+x[30];p2=x[ 2]+x[29];p3=x[ 3]+x[28];
+      p4=x[ 4]+x[27];p5=x[ 5]+x[26];p6=x[ 6]+x[25];p7=x[ 7]+x[24];
+      p8=x[ 8]+x[23];p9=x[ 9]+x[22];pa=x[10]+x[21];pb=x[11]+x[20];
+      pc=x[12]+x[19];pd=x[13]+x[18];pe=x[14]+x[17];pf=x[15]+x[16];
+    }
+
+    q0=p0+pf;q1=p1+pe;q2=p2+pd;q3=p3+pc;
+    q4=p4+pb;q5=p5+pa;q6=p6+p9;q7=p7+p8;
+    q8=hcos_32[0]*(p0-pf);q9=hcos_32[1]*(p1-pe);
+    qa=hcos_32[2]*(p2-pd);qb=hcos_32[3]*(p3-pc);
+    qc=hcos_32[4]*(p4-pb);qd=hcos_32[5]*(p5-pa);
+    qe=hcos_32[6]*(p6-p9);qf=hcos_32[7]*(p7-p8); */
+
+    {
+      register REAL *x=fraction;
+
+      q0=x[ 0]+x[15];q1=x[ 1]+x[14];q2=x[ 2]+x[13];q3=x[ 3]+x[12];
+      q4=x[ 4]+x[11];q5=x[ 5]+x[10];q6=x[ 6]+x[ 9];q7=x[ 7]+x[ 8];
+
+      q8=hcos_32[0]*(x[ 0]-x[15]);q9=hcos_32[1]*(x[ 1]-x[14]);
+      qa=hcos_32[2]*(x[ 2]-x[13]);qb=hcos_32[3]*(x[ 3]-x[12]);
+      qc=hcos_32[4]*(x[ 4]-x[11]);qd=hcos_32[5]*(x[ 5]-x[10]);
+      qe=hcos_32[6]*(x[ 6]-x[ 9]);qf=hcos_32[7]*(x[ 7]-x[ 8]);
+    }
   }
+  else {PREFIX(prefix);}
 
   p0=q0+q7;p1=q1+q6;p2=q2+q5;p3=q3+q4;
   p4=hcos_16[0]*(q0-q7);p5=hcos_16[1]*(q1-q6);
@@ -94,34 +107,38 @@ void Mpegtoraw::computebuffer_2(REAL *fraction,REAL buffer[2][CALCBUFFERSIZE])
     OUT2(40)=-(p2+p3);
   }
 
+  if(synthesiskernel<SK_SSE)
   {
-    register REAL *x=fraction;
-
-    /*    p0=hcos_64[ 0]*(x[ 0]-x[31]);p1=hcos_64[ 1]*(x[ 1]-x[30]);
-    p2=hcos_64[ 2]*(x[ 2]-x[29]);p3=hcos_64[ 3]*(x[ 3]-x[28]);
-    p4=hcos_64[ 4]*(x[ 4]-x[27]);p5=hcos_64[ 5]*(x[ 5]-x[26]);
-    p6=hcos_64[ 6]*(x[ 6]-x[25]);p7=hcos_64[ 7]*(x[ 7]-x[24]);
-    p8=hcos_64[ 8]*(x[ 8]-x[23]);p9=hcos_64[ 9]*(x[ 9]-x[22]);
-    pa=hcos_64[10]*(x[10]-x[21]);pb=hcos_64[11]*(x[11]-x[20]);
-    pc=hcos_64[12]*(x[12]-x[19]);pd=hcos_64[13]*(x[13]-x[18]);
-    pe=hcos_64[14]*(x[14]-x[17]);pf=hcos_64[15]*(x[15]-x[16]); */
-
-    p0=hcos_64[ 0]*x[ 0];p1=hcos_64[ 1]*x[ 1];
-    p2=hcos_64[ 2]*x[ 2];p3=hcos_64[ 3]*x[ 3];
-    p4=hcos_64[ 4]*x[ 4];p5=hcos_64[ 5]*x[ 5];
-    p6=hcos_64[ 6]*x[ 6];p7=hcos_64[ 7]*x[ 7];
-    p8=hcos_64[ 8]*x[ 8];p9=hcos_64[ 9]*x[ 9];
-    pa=hcos_64[10]*x[10];pb=hcos_64[11]*x[11];
-    pc=hcos_64[12]*x[12];pd=hcos_64[13]*x[13];
-    pe=hcos_64[14]*x[14];pf=hcos_64[15]*x[15];
+    {
+      register REAL *x=fraction;
+
+      /*    p0=hcos_64[ 0]*(x[ 0]-x[31]);p1=hcos_64[ 1]*(x[ 1]-x[30]);
+      p2=hcos_64[ 2]*(x[ 2]-x[29]);p3=hcos_64[ 3]*(x[ 3]-x[28]);
+      p4=hcos_64[ 4]*(x[ 4]-x[27]);p5=hcos_64[ 5]*(x[ 5]-x[26]);
+      p6=hcos_64[ 6]*(x[ 6]-x[25]);p7=hcos_64[ 7]*(x[ 7]-x[24]);
+      p8=hcos_64[ 8]*(x[ 8]-x[23]);p9=hcos_64[ 9]*(x[ 9]-x[22]);
+      pa=hcos_64[10]*(x[10]-x[21]);pb=hcos_64[11]*(x[11]-x[20]);
+      pc=hcos_64[12]*(x[12]-x[19]);pd=hcos_64[13]*(x[13]-x[18]);
+      pe=hcos_64[14]*(x[14]-x[17]);pf=hcos_64[15]*(x[15]-x[16]); */
+
+      p0=hcos_64[ 0]*x[ 0];p1=hcos_64[ 1]*x[ 1];
+      p2=hcos_64[ 2]*x[ 2];p3=hcos_64[ 3]*x[ 3];
+      p4=hcos_64[ 4]*x[ 4];p5=hcos_64[ 5]*x[ 5];
+      p6=hcos_64[ 6]*x[ 6];p7=hcos_64[ 7]*x[ 7];
+      p8=hcos_64[ 8]*x[ 8];p9=hcos_64[ 9]*x[ 9];
+      pa=hcos_64[10]*x[10];pb=hcos_64[11]*x[11];
+      pc=hcos_64[12]*x[12];pd=hcos_64[13]*x[13];
+      pe=hcos_64[14]*x[14];pf=hcos_64[15]*x[15];
+    }
+
+    q0=p0+pf;q1=p1+pe;q2=p2+pd;q3=p3+pc;
+    q4=p4+pb;q5=p5+pa;q6=p6+p9;q7=p7+p8;
+    q8=hcos_32[0]*(p0-pf);q9=hcos_32[1]*(p1-pe);
+    qa=hcos_32[2]*(p2-pd);qb=hcos_32[3]*(p3-pc);
+    qc=hcos_32[4]*(p4-pb);qd=hcos_32[5]*(p5-pa);
+    qe=hcos_32[6]*(p6-p9);qf=hcos_32[7]*(p7-p8);
   }
-
-  q0=p0+pf;q1=p1+pe;q2=p2+pd;q3=p3+pc;
-  q4=p4+pb;q5=p5+pa;q6=p6+p9;q7=p7+p8;
-  q8=hcos_32[0]*(p0-pf);q9=hcos_32[1]*(p1-pe);
-  qa=hcos_32[2]*(p2-pd);qb=hcos_32[3]*(p3-pc);
-  qc=hcos_32[4]*(p4-pb);qd=hcos_32[5]*(p5-pa);
-  qe=hcos_32[6]*(p6-p9);qf=hcos_32[7]*(p7-p8);
+  else {PREFIX(prefix+16);}
 
   p0=q0+q7;p1=q1+q6;p2=q2+q5;p3=q3+q4;
   p4=hcos_16[0]*(q0-q7);p5=hcos_16[1]*(q1-q6);
@@ -175,8 +192,7 @@ void Mpegtoraw::computebuffer_2(REAL *fraction,REAL buffer[2][CALCBUFFERSIZE])
 
 
 #define SAVE \
-        raw=(int)(r*scalefactor); \
-        if(raw>MAXSCALE)raw=MAXSCALE;else if(raw<MINSCALE)raw=MINSCALE; \
+        raw=clipraw(r*scalefactor); \
 	putraw(raw); \
         dp+=16;vp+=15+(15-14)
 #define OS   r=*vp * *dp++
@@ -254,11 +270,9 @@ inline void Mpegtoraw::generatesingle_2(void)
 #undef SAVE
 
 #define SAVE \
-        raw=(int)(r1*scalefactor);  \
-        if(raw>MAXSCALE)raw=MAXSCALE;else if(raw<MINSCALE)raw=MINSCALE; \
+        raw=clipraw(r1*scalefactor);  \
 	putraw(raw);  \
-        raw=(int)(r2*scalefactor);  \
-        if(raw>MAXSCALE)raw=MAXSCALE;else if(raw<MINSCALE)raw=MINSCALE; \
+        raw=clipraw(r2*scalefactor);  \
 	putraw(raw); \
         dp+=16;vp1+=15+(15-14);vp2+=15+(15-14)
 #define OS r1=*vp1 * *dp; \
@@ -340,12 +354,10 @@ inline void Mpegtoraw::generate_2(void)
 void Mpegtoraw::subbandsynthesis_2(REAL *fractionL,REAL *fractionR)
 {
   computebuffer_2(fractionL,calcbufferL);
-  if(!outputstereo)generatesingle_2();
-  else
-  {
-    computebuffer_2(fractionR,calcbufferR);
-    generate_2();
-  }
+  if(outputstereo)computebuffer_2(fractionR,calcbufferR);
+  if(synthesiskernel>=SK_SSE)generate_simd(2);
+  else if(!outputstereo)generatesingle_2();
+  else generate_2();
 
   if(calcbufferoffset<15)calcbufferoffset++;
   else calcbufferoffset=0;
@@ -0,0 +1,304 @@
+/* MPEG/WAVE Sound library
+
+   (C) 1997 by Jung woo-jae */
+
+// Filter_simd.cc
+// SSE/AVX versions of the subbandsynthesis routines in filter.cc and
+// filter_2.cc. The scalar routines remain the reference implementation.
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <atomic>
+#include <mutex>
+
+#include "mpegsound.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_SYNTHESIS_SIMD
+#include <immintrin.h>
+#endif
+
+// Kernel selected for all decoders. It may be changed while other threads
+// decode, so it is atomic.
+static std::atomic<int> selectedsynthesiskernel(SK_AUTO);
+
+// generate() multiplies the 16 values of each calcbuffer row, read
+// backwards from calcbufferoffset with wrap-around, by 16 consecutive filter
+// coefficients. synthesiswindow holds every filter row reversed and stored
+// twice, so the coefficients for calcbufferoffset o start at
+// synthesiswindow[32*row+15-o] and line up with calcbuffer row[0..15].
+alignas(64) static REAL synthesiswindow[2*512];
+
+
+static bool synthesiskernelsupported(int kernel)
+{
+  switch(kernel)
+  {
+    case SK_SCALAR:
+      return true;
+#ifdef HAVE_SYNTHESIS_SIMD
+    case SK_SSE:
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("sse2");
+    case SK_AVX:
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx");
+#endif
+  }
+  return false;
+}
+
+static int bestsynthesiskernel(void)
+{
+  if(synthesiskernelsupported(SK_AVX))return SK_AVX;
+  if(synthesiskernelsupported(SK_SSE))return SK_SSE;
+  return SK_SCALAR;
+}
+
+static std::once_flag synthesisinitialized;
+
+void Mpegtoraw::synthesisinitialize(void)
+{
+  std::call_once(synthesisinitialized,[](){
+    for(int row=0;row<32;row++)
+      for(int i=0;i<32;i++)
+	synthesiswindow[row*32+i]=filter[row*16+15-(i&15)];
+    int kernel=SK_AUTO;
+    selectedsynthesiskernel.compare_exchange_strong(kernel,bestsynthesiskernel());
+  });
+}
+
+bool Mpegtoraw::setsynthesiskernel(int kernel)
+{
+  if(kernel==SK_AUTO)kernel=bestsynthesiskernel();
+  else if(!synthesiskernelsupported(kernel))return false;
+
+  synthesisinitialize();
+  selectedsynthesiskernel.store(kernel);
+  return true;
+}
+
+int Mpegtoraw::getsynthesiskernel(void)
+{
+  synthesisinitialize();
+  return selectedsynthesiskernel.load();
+}
+
+
+#ifdef HAVE_SYNTHESIS_SIMD
+
+#define REVERSE(a) _mm_shuffle_ps((a),(a),_MM_SHUFFLE(0,1,2,3))
+
+// q[i]=s[i]+s[15-i], q[8+i]=hcos_32[i]*(s[i]-s[15-i]), as in computebuffer()
+__attribute__((target("sse2")))
+static inline void butterfly16(__m128 s0,__m128 s1,__m128 s2,__m128 s3,
+			       const REAL *hcos_32,REAL *q)
+{
+  __m128 r2=REVERSE(s2),r3=REVERSE(s3);
+
+  _mm_storeu_ps(q   ,_mm_add_ps(s0,r3));
+  _mm_storeu_ps(q+ 4,_mm_add_ps(s1,r2));
+  _mm_storeu_ps(q+ 8,_mm_mul_ps(_mm_loadu_ps(hcos_32  ),_mm_sub_ps(s0,r3)));
+  _mm_storeu_ps(q+12,_mm_mul_ps(_mm_loadu_ps(hcos_32+4),_mm_sub_ps(s1,r2)));
+}
+
+// First two stages of the fast cosine transform for both halves. The
+// lane-wise operations are the scalar ones, so the results are identical.
+__attribute__((target("sse2")))
+void Mpegtoraw::computeprefix_simd(const REAL *x,REAL *q,bool half)
+{
+  __m128 a0=_mm_loadu_ps(x),a1=_mm_loadu_ps(x+4),
+	 a2=_mm_loadu_ps(x+8),a3=_mm_loadu_ps(x+12);
+
+  if(!half)
+  {
+    __m128 b0=_mm_loadu_ps(x+28),b1=_mm_loadu_ps(x+24),
+	   b2=_mm_loadu_ps(x+20),b3=_mm_loadu_ps(x+16);
+
+    b0=REVERSE(b0);b1=REVERSE(b1);b2=REVERSE(b2);b3=REVERSE(b3);
+    butterfly16(_mm_add_ps(a0,b0),_mm_add_ps(a1,b1),
+		_mm_add_ps(a2,b2),_mm_add_ps(a3,b3),hcos_32,q);
+    butterfly16(_mm_mul_ps(_mm_loadu_ps(hcos_64   ),_mm_sub_ps(a0,b0)),
+		_mm_mul_ps(_mm_loadu_ps(hcos_64+ 4),_mm_sub_ps(a1,b1)),
+		_mm_mul_ps(_mm_loadu_ps(hcos_64+ 8),_mm_sub_ps(a2,b2)),
+		_mm_mul_ps(_mm_loadu_ps(hcos_64+12),_mm_sub_ps(a3,b3)),
+		hcos_32,q+16);
+  }
+  else
+  {
+    // computebuffer_2() only uses the lower 16 subbands
+    butterfly16(a0,a1,a2,a3,hcos_32,q);
+    butterfly16(_mm_mul_ps(_mm_loadu_ps(hcos_64   ),a0),
+		_mm_mul_ps(_mm_loadu_ps(hcos_64+ 4),a1),
+		_mm_mul_ps(_mm_loadu_ps(hcos_64+ 8),a2),
+		_mm_mul_ps(_mm_loadu_ps(hcos_64+12),a3),
+		hcos_32,q+16);
+  }
+}
+
+#undef REVERSE
+
+
+// ###### SSE windowing #####################################################
+__attribute__((target("sse2")))
+static inline __m128 windowrow_sse(const REAL *v,const REAL *w)
+{
+  __m128 r=_mm_mul_ps(_mm_loadu_ps(v),_mm_loadu_ps(w));
+
+  r=_mm_add_ps(r,_mm_mul_ps(_mm_loadu_ps(v+ 4),_mm_loadu_ps(w+ 4)));
+  r=_mm_add_ps(r,_mm_mul_ps(_mm_loadu_ps(v+ 8),_mm_loadu_ps(w+ 8)));
+  r=_mm_add_ps(r,_mm_mul_ps(_mm_loadu_ps(v+12),_mm_loadu_ps(w+12)));
+  return r;
+}
+
+__attribute__((target("sse2")))
+static inline __m128 window4_sse(const REAL *v,const REAL *w,int rowstep)
+{
+  const int vs=16*rowstep,ws=32*rowstep;
+  __m128 r0=windowrow_sse(v     ,w     ),r1=windowrow_sse(v+  vs,w+  ws),
+	 r2=windowrow_sse(v+2*vs,w+2*ws),r3=windowrow_sse(v+3*vs,w+3*ws);
+
+  _MM_TRANSPOSE4_PS(r0,r1,r2,r3);
+  return _mm_add_ps(_mm_add_ps(r0,r1),_mm_add_ps(r2,r3));
+}
+
+// Same truncation and clipping as clipraw() in mpegsound_locals.h
+__attribute__((target("sse2")))
+static inline __m128i scale_sse(__m128 r,__m128 scale)
+{
+  r=_mm_mul_ps(r,scale);
+  r=_mm_min_ps(_mm_max_ps(r,_mm_set1_ps(MINSCALE)),_mm_set1_ps(MAXSCALE));
+  return _mm_cvttps_epi32(r);
+}
+
+__attribute__((target("sse2")))
+static void window_sse(const REAL *vl,const REAL *vr,const REAL *w,
+		       int rows,int rowstep,REAL scalefactor,short int *out)
+{
+  const __m128 scale=_mm_set1_ps(scalefactor);
+
+  for(int i=0;i<rows;i+=4)
+  {
+    const int v=16*rowstep*i;
+    __m128i l=scale_sse(window4_sse(vl+v,w+2*v,rowstep),scale);
+
+    if(!vr)
+    {
+      _mm_storel_epi64((__m128i *)out,_mm_packs_epi32(l,l));
+      out+=4;
+    }
+    else
+    {
+      __m128i r=scale_sse(window4_sse(vr+v,w+2*v,rowstep),scale);
+
+      _mm_storeu_si128((__m128i *)out,
+		       _mm_packs_epi32(_mm_unpacklo_epi32(l,r),
+				       _mm_unpackhi_epi32(l,r)));
+      out+=8;
+    }
+  }
+}
+
+
+// ###### AVX windowing #####################################################
+__attribute__((target("avx")))
+static inline __m256 windowrow_avx(const REAL *v,const REAL *w)
+{
+  return _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(v  ),_mm256_loadu_ps(w  )),
+		       _mm256_mul_ps(_mm256_loadu_ps(v+8),_mm256_loadu_ps(w+8)));
+}
+
+__attribute__((target("avx")))
+static inline __m256 window8_avx(const REAL *v,const REAL *w,int rowstep)
+{
+  const int vs=16*rowstep,ws=32*rowstep;
+  __m256 a=_mm256_hadd_ps(
+	     _mm256_hadd_ps(windowrow_avx(v     ,w     ),
+			    windowrow_avx(v+  vs,w+  ws)),
+	     _mm256_hadd_ps(windowrow_avx(v+2*vs,w+2*ws),
+			    windowrow_avx(v+3*vs,w+3*ws)));
+  __m256 b=_mm256_hadd_ps(
+	     _mm256_hadd_ps(windowrow_avx(v+4*vs,w+4*ws),
+			    windowrow_avx(v+5*vs,w+5*ws)),
+	     _mm256_hadd_ps(windowrow_avx(v+6*vs,w+6*ws),
+			    windowrow_avx(v+7*vs,w+7*ws)));
+
+  // a and b now hold the sums of the lower and upper halves of rows 0-3 and
+  // 4-7 in their lower and upper 128 bit lanes.
+  return _mm256_add_ps(_mm256_permute2f128_ps(a,b,0x20),
+		       _mm256_permute2f128_ps(a,b,0x31));
+}
+
+__attribute__((target("avx")))
+static inline __m256i scale_avx(__m256 r,__m256 scale)
+{
+  r=_mm256_mul_ps(r,scale);
+  r=_mm256_min_ps(_mm256_max_ps(r,_mm256_set1_ps(MINSCALE)),
+		  _mm256_set1_ps(MAXSCALE));
+  return _mm256_cvttps_epi32(r);
+}
+
+__attribute__((target("avx")))
+static void window_avx(const REAL *vl,const REAL *vr,const REAL *w,
+		       int rows,int rowstep,REAL scalefactor,short int *out)
+{
+  const __m256 scale=_mm256_set1_ps(scalefactor);
+
+  for(int i=0;i<rows;i+=8)
+  {
+    const int v=16*rowstep*i;
+    __m256i l=scale_avx(window8_avx(vl+v,w+2*v,rowstep),scale);
+    __m128i l0=_mm256_castsi256_si128(l),l1=_mm256_extractf128_si256(l,1);
+
+    if(!vr)
+    {
+      _mm_storeu_si128((__m128i *)out,_mm_packs_epi32(l0,l1));
+      out+=8;
+    }
+    else
+    {
+      __m256i r=scale_avx(window8_avx(vr+v,w+2*v,rowstep),scale);
+      __m128i r0=_mm256_castsi256_si128(r),r1=_mm256_extractf128_si256(r,1);
+
+      _mm_storeu_si128((__m128i *)out,
+		       _mm_packs_epi32(_mm_unpacklo_epi32(l0,r0),
+				       _mm_unpackhi_epi32(l0,r0)));
+      _mm_storeu_si128((__m128i *)(out+8),
+		       _mm_packs_epi32(_mm_unpacklo_epi32(l1,r1),
+				       _mm_unpackhi_epi32(l1,r1)));
+      out+=16;
+    }
+  }
+}
+
+
+// Replaces generate()/generatesingle() (rowstep 1) and their _2 variants
+// (rowstep 2, every other filter row).
+void Mpegtoraw::generate_simd(int rowstep)
+{
+  const REAL *vl=calcbufferL[currentcalcbuffer];
+  const REAL *vr=(outputstereo ? calcbufferR[currentcalcbuffer] : NULL);
+  const REAL *w=synthesiswindow+15-calcbufferoffset;
+  const int   rows=32/rowstep;
+
+  if(synthesiskernel==SK_AVX)
+    window_avx(vl,vr,w,rows,rowstep,scalefactor,rawdata+rawdataoffset);
+  else
+    window_sse(vl,vr,w,rows,rowstep,scalefactor,rawdata+rawdataoffset);
+  rawdataoffset+=(vr ? 2*rows : rows);
+}
+
+#else
+
+// Never selected: synthesiskernelsupported() only accepts SK_SCALAR here.
+void Mpegtoraw::computeprefix_simd(const REAL *,REAL *,bool)
+{
+}
+
+void Mpegtoraw::generate_simd(int)
+{
+}
+
+#endif
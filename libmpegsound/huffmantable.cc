@@ -9,6 +9,8 @@
 #include "config.h"
 #endif
 
+#include <atomic>
+
 #include "mpegsound.h"
 
 static const unsigned int
@@ -585,3 +587,55 @@ const HUFFMANCODETABLE Mpegtoraw::ht[HTN]=
   {32, 1-1,16-1, 0, 31,htd32},
   {33, 1-1,16-1, 0, 31,htd33}
 };
+
+// Lookup tables for decoding HUFFMANLOOKUPBITS bits at once. An entry >=0
+// is a complete code, (length<<8)|value. An entry <0 belongs to a longer
+// code, whose tree walk continues at node -entry.
+static short huffmanlookuptable[HTN][1<<HUFFMANLOOKUPBITS];
+const short *Mpegtoraw::huffmanlookup[HTN];
+
+static std::atomic<bool> selectedhuffmanlookup(true);
+
+void Mpegtoraw::sethuffmanlookup(bool enable)
+{
+  selectedhuffmanlookup.store(enable);
+}
+
+bool Mpegtoraw::gethuffmanlookup(void)
+{
+  return selectedhuffmanlookup.load();
+}
+
+void Mpegtoraw::huffmaninitialize(void)
+{
+  int t,u;
+
+  for(t=0;t<HTN;t++)
+  {
+    huffmanlookup[t]=NULL;
+    if(!ht[t].treelen)continue;
+
+    // Tables 16-23 and 24-31 share their trees
+    for(u=0;u<t;u++)
+      if(huffmanlookup[u] && ht[u].val==ht[t].val)
+	huffmanlookup[t]=huffmanlookup[u];
+    if(huffmanlookup[t])continue;
+
+    for(int bits=0;bits<(1<<HUFFMANLOOKUPBITS);bits++)
+    {
+      unsigned int point=0;
+      int length=0;
+
+      while(ht[t].val[point][0] && length<HUFFMANLOOKUPBITS)
+      {
+	point+=ht[t].val[point][(bits>>(HUFFMANLOOKUPBITS-1-length))&1];
+	length++;
+      }
+      if(ht[t].val[point][0]==0)
+	huffmanlookuptable[t][bits]=(length<<8)|ht[t].val[point][1];
+      else
+	huffmanlookuptable[t][bits]=-(short)point;
+    }
+    huffmanlookup[t]=huffmanlookuptable[t];
+  }
+}
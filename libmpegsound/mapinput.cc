@@ -0,0 +1,162 @@
+/* MPEG/WAVE Sound library */
+
+// Mapinput.cc
+// Inputstream from a memory mapped file
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <limits.h>
+
+#include "mpegsound.h"
+#include "soundfilemapping.h"
+
+// Minimum size of a read-ahead request and how far read-ahead reaches
+#define READAHEADSTEP   (256*1024)
+#define READAHEADWINDOW (1024*1024)
+
+/**************************************/
+/* Input bitstream from a mapped file */
+/**************************************/
+Soundinputstreamfrommap::Soundinputstreamfrommap()
+{
+  mapping=NULL;
+  data=NULL;
+  size=position=readaheadposition=checkedposition=0;
+  ateof=false;
+  __canseek=true;
+}
+
+Soundinputstreamfrommap::~Soundinputstreamfrommap()
+{
+  close();
+}
+
+// Unlike Soundinputstreamfromfile, small files are accepted. Whether they
+// are valid is decided by the decoder.
+bool Soundinputstreamfrommap::open(const char *filename)
+{
+  close();
+  if((mapping=Soundfilemapping::attach(filename))==NULL)
+  {
+    seterrorcode(SOUND_ERROR_FILEOPENFAIL);
+    return false;
+  }
+  data=mapping->getdata();
+  size=mapping->getsize();
+  readahead();
+  return true;
+}
+
+void Soundinputstreamfrommap::close(void)
+{
+  Soundfilemapping::detach(mapping);
+  mapping=NULL;
+  data=NULL;
+  size=position=readaheadposition=checkedposition=0;
+  ateof=false;
+}
+
+// Keeps READAHEADWINDOW bytes ahead of the position in reading.
+// readaheadposition is where the requested range ends, so every part of
+// the file is requested once, in pieces of at least READAHEADSTEP bytes.
+inline void Soundinputstreamfrommap::readahead(void)
+{
+  if(readaheadposition<position+READAHEADWINDOW-READAHEADSTEP)
+  {
+    size_t from=(readaheadposition>position)?readaheadposition:position;
+    mapping->readahead(from,position+READAHEADWINDOW-from);
+    readaheadposition=position+READAHEADWINDOW;
+  }
+}
+
+// Accessing the mapping beyond the end of a file truncated meanwhile
+// raises SIGBUS. So the file is checked for the bytes to be read whenever
+// reading leaves the checked range, and a truncated file ends where it has
+// been cut.
+inline void Soundinputstreamfrommap::checkwindow(size_t bytes)
+{
+  if(bytes>size-position)bytes=size-position;
+  if(position+bytes>checkedposition)
+  {
+    size_t available=mapping->available(position,bytes);
+    checkedposition=position+available;
+    if(available<bytes)size=checkedposition;
+  }
+}
+
+int Soundinputstreamfrommap::getbytedirect(void)
+{
+  checkwindow(1);
+  if(position>=size)
+  {
+    ateof=true;
+    seterrorcode(SOUND_ERROR_FILEREADFAIL);
+    return -1;
+  }
+  int byte=data[position++];
+  readahead();
+  return byte;
+}
+
+bool Soundinputstreamfrommap::_readbuffer(char *buffer,int bytes)
+{
+  if(bytes<0)bytes=0;
+  checkwindow(bytes);
+  if((size_t)bytes>size-position)
+  {
+    position=size;
+    ateof=true;
+    seterrorcode(SOUND_ERROR_FILEREADFAIL);
+    return false;
+  }
+  memcpy(buffer,data+position,bytes);
+  position+=bytes;
+  readahead();
+  return true;
+}
+
+bool Soundinputstreamfrommap::eof(void)
+{
+  return ateof;
+}
+
+int Soundinputstreamfrommap::getblock(char *buffer,int size)
+{
+  size_t bytes;
+
+  if(size<=0)
+    return 0;
+  checkwindow(size);
+  bytes=this->size-position;
+  if(bytes>=(size_t)size)bytes=size;
+  else ateof=true;
+  if(bytes==0)
+    return 0;
+  memcpy(buffer,data+position,bytes);
+  position+=bytes;
+  readahead();
+  return bytes;
+}
+
+// Streams are addressed by int, so positions beyond INT_MAX are reported
+// as INT_MAX. Reading continues across them.
+int Soundinputstreamfrommap::getsize(void)
+{
+  return (size>INT_MAX)?INT_MAX:(int)size;
+}
+
+void Soundinputstreamfrommap::setposition(int pos)
+{
+  if(pos<0)pos=0;
+  position=((size_t)pos>size)?size:(size_t)pos;
+  readaheadposition=checkedposition=position;
+  ateof=false;
+  if(mapping)readahead();
+}
+
+int Soundinputstreamfrommap::getposition(void)
+{
+  return (position>INT_MAX)?INT_MAX:(int)position;
+}
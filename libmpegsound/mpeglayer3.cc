@@ -16,7 +16,13 @@
 #endif
 
 #include <math.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
+#include <mutex>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "mpegsound.h"
 #include "mpegsound_locals.h"
@@ -55,6 +61,28 @@ inline int Mpegbitwindow::getbits9(int bits)
   return (int)((unsigned int)(a>>(16-bits)));
 }
 
+// Loads the 64 bits at the current byte and returns the next 1..32 bits
+inline unsigned int Mpegbitwindow::peekbits(int bits) const
+{
+  uint64_t a;
+
+  memcpy(&a,buffer+(bitindex>>3),sizeof(a));
+#ifndef WORDS_BIGENDIAN
+  a=__builtin_bswap64(a);
+#endif
+  return (unsigned int)((a<<(bitindex&7))>>(64-bits));
+}
+
+inline int Mpegbitwindow::getbits(int bits)
+{
+  register int r;
+
+  if(!bits)return 0;
+  r=(int)peekbits(bits);
+  bitindex+=bits;
+  return r;
+}
+
 inline int Mpegtoraw::wgetbit  (void)    {return bitwindow.getbit  ();    }
 inline int Mpegtoraw::wgetbits9(int bits){return bitwindow.getbits9(bits);}
 inline int Mpegtoraw::wgetbits (int bits){return bitwindow.getbits (bits);}
@@ -90,31 +118,71 @@ __asm__ __volatile__(
 
 #define FOURTHIRDSTABLENUMBER (1<<13)
 
-static REAL two_to_negative_half_pow[40];
-static REAL TO_FOUR_THIRDSTABLE[FOURTHIRDSTABLENUMBER*2];
-static REAL POW2[256];
-static REAL POW2_1[8][2][16];
-static REAL ca[8],cs[8];
-
-
-
-static REAL cos1_6=cos(PI/6.0*1.0);
-static REAL cos2_6=cos(PI/6.0*2.0);
-static REAL win[4][36];
-static REAL cos_18[9];
-static REAL hsec_36[9],hsec_12[3];
-
 typedef struct
 {
   REAL l,r;
 }RATIOS;
 
-static RATIOS rat_1[16],rat_2[2][64];
+// Tables shared by all decoders. They are filled once by
+// layer3tableinitialize() and only read through the const references
+// below afterwards. Every table starts on its own cache line.
+static struct
+{
+  alignas(64) REAL two_to_negative_half_pow[40];
+  alignas(64) REAL TO_FOUR_THIRDSTABLE[FOURTHIRDSTABLENUMBER*2];
+  alignas(64) REAL POW2[256];
+  alignas(64) REAL POW2_1[8][2][16];
+  alignas(64) REAL ca[8],cs[8];
+  alignas(64) REAL win[4][36];
+  alignas(64) REAL cos_18[9];
+  alignas(64) REAL hsec_36[9],hsec_12[3];
+  alignas(64) RATIOS rat_1[16],rat_2[2][64];
+}layer3tables;
+
+static std::once_flag layer3tablesinitialized;
+
+static const REAL (&two_to_negative_half_pow)[40]=layer3tables.two_to_negative_half_pow;
+static const REAL (&TO_FOUR_THIRDSTABLE)[FOURTHIRDSTABLENUMBER*2]=layer3tables.TO_FOUR_THIRDSTABLE;
+static const REAL (&POW2)[256]=layer3tables.POW2;
+static const REAL (&POW2_1)[8][2][16]=layer3tables.POW2_1;
+static const REAL (&ca)[8]=layer3tables.ca,(&cs)[8]=layer3tables.cs;
+static const REAL (&win)[4][36]=layer3tables.win;
+static const REAL (&cos_18)[9]=layer3tables.cos_18;
+static const REAL (&hsec_36)[9]=layer3tables.hsec_36,(&hsec_12)[3]=layer3tables.hsec_12;
+static const RATIOS (&rat_1)[16]=layer3tables.rat_1,(&rat_2)[2][64]=layer3tables.rat_2;
+
+static const REAL cos1_6=cos(PI/6.0*1.0);
+static const REAL cos2_6=cos(PI/6.0*2.0);
+
+
+#ifdef __SSE2__
+#define HAVE_LAYER3_SIMD
+
+// Four REALs side by side. Each operator is the scalar one applied per
+// lane, so the templated dct36()/dct12() give bit-identical results for
+// REAL and REAL4.
+struct REAL4
+{
+  __m128 v;
+
+  REAL4() {};
+  REAL4(__m128 a) : v(a) {};
+  REAL4(REAL a)   : v(_mm_set1_ps(a)) {};
+
+  REAL4 &operator+=(const REAL4 &a) {v=_mm_add_ps(v,a.v);return *this;};
+  REAL4 &operator-=(const REAL4 &a) {v=_mm_sub_ps(v,a.v);return *this;};
+  REAL4 &operator*=(const REAL4 &a) {v=_mm_mul_ps(v,a.v);return *this;};
+};
+
+inline REAL4 operator+(const REAL4 &a,const REAL4 &b) {return _mm_add_ps(a.v,b.v);}
+inline REAL4 operator-(const REAL4 &a,const REAL4 &b) {return _mm_sub_ps(a.v,b.v);}
+inline REAL4 operator*(const REAL4 &a,const REAL4 &b) {return _mm_mul_ps(a.v,b.v);}
+
+#define REVERSE(a) _mm_shuffle_ps((a),(a),_MM_SHUFFLE(0,1,2,3))
+#endif
 
 void Mpegtoraw::layer3initialize(void)
 {
-  static bool initializedlayer3=false;
-
   layer3framestart=0;
   currentprevblock=0;
 
@@ -130,7 +198,22 @@ void Mpegtoraw::layer3initialize(void)
 
   bitwindow.initialize();
 
-  if(initializedlayer3)return;
+  std::call_once(layer3tablesinitialized,layer3tableinitialize);
+}
+
+void Mpegtoraw::layer3tableinitialize(void)
+{
+  // Writable views of the tables, shadowing the const ones
+  REAL (&two_to_negative_half_pow)[40]=layer3tables.two_to_negative_half_pow;
+  REAL (&POW2)[256]=layer3tables.POW2;
+  REAL (&POW2_1)[8][2][16]=layer3tables.POW2_1;
+  REAL (&ca)[8]=layer3tables.ca,(&cs)[8]=layer3tables.cs;
+  REAL (&win)[4][36]=layer3tables.win;
+  REAL (&cos_18)[9]=layer3tables.cos_18;
+  REAL (&hsec_36)[9]=layer3tables.hsec_36,(&hsec_12)[3]=layer3tables.hsec_12;
+  RATIOS (&rat_1)[16]=layer3tables.rat_1,(&rat_2)[2][64]=layer3tables.rat_2;
+
+  huffmaninitialize();
 
   // Calculate win
   {
@@ -163,7 +246,7 @@ void Mpegtoraw::layer3initialize(void)
   for(int i=0;i<40;i++)
     two_to_negative_half_pow[i]=(REAL)pow(2.0,-0.5*(double)i);
   {
-    REAL *TO_FOUR_THIRDS=TO_FOUR_THIRDSTABLE+FOURTHIRDSTABLENUMBER;
+    REAL *TO_FOUR_THIRDS=layer3tables.TO_FOUR_THIRDSTABLE+FOURTHIRDSTABLENUMBER;
 
     for(int i=0;i<FOURTHIRDSTABLENUMBER;i++)
       TO_FOUR_THIRDS[-i]=
@@ -175,7 +258,7 @@ void Mpegtoraw::layer3initialize(void)
       for(k=0;k<16;k++)POW2_1[i][j][k]=pow(2.0,(-2.0*i)-(0.5*(1.0+j)*k));
 
   {
-    static REAL TAN12[16]=
+    static const REAL TAN12[16]=
     { 0.0,        0.26794919, 0.57735027  , 1.0,
       1.73205081, 3.73205081, 9.9999999e10,-3.73205081,
       -1.73205081,-1.01,      -0.57735027,  -0.26794919,
@@ -210,7 +293,7 @@ void Mpegtoraw::layer3initialize(void)
     }
 
   {
-    static REAL Ci[8]=
+    static const REAL Ci[8]=
     {-0.6f,-0.535f,-0.33f,-0.185f,-0.095f,-0.041f,-0.0142f,-0.0037f};
     REAL sq;
 
@@ -221,8 +304,6 @@ void Mpegtoraw::layer3initialize(void)
       ca[i]=Ci[i]*cs[i];
     }
   }
-
-  initializedlayer3=true;
 }
 
 bool Mpegtoraw::layer3getsideinfo(void)
@@ -623,57 +704,78 @@ typedef unsigned int HUFFBITS;
 
 /* do the huffman-decoding 						*/
 /* note! for counta,countb -the 4 bit value is returned in y, discard x */
-// Huffman decoder for tablename<32
-inline void Mpegtoraw::huffmandecoder_1(const HUFFMANCODETABLE *h,int *x,int *y)
-{  
+// Returns the leaf value of the next code, or -1 if no leaf was reached
+// within 32 bits. Codes up to HUFFMANLOOKUPBITS bits take a single table
+// lookup, longer ones continue the tree walk where the table ends. Without
+// usehuffmanlookup, the whole code is decoded by the tree walk.
+inline int Mpegtoraw::huffmandecode(const HUFFMANCODETABLE *h)
+{
   HUFFBITS level=(1<<(sizeof(HUFFBITS)*8-1));
   int point=0;
 
-  /* Lookup in Huffman table. */
-  for(;;)
+  if(usehuffmanlookup)
   {
-    if(h->val[point][0]==0)
-    {   /*end of tree*/
-      int xx,yy;
+    register int entry=huffmanlookup[h-ht][bitwindow.peekbits(HUFFMANLOOKUPBITS)];
 
-      xx=h->val[point][1]>>4;
-      yy=h->val[point][1]&0xf;
-
-      if(h->linbits)
-      {
-	if((h->xlen)==(unsigned)xx)xx+=wgetbits(h->linbits);
-	if(xx)if(wgetbit())xx=-xx;
-	if((h->ylen)==(unsigned)yy)yy+=wgetbits(h->linbits);
-	if(yy)if(wgetbit())yy=-yy;
-      }
-      else
-      {
-	if(xx)if(wgetbit())xx=-xx;
-	if(yy)if(wgetbit())yy=-yy;
-      }
-      *x=xx;*y=yy;
-      break;
-    } 
+    if(entry>=0)
+    {
+      bitwindow.forward(entry>>8);
+      return entry&0xff;
+    }
+    level>>=HUFFMANLOOKUPBITS;
+    point=-entry;
+    bitwindow.forward(HUFFMANLOOKUPBITS);
+  }
 
+  for(;;)
+  {
+    if(h->val[point][0]==0)return h->val[point][1];
     point+=h->val[point][wgetbit()];
-    
     level>>=1;
-    if(!(level || ((unsigned)point<ht->treelen)))
-    {
-      register int xx,yy;
+    if(!level)return -1;
+  }
+}
+
+// Huffman decoder for tablename<32
+inline void Mpegtoraw::huffmandecoder_1(const HUFFMANCODETABLE *h,int *x,int *y)
+{  
+  register int t=huffmandecode(h);
 
-      xx=(h->xlen<<1);// set x and y to a medium value as a simple concealment
-      yy=(h->ylen<<1);
+  if(t>=0)
+  {   /*end of tree*/
+    int xx,yy;
 
-      // h->xlen and h->ylen can't be 1 under tablename 32
-      //      if(xx)
-	if(wgetbit())xx=-xx;
-      //      if(yy)
-	if(wgetbit())yy=-yy;
+    xx=t>>4;
+    yy=t&0xf;
 
-      *x=xx;*y=yy;
-      break;
+    if(h->linbits)
+    {
+      if((h->xlen)==(unsigned)xx)xx+=wgetbits(h->linbits);
+      if(xx)if(wgetbit())xx=-xx;
+      if((h->ylen)==(unsigned)yy)yy+=wgetbits(h->linbits);
+      if(yy)if(wgetbit())yy=-yy;
     }
+    else
+    {
+      if(xx)if(wgetbit())xx=-xx;
+      if(yy)if(wgetbit())yy=-yy;
+    }
+    *x=xx;*y=yy;
+  }
+  else
+  {
+    register int xx,yy;
+
+    xx=(h->xlen<<1);// set x and y to a medium value as a simple concealment
+    yy=(h->ylen<<1);
+
+    // h->xlen and h->ylen can't be 1 under tablename 32
+    //      if(xx)
+    if(wgetbit())xx=-xx;
+    //      if(yy)
+    if(wgetbit())yy=-yy;
+
+    *x=xx;*y=yy;
   }
 }
 
@@ -681,32 +783,21 @@ inline void Mpegtoraw::huffmandecoder_1(const HUFFMANCODETABLE *h,int *x,int *y)
 inline void Mpegtoraw::huffmandecoder_2(const HUFFMANCODETABLE *h,
 				       int *x,int *y,int *v,int *w)
 {  
-  HUFFBITS level=(1<<(sizeof(HUFFBITS)*8-1));
-  int point=0;
-
-  /* Lookup in Huffman table. */
-  for(;;)
+  register int t=huffmandecode(h);
+
+  if(t>=0)
+  {   /*end of tree*/
+    if(t&8)*v=1-(wgetbit()<<1); else *v=0;
+    if(t&4)*w=1-(wgetbit()<<1); else *w=0;
+    if(t&2)*x=1-(wgetbit()<<1); else *x=0;
+    if(t&1)*y=1-(wgetbit()<<1); else *y=0;
+  }
+  else
   {
-    if(h->val[point][0]==0)
-    {   /*end of tree*/
-      register int t=h->val[point][1];
-
-      if(t&8)*v=1-(wgetbit()<<1); else *v=0;
-      if(t&4)*w=1-(wgetbit()<<1); else *w=0;
-      if(t&2)*x=1-(wgetbit()<<1); else *x=0;
-      if(t&1)*y=1-(wgetbit()<<1); else *y=0;
-      break;
-    } 
-    point+=h->val[point][wgetbit()];
-    level>>=1;
-    if(!(level || ((unsigned)point<ht->treelen)))
-    {
-      *v=1-(wgetbit()<<1);
-      *w=1-(wgetbit()<<1);
-      *x=1-(wgetbit()<<1);
-      *y=1-(wgetbit()<<1);
-      break;
-    }
+    *v=1-(wgetbit()<<1);
+    *w=1-(wgetbit()<<1);
+    *x=1-(wgetbit()<<1);
+    *y=1-(wgetbit()<<1);
   }
 }
 
@@ -827,13 +918,38 @@ inline REAL Mpegtoraw::layer3twopow2_1(int a,int b,int c)
   return POW2_1[a][b][c];
 }
 
+// out[i]=factor*TO_FOUR_THIRDS[in[i]], count is even
+static inline void layer3dequantize(REAL *out,const int *in,int count,
+				    REAL factor,const REAL *TO_FOUR_THIRDS,
+				    bool simd)
+{
+#ifdef HAVE_LAYER3_SIMD
+  if(simd)
+  {
+    const __m128 f=_mm_set1_ps(factor);
+
+    for(;count>=4;count-=4,in+=4,out+=4)
+      _mm_storeu_ps(out,_mm_mul_ps(f,_mm_setr_ps(TO_FOUR_THIRDS[in[0]],
+						 TO_FOUR_THIRDS[in[1]],
+						 TO_FOUR_THIRDS[in[2]],
+						 TO_FOUR_THIRDS[in[3]])));
+  }
+#endif
+  for(;count>0;count-=2,in+=2,out+=2)
+  {
+    out[0]=factor*TO_FOUR_THIRDS[in[0]];
+    out[1]=factor*TO_FOUR_THIRDS[in[1]];
+  }
+}
+
 void Mpegtoraw::layer3dequantizesample(int ch,int gr,
 	int	 in[SBLIMIT][SSLIMIT], REAL out[SBLIMIT][SSLIMIT])
 {
 	layer3grinfo *gi=&(sideinfo.ch[ch].gr[gr]);
 	SFBANDINDEX *sfBandIndex=&(sfBandIndextable[version][frequency]);
 	REAL globalgain=POW2[gi->global_gain];
-	REAL *TO_FOUR_THIRDS=TO_FOUR_THIRDSTABLE+FOURTHIRDSTABLENUMBER;
+	const REAL *TO_FOUR_THIRDS=TO_FOUR_THIRDSTABLE+FOURTHIRDSTABLENUMBER;
+	bool simd=(synthesiskernel>=SK_SSE);
 
 	/* choose correct scalefactor band per block type, initalize boundary */
 	/* and apply formula per block type */
@@ -851,11 +967,9 @@ void Mpegtoraw::layer3dequantizesample(int ch,int gr,
 				layer3twopow2(gi->scalefac_scale,gi->preflag,
 				pretab[cb],scalefactors[ch].l[cb]);
 
-			for(;index<next_cb_boundary;)
-			{
-				out[0][index]=factor*TO_FOUR_THIRDS[in[0][index]];index++;
-				out[0][index]=factor*TO_FOUR_THIRDS[in[0][index]];index++;
-			}
+			layer3dequantize(&out[0][index],&in[0][index],
+				next_cb_boundary-index,factor,TO_FOUR_THIRDS,simd);
+			index=next_cb_boundary;
 		}while(index<ARRAYSIZE);
 	}
 	else if(!gi->mixed_block_flag)
@@ -875,10 +989,9 @@ void Mpegtoraw::layer3dequantizesample(int ch,int gr,
 				factor=globalgain*
 					layer3twopow2_1(gi->subblock_gain[k],gi->scalefac_scale,
 					scalefactors[ch].s[k][cb]);
-				do{
-					out[0][index]=factor*TO_FOUR_THIRDS[in[0][index]];index++;
-					out[0][index]=factor*TO_FOUR_THIRDS[in[0][index]];index++;
-				}while(--count);
+				layer3dequantize(&out[0][index],&in[0][index],
+					count<<1,factor,TO_FOUR_THIRDS,simd);
+				index+=count<<1;
 			}
 			cb++;
 		}while(index<ARRAYSIZE);
@@ -1001,7 +1114,7 @@ inline void Mpegtoraw::layer3fixtostereo(int gr,REAL in[2][SBLIMIT][SSLIMIT])
 		int i;
 		int		 is_pos[ARRAYSIZE];
 		RATIOS is_ratio[ARRAYSIZE];
-		RATIOS *ratios;
+		const RATIOS *ratios;
 
 		if(version)ratios=rat_2[gi->scalefac_compress%2];
 		else ratios=rat_1;
@@ -1086,7 +1199,7 @@ inline void Mpegtoraw::layer3fixtostereo(int gr,REAL in[2][SBLIMIT][SSLIMIT])
 						int k;
 
 						temp=in[1][0][0];in[1][0][0]=1.0;
-						for(k=3*SSLIMIT-1;in[1][0][k]==0.0;k--);
+						for(k=3*SSLIMIT-1;in[1][0][k]==0.0f;k--);
 						in[1][0][0]=temp;
 						for(i=0;sfBandIndex->l[i]<=k;i++);
 					}
@@ -1185,7 +1298,7 @@ inline void Mpegtoraw::layer3fixtostereo(int gr,REAL in[2][SBLIMIT][SSLIMIT])
 				int k;
 
 				temp=in[1][0][0];in[1][0][0]=1.0;
-				for(k=ARRAYSIZE-1;in[1][0][k]==0.0;k--);
+				for(k=ARRAYSIZE-1;in[1][0][k]==0.0f;k--);
 				in[1][0][0]=temp;
 				for(i=0;sfBandIndex->l[i]<=k;i++);
 			}
@@ -1396,6 +1509,40 @@ void layer3antialias_2(REAL  in[SBLIMIT][SSLIMIT],
   out[31][16]=in[31][16];out[31][17]=in[31][17];
 }
 
+#ifdef HAVE_LAYER3_SIMD
+// layer3antialias_2() with the eight butterflies of each subband boundary
+// in two vectors
+inline
+void layer3antialias_2_simd(REAL  in[SBLIMIT][SSLIMIT],
+			    REAL out[SBLIMIT][SSLIMIT])
+{
+  const __m128 cs0=_mm_loadu_ps(cs),cs1=_mm_loadu_ps(cs+4),
+	       ca0=_mm_loadu_ps(ca),ca1=_mm_loadu_ps(ca+4);
+
+  _mm_storeu_ps(&out[0][0],_mm_loadu_ps(&in[0][0]));
+  _mm_storeu_ps(&out[0][4],_mm_loadu_ps(&in[0][4]));
+
+  for(int index=SSLIMIT;index<=(SBLIMIT-1)*SSLIMIT;index+=SSLIMIT)
+  {
+    REAL *i=&in[0][index],*o=&out[0][index];
+    __m128 bd0=_mm_loadu_ps(i  ),bd1=_mm_loadu_ps(i+4),
+	   bu0=_mm_loadu_ps(i-4),bu1=_mm_loadu_ps(i-8);
+
+    bu0=REVERSE(bu0);bu1=REVERSE(bu1);
+    _mm_storeu_ps(o-4,REVERSE(_mm_sub_ps(_mm_mul_ps(bu0,cs0),_mm_mul_ps(bd0,ca0))));
+    _mm_storeu_ps(o-8,REVERSE(_mm_sub_ps(_mm_mul_ps(bu1,cs1),_mm_mul_ps(bd1,ca1))));
+    _mm_storeu_ps(o  ,_mm_add_ps(_mm_mul_ps(bd0,cs0),_mm_mul_ps(bu0,ca0)));
+    _mm_storeu_ps(o+4,_mm_add_ps(_mm_mul_ps(bd1,cs1),_mm_mul_ps(bu1,ca1)));
+    o[8-SSLIMIT]=i[8-SSLIMIT];
+    o[9-SSLIMIT]=i[9-SSLIMIT];
+  }
+
+  out[31][ 8]=in[31][ 8];out[31][ 9]=in[31][ 9];
+  _mm_storeu_ps(&out[31][10],_mm_loadu_ps(&in[31][10]));
+  _mm_storeu_ps(&out[31][14],_mm_loadu_ps(&in[31][14]));
+}
+#endif
+
 void Mpegtoraw::layer3reorderandantialias(int ch,int gr,
 					  REAL  in[SBLIMIT][SSLIMIT],
 					  REAL out[SBLIMIT][SSLIMIT])
@@ -1413,32 +1560,38 @@ void Mpegtoraw::layer3reorderandantialias(int ch,int gr,
     else
       layer3reorder_2(version,frequency,in,out);
   }
+#ifdef HAVE_LAYER3_SIMD
+  else if(synthesiskernel>=SK_SSE)
+    layer3antialias_2_simd(in,out);
+#endif
   else
     layer3antialias_2(in,out);
 }
 
-static void dct36(REAL *inbuf,REAL *prevblk1,REAL *prevblk2,REAL *wi,REAL *out)
+template<class V>
+static inline void dct36(V *inbuf,V *prevblk1,V *prevblk2,const REAL *wi,V *out,
+			  const int step)
 {
 #define MACRO0(v) {                                 \
-    REAL tmp;                                       \
+    V tmp;                                          \
     out2[9+(v)]=(tmp=sum0+sum1)*wi[27+(v)];         \
     out2[8-(v)]=tmp * wi[26-(v)];  }                \
     sum0-=sum1;                                     \
-    ts[SBLIMIT*(8-(v))]=out1[8-(v)]+sum0*wi[8-(v)]; \
-    ts[SBLIMIT*(9+(v))]=out1[9+(v)]+sum0*wi[9+(v)]; 
+    ts[step*(8-(v))]=out1[8-(v)]+sum0*wi[8-(v)];    \
+    ts[step*(9+(v))]=out1[9+(v)]+sum0*wi[9+(v)]; 
 #define MACRO1(v) { \
-    REAL sum0,sum1; \
+    V sum0,sum1; \
     sum0=tmp1a+tmp2a; \
     sum1=(tmp1b+tmp2b)*hsec_36[(v)]; \
     MACRO0(v); }
 #define MACRO2(v) {                    \
-    REAL sum0,sum1;                    \
+    V sum0,sum1;                       \
     sum0=tmp2a-tmp1a;                  \
     sum1=(tmp2b-tmp1b) * hsec_36[(v)]; \
     MACRO0(v); }
 
   {
-    register REAL *in = inbuf;
+    V *in = inbuf;
    
     in[17]+=in[16];in[16]+=in[15];in[15]+=in[14];in[14]+=in[13]; 
     in[13]+=in[12];in[12]+=in[11];in[11]+=in[10];in[10]+=in[ 9];
@@ -1450,12 +1603,12 @@ static void dct36(REAL *inbuf,REAL *prevblk1,REAL *prevblk2,REAL *wi,REAL *out)
     in[ 9]+=in[ 7];in[7] +=in[ 5];in[ 5]+=in[ 3];in[ 3]+=in[ 1];
 
     {
-      register REAL *c = cos_18;
-      register REAL *out2 = prevblk2;
-      register REAL *out1 = prevblk1;
-      register REAL *ts = out;
+      const REAL *c = cos_18;
+      V *out2 = prevblk2;
+      V *out1 = prevblk1;
+      V *ts = out;
       
-      REAL ta33,ta66,tb33,tb66;
+      V ta33,ta66,tb33,tb66;
 
       ta33=in[2*3+0]*c[3];
       ta66=in[2*6+0]*c[6];
@@ -1463,7 +1616,7 @@ static void dct36(REAL *inbuf,REAL *prevblk1,REAL *prevblk2,REAL *wi,REAL *out)
       tb66=in[2*6+1]*c[6];
 
       { 
-	REAL tmp1a,tmp2a,tmp1b,tmp2b;
+	V tmp1a,tmp2a,tmp1b,tmp2b;
 	tmp1a=          in[2*1+0]*c[1]+ta33          +in[2*5+0]*c[5]+in[2*7+0]*c[7];
 	tmp1b=          in[2*1+1]*c[1]+tb33          +in[2*5+1]*c[5]+in[2*7+1]*c[7];
 	tmp2a=in[2*0+0]+in[2*2+0]*c[2]+in[2*4+0]*c[4]+ta66          +in[2*8+0]*c[8];
@@ -1473,7 +1626,7 @@ static void dct36(REAL *inbuf,REAL *prevblk1,REAL *prevblk2,REAL *wi,REAL *out)
       }
 
       {
-	REAL tmp1a,tmp2a,tmp1b,tmp2b;
+	V tmp1a,tmp2a,tmp1b,tmp2b;
 	tmp1a=(in[2*1+0]-in[2*5+0]-in[2*7+0])*c[3];
 	tmp1b=(in[2*1+1]-in[2*5+1]-in[2*7+1])*c[3];
 	tmp2a=(in[2*2+0]-in[2*4+0]-in[2*8+0])*c[6]-in[2*6+0]+in[2*0+0];
@@ -1483,7 +1636,7 @@ static void dct36(REAL *inbuf,REAL *prevblk1,REAL *prevblk2,REAL *wi,REAL *out)
       }
 
       {
-	REAL tmp1a,tmp2a,tmp1b,tmp2b;
+	V tmp1a,tmp2a,tmp1b,tmp2b;
 	tmp1a=          in[2*1+0]*c[5]-ta33          -in[2*5+0]*c[7]+in[2*7+0]*c[1];
 	tmp1b=          in[2*1+1]*c[5]-tb33          -in[2*5+1]*c[7]+in[2*7+1]*c[1];
 	tmp2a=in[2*0+0]-in[2*2+0]*c[8]-in[2*4+0]*c[2]+ta66          +in[2*8+0]*c[4];
@@ -1493,7 +1646,7 @@ static void dct36(REAL *inbuf,REAL *prevblk1,REAL *prevblk2,REAL *wi,REAL *out)
       }
 
       {
-	REAL tmp1a,tmp2a,tmp1b,tmp2b;
+	V tmp1a,tmp2a,tmp1b,tmp2b;
 	tmp1a=          in[2*1+0]*c[7]-ta33          +in[2*5+0]*c[1]-in[2*7+0]*c[5];
 	tmp1b=          in[2*1+1]*c[7]-tb33          +in[2*5+1]*c[1]-in[2*7+1]*c[5];
 	tmp2a=in[2*0+0]-in[2*2+0]*c[4]+in[2*4+0]*c[8]+ta66          -in[2*8+0]*c[2];
@@ -1503,7 +1656,7 @@ static void dct36(REAL *inbuf,REAL *prevblk1,REAL *prevblk2,REAL *wi,REAL *out)
       }
 
       {
-        REAL sum0,sum1;
+        V sum0,sum1;
     	sum0= in[2*0+0]-in[2*2+0]+in[2*4+0]-in[2*6+0]+in[2*8+0];
     	sum1=(in[2*0+1]-in[2*2+1]+in[2*4+1]-in[2*6+1]+in[2*8+1])*hsec_36[4];
 	MACRO0(4);
@@ -1513,7 +1666,9 @@ static void dct36(REAL *inbuf,REAL *prevblk1,REAL *prevblk2,REAL *wi,REAL *out)
 }
 
 
-static void dct12(REAL *in,REAL *prevblk1,REAL *prevblk2,register REAL *wi,register REAL *out)
+template<class V>
+static inline void dct12(V *in,V *prevblk1,V *prevblk2,const REAL *wi,V *out,
+			  const int step)
 {
 #define DCT12_PART1   \
         in5=in[5*3];  \
@@ -1546,56 +1701,56 @@ static void dct12(REAL *in,REAL *prevblk1,REAL *prevblk2,register REAL *wi,regis
   in0-=in1;
 
   {
-    REAL in0,in1,in2,in3,in4,in5;
-    register REAL *pb1=prevblk1;
-    out[SBLIMIT*0]=pb1[0];out[SBLIMIT*1]=pb1[1];out[SBLIMIT*2]=pb1[2];
-    out[SBLIMIT*3]=pb1[3];out[SBLIMIT*4]=pb1[4];out[SBLIMIT*5]=pb1[5];
+    V in0,in1,in2,in3,in4,in5;
+    V *pb1=prevblk1;
+    out[step*0]=pb1[0];out[step*1]=pb1[1];out[step*2]=pb1[2];
+    out[step*3]=pb1[3];out[step*4]=pb1[4];out[step*5]=pb1[5];
  
     DCT12_PART1;
     
     {
-      REAL tmp0,tmp1=(in0-in4);
+      V tmp0,tmp1=(in0-in4);
       {
-	register REAL tmp2=(in1-in5)*hsec_12[1];
+	V tmp2=(in1-in5)*hsec_12[1];
 	tmp0=tmp1+tmp2;
 	tmp1-=tmp2;
       }
-      out[(17-1)*SBLIMIT]=pb1[17-1]+tmp0*wi[11-1];
-      out[(12+1)*SBLIMIT]=pb1[12+1]+tmp0*wi[ 6+1];
-      out[(6 +1)*SBLIMIT]=pb1[6 +1]+tmp1*wi[ 1  ];
-      out[(11-1)*SBLIMIT]=pb1[11-1]+tmp1*wi[ 5-1];
+      out[(17-1)*step]=pb1[17-1]+tmp0*wi[11-1];
+      out[(12+1)*step]=pb1[12+1]+tmp0*wi[ 6+1];
+      out[(6 +1)*step]=pb1[6 +1]+tmp1*wi[ 1  ];
+      out[(11-1)*step]=pb1[11-1]+tmp1*wi[ 5-1];
     }
 
     DCT12_PART2;
-    out[(17-0)*SBLIMIT]=pb1[17-0]+in2*wi[11-0];
-    out[(12+0)*SBLIMIT]=pb1[12+0]+in2*wi[ 6+0];
-    out[(12+2)*SBLIMIT]=pb1[12+2]+in3*wi[ 6+2];
-    out[(17-2)*SBLIMIT]=pb1[17-2]+in3*wi[11-2];
-
-    out[( 6+0)*SBLIMIT]=pb1[ 6+0]+in0*wi[0];
-    out[(11-0)*SBLIMIT]=pb1[11-0]+in0*wi[5-0];
-    out[( 6+2)*SBLIMIT]=pb1[ 6+2]+in4*wi[2];
-    out[(11-2)*SBLIMIT]=pb1[11-2]+in4*wi[5-2];
+    out[(17-0)*step]=pb1[17-0]+in2*wi[11-0];
+    out[(12+0)*step]=pb1[12+0]+in2*wi[ 6+0];
+    out[(12+2)*step]=pb1[12+2]+in3*wi[ 6+2];
+    out[(17-2)*step]=pb1[17-2]+in3*wi[11-2];
+
+    out[( 6+0)*step]=pb1[ 6+0]+in0*wi[0];
+    out[(11-0)*step]=pb1[11-0]+in0*wi[5-0];
+    out[( 6+2)*step]=pb1[ 6+2]+in4*wi[2];
+    out[(11-2)*step]=pb1[11-2]+in4*wi[5-2];
   }
 
   in++;
   {
-    REAL in0,in1,in2,in3,in4,in5;
-    register REAL *pb2 = prevblk2;
+    V in0,in1,in2,in3,in4,in5;
+    V *pb2 = prevblk2;
  
     DCT12_PART1;
 
     {
-      REAL tmp0,tmp1=(in0-in4);
+      V tmp0,tmp1=(in0-in4);
       {
-	REAL tmp2=(in1-in5)*hsec_12[1];
+	V tmp2=(in1-in5)*hsec_12[1];
 	tmp0=tmp1+tmp2;
 	tmp1-=tmp2;
       }
       pb2[5-1]=tmp0*wi[11-1];
       pb2[0+1]=tmp0*wi[6+1];
-      out[(12+1)*SBLIMIT]+=tmp1*wi[1];
-      out[(17-1)*SBLIMIT]+=tmp1*wi[5-1];
+      out[(12+1)*step]+=tmp1*wi[1];
+      out[(17-1)*step]+=tmp1*wi[5-1];
     }
 
     DCT12_PART2;
@@ -1605,24 +1760,24 @@ static void dct12(REAL *in,REAL *prevblk1,REAL *prevblk2,register REAL *wi,regis
     pb2[0+2]=in3*wi[6+2];
     pb2[5-2]=in3*wi[11-2];
 
-    out[(12+0)*SBLIMIT]+=in0*wi[0];
-    out[(17-0)*SBLIMIT]+=in0*wi[5-0];
-    out[(12+2)*SBLIMIT]+=in4*wi[2];
-    out[(17-2)*SBLIMIT]+=in4*wi[5-2];
+    out[(12+0)*step]+=in0*wi[0];
+    out[(17-0)*step]+=in0*wi[5-0];
+    out[(12+2)*step]+=in4*wi[2];
+    out[(17-2)*step]+=in4*wi[5-2];
   }
 
   in++; 
   {
-    REAL in0,in1,in2,in3,in4,in5;
-    register REAL *pb2 = prevblk2;
-    pb2[12]=pb2[13]=pb2[14]=pb2[15]=pb2[16]=pb2[17]=0.0;
+    V in0,in1,in2,in3,in4,in5;
+    V *pb2 = prevblk2;
+    pb2[12]=pb2[13]=pb2[14]=pb2[15]=pb2[16]=pb2[17]=0.0f;
 
     DCT12_PART1;
 
     {
-      REAL tmp0,tmp1=(in0-in4);
+      V tmp0,tmp1=(in0-in4);
       {
-	REAL tmp2=(in1-in5)*hsec_12[1];
+	V tmp2=(in1-in5)*hsec_12[1];
 	tmp0=tmp1+tmp2;
 	tmp1-=tmp2;
       }
@@ -1645,6 +1800,56 @@ static void dct12(REAL *in,REAL *prevblk1,REAL *prevblk2,register REAL *wi,regis
   }
 }
 
+#ifdef HAVE_LAYER3_SIMD
+// Transposes four subbands of SSLIMIT values into SSLIMIT REAL4s
+static inline void layer3load4(const REAL *in,REAL4 *out)
+{
+  for(int k=0;k<16;k+=4)
+  {
+    __m128 r0=_mm_loadu_ps(in          +k),r1=_mm_loadu_ps(in+  SSLIMIT+k),
+	   r2=_mm_loadu_ps(in+2*SSLIMIT+k),r3=_mm_loadu_ps(in+3*SSLIMIT+k);
+
+    _MM_TRANSPOSE4_PS(r0,r1,r2,r3);
+    out[k]=r0;out[k+1]=r1;out[k+2]=r2;out[k+3]=r3;
+  }
+  for(int k=16;k<SSLIMIT;k++)
+    out[k]=_mm_setr_ps(in[k],in[SSLIMIT+k],in[2*SSLIMIT+k],in[3*SSLIMIT+k]);
+}
+
+static inline void layer3store4(const REAL4 *in,REAL *out)
+{
+  for(int k=0;k<16;k+=4)
+  {
+    __m128 r0=in[k].v,r1=in[k+1].v,r2=in[k+2].v,r3=in[k+3].v;
+
+    _MM_TRANSPOSE4_PS(r0,r1,r2,r3);
+    _mm_storeu_ps(out          +k,r0);_mm_storeu_ps(out+  SSLIMIT+k,r1);
+    _mm_storeu_ps(out+2*SSLIMIT+k,r2);_mm_storeu_ps(out+3*SSLIMIT+k,r3);
+  }
+  for(int k=16;k<SSLIMIT;k++)
+  {
+    REAL t[4];
+
+    _mm_storeu_ps(t,in[k].v);
+    out[k]=t[0];out[SSLIMIT+k]=t[1];out[2*SSLIMIT+k]=t[2];out[3*SSLIMIT+k]=t[3];
+  }
+}
+
+// dct36()/dct12() of four subbands with the same block type at once
+static inline void layer3hybrid4(REAL *ci,REAL *prev1,REAL *prev2,int bt,
+				 REAL *co)
+{
+  REAL4 in[SSLIMIT],pb1[SSLIMIT],pb2[SSLIMIT],out[SSLIMIT];
+
+  layer3load4(ci,in);
+  layer3load4(prev1,pb1);
+  if(bt==2)dct12(in,pb1,pb2,win[2],out,1);
+  else     dct36(in,pb1,pb2,win[bt],out,1);
+  layer3store4(pb2,prev2);
+  for(int k=0;k<SSLIMIT;k++)_mm_storeu_ps(co+k*SBLIMIT,out[k].v);
+}
+#endif
+
 void Mpegtoraw::layer3hybrid(int ch,int gr,REAL in[SBLIMIT][SSLIMIT],
 			                   REAL out[SSLIMIT][SBLIMIT])
 {
@@ -1663,6 +1868,26 @@ void Mpegtoraw::layer3hybrid(int ch,int gr,REAL in[SBLIMIT][SSLIMIT],
          *co=(REAL *)out;
     int  i;
 
+#ifdef HAVE_LAYER3_SIMD
+    if(synthesiskernel>=SK_SSE)
+    {
+      int sb=0,subbands=(downfrequency ? SBLIMIT/2 : SBLIMIT);
+
+      // Mixed blocks transform subbands 0 and 1 differently
+      if(bt1!=bt2)
+	for(;sb<4;sb++,ci+=SSLIMIT,prev1+=SSLIMIT,prev2+=SSLIMIT,co++)
+	{
+	  int bt=(sb<2 ? bt1 : bt2);
+
+	  if(bt==2)dct12(ci,prev1,prev2,win[2],co,SBLIMIT);
+	  else     dct36(ci,prev1,prev2,win[bt],co,SBLIMIT);
+	}
+      for(;sb<subbands;sb+=4,ci+=4*SSLIMIT,prev1+=4*SSLIMIT,prev2+=4*SSLIMIT,co+=4)
+	layer3hybrid4(ci,prev1,prev2,bt2,co);
+      return;
+    }
+#endif
+
     if(downfrequency)i=(SBLIMIT/2)-2;
     else i=SBLIMIT-2;
 
@@ -1670,32 +1895,32 @@ void Mpegtoraw::layer3hybrid(int ch,int gr,REAL in[SBLIMIT][SSLIMIT],
     {
       if(!bt1)
       {
- 	dct36(ci,prev1,prev2,win[0],co);
+ 	dct36(ci,prev1,prev2,win[0],co,SBLIMIT);
 	ci+=SSLIMIT;prev1+=SSLIMIT;prev2+=SSLIMIT;co++;
- 	dct36(ci,prev1,prev2,win[0],co);
+ 	dct36(ci,prev1,prev2,win[0],co,SBLIMIT);
       }
       else
       {
-	dct12(ci,prev1,prev2,win[2],co);
+	dct12(ci,prev1,prev2,win[2],co,SBLIMIT);
 	ci+=SSLIMIT;prev1+=SSLIMIT;prev2+=SSLIMIT;co++;
-	dct12(ci,prev1,prev2,win[2],co);
+	dct12(ci,prev1,prev2,win[2],co,SBLIMIT);
       }
 
       do{
 	ci+=SSLIMIT;prev1+=SSLIMIT;prev2+=SSLIMIT;co++;
-	dct12(ci,prev1,prev2,win[2],co);
+	dct12(ci,prev1,prev2,win[2],co,SBLIMIT);
       }while(--i);
     }
     else
     {
-      dct36(ci,prev1,prev2,win[bt1],co);
+      dct36(ci,prev1,prev2,win[bt1],co,SBLIMIT);
       ci+=SSLIMIT;prev1+=SSLIMIT;prev2+=SSLIMIT;co++;
-      dct36(ci,prev1,prev2,win[bt1],co);
+      dct36(ci,prev1,prev2,win[bt1],co,SBLIMIT);
 
       do
       {
 	ci+=SSLIMIT;prev1+=SSLIMIT;prev2+=SSLIMIT;co++;
-	dct36(ci,prev1,prev2,win[bt2],co);
+	dct36(ci,prev1,prev2,win[bt2],co,SBLIMIT);
       }while(--i);
     }
   }
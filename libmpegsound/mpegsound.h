@@ -14,6 +14,7 @@
 #endif
 #include <errno.h>
 #include <stdio.h>
+#include <string.h>
 #include <sys/types.h>
 #ifdef HAVE_BOOL_H
 #include <bool.h>
@@ -115,6 +116,7 @@
 
 // Huffmancode
 #define HTN 34
+#define HUFFMANLOOKUPBITS 8
 
 
 /*******************************************/
@@ -169,6 +171,9 @@ struct buffer_node {
 
 enum soundtype { ST_NONE, ST_RAW, ST_WAV };
 
+// Subband synthesis implementations, see Mpegtoraw::setsynthesiskernel()
+enum synthesiskernel { SK_AUTO, SK_SCALAR, SK_SSE, SK_AVX };
+
 typedef struct _waveheader {
   u_int32_t     main_chunk;  // 'RIFF'
   u_int32_t     length;      // filelen
@@ -307,6 +312,38 @@ private:
   int  size;
 };
 
+// Inputstream from a memory mapped local file
+class Soundfilemapping;
+class Soundinputstreamfrommap : public Soundinputstream
+{
+public:
+  Soundinputstreamfrommap();
+  ~Soundinputstreamfrommap();
+
+  bool open(const char *filename);
+  void close(void);
+  bool _readbuffer(char *buffer,int bytes);
+  int  getbytedirect(void);
+  bool eof(void);
+  int  getblock(char *buffer,int size);
+
+  int  getsize(void);
+  int  getposition(void);
+  void setposition(int pos);
+
+private:
+  void readahead(void);
+  void checkwindow(size_t bytes);
+
+  Soundfilemapping    *mapping;
+  const unsigned char *data;
+  size_t size;
+  size_t position;
+  size_t readaheadposition;
+  size_t checkedposition;
+  bool   ateof;
+};
+
 // Inputstream from http
 class Soundinputstreamfromhttp : public Soundinputstream
 {
@@ -600,7 +637,7 @@ private:
 class Mpegbitwindow
 {
 public:
-  Mpegbitwindow(){bitindex=point=0;};
+  Mpegbitwindow(){bitindex=point=0;memset(buffer,0,sizeof(buffer));};
 
   void initialize(void)  {bitindex=point=0;};
   int  gettotalbit(void) const {return bitindex;};
@@ -611,10 +648,13 @@ public:
   int  getbit(void);
   int  getbits9(int bits);
   int  getbits(int bits);
+  // Next 1..32 bits without consuming them
+  unsigned int peekbits(int bits) const;
 
 private:
   int  point,bitindex;
-  char buffer[2*WINDOWSIZE];
+  // peekbits() loads 64 bits at once, the padding keeps it inside buffer
+  char buffer[2*WINDOWSIZE+8];
 };
 
 
@@ -630,7 +670,7 @@ private:
   static const REAL scalefactorstable[64];
   static const HUFFMANCODETABLE ht[HTN];
   static const REAL filter[512];
-  static REAL hcos_64[16],hcos_32[8],hcos_16[4],hcos_8[2],hcos_4;
+  static const REAL hcos_64[16],hcos_32[8],hcos_16[4],hcos_8[2],hcos_4;
 
   /*************************/
   /* MPEG header variables */
@@ -686,6 +726,18 @@ public:
   void setforcetomono(short flag);
   void set8bitmode() { if(player) player->set8bitmode(); }
   void setdownfrequency(int value);
+  // Select the subband synthesis implementation for all decoders. Any
+  // SIMD kernel also vectorizes layer III dequantization, antialiasing
+  // and IMDCT. SK_AUTO picks the fastest one supported by the CPU,
+  // SK_SCALAR is the reference implementation. Returns false if the
+  // kernel is unsupported. A decoder switches at its next frame.
+  static bool setsynthesiskernel(int kernel);
+  static int  getsynthesiskernel(void);
+  // Decode layer III Huffman codes through lookup tables (default) or by
+  // walking the code trees bit by bit, which is the reference
+  // implementation. A decoder switches at its next frame.
+  static void sethuffmanlookup(bool enable);
+  static bool gethuffmanlookup(void);
 
   /******************************************/
   /* Functions getting other MPEG variables */
@@ -796,6 +848,7 @@ public:
 private:
   int __errorcode;
   bool seterrorcode(int errorno){__errorcode=errorno;return false;};
+  void clearhistory(void);
 
   /*****************************/
   /* Loading MPEG-Audio stream */
@@ -864,6 +917,13 @@ private:
   void generate_2(void);
   void subbandsynthesis_2(REAL *fractionL,REAL *fractionR);
 
+  // Kernel used for the current frame, taken from the selection before
+  // each frame, so that a frame is decoded by one kernel throughout
+  int synthesiskernel;
+  static void synthesisinitialize(void);
+  static void computeprefix_simd(const REAL *fraction,REAL *q,bool half);
+  void generate_simd(int rowstep);
+
   // Extarctor
   void extractlayer1(void);    // MPEG-1
   void extractlayer2(void);
@@ -873,6 +933,7 @@ private:
 
   // Functions for layer 3
   void layer3initialize(void);
+  static void layer3tableinitialize(void);
   bool layer3getsideinfo(void);
   bool layer3getsideinfo_2(void);
   void layer3getscalefactors(int ch,int gr);
@@ -889,6 +950,11 @@ private:
   void layer3hybrid(int ch,int gr,REAL in[SBLIMIT][SSLIMIT],
 		                  REAL out[SSLIMIT][SBLIMIT]);
   
+  static const short *huffmanlookup[HTN];
+  // Whether the current frame uses huffmanlookup, see synthesiskernel
+  bool usehuffmanlookup;
+  static void huffmaninitialize(void);
+  int  huffmandecode(const HUFFMANCODETABLE *h);
   void huffmandecoder_1(const HUFFMANCODETABLE *h,int *x,int *y);
   void huffmandecoder_2(const HUFFMANCODETABLE *h,int *x,int *y,int *v,int *w);
 
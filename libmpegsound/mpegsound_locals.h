@@ -50,4 +50,13 @@ inline int Mpegtoraw::getbit(void)
   return r;
 };
 
+// Out of range values are clipped before they are converted, since the
+// conversion of a value beyond the range of int is undefined.
+inline int clipraw(REAL r)
+{
+  if(r>MAXSCALE)return MAXSCALE;
+  if(r<MINSCALE)return MINSCALE;
+  return (int)r;
+}
+
 #endif
@@ -184,8 +184,29 @@ const REAL Mpegtoraw::filter[512]=
    0.007919312, -0.003326416,  0.000473022,  0.000015259
 };
 
-REAL Mpegtoraw::hcos_64[16],
-     Mpegtoraw::hcos_32[ 8],
-     Mpegtoraw::hcos_16[ 4],
-     Mpegtoraw::hcos_8 [ 2],
-     Mpegtoraw::hcos_4;
+// hcos_n[i]=1/(2*cos(PI*(2*i+1)/n)), rounded to REAL
+const REAL Mpegtoraw::hcos_64[16]=
+{
+   0.500603020,  0.505470932,  0.515447319,  0.531042576,
+   0.553103924,  0.582934976,  0.622504115,  0.674808323,
+   0.744536281,  0.839349627,  0.972568214,  1.169439912,
+   1.484164596,  2.057780981,  3.407608509, 10.190008163
+};
+
+const REAL Mpegtoraw::hcos_32[ 8]=
+{
+   0.502419293,  0.522498608,  0.566944063,  0.646821797,
+   0.788154602,  1.060677648,  1.722447157,  5.101148605
+};
+
+const REAL Mpegtoraw::hcos_16[ 4]=
+{
+   0.509795606,  0.601344883,  0.899976194,  2.562915564
+};
+
+const REAL Mpegtoraw::hcos_8 [ 2]=
+{
+   0.541196108,  1.306563020
+};
+
+const REAL Mpegtoraw::hcos_4=0.707106769;
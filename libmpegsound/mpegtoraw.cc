@@ -43,7 +43,6 @@ extern "C" {
 }
 #endif
 
-#define MY_PI 3.14159265358979323846
 #undef DEBUG
 
 #ifdef NEWTHREAD
@@ -518,6 +517,8 @@ Mpegtoraw::Mpegtoraw(Soundinputstream *loader,Soundplayer *player)
 	forcetomonoflag = 0;
 	downfrequency = 0;
 	scan_mp3 = 1;
+	synthesiskernel = SK_SCALAR;
+	usehuffmanlookup = true;
 
 	this->loader=loader;
 	this->player=player;
@@ -777,39 +778,42 @@ inline void parseID3(Soundinputstream *fp,ID3 *data)
 
 // Convert mpeg to raw
 // Mpeg header class
-bool Mpegtoraw::initialize(const char *filename)
+/* Function   : clearhistory
+ * Description: Clears the state carried over from decoded frames to the
+ *            : following ones: the synthesis buffers, the previous
+ *            : layer III blocks and the bit reservoir.
+ * Parameters : None
+ * Returns    : Nothing
+ * SideEffects: None.
+ */
+void Mpegtoraw::clearhistory(void)
 {
 	register int i;
-	register REAL *s1,*s2;
-	REAL *s3,*s4;
-	static bool initialized=false;
 
-	if (!filename)
-		return false;
-
-	scalefactor       = SCALE;
 	calcbufferoffset  = 15;
 	currentcalcbuffer = 0;
-
-	s1 = calcbufferL[0]; s2 = calcbufferR[0];
-	s3 = calcbufferL[1]; s4 = calcbufferR[1];
 	for(i=CALCBUFFERSIZE-1;i>=0;i--)
 	{
 		calcbufferL[0][i] = calcbufferL[1][i] =
 		calcbufferR[0][i] = calcbufferR[1][i] = 0.0;
 	}
+	layer3initialize();
+}
 
-	if(!initialized)
-	{
-		for(i=0;i<16;i++)hcos_64[i]=1.0/(2.0*cos(MY_PI*double(i*2+1)/64.0));
-		for(i=0;i< 8;i++)hcos_32[i]=1.0/(2.0*cos(MY_PI*double(i*2+1)/32.0));
-		for(i=0;i< 4;i++)hcos_16[i]=1.0/(2.0*cos(MY_PI*double(i*2+1)/16.0));
-		for(i=0;i< 2;i++)hcos_8 [i]=1.0/(2.0*cos(MY_PI*double(i*2+1)/ 8.0));
-		hcos_4=1.0/(2.0*cos(MY_PI*1.0/4.0));
-		initialized=true;
-	}
+bool Mpegtoraw::initialize(const char *filename)
+{
+	register int i;
 
-	layer3initialize();
+	if (!filename)
+		return false;
+
+	scalefactor       = SCALE;
+
+	// The shared tables are set up only by the first decoder, even if
+	// several are created concurrently
+	synthesiskernel=getsynthesiskernel();
+	usehuffmanlookup=gethuffmanlookup();
+	clearhistory();
 
 	currentframe=decodeframe=0;
 	is_vbr = 0;
@@ -1111,6 +1115,9 @@ void Mpegtoraw::setframe(int framenumber)
 	}
 
 	clearbuffer();
+	// Decoding continues like a fresh decoder, independently of the frames
+	// decoded before.
+	clearhistory();
 	loader->setposition(pos);
 	decodeframe=currentframe=framenumber;
 }
@@ -1558,6 +1565,8 @@ bool Mpegtoraw::run(int frames)
 
 		decodeframe++;
 
+		synthesiskernel=getsynthesiskernel();
+		usehuffmanlookup=gethuffmanlookup();
 		if		 (layer==3)extractlayer3();
 		else if(layer==2)extractlayer2();
 		else if(layer==1)extractlayer1();
@@ -0,0 +1,147 @@
+/* MPEG/WAVE Sound library */
+
+// Soundfilemapping.cc
+// Read-only memory mappings of media files, shared by all their readers
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <mutex>
+
+#include "soundfilemapping.h"
+#include "soundreadahead.h"
+
+Soundfilemapping *Soundfilemapping::mappings=NULL;
+
+static std::mutex mappingsmutex;
+
+Soundfilemapping::Soundfilemapping()
+{
+	next=NULL;
+	fd=-1;
+	device=0;
+	inode=0;
+	users=0;
+	data=NULL;
+	size=0;
+	truncated=false;
+}
+
+Soundfilemapping::~Soundfilemapping()
+{
+	if(data)
+		munmap((void *)data,size);
+	if(fd>=0)
+	{
+		Soundreadahead::cancel(fd);
+		close(fd);
+	}
+}
+
+Soundfilemapping *Soundfilemapping::attach(const char *filename)
+{
+	struct stat buf;
+	int fd;
+
+	if(filename==NULL || (fd=open(filename,O_RDONLY))<0)
+		return NULL;
+	if(fstat(fd,&buf)!=0 || !S_ISREG(buf.st_mode) || buf.st_size<=0 ||
+	   (unsigned long long)buf.st_size>(unsigned long long)SIZE_MAX)
+	{
+		close(fd);
+		return NULL;
+	}
+
+	std::lock_guard<std::mutex> lock(mappingsmutex);
+
+	/* A replaced file gets a new inode, so it is never served from the
+	 * mapping of its predecessor. A mapping of a file found truncated is
+	 * not shared any more, even if the file has grown back to its size. */
+	for(Soundfilemapping *m=mappings;m;m=m->next)
+		if(m->device==buf.st_dev && m->inode==buf.st_ino &&
+		   m->size==(size_t)buf.st_size &&
+		   !m->truncated.load(std::memory_order_relaxed))
+		{
+			close(fd);
+			m->users++;
+			return m;
+		}
+
+	// The descriptor stays open for Soundreadahead
+	void *data=mmap(NULL,buf.st_size,PROT_READ,MAP_SHARED,fd,0);
+	if(data==MAP_FAILED)
+	{
+		close(fd);
+		return NULL;
+	}
+	madvise(data,buf.st_size,MADV_SEQUENTIAL);
+
+	Soundfilemapping *m=new Soundfilemapping;
+	m->device=buf.st_dev;
+	m->inode=buf.st_ino;
+	m->users=1;
+	m->data=(const unsigned char *)data;
+	m->size=buf.st_size;
+	m->fd=fd;
+	m->next=mappings;
+	mappings=m;
+	return m;
+}
+
+void Soundfilemapping::detach(Soundfilemapping *mapping)
+{
+	if(mapping==NULL)
+		return;
+
+	std::lock_guard<std::mutex> lock(mappingsmutex);
+
+	if(--mapping->users>0)
+		return;
+	for(Soundfilemapping **m=&mappings;*m;m=&(*m)->next)
+		if(*m==mapping)
+		{
+			*m=mapping->next;
+			break;
+		}
+	delete mapping;
+}
+
+void Soundfilemapping::readahead(size_t offset, size_t length) const
+{
+	const size_t pagesize=(size_t)sysconf(_SC_PAGESIZE);
+	size_t start;
+
+	if(offset>=size)
+		return;
+	if(length>size-offset)
+		length=size-offset;
+	start=offset&~(pagesize-1);
+	if(Soundreadahead::prefetch(fd,start,length+(offset-start)))
+		return;
+	madvise((void *)(data+start),length+(offset-start),MADV_WILLNEED);
+}
+
+size_t Soundfilemapping::available(size_t offset, size_t length) const
+{
+	struct stat buf;
+	size_t end=size;
+
+	if(fstat(fd,&buf)!=0)
+		return 0;
+	if((off_t)end>buf.st_size)
+	{
+		end=(size_t)buf.st_size;
+		truncated.store(true,std::memory_order_relaxed);
+	}
+	if(offset>=end)
+		return 0;
+	return (length<end-offset) ? length : end-offset;
+}
@@ -0,0 +1,78 @@
+#ifndef _MPEGSOUND_SOUNDFILEMAPPING_
+#define _MPEGSOUND_SOUNDFILEMAPPING_
+
+#include <sys/types.h>
+
+#include <atomic>
+
+class Soundfilemapping
+{
+public:
+	/* Function   : attach
+	 * Description: Maps a file read-only into memory. All users of the
+	 *            : same file (device and inode) share one mapping.
+	 * Parameters : filename
+	 *            :  Name of the file
+	 * Returns    : The mapping, or NULL if the file cannot be mapped
+	 * SideEffects: The mapping's reference count is incremented.
+	 */
+	static Soundfilemapping *attach(const char *filename);
+
+	/* Function   : detach
+	 * Description: Releases a mapping obtained by attach(). The file is
+	 *            : unmapped when its last user detaches.
+	 * Parameters : mapping
+	 *            :  The mapping
+	 * Returns    : Nothing
+	 * SideEffects: None.
+	 */
+	static void detach(Soundfilemapping *mapping);
+
+	/* Function   : readahead
+	 * Description: Has a range of the file read in the background, by
+	 *            : Soundreadahead if it is running, otherwise by the
+	 *            : kernel's read-ahead.
+	 * Parameters : offset
+	 *            :  Start of the range
+	 *            : length
+	 *            :  Length of the range
+	 * Returns    : Nothing
+	 * SideEffects: None.
+	 */
+	void readahead(size_t offset, size_t length) const;
+
+	/* Function   : available
+	 * Description: Checks how much of a range the file still holds. A
+	 *            : file truncated while it is mapped raises SIGBUS on
+	 *            : accesses beyond its new end, so readers check each
+	 *            : range of the mapping right before they access it. A
+	 *            : mapping found truncated is not shared any more.
+	 * Parameters : offset
+	 *            :  Start of the range
+	 *            : length
+	 *            :  Length of the range
+	 * Returns    : The length of the range that is still in the file
+	 * SideEffects: A truncated mapping is no longer shared.
+	 */
+	size_t available(size_t offset, size_t length) const;
+
+	const unsigned char *getdata(void) const { return data; };
+	size_t               getsize(void) const { return size; };
+
+private:
+	Soundfilemapping();
+	~Soundfilemapping();
+
+	Soundfilemapping    *next;
+	int                  fd;
+	dev_t                device;
+	ino_t                inode;
+	unsigned int         users;
+	const unsigned char *data;
+	size_t               size;
+	mutable std::atomic<bool> truncated;
+
+	static Soundfilemapping *mappings;
+};
+
+#endif /* _MPEGSOUND_SOUNDFILEMAPPING_ */
@@ -35,7 +35,14 @@ Soundinputstream *Soundinputstream::hopen(const char *filename,int *errorcode)
 	else if (strstr(filename,"://"))
 		st=new Soundinputstreamfromhttp;
 	else
+	{
+		/* Local files are memory mapped, if possible */
+		st=new Soundinputstreamfrommap;
+		if (st!=NULL && st->open(filename))
+			return st;
+		delete st;
 		st=new Soundinputstreamfromfile;
+	}
 
 	if (st==NULL)
 	{
@@ -0,0 +1,299 @@
+/* MPEG/WAVE Sound library */
+
+// Soundreadahead.cc
+// Asynchronous read-ahead of media files by io_uring fadvise requests
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "soundreadahead.h"
+
+#ifdef HAVE_IO_URING
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <deque>
+#include <mutex>
+
+// At most this many chunks wait for a free slot. Further requests are
+// dropped; the kernel's own read-ahead still covers them.
+#define MAXPENDING 4096
+
+struct Readrequest
+{
+	int    fd;
+	size_t offset;
+	size_t length;
+};
+
+static std::mutex                 enginemutex;
+static bool                       enginerunning=false;
+
+static int                        ringfd=-1;
+static void                      *sqring=MAP_FAILED;
+static void                      *cqring=MAP_FAILED;
+static size_t                     sqringsize,cqringsize;
+static struct io_uring_sqe       *sqes=(struct io_uring_sqe *)MAP_FAILED;
+static size_t                     sqessize;
+static unsigned int              *sqhead,*sqtail,*sqmask,*sqarray;
+static unsigned int              *cqhead,*cqtail;
+
+static unsigned int               slots;
+static size_t                     chunksize;
+static unsigned int               inflight;
+static std::deque<Readrequest>    pending;
+
+static void release(void)
+{
+	if(sqes!=MAP_FAILED)munmap(sqes,sqessize);
+	if(cqring!=MAP_FAILED && cqring!=sqring)munmap(cqring,cqringsize);
+	if(sqring!=MAP_FAILED)munmap(sqring,sqringsize);
+	if(ringfd>=0)close(ringfd);
+	sqes=(struct io_uring_sqe *)MAP_FAILED;
+	sqring=cqring=MAP_FAILED;
+	ringfd=-1;
+}
+
+// Tells whether the kernel supports IORING_OP_FADVISE.
+static bool fadvisesupported(void)
+{
+	const size_t size=sizeof(struct io_uring_probe)+
+		(IORING_OP_LAST+1)*sizeof(struct io_uring_probe_op);
+	struct io_uring_probe *probe=(struct io_uring_probe *)calloc(1,size);
+	bool supported=false;
+
+	if(probe==NULL)
+		return false;
+	if(syscall(__NR_io_uring_register,ringfd,IORING_REGISTER_PROBE,probe,IORING_OP_LAST+1)==0)
+		supported=(probe->last_op>=IORING_OP_FADVISE) &&
+			  (probe->ops[IORING_OP_FADVISE].flags&IO_URING_OP_SUPPORTED);
+	free(probe);
+	return supported;
+}
+
+// Puts one entry into the submission queue. The caller holds enginemutex
+// and has checked that a slot is free; the queue holds one entry per slot.
+static struct io_uring_sqe *getsqe(void)
+{
+	const unsigned int tail=*sqtail;
+	const unsigned int index=tail&*sqmask;
+	struct io_uring_sqe *sqe=&sqes[index];
+
+	memset(sqe,0,sizeof(*sqe));
+	sqarray[index]=index;
+	__atomic_store_n(sqtail,tail+1,__ATOMIC_RELEASE);
+	return sqe;
+}
+
+// Hands the prepared entries to the kernel. If it does not take all of
+// them, the remaining ones are taken back out of the queue and their slots
+// are freed again; their chunks are dropped.
+static void submit(unsigned int count)
+{
+	while(count>0)
+	{
+		const int result=(int)syscall(__NR_io_uring_enter,ringfd,count,0,0,NULL,0);
+		if(result<0)
+		{
+			if(errno==EINTR || errno==EAGAIN || errno==EBUSY)continue;
+			break;
+		}
+		count-=(unsigned int)result;
+		if(result==0)break;
+	}
+	if(count>0)
+	{
+		__atomic_store_n(sqtail,__atomic_load_n(sqhead,__ATOMIC_ACQUIRE),__ATOMIC_RELEASE);
+		inflight-=count;
+	}
+}
+
+// Frees the slots of finished requests. The caller holds enginemutex.
+static void reap(void)
+{
+	unsigned int head=*cqhead;
+	const unsigned int tail=__atomic_load_n(cqtail,__ATOMIC_ACQUIRE);
+
+	inflight-=tail-head;
+	head=tail;
+	__atomic_store_n(cqhead,head,__ATOMIC_RELEASE);
+}
+
+// Moves queued chunks into free slots. The caller holds enginemutex.
+static void submitpending(void)
+{
+	unsigned int count=0;
+
+	reap();
+	while(inflight<slots && !pending.empty())
+	{
+		const Readrequest request=pending.front();
+		struct io_uring_sqe *sqe=getsqe();
+
+		pending.pop_front();
+		sqe->opcode=IORING_OP_FADVISE;
+		sqe->fd=request.fd;
+		sqe->off=request.offset;
+		sqe->len=(__u32)request.length;
+		sqe->fadvise_advice=POSIX_FADV_WILLNEED;
+		inflight++;
+		count++;
+	}
+	if(count>0)
+		submit(count);
+}
+
+bool Soundreadahead::start(unsigned int requests, size_t size)
+{
+	std::lock_guard<std::mutex> lock(enginemutex);
+	struct io_uring_params params;
+
+	if(enginerunning)
+		return true;
+	if(requests<1 || size<1)
+		return false;
+
+	// The completion queue is at least twice as large as the submission
+	// queue, so that completions of all slots always fit into it.
+	memset(&params,0,sizeof(params));
+	if((ringfd=(int)syscall(__NR_io_uring_setup,requests,&params))<0)
+	{
+		ringfd=-1;
+		return false;
+	}
+	if(!fadvisesupported())
+	{
+		release();
+		return false;
+	}
+
+	sqringsize=params.sq_off.array+params.sq_entries*sizeof(unsigned int);
+	cqringsize=params.cq_off.cqes+params.cq_entries*sizeof(struct io_uring_cqe);
+	if(params.features&IORING_FEAT_SINGLE_MMAP)
+	{
+		if(cqringsize>sqringsize)sqringsize=cqringsize;
+		cqringsize=sqringsize;
+	}
+	sqring=mmap(NULL,sqringsize,PROT_READ|PROT_WRITE,MAP_SHARED|MAP_POPULATE,
+		    ringfd,IORING_OFF_SQ_RING);
+	if(sqring==MAP_FAILED)
+	{
+		release();
+		return false;
+	}
+	if(params.features&IORING_FEAT_SINGLE_MMAP)
+		cqring=sqring;
+	else if((cqring=mmap(NULL,cqringsize,PROT_READ|PROT_WRITE,MAP_SHARED|MAP_POPULATE,
+			      ringfd,IORING_OFF_CQ_RING))==MAP_FAILED)
+	{
+		release();
+		return false;
+	}
+	sqessize=params.sq_entries*sizeof(struct io_uring_sqe);
+	sqes=(struct io_uring_sqe *)mmap(NULL,sqessize,PROT_READ|PROT_WRITE,
+					 MAP_SHARED|MAP_POPULATE,ringfd,IORING_OFF_SQES);
+	if(sqes==MAP_FAILED)
+	{
+		release();
+		return false;
+	}
+
+	sqhead =(unsigned int *)((char *)sqring+params.sq_off.head);
+	sqtail =(unsigned int *)((char *)sqring+params.sq_off.tail);
+	sqmask =(unsigned int *)((char *)sqring+params.sq_off.ring_mask);
+	sqarray=(unsigned int *)((char *)sqring+params.sq_off.array);
+	cqhead =(unsigned int *)((char *)cqring+params.cq_off.head);
+	cqtail =(unsigned int *)((char *)cqring+params.cq_off.tail);
+
+	slots=requests;
+	chunksize=(size+4095)&~(size_t)4095;
+	inflight=0;
+	enginerunning=true;
+	return true;
+}
+
+// Closing the ring lets the kernel finish or cancel the requests in flight.
+void Soundreadahead::stop(void)
+{
+	std::lock_guard<std::mutex> lock(enginemutex);
+
+	if(!enginerunning)
+		return;
+	enginerunning=false;
+	pending.clear();
+	release();
+}
+
+bool Soundreadahead::running(void)
+{
+	std::lock_guard<std::mutex> lock(enginemutex);
+	return enginerunning;
+}
+
+bool Soundreadahead::prefetch(int fd, size_t offset, size_t length)
+{
+	std::lock_guard<std::mutex> lock(enginemutex);
+
+	if(!enginerunning)
+		return false;
+	while(length>0 && pending.size()<MAXPENDING)
+	{
+		Readrequest request;
+		request.fd=fd;
+		request.offset=offset;
+		request.length=(length<chunksize) ? length : chunksize;
+		pending.push_back(request);
+		offset+=request.length;
+		length-=request.length;
+	}
+	submitpending();
+	return true;
+}
+
+// Requests already submitted hold their own reference to the file, so only
+// the queued ones have to go.
+void Soundreadahead::cancel(int fd)
+{
+	std::lock_guard<std::mutex> lock(enginemutex);
+
+	for(std::deque<Readrequest>::iterator i=pending.begin();i!=pending.end();)
+		if(i->fd==fd)
+			i=pending.erase(i);
+		else
+			++i;
+}
+
+#else
+
+bool Soundreadahead::start(unsigned int, size_t)
+{
+	return false;
+}
+
+void Soundreadahead::stop(void)
+{
+}
+
+bool Soundreadahead::running(void)
+{
+	return false;
+}
+
+bool Soundreadahead::prefetch(int, size_t, size_t)
+{
+	return false;
+}
+
+void Soundreadahead::cancel(int)
+{
+}
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef _MPEGSOUND_SOUNDREADAHEAD_
+#define _MPEGSOUND_SOUNDREADAHEAD_
+
+#include <sys/types.h>
+
+class Soundreadahead
+{
+public:
+	/* Function   : start
+	 * Description: Starts the asynchronous read-ahead engine. Upcoming
+	 *            : parts of media files are passed to the kernel as
+	 *            : io_uring fadvise(WILLNEED) requests, which bring them
+	 *            : into the page cache before their readers access them.
+	 *            : The readers themselves keep reading from the page cache.
+	 * Parameters : requests
+	 *            :  Number of requests in flight at a time
+	 *            : size
+	 *            :  Size of the range covered by each request
+	 * Returns    : true if the engine is running, false if io_uring or
+	 *            : its fadvise operation is not available
+	 * SideEffects: None.
+	 */
+	static bool start(unsigned int requests, size_t size);
+
+	/* Function   : stop
+	 * Description: Stops the engine. Queued requests are dropped; the
+	 *            : kernel finishes the ones in flight.
+	 * Parameters : None
+	 * Returns    : Nothing
+	 * SideEffects: None.
+	 */
+	static void stop(void);
+
+	/* Function   : running
+	 * Description: Tells whether the engine is running.
+	 * Parameters : None
+	 * Returns    : true if the engine is running
+	 * SideEffects: None.
+	 */
+	static bool running(void);
+
+	/* Function   : prefetch
+	 * Description: Queues a range of a file for read-ahead. The call does
+	 *            : not wait for any I/O.
+	 * Parameters : fd
+	 *            :  File descriptor; it must stay open until cancel()
+	 *            : offset
+	 *            :  Start of the range
+	 *            : length
+	 *            :  Length of the range
+	 * Returns    : false if the engine is not running
+	 * SideEffects: None.
+	 */
+	static bool prefetch(int fd, size_t offset, size_t length);
+
+	/* Function   : cancel
+	 * Description: Drops all queued requests of a file. It must be called
+	 *            : before the file descriptor is closed.
+	 * Parameters : fd
+	 *            :  File descriptor
+	 * Returns    : Nothing
+	 * SideEffects: None.
+	 */
+	static void cancel(int fd);
+};
+
+#endif /* _MPEGSOUND_SOUNDREADAHEAD_ */
@@ -13,6 +13,7 @@ BuildRequires: extra-cmake-modules
 BuildRequires: gcc-c++
 BuildRequires: lksctp-tools-devel
 BuildRequires: (pulseaudio-libs-devel or libpulse-devel)
+BuildRequires: libvorbis-devel
 BuildRequires: (qt6-qtbase-devel or qt6-base-devel)
 BuildRequires: (qt6-linguist or qt6-linguist-devel)
 
@@ -100,10 +101,14 @@ This package provides the development files for libtdtoolbox.
 %{_includedir}/condition.h
 %{_includedir}/condition.icc
 %{_includedir}/ext_socket.h
+%{_includedir}/flowlabelmanager.h
+%{_includedir}/flowlabelmanager.icc
 %{_includedir}/internetaddress.h
 %{_includedir}/internetaddress.icc
 %{_includedir}/internetflow.h
 %{_includedir}/internetflow.icc
+%{_includedir}/lockprofiler.h
+%{_includedir}/lockprofiler.icc
 %{_includedir}/multitimerthread.h
 %{_includedir}/multitimerthread.icc
 %{_includedir}/portableaddress.h
@@ -116,6 +121,10 @@ This package provides the development files for libtdtoolbox.
 %{_includedir}/seqnumvalidator.icc
 %{_includedir}/socketaddress.h
 %{_includedir}/socketaddress.icc
+%{_includedir}/statisticsserver.h
+%{_includedir}/statisticsserver.icc
+%{_includedir}/statisticsslot.h
+%{_includedir}/statisticsslot.icc
 %{_includedir}/synchronizable.h
 %{_includedir}/synchronizable.icc
 %{_includedir}/tdsystem.h
@@ -245,7 +254,14 @@ This package provides the development files for audio input reading.
 %{_libdir}/libaudioreader*.so
 %{_includedir}/audioreaderinterface.h
 %{_includedir}/mp3audioreader.h
+%{_includedir}/mp3decoderpool.h
+%{_includedir}/mp3decoderpool.icc
 %{_includedir}/multiaudioreader.h
+%{_includedir}/oggaudioreader.h
+%{_includedir}/renditioncache.h
+%{_includedir}/renditioncache.icc
+%{_includedir}/renditionreader.h
+%{_includedir}/renditionreader.icc
 %{_includedir}/wavaudioreader.h
 
 
@@ -326,6 +342,7 @@ Requires: %{name}-libaudiocommon-devel = %{version}-%{release}
 %{_libdir}/libaudiocodeccommon*.a
 %{_libdir}/libaudiocodeccommon*.so
 %{_includedir}/advancedaudiopacket.h
+%{_includedir}/qualityladder.h
 %{_includedir}/simpleaudiopacket.h
 
 
@@ -484,6 +501,7 @@ Requires: %{name}-libtdtoolbox-devel = %{version}-%{release}
 %{_libdir}/librtpaudioclient*.so
 %{_includedir}/audioclient.h
 %{_includedir}/audioclient.icc
+%{_includedir}/multicastlayermanager.h
 
 
 %package librtpaudioserver
@@ -526,6 +544,8 @@ Requires: %{name}-libtdtoolbox-devel = %{version}-%{release}
 %{_libdir}/librtpaudioserver*.so
 %{_includedir}/audioserver.h
 %{_includedir}/audioserver.icc
+%{_includedir}/multicastchannel.h
+%{_includedir}/multicastchannel.icc
 
 
 %package librtpcommon
@@ -649,6 +669,8 @@ Requires: %{name}-libtdtoolbox-devel = %{version}-%{release}
 %{_includedir}/qosmanagerinterface.h
 %{_includedir}/resourceutilizationpoint.h
 %{_includedir}/resourceutilizationpoint.icc
+%{_includedir}/roundtriptimeestimator.h
+%{_includedir}/roundtriptimeestimator.icc
 %{_includedir}/rtcpabstractserver.h
 %{_includedir}/rtcpabstractserver.icc
 %{_includedir}/rtcpreceiver.h
@@ -696,8 +718,12 @@ Requires: %{name}-libtdtoolbox-devel = %{version}-%{release}
 %{_includedir}/servicelevelagreement.icc
 %{_includedir}/pingerhost.h
 %{_includedir}/pingerhost.icc
+%{_includedir}/qoseventqueue.h
+%{_includedir}/qoseventqueue.icc
 %{_includedir}/roundtriptimepinger.h
 %{_includedir}/roundtriptimepinger.icc
+%{_includedir}/roundtriptimetable.h
+%{_includedir}/roundtriptimetable.icc
 %{_includedir}/sessiondescription.h
 %{_includedir}/streamdescription.h
 
@@ -39,6 +39,8 @@
 
 // ###### Constructor #######################################################
 AdvancedAudioEncoder::AdvancedAudioEncoder(AudioReaderInterface* audioReader)
+   : Ladder(AdvancedAudioPacket::calculateRequirements,
+            1 + AdvancedAudioPacket::AdvancedAudioMaxQualityLayers)
 {
    Source            = audioReader;
    FrameBufferPosLL  = 0;
@@ -181,6 +183,20 @@ void AdvancedAudioEncoder::updateQuality(const AbstractQoSDescription* aqd)
 }
 
 
+// ###### Get byte rate limit ###############################################
+card64 AdvancedAudioEncoder::getByteRateLimit() const
+{
+   return(TotalByteRateLimit);
+}
+
+
+// ###### Get network quality decrement #####################################
+cardinal AdvancedAudioEncoder::getNetworkQualityDecrement() const
+{
+   return(NetworkQualityDecrement);
+}
+
+
 // ###### Check for new interval #############################################
 bool AdvancedAudioEncoder::checkInterval(card64& time, bool& newRUList)
 {
@@ -216,26 +232,40 @@ bool AdvancedAudioEncoder::prepareNextFrame(const cardinal headerSize,
    FrameFragmentRU   = 0;
    FramePosition     = Source->getPosition();
    FrameMaxPosition  = Source->getMaxPosition();
-   const AudioQuality inputQuality(*Source);
-   FrameQualitySetting = AdvancedAudioPacket::calculateQualityForLimits(
-                            (AudioQuality)*this,inputQuality,
-                            TotalByteRateLimit,
-                            ByteRateLimitL1,ByteRateLimitL2,ByteRateLimitL3,
+   const card64 limits[1 + AdvancedAudioPacket::AdvancedAudioMaxQualityLayers] = {
+      TotalByteRateLimit, ByteRateLimitL1, ByteRateLimitL2, ByteRateLimitL3
+   };
+   FrameQualitySetting = Ladder.getQualityForLimits(
+                            (AudioQuality)*this,(AudioQuality)*Source,
+                            (const card64*)&limits,
                             NetworkQualityDecrement,
                             headerSize,maxPacketSize);
    FrameQualitySetting.setByteOrder(LITTLE_ENDIAN);
 
    // ====== Read frame from AudioReader ====================================
-   cardinal len = AdvancedAudioPacket::calculateFrameSize(
-                           inputQuality.getBytesPerSecond(),
-                           AdvancedAudioPacket::AdvancedAudioFrameSize);
-   card8 buffer[len];
-   if((Source->getPosition() < Source->getMaxPosition()) && (Source->getNextBlock((void*)&buffer,len) == len)) {
-      // Check, if conversion is necessary
-      if(inputQuality != FrameQualitySetting) {
-         AudioConverter(inputQuality,FrameQualitySetting,
-                           (card8*)&buffer,(card8*)&buffer,len,len);
+   // The reader may deliver the frame in a quality closer to the frame's.
+   const AudioQuality inputQuality = Source->selectQuality(FrameQualitySetting);
+   cardinal len = getAlignedLength(inputQuality,inputQuality,
+                     AdvancedAudioPacket::calculateFrameSize(
+                        inputQuality.getBytesPerSecond(),
+                        AdvancedAudioPacket::AdvancedAudioFrameSize));
+   card8        storage[len];
+   const card8* buffer = NULL;
+   if(Source->getPosition() < Source->getMaxPosition()) {
+      // A block not to be converted is used in place, if possible
+      if(inputQuality == FrameQualitySetting) {
+         buffer = (const card8*)Source->getNextBlockView(len);
       }
+      if((buffer == NULL) && (Source->getNextBlock((void*)&storage,len) == len)) {
+         // Check, if conversion is necessary
+         if(inputQuality != FrameQualitySetting) {
+            AudioConverter(inputQuality,FrameQualitySetting,
+                           (card8*)&storage,(card8*)&storage,len,len);
+         }
+         buffer = (const card8*)&storage;
+      }
+   }
+   if(buffer != NULL) {
       len = getAlignedLength(inputQuality,FrameQualitySetting,len);
 
       cardinal i;
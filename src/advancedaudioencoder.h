@@ -38,6 +38,7 @@
 #include "audioencoderinterface.h"
 #include "audioreaderinterface.h"
 #include "audioquality.h"
+#include "qualityladder.h"
 
 
 /**
@@ -153,6 +154,22 @@ class AdvancedAudioEncoder : public AudioEncoderInterface,
    void updateQuality(const AbstractQoSDescription* aqd);
 
 
+   // ====== AudioEncoderInterface implementation ===========================
+   /**
+     * getByteRateLimit() implementation of AudioEncoderInterface.
+     *
+     * @see AudioEncoderInterface#getByteRateLimit
+     */
+   card64 getByteRateLimit() const;
+
+   /**
+     * getNetworkQualityDecrement() implementation of AudioEncoderInterface.
+     *
+     * @see AudioEncoderInterface#getNetworkQualityDecrement
+     */
+   cardinal getNetworkQualityDecrement() const;
+
+
    // ====== Private data ===================================================
    private:
    AudioReaderInterface* Source;
@@ -160,6 +177,7 @@ class AdvancedAudioEncoder : public AudioEncoderInterface,
    card64       FramePosition;                       // Current frame
    card64       FrameMaxPosition;
    AudioQuality FrameQualitySetting;
+   QualityLadder Ladder;
    card8*       FrameBufferLL;
    card8*       FrameBufferRL;
    card8*       FrameBufferLU;
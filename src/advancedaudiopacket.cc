@@ -173,6 +173,32 @@ static void calculateLevelForQuality(
 }
 
 
+// ###### Calculate byte rate requirements of quality #####################
+void AdvancedAudioPacket::calculateRequirements(
+        const AudioQualityInterface& quality,
+        const cardinal               headerSize,
+        const cardinal               maxPacketSize,
+        card64*                      required)
+{
+   Level level;
+   calculateLevelForQuality(level,headerSize,maxPacketSize,quality);
+
+   // ====== Calculate total bandwidth requirements =========================
+   required[0] = level.QualityLayer[0].BytesPerSecond;
+   for(cardinal i = 1;i < level.QualityLayers;i++) {
+      required[0] += level.QualityLayer[i].BytesPerSecond;
+   }
+
+   // ====== Calculate bandwidth requirements for each level ================
+   for(cardinal i = 0;i < AdvancedAudioMaxQualityLayers;i++) {
+      if(i < level.QualityLayers)
+         required[1 + i] = level.QualityLayer[i].BytesPerSecond;
+      else
+         required[1 + i] = 0;
+   }
+}
+
+
 // ###### Calculate encoder's quality #######################################
 AudioQuality AdvancedAudioPacket::calculateQualityForLimits(
                 const AudioQualityInterface& userSetting,
@@ -190,53 +216,21 @@ AudioQuality AdvancedAudioPacket::calculateQualityForLimits(
    networkQuality.decrease(networkQualityDecrement);
    AudioQuality newSetting = networkQuality - inputQuality;
 
-   // cout << "=> " << newSetting << endl;
-
    // ====== Calculate new quality using total byte rate limit ==============
-   Level level;
+   card64 required[1 + AdvancedAudioMaxQualityLayers];
    while(!newSetting.isLowest()) {
-      calculateLevelForQuality(level,headerSize,maxPacketSize,newSetting);
-      const cardinal layers = calculateLayers(newSetting);
-
-      // ====== Calculate total bandwidth requirements ======================
-      card64 requiredTotal = level.QualityLayer[0].BytesPerSecond;
-      for(cardinal i = 1;i < level.QualityLayers;i++) {
-         requiredTotal += level.QualityLayer[i].BytesPerSecond;
-      }
-
-      // ====== Calculate bandwidth requirements for each level =============
-      card64 required1 = level.QualityLayer[0].BytesPerSecond;
-      card64 required2;
-      card64 required3;
-      if(layers > 1)
-         required2 = level.QualityLayer[1].BytesPerSecond;
-      else
-         required2 = 0;
-      if(layers > 2)
-         required3 = level.QualityLayer[2].BytesPerSecond;
-      else
-         required3 = 0;
+      calculateRequirements(newSetting,headerSize,maxPacketSize,(card64*)&required);
 
       // ====== Check, if limits are acceptable for this level ==============
-      if((requiredTotal <= totalByteRateLimit) &&
-         (required1 <= byteRateLimitL1) &&
-         (required2 <= byteRateLimitL2) &&
-         (required3 <= byteRateLimitL3)) {
+      if((required[0] <= totalByteRateLimit) &&
+         (required[1] <= byteRateLimitL1) &&
+         (required[2] <= byteRateLimitL2) &&
+         (required[3] <= byteRateLimitL3)) {
          break;
       }
-
-/*
-      cout << "(" << newSetting << ")--   => ";
-      cout.flush();
-      printf("req=[%Ld %Ld %Ld] <-> lim=[%Ld %Ld %Ld]\n",
-         required1,required2,required3,byteRateLimitL1,byteRateLimitL2,byteRateLimitL3);
-*/
-
       newSetting--;
    }
 
-   // cout << "<= " << newSetting << endl;
-
    return(newSetting);
 }
 
@@ -120,6 +120,24 @@ struct AdvancedAudioPacket
    static const cardinal AdvancedAudioQualityLevels = AudioQuality::QualityLevels;
 
 
+   /**
+     * Calculate the byte rate requirements of given quality with given header
+     * size (eg. IP + UDP + RTP) and maximum packet size: total, layer #0,
+     * layer #1 and layer #2 (0 for layers not used by the quality).
+     *
+     * @param quality Quality.
+     * @param headerSize Header size. AdvancedAudioPacket size is added automatically.
+     * @param maxPacketSize Maximum packet size.
+     * @param required Array of 1 + AdvancedAudioMaxQualityLayers entries to store the requirements into.
+     *
+     * @see QualityLadder
+     */
+   static void calculateRequirements(const AudioQualityInterface& quality,
+                                     const cardinal               headerSize,
+                                     const cardinal               maxPacketSize,
+                                     card64*                      required);
+
+
    /**
      * Quality calculation for given user quality limited by input quality,
      * byte rate and network quality decrement with given header size
@@ -65,6 +65,7 @@ AudioClient::AudioClient(AudioWriterInterface* audioOutput)
    Status.SamplingRate = AudioQuality::HighestSamplingRate;
    Sender              = NULL;
    Receiver            = NULL;
+   LayerManager        = NULL;
    AudioOutput         = audioOutput;
    OldPosition         = (card64)-1;
    ChangeTimeStamp     = 0;
@@ -143,7 +144,8 @@ bool AudioClient::play(const char* url)
       return(false);
    }
 
-   bool useSCTP;
+   bool useSCTP      = false;
+   bool useMulticast = false;
    protocol = protocol.toLower();
    if(protocol == "rtpa") {
       useSCTP = false;
@@ -154,11 +156,14 @@ bool AudioClient::play(const char* url)
    else if(protocol == "rtpa+sctp") {
       useSCTP = true;
    }
+   else if(protocol == "rtpa+mcast") {
+      useMulticast = true;
+   }
    else {
       return(false);
    }
 
-   if(Sender == NULL) {
+   if(Receiver == NULL) {
       // ====== Set default settings ========================================
       Status.FormatID        = AudioClientAppPacket::AudioClientFormatID;
       Status.SequenceNumber  = 0;
@@ -183,6 +188,9 @@ bool AudioClient::play(const char* url)
       if(ServerAddress.getPort() == 0) {
          ServerAddress.setPort(RTPAudioDefaultPort);
       }
+      if(useMulticast) {
+         return(playMulticast());
+      }
 
 
       // ====== Create sockets ==============================================
@@ -217,7 +225,7 @@ bool AudioClient::play(const char* url)
 
 
       // ====== Connect sender socket to server =============================
-      Flow = SenderSocket.allocFlow(ServerAddress);
+      Flow = FlowLabels.allocFlow(&SenderSocket,ServerAddress);
       if(Flow.getFlowLabel() == 0) {
          Flow = InternetFlow(ServerAddress,0,0);
       }
@@ -268,7 +276,6 @@ bool AudioClient::play(const char* url)
       Sender->addSDESItem(RTCP_SDES_LOC,"Essen, Germany");
       Sender->addSDESItem(RTCP_SDES_EMAIL,"email@domain.xy");
 */
-      Sender->sendSDES();
 
       if(Sender->start() == false) {
          std::cerr << "ERROR: AudioClient::play() - Unable to start RTCP sender thread!" << std::endl;
@@ -308,12 +315,15 @@ bool AudioClient::play(const char* url)
 void AudioClient::stop()
 {
    IsPlaying = false;
+   if(LayerManager != NULL) {
+      LayerManager->stop();
+      delete LayerManager;
+      LayerManager = NULL;
+   }
    if(Sender != NULL) {
       Sender->sendBye();
       Sender->stop();
-      if(Flow.getFlowLabel() !=0) {
-         SenderSocket.freeFlow(Flow);
-      }
+      FlowLabels.freeFlow(&SenderSocket,Flow);
       delete Sender;
       Sender = NULL;
    }
@@ -333,6 +343,77 @@ void AudioClient::stop()
 }
 
 
+// ###### Start receiving a layered multicast channel #######################
+bool AudioClient::playMulticast()
+{
+   if(!ServerAddress.isMulticast()) {
+      std::cerr << "ERROR: AudioClient::playMulticast() - "
+                   "No multicast address given!" << std::endl;
+      stop();
+      return(false);
+   }
+
+   // ====== Create receiver socket =========================================
+   // All layer groups use the same port; the socket must only receive the
+   // groups joined by itself, not those of other clients on this host.
+   ReceiverSocket.create(ServerAddress.isIPv4() ? Socket::IPv4 : Socket::IPv6,
+                         Socket::Datagram);
+   if(!ReceiverSocket.ready()) {
+      std::cerr << "ERROR: AudioClient::playMulticast() - "
+                   "Unable to create socket for RTPReceiver!" << std::endl;
+      stop();
+      return(false);
+   }
+   ReceiverSocket.setSoReuseAddress(true);
+   ReceiverSocket.setMulticastAll(false);
+   InternetAddress localAddress(ServerAddress.getPort());
+   if(!ReceiverSocket.bind(localAddress)) {
+      std::cerr << "ERROR: AudioClient::playMulticast() - Unable to bind socket!" << std::endl;
+      stop();
+      return(false);
+   }
+
+
+   // ====== Create RTPReceiver =============================================
+   Receiver = new RTPReceiver(&Decoders,&ReceiverSocket);
+   if(Receiver == NULL) {
+      std::cerr << "ERROR: AudioClient::playMulticast() - Out of memory!" << std::endl;
+      stop();
+      return(false);
+   }
+   if(Receiver->start() == false) {
+      std::cerr << "ERROR: AudioClient::playMulticast() - Unable to start RTP receiver thread!" << std::endl;
+      stop();
+      return(false);
+   }
+
+
+   // ====== Create MulticastLayerManager ===================================
+   LayerManager = new MulticastLayerManager(
+                     Receiver,&ReceiverSocket,ServerAddress,
+                     (MulticastInterface.length() > 0) ? MulticastInterface.getData() : NULL);
+   if(LayerManager == NULL) {
+      std::cerr << "ERROR: AudioClient::playMulticast() - Out of memory!" << std::endl;
+      stop();
+      return(false);
+   }
+   LayerManager->setBandwidthLimit(Status.BandwidthLimit);
+   if(LayerManager->start() == false) {
+      std::cerr << "ERROR: AudioClient::playMulticast() - Unable to join multicast channel!" << std::endl;
+      stop();
+      return(false);
+   }
+   IsPlaying = true;
+
+   ReceiverSocket.getSocketAddress(OurAddress);
+
+#ifdef DEBUG
+   std::cout << "Receiving layered multicast channel " << ServerAddress << "." << std::endl;
+#endif
+   return(IsPlaying);
+}
+
+
 // ###### Begin/end pause mode ##############################################
 void AudioClient::setPause(const bool on)
 {
@@ -349,7 +430,8 @@ void AudioClient::setPause(const bool on)
 // ###### Send command to server ############################################
 void AudioClient::sendCommand(const bool updateRestartPosition)
 {
-   if(IsPlaying) {
+   // A layered multicast channel has no control connection.
+   if((IsPlaying) && (Sender != NULL)) {
       Status.SequenceNumber  = Status.SequenceNumber + 1;
 
       if(updateRestartPosition == true)
@@ -402,7 +484,8 @@ card64 AudioClient::getPosition()
             priv.Status    = Status;
             priv.Status.translate();
 
-            if(Sender->addSDESItem(RTCP_SDES_PRIV,(const char*)&priv,sizeof(priv)) == false) {
+            if((Sender != NULL) &&
+               (Sender->addSDESItem(RTCP_SDES_PRIV,(const char*)&priv,sizeof(priv)) == false)) {
                std::cerr << "ERROR: Unable to add SDES - Out of memory!" << std::endl;
             }
          }
@@ -40,8 +40,10 @@
 #include "mediainfo.h"
 #include "rtcpsender.h"
 #include "rtpreceiver.h"
+#include "multicastlayermanager.h"
 #include "internetaddress.h"
 #include "tdsocket.h"
+#include "flowlabelmanager.h"
 #include "strings.h"
 
 #include "audioclientapppacket.h"
@@ -78,6 +80,9 @@ class AudioClient : virtual public AdjustableAudioQualityInterface
    /**
      * Start playing given media from given server.
      *
+     * A layered multicast channel is received by an URL of the form
+     * "rtpa+mcast://239.255.42.1:7600/"; the media name is ignored then.
+     *
      * @param url Media URL (e.g. "rtpa+sctp://gaffel:7500/Test1.list").
      * @return true, if play request has been sent to server.
      */
@@ -401,10 +406,25 @@ class AudioClient : virtual public AdjustableAudioQualityInterface
      */
    inline void setBandwidthLimit(const card32 bandwidthLimit);
 
+   /**
+     * Set interface to join layered multicast channels on.
+     *
+     * @param interface Interface name (NULL for default).
+     */
+   inline void setMulticastInterface(const char* interface);
+
+   /**
+     * Get number of joined layers of a layered multicast channel.
+     *
+     * @return Number of joined layers (0 if not receiving a multicast channel).
+     */
+   inline cardinal getJoinedLayers() const;
+
 
    // ====== Private data ===================================================
    private:
    void sendCommand(const bool updateRestartPosition = true);
+   bool playMulticast();
 
 
    // Update of RestartPosition has to be delayed after change() call to
@@ -416,8 +436,11 @@ class AudioClient : virtual public AdjustableAudioQualityInterface
    AudioWriterInterface*                                AudioOutput;
    RTPReceiver*                                         Receiver;
    RTCPSender*                                          Sender;
+   MulticastLayerManager*                               LayerManager;
+   String                                               MulticastInterface;
    Socket                                               SenderSocket;
    Socket                                               ReceiverSocket;
+   FlowLabelManager                                     FlowLabels;
    InternetFlow                                         Flow;
    InternetAddress                                      ServerAddress;
    InternetAddress                                      OurAddress;
@@ -35,6 +35,9 @@
 #include "tools.h"
 
 
+#include <netinet/in.h>
+
+
 // ###### Constructor #######################################################
 AudioClientAppPacket::AudioClientAppPacket()
 {
@@ -74,3 +77,22 @@ void AudioClientAppPacket::translate()
    RestartPosition = translate64(RestartPosition);
    BandwidthLimit  = translate32(BandwidthLimit);
 }
+
+
+// ###### Get multicast group of a quality layer ############################
+InternetAddress getLayerMulticastAddress(const InternetAddress& group,
+                                         const cardinal         layer)
+{
+   // ====== Add layer number to the lowest 32 bits of the address ==========
+   // IPv4 addresses are stored as IPv4-mapped IPv6 addresses, so the same
+   // calculation applies to both protocols.
+   sockaddr_in6 address;
+   if(group.getSystemAddress((sockaddr*)&address,sizeof(address),AF_INET6) == 0) {
+      return(group);
+   }
+   card32 lowest;
+   memcpy((char*)&lowest,(char*)&address.sin6_addr.s6_addr[12],sizeof(lowest));
+   lowest = htonl(ntohl(lowest) + (card32)layer);
+   memcpy((char*)&address.sin6_addr.s6_addr[12],(char*)&lowest,sizeof(lowest));
+   return(InternetAddress((sockaddr*)&address,sizeof(address)));
+}
@@ -35,6 +35,8 @@
 
 
 // #include <linux/ip.h>
+#include "tdsystem.h"
+#include "internetaddress.h"
 
 
 // ###### IPv6 Traffic Class Settings #######################################
@@ -65,6 +67,24 @@ static const card32 RTPAudioDataPPID = 0x2909ffff;
   */
 static const card32 RTPAudioControlPPID = 0x2909fffe;
 
+/**
+  * Default multicast TTL for layered multicast channels.
+  */
+static const card8 AudioServerDefaultMulticastTTL = 16;
+
+
+/**
+  * Get the multicast group of a quality layer of a layered multicast
+  * channel. Layer n is sent to the channel's base group address plus n,
+  * using the same port.
+  *
+  * @param group Base group address and port of the channel.
+  * @param layer Layer number.
+  * @return Group address and port of the layer.
+  */
+InternetAddress getLayerMulticastAddress(const InternetAddress& group,
+                                         const cardinal         layer);
+
 
 /**
   * This struct defines the packet format for the audio client's
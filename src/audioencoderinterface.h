@@ -55,6 +55,22 @@ class AudioEncoderInterface : virtual public EncoderInterface,
      *
      */
    virtual ~AudioEncoderInterface();   
+
+
+   /**
+     * Get the total byte rate limit the encoder currently applies.
+     *
+     * @return Byte rate limit ((card64)-1 for unlimited).
+     */
+   virtual card64 getByteRateLimit() const = 0;
+
+   /**
+     * Get the number of steps the encoder currently lowers its quality by
+     * because of losses in the network.
+     *
+     * @return Quality decrement.
+     */
+   virtual cardinal getNetworkQualityDecrement() const = 0;
 };
 
 
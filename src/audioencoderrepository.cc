@@ -215,3 +215,9 @@ card16 AudioEncoderRepository::setSamplingRate(const card16 rate)
 
 card16 AudioEncoderRepository::setByteOrder(const card16 byteOrder)
    { return(Encoder->setByteOrder(byteOrder)); }
+
+card64 AudioEncoderRepository::getByteRateLimit() const
+   { return(Encoder->getByteRateLimit()); }
+
+cardinal AudioEncoderRepository::getNetworkQualityDecrement() const
+   { return(Encoder->getNetworkQualityDecrement()); }
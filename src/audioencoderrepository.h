@@ -271,6 +271,20 @@ class AudioEncoderRepository : virtual public EncoderRepositoryInterface,
      */
    void updateQuality(const AbstractQoSDescription* aqd);
 
+   /**
+     * getByteRateLimit() implementation of AudioEncoderInterface.
+     *
+     * @see AudioEncoderInterface#getByteRateLimit
+     */
+   card64 getByteRateLimit() const;
+
+   /**
+     * getNetworkQualityDecrement() implementation of AudioEncoderInterface.
+     *
+     * @see AudioEncoderInterface#getNetworkQualityDecrement
+     */
+   cardinal getNetworkQualityDecrement() const;
+
 
    // ====== Private data ===================================================
    private:
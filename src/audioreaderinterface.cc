@@ -36,3 +36,17 @@
 AudioReaderInterface::~AudioReaderInterface()
 {
 }
+
+
+// ###### Select quality of the following blocks ############################
+AudioQuality AudioReaderInterface::selectQuality(const AudioQualityInterface&)
+{
+   return(AudioQuality(*this));
+}
+
+
+// ###### Get view of next block ############################################
+const void* AudioReaderInterface::getNextBlockView(const cardinal)
+{
+   return(NULL);
+}
@@ -36,6 +36,7 @@
 
 #include "tdsystem.h"
 #include "audioqualityinterface.h"
+#include "audioquality.h"
 #include "mediainfo.h"
 
 
@@ -119,6 +120,31 @@ class AudioReaderInterface : virtual public AudioQualityInterface
      * @return Number of bytes read.
      */
    virtual cardinal getNextBlock(void* buffer, const cardinal blockSize) = 0;
+
+   /**
+     * Read next block in place. Readers having the media's samples in
+     * memory, in the quality returned by selectQuality(), may return a
+     * pointer to them instead of copying them. The block remains valid
+     * until the next call of a method of the reader. If the reader cannot
+     * provide a view, NULL is returned without reading anything and
+     * getNextBlock() has to be used. The default implementation returns NULL.
+     *
+     * @param blockSize Size of block in bytes.
+     * @return Pointer to block or NULL.
+     */
+   virtual const void* getNextBlockView(const cardinal blockSize);
+
+   /**
+     * Select the quality of the following blocks. Readers having the media
+     * in several qualities deliver the smallest one of at least the
+     * requested quality, so that the caller has little or nothing left to
+     * convert. The reader's own quality (the media's quality) is not
+     * changed. The default implementation returns the reader's own quality.
+     *
+     * @param quality Requested quality.
+     * @return Quality of the blocks returned by getNextBlock().
+     */
+   virtual AudioQuality selectQuality(const AudioQualityInterface& quality);
 };
 
 
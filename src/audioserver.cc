@@ -65,6 +65,8 @@ AudioServer::AudioServer(QoSManagerInterface* qosManager,
    UseSCTP = useSCTP;
    setMaxPacketSize(maxPacketSize);
    setLossScalability(true);
+   setBroadcastGroups(false);
+   NextSharedSocket = 0;
 }
 
 
@@ -72,6 +74,49 @@ AudioServer::AudioServer(QoSManagerInterface* qosManager,
 AudioServer::~AudioServer()
 {
    stop();
+   setSharedSockets(0);
+}
+
+
+// ###### Set number of shared sender sockets ###############################
+bool AudioServer::setSharedSockets(const cardinal sockets)
+{
+   while(!SharedSockets.empty()) {
+      delete SharedSockets.back();
+      SharedSockets.pop_back();
+   }
+   NextSharedSocket = 0;
+
+   // SCTP sets the traffic class for the whole socket, which would race
+   // between the senders sharing it.
+   if(UseSCTP && (sockets > 0)) {
+      std::cerr << "WARNING: AudioServer::setSharedSockets() - Shared sockets are not supported with SCTP!" << std::endl;
+      return(false);
+   }
+
+   for(cardinal i = 0;i < sockets;i++) {
+      Socket* socket = new Socket(Socket::IP,
+                                  UseSCTP ? Socket::SeqPacket : Socket::Datagram,
+                                  UseSCTP ? Socket::SCTP      : Socket::Default);
+      if(socket == NULL) {
+         outOfMemoryWarning();
+         setSharedSockets(0);
+         return(false);
+      }
+      SharedSockets.push_back(socket);
+      if(!socket->ready()) {
+         std::cerr << "WARNING: AudioServer::setSharedSockets() - Unable to create socket!" << std::endl;
+         setSharedSockets(0);
+         return(false);
+      }
+      socket->setBlockingMode(false);
+
+      // ====== Size send buffer for the streams of many users ==============
+      // The kernel limits the size to net.core.wmem_max.
+      const int bufferSize = (int)(MaxPacketSize * SharedSocketBufferPackets);
+      socket->setSocketOption(SOL_SOCKET,SO_SNDBUF,&bufferSize,sizeof(bufferSize));
+   }
+   return(true);
 }
 
 
@@ -101,22 +146,35 @@ void* AudioServer::newClient(Client* client, const char* cname)
    }
    user->Client           = client;
    user->StreamIdentifier = 0;
+   user->BroadcastLeader  = NULL;
    client->UserData       = user;
 
-   // ====== Create and connect sender socket ===============================
-   user->SenderSocket.create(Socket::IP,
-                             UseSCTP ? Socket::SeqPacket : Socket::Datagram,
-                             UseSCTP ? Socket::SCTP      : Socket::Default);
-   if(!user->SenderSocket.ready()) {
-      std::cerr << "WARNING: AudioServer::newClient() - Unable to create socket!" << std::endl;
-      deleteClient(client,DeleteReason_Error);
-      return(NULL);
-   }
-   user->SenderSocket.setBlockingMode(false);
-   user->Flow = user->SenderSocket.allocFlow(client->ClientAddress);
-   if(user->Flow.getFlowLabel() == 0) {
+   // ====== Use shared sender socket =======================================
+   if(!SharedSockets.empty()) {
+      UserSetSync.synchronized();
+      user->SenderSocket = SharedSockets[NextSharedSocket];
+      NextSharedSocket   = (NextSharedSocket + 1) % SharedSockets.size();
+      UserSetSync.unsynchronized();
       user->Flow = InternetFlow(client->ClientAddress,0,0);
    }
+
+   // ====== Create and connect sender socket ===============================
+   else {
+      user->SenderSocket = &user->OwnSocket;
+      user->SenderSocket->create(Socket::IP,
+                                 UseSCTP ? Socket::SeqPacket : Socket::Datagram,
+                                 UseSCTP ? Socket::SCTP      : Socket::Default);
+      if(!user->SenderSocket->ready()) {
+         std::cerr << "WARNING: AudioServer::newClient() - Unable to create socket!" << std::endl;
+         deleteClient(client,DeleteReason_Error);
+         return(NULL);
+      }
+      user->SenderSocket->setBlockingMode(false);
+      user->Flow = FlowLabels.allocFlow(user->SenderSocket,client->ClientAddress);
+      if(user->Flow.getFlowLabel() == 0) {
+         user->Flow = InternetFlow(client->ClientAddress,0,0);
+      }
+   }
    user->Flow.setTrafficClass(AudioServerDefaultTrafficClass);
 
    // ====== Create repository and encoders =================================
@@ -137,13 +195,24 @@ void* AudioServer::newClient(Client* client, const char* cname)
 
    // ====== Initialize RTPSender ===========================================
    user->Sender.init(user->Flow,OurSSRC,
-                     &user->Repository,&user->SenderSocket,
+                     &user->Repository,user->SenderSocket,
                      RTPAudioControlPPID, RTPAudioDataPPID,
                      MaxPacketSize,QoSMgr);
 
+   // ====== Publish statistics =============================================
+   // The reception report values are updated by the RTCP receiver thread,
+   // the sender's values by the sender thread.
+   char slotName[32];
+   snprintf((char*)&slotName,sizeof(slotName),"User $%08x",client->SSRC);
+   user->Sender.setStatistics(&user->Statistics);
+   user->StatLossRate    = user->Statistics.addCounter("LossRate","permille");
+   user->StatPacketsLost = user->Statistics.addCounter("PacketsLost");
+   user->StatJitter      = user->Statistics.addCounter("Jitter","us");
+   user->Statistics.publish(slotName);
+
    // ====== Add stream to QoS management ===================================
    InternetAddress ourAddress;
-   user->SenderSocket.getSocketAddress(ourAddress);
+   user->SenderSocket->getSocketAddress(ourAddress);
    UserSetSync.synchronized();
    user->StreamIdentifier = (integer)((long)user);
    UserSet.insert(std::pair<const cardinal,User*>(user->StreamIdentifier,user));
@@ -162,16 +231,16 @@ void* AudioServer::newClient(Client* client, const char* cname)
    snprintf((char*)&str,sizeof(str),"New member $%08x added.",client->SSRC);
    std::cout << str << std::endl;
    InternetAddress sourceAddress;
-   user->SenderSocket.getSocketAddress(sourceAddress);
+   user->SenderSocket->getSocketAddress(sourceAddress);
    sourceAddress.setPrintFormat(InternetAddress::PF_Address);
    std::cout << "   CNAME:               " << cname << std::endl
              << "   Source Address:      " << sourceAddress << std::endl
              << "   Destination Address: " << (InternetAddress)client->ClientAddress << std::endl;
-   if(user->SenderSocket.getSendFlowLabel() != 0) {
-      snprintf((char*)&str,sizeof(str),"$%05x",user->SenderSocket.getSendFlowLabel());
+   if(user->SenderSocket->getSendFlowLabel() != 0) {
+      snprintf((char*)&str,sizeof(str),"$%05x",user->SenderSocket->getSendFlowLabel());
       std::cout << "   Flow Label:          " << str << std::endl;
    }
-   snprintf((char*)&str,sizeof(str),"$%02x",user->SenderSocket.getSendTrafficClass());
+   snprintf((char*)&str,sizeof(str),"$%02x",user->SenderSocket->getSendTrafficClass());
    std::cout << "   Traffic Class:       " << str << std::endl
              << "   => We have " << getMembers() + 1 << " member(s) now!" << std::endl;
 #endif
@@ -186,6 +255,8 @@ void AudioServer::deleteClient(Client* client, const DeleteReason reason)
 
    // ====== Remove user ====================================================
    if(user != NULL) {
+      std::vector<User*> released;
+      leaveBroadcastGroup(user,released);
       if(user->StreamIdentifier != 0) {
          UserSetSync.synchronized();
          std::multimap<const cardinal,User*>::iterator found =
@@ -197,10 +268,13 @@ void AudioServer::deleteClient(Client* client, const DeleteReason reason)
          QoSMgr->removeStream(&user->Sender);
       }
       user->Sender.stop();
-      if(user->Flow.getFlowLabel() != 0) {
-         user->SenderSocket.freeFlow(user->Flow);
-      }
+      FlowLabels.freeFlow(user->SenderSocket,user->Flow);
       delete user;
+
+      for(std::vector<User*>::iterator iterator = released.begin();
+          iterator != released.end();iterator++) {
+         joinBroadcastGroup(*iterator);
+      }
    }
 
    client->UserData = NULL;
@@ -246,6 +320,13 @@ void AudioServer::userCommand(Client*               client,
    }
 
    user->LastSequenceNumber = app->SequenceNumber;
+
+   // ====== Leave broadcast group ==========================================
+   // The command may change media, position or quality. The user and its
+   // followers continue at the group's position and rejoin afterwards.
+   std::vector<User*> released;
+   leaveBroadcastGroup(user,released);
+
    user->Sender.synchronized();
 
    // ====== Set quality, position, media name and bandwidth limit ==========
@@ -372,6 +453,202 @@ void AudioServer::userCommand(Client*               client,
    }
 
    user->Sender.unsynchronized();
+
+   // ====== Join broadcast group ===========================================
+   joinBroadcastGroup(user);
+   for(std::vector<User*>::iterator iterator = released.begin();
+       iterator != released.end();iterator++) {
+      joinBroadcastGroup(*iterator);
+   }
+}
+
+
+// ###### Check, if user's settings match the leader's ######################
+bool AudioServer::matchesBroadcastSettings(User* user, User* leader)
+{
+   return((leader->MediaName == user->MediaName) &&
+          (leader->BandwidthLimit == user->BandwidthLimit) &&
+          (leader->Repository.getTypeID() == user->Repository.getTypeID()) &&
+          (leader->Repository.getSamplingRate() == user->Repository.getSamplingRate()) &&
+          (leader->Repository.getBits() == user->Repository.getBits()) &&
+          (leader->Repository.getChannels() == user->Repository.getChannels()) &&
+          (leader->Repository.getByteRateLimit() == user->Repository.getByteRateLimit()) &&
+          (leader->Repository.getNetworkQualityDecrement() ==
+              user->Repository.getNetworkQualityDecrement()));
+}
+
+
+// ###### Check, if user may join leader's broadcast group ##################
+bool AudioServer::matchesBroadcastGroup(User* user, User* leader)
+{
+   if((leader->BroadcastLeader != NULL) ||
+      (leader->Sender.paused()) ||
+      (leader->Reader.getErrorCode() != ME_NoError) ||
+      (!matchesBroadcastSettings(user,leader))) {
+      return(false);
+   }
+   const card64 userPosition   = user->Reader.getPosition();
+   const card64 leaderPosition = leader->Reader.getPosition();
+   const card64 difference     = (userPosition > leaderPosition) ?
+                                    (userPosition - leaderPosition) :
+                                    (leaderPosition - userPosition);
+   return(difference <= BroadcastPositionTolerance);
+}
+
+
+// ###### Join broadcast group ##############################################
+void AudioServer::joinBroadcastGroup(User* user)
+{
+   if((BroadcastGroups == false) || (QoSMgr != NULL)) {
+      return;
+   }
+
+   UserSetSync.synchronized();
+
+   // ====== Check, if user may join any group ==============================
+   user->Sender.synchronized();
+   const bool ready = (user->BroadcastLeader == NULL) &&
+                      (user->BroadcastFollowers.empty()) &&
+                      (!user->Sender.paused()) &&
+                      (user->Reader.getErrorCode() == ME_NoError) &&
+                      (user->MediaName != "");
+   user->Sender.unsynchronized();
+
+   // ====== Look for a leader ==============================================
+   // Lock order is leader before follower, as in the leader's sender.
+   if(ready) {
+      for(std::multimap<const cardinal,User*>::iterator iterator = UserSet.begin();
+          iterator != UserSet.end();iterator++) {
+         User* leader = iterator->second;
+         if(leader == user) {
+            continue;
+         }
+         leader->Sender.synchronized();
+         user->Sender.synchronized();
+         if(matchesBroadcastGroup(user,leader)) {
+            leader->Sender.addBroadcastReceiver(&user->Sender);
+            leader->BroadcastFollowers.push_back(user);
+            user->BroadcastLeader = leader;
+         }
+         user->Sender.unsynchronized();
+         leader->Sender.unsynchronized();
+
+         if(user->BroadcastLeader != NULL) {
+#ifdef VERBOSE
+            printTimeStamp();
+            char str[128];
+            snprintf((char*)&str,sizeof(str),"$%08x joined broadcast group of $%08x (%u follower(s)).",
+                     user->Client->SSRC,leader->Client->SSRC,
+                     (unsigned int)leader->BroadcastFollowers.size());
+            std::cout << str << std::endl;
+#endif
+            break;
+         }
+      }
+   }
+
+   UserSetSync.unsynchronized();
+}
+
+
+// ###### Leave broadcast group #############################################
+void AudioServer::leaveBroadcastGroup(User* user, std::vector<User*>& released)
+{
+   UserSetSync.synchronized();
+
+   // ====== Leave leader's group ===========================================
+   User* leader = user->BroadcastLeader;
+   if(leader != NULL) {
+      leader->Sender.synchronized();
+      user->Sender.synchronized();
+      leader->Sender.removeBroadcastReceiver(&user->Sender);
+      for(std::vector<User*>::iterator iterator = leader->BroadcastFollowers.begin();
+          iterator != leader->BroadcastFollowers.end();iterator++) {
+         if(*iterator == user) {
+            leader->BroadcastFollowers.erase(iterator);
+            break;
+         }
+      }
+      user->BroadcastLeader = NULL;
+      user->Reader.setPosition(leader->Reader.getPosition());
+      user->Sender.unsynchronized();
+      leader->Sender.unsynchronized();
+   }
+
+   // ====== Release own followers ==========================================
+   if(!user->BroadcastFollowers.empty()) {
+      user->Sender.synchronized();
+      for(std::vector<User*>::iterator iterator = user->BroadcastFollowers.begin();
+          iterator != user->BroadcastFollowers.end();iterator++) {
+         User* follower = *iterator;
+         follower->Sender.synchronized();
+         user->Sender.removeBroadcastReceiver(&follower->Sender);
+         follower->BroadcastLeader = NULL;
+         follower->Reader.setPosition(user->Reader.getPosition());
+         follower->Sender.unsynchronized();
+         released.push_back(follower);
+      }
+      user->BroadcastFollowers.clear();
+      user->Sender.unsynchronized();
+   }
+
+   UserSetSync.unsynchronized();
+}
+
+
+// ###### Leave broadcast group, if settings have diverged ##################
+void AudioServer::checkBroadcastGroup(User* user)
+{
+   if(BroadcastGroups == false) {
+      return;
+   }
+
+   // ====== Find group members with diverged settings ======================
+   std::vector<User*> diverged;
+   UserSetSync.synchronized();
+   User* leader = user->BroadcastLeader;
+   if(leader != NULL) {
+      leader->Sender.synchronized();
+      user->Sender.synchronized();
+      if(!matchesBroadcastSettings(user,leader)) {
+         diverged.push_back(user);
+      }
+      user->Sender.unsynchronized();
+      leader->Sender.unsynchronized();
+   }
+   else if(!user->BroadcastFollowers.empty()) {
+      user->Sender.synchronized();
+      for(std::vector<User*>::iterator iterator = user->BroadcastFollowers.begin();
+          iterator != user->BroadcastFollowers.end();iterator++) {
+         User* follower = *iterator;
+         follower->Sender.synchronized();
+         if(!matchesBroadcastSettings(follower,user)) {
+            diverged.push_back(follower);
+         }
+         follower->Sender.unsynchronized();
+      }
+      user->Sender.unsynchronized();
+   }
+   UserSetSync.unsynchronized();
+
+   // ====== Let them leave and look for a matching group ===================
+   // Followers have no followers of their own, so nobody else is released.
+   for(std::vector<User*>::iterator iterator = diverged.begin();
+       iterator != diverged.end();iterator++) {
+      std::vector<User*> released;
+      leaveBroadcastGroup(*iterator,released);
+#ifdef VERBOSE
+      printTimeStamp();
+      char str[128];
+      snprintf((char*)&str,sizeof(str),"$%08x left its broadcast group due to changed settings.",
+               (*iterator)->Client->SSRC);
+      std::cout << str << std::endl;
+#endif
+   }
+   for(std::vector<User*>::iterator iterator = diverged.begin();
+       iterator != diverged.end();iterator++) {
+      joinBroadcastGroup(*iterator);
+   }
 }
 
 
@@ -433,7 +710,18 @@ bool AudioServer::checkClient(Client* client)
 {
    User* user = (User*)client->UserData;
 
-   return(user->Sender.transmissionErrorDetected() == false);
+   // ====== Check for transmission error ===================================
+   // The user will be deleted. If it is a broadcast group leader, this
+   // releases its followers to their own encoders.
+   if(user->Sender.transmissionErrorDetected() == true) {
+      return(false);
+   }
+
+   // ====== Check broadcast group ==========================================
+   // Settings normally change in userCommand() only, which leaves the group
+   // first. This is a safeguard against settings diverging otherwise.
+   checkBroadcastGroup(user);
+   return(true);
 }
 
 
@@ -444,6 +732,17 @@ void AudioServer::receiverReport(Client*                   client,
 {
    User* user = (User*)client->UserData;
 
+   // ====== Passive round trip time estimation =============================
+   user->Sender.receptionReport(report);
+
+   // ====== Update statistics ==============================================
+   user->Statistics.set(user->StatLossRate,
+                        (card64)rint(1000.0 * report->getFractionLost()));
+   user->Statistics.set(user->StatPacketsLost,report->getPacketsLost());
+   user->Statistics.set(user->StatJitter,
+                        (card64)rint((double)report->getJitter() *
+                                     RTPConstants::RTPMicroSecondsPerTimeStamp));
+
    if(LossScalability == true) {
       if(QoSMgr != NULL) {
 #ifdef QOSMGR_DEBUG
@@ -452,4 +751,7 @@ void AudioServer::receiverReport(Client*                   client,
          QoSMgr->reportEvent(&user->Sender,report,layer);
       }
    }
+
+   // ====== Check broadcast group ==========================================
+   checkBroadcastGroup(user);
 }
@@ -37,6 +37,7 @@
 #include "tdsystem.h"
 #include "multiaudioreader.h"
 #include "tdsocket.h"
+#include "flowlabelmanager.h"
 #include "audioencoderrepository.h"
 #include "rtpsender.h"
 #include "rtcppacket.h"
@@ -46,8 +47,10 @@
 #include "qosmanagerinterface.h"
 
 #include "audioclientapppacket.h"
+#include "statisticsslot.h"
 
 #include <map>
+#include <vector>
 
 
 /**
@@ -63,8 +66,13 @@ class AudioServer : public RTCPAbstractServer
    private:
    struct User {
       RTCPAbstractServer::Client* Client;
+      StatisticsSlot              Statistics;
+      cardinal                    StatLossRate;
+      cardinal                    StatPacketsLost;
+      cardinal                    StatJitter;
       RTPSender                   Sender;
-      Socket                      SenderSocket;
+      Socket                      OwnSocket;
+      Socket*                     SenderSocket;
       InternetFlow                Flow;
       AudioEncoderRepository      Repository;
       MultiAudioReader            Reader;
@@ -76,8 +84,20 @@ class AudioServer : public RTCPAbstractServer
       bool                        UserLimitPause;
       bool                        ManagerLimitPause;
       bool                        ClientPause;
+      User*                       BroadcastLeader;
+      std::vector<User*>          BroadcastFollowers;
    };
 
+   /**
+     * Maximum position difference of users sharing a broadcast group.
+     */
+   static const card64 BroadcastPositionTolerance = PositionStepsPerSecond;
+
+   /**
+     * Send buffer size of a shared sender socket in packets of maximum size.
+     */
+   static const cardinal SharedSocketBufferPackets = 1024;
+
 
    // ====== Constructor/Destructor =========================================
    public:
@@ -120,6 +140,42 @@ class AudioServer : public RTCPAbstractServer
      */
    inline void setLossScalability(const bool on);
 
+   /**
+     * Get broadcast groups setting.
+     *
+     * @return true, if broadcast groups are on; false otherwise.
+     */
+   inline bool getBroadcastGroups() const;
+
+   /**
+     * Set broadcast groups setting. Users playing the same media at the same
+     * position, quality and encoding then share the encoder output of one
+     * of them, the group's leader. Broadcast groups are not used with a QoS
+     * manager, since it sets each stream's quality separately.
+     *
+     * @param on true, if to set broadcast groups on; false otherwise.
+     */
+   inline void setBroadcastGroups(const bool on);
+
+   /**
+     * Get number of shared sender sockets.
+     *
+     * @return Number of shared sender sockets (0 if each user has its own).
+     */
+   inline cardinal getSharedSockets() const;
+
+   /**
+     * Set number of shared sender sockets. New users are then assigned to
+     * these unconnected sockets in turn, instead of creating a socket and
+     * flow label for each of them; destination and traffic class are given
+     * for each packet. This has to be set before the first user joins.
+     * Shared sockets are not supported with SCTP.
+     *
+     * @param sockets Number of sockets (0 for one socket per user).
+     * @return true for success; false otherwise.
+     */
+   bool setSharedSockets(const cardinal sockets);
+
 
    // ====== Packet size ====================================================
    /**
@@ -216,6 +272,53 @@ class AudioServer : public RTCPAbstractServer
    void managementUpdate(RTCPAbstractServer::Client* client, User* user);
 
 
+   // ====== Broadcast groups ===============================================
+   /**
+     * Add user to the broadcast group of a matching user, if there is one.
+     *
+     * @param user User.
+     */
+   void joinBroadcastGroup(User* user);
+
+   /**
+     * Remove user from its broadcast group. If the user is a group leader,
+     * the group is dissolved. The users leaving continue at the group's
+     * position.
+     *
+     * @param user User.
+     * @param released Vector to add the released followers to.
+     */
+   void leaveBroadcastGroup(User* user, std::vector<User*>& released);
+
+   /**
+     * Check, if user may join the broadcast group of given leader. Both
+     * users' senders have to be locked.
+     *
+     * @param user User.
+     * @param leader Leader.
+     * @return true, if user may join; false otherwise.
+     */
+   bool matchesBroadcastGroup(User* user, User* leader);
+
+   /**
+     * Check, if user's media, quality, bandwidth limit and encoder settings
+     * match the leader's. Both users' senders have to be locked.
+     *
+     * @param user User.
+     * @param leader Leader.
+     * @return true, if settings match; false otherwise.
+     */
+   bool matchesBroadcastSettings(User* user, User* leader);
+
+   /**
+     * Remove user or its followers from their broadcast group, if their
+     * settings no longer match, and let them join a matching group.
+     *
+     * @param user User.
+     */
+   void checkBroadcastGroup(User* user);
+
+
    // ====== Private data ===================================================
    private:
    QoSManagerInterface*                QoSMgr;
@@ -224,7 +327,11 @@ class AudioServer : public RTCPAbstractServer
    cardinal                            MaxPacketSize;
    card32                              OurSSRC;
    bool                                LossScalability;
+   bool                                BroadcastGroups;
    bool                                UseSCTP;
+   std::vector<Socket*>                SharedSockets;
+   cardinal                            NextSharedSocket;
+   FlowLabelManager                    FlowLabels;
 };
 
 
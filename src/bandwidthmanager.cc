@@ -39,6 +39,9 @@
 #include "streamdescription.h"
 
 
+#include <set>
+
+
 // Print results
 // #define PRINT_REPORTS
 // #define PRINT_ROUNDTRIPTIMES
@@ -102,6 +105,9 @@ BandwidthManager::BandwidthManager(ServiceLevelAgreement* sla,
                                    RoundTripTimePinger*   rttp)
    : TimedThread(50000)
 {
+   // The thread's lock has to stay recursive: addStream() and
+   // removeStream() call doCompleteRemapping() and processEvents() with
+   // the lock held, and both of them lock again.
    setTimerCorrection(0);
 
    MaxRUPoints                          = 32;
@@ -142,6 +148,17 @@ BandwidthManager::BandwidthManager(ServiceLevelAgreement* sla,
       ClassBandwidthArray[i]          = 0;
       SLAUpdateRecommendation[i]      = 0;
    }
+
+   StatCompleteRemappings  = Statistics.addCounter("CompleteRemappings");
+   StatPartialRemappings   = Statistics.addCounter("PartialRemappings");
+   StatBufferFlushes       = Statistics.addCounter("BufferFlushes");
+   StatTotalBandwidth      = Statistics.addCounter("TotalBandwidth","B/s");
+   StatProcessedEvents     = Statistics.addCounter("ProcessedEvents");
+   StatCoalescedEvents     = Statistics.addCounter("CoalescedEvents");
+   StatEventQueueOverflows = Statistics.addCounter("EventQueueOverflows");
+   StatRemappingTime       = Statistics.addHistogram("RemappingTime","us");
+   StatEventLatency        = Statistics.addHistogram("EventLatency","us");
+   Statistics.publish("QoS Manager");
 }
 
 
@@ -159,6 +176,7 @@ BandwidthManager::~BandwidthManager()
 // ###### Main loop #########################################################
 void BandwidthManager::timerEvent()
 {
+   processEvents();
    doCompleteRemapping();
 }
 
@@ -277,6 +295,7 @@ void BandwidthManager::addStream(ManagedStreamInterface* stream,
 void BandwidthManager::removeStream(ManagedStreamInterface* stream)
 {
    synchronized();
+   processEvents();   // Queued events may still refer to this stream!
    std::multimap<ManagedStreamInterface*,StreamDescription*>::iterator found =
       StreamSet.find(stream);
    if(found != StreamSet.end()) {
@@ -342,21 +361,41 @@ void BandwidthManager::updateStream(ManagedStreamInterface* stream)
 // ###### Get round trip times for DiffServ classes #########################
 void BandwidthManager::getRoundTripTimes(StreamDescription* sd)
 {
-   // ====== Get round trip times from RTT pinger ===========================
-   if(RTTP != NULL) {
-      // ====== Get round trip times ========================================
-      cardinal rtt[SLA->Classes];
-      for(cardinal i = 0;i < SLA->Classes;i++) {
+   // ====== Get round trip times ===========================================
+   // Passive estimates from the stream's RTCP reports are preferred. The
+   // RTT pinger is only asked for classes without passive estimate.
+   cardinal rtt[SLA->Classes];
+   bool     measured = false;
+   for(cardinal i = 0;i < SLA->Classes;i++) {
+      rtt[i] = (sd->Interface != NULL) ?
+                  sd->Interface->getRoundTripTime(SLA->Class[i].TrafficClass) :
+                  (cardinal)-1;
+      if(rtt[i] != (cardinal)-1) {
+         measured = true;
+      }
+      else if(RTTP != NULL) {
          rtt[i] = RTTP->getRoundTripTime(
             sd->RoundTripTimeDestination,SLA->Class[i].TrafficClass);
-         // Note: The round trip time is already smoothed!
+         measured = true;
       }
+      // Note: The round trip time is already smoothed!
+   }
 
+   if(measured) {
       // ====== Calculate transfer delays ===================================
       for(cardinal i = 0;i < SLA->Classes;i++) {
-         sd->MeasuredTransferDelay[i] =
-            std::max((double)rtt[i] - (double)(rtt[SLA->BestEffort] / 2),
-                     (double)(rtt[i] / 2.0));
+         if((RTTP == NULL) && (rtt[i] == (cardinal)-1)) {
+            // No estimate and no pinger: use simulation value.
+            sd->MeasuredTransferDelay[i] = SLA->Class[i].MaxTransferDelay;
+         }
+         else if((RTTP == NULL) && (rtt[SLA->BestEffort] == (cardinal)-1)) {
+            sd->MeasuredTransferDelay[i] = (double)(rtt[i] / 2.0);
+         }
+         else {
+            sd->MeasuredTransferDelay[i] =
+               std::max((double)rtt[i] - (double)(rtt[SLA->BestEffort] / 2),
+                        (double)(rtt[i] / 2.0));
+         }
       }
 
       // ====== Write log entry =============================================
@@ -524,42 +563,70 @@ void BandwidthManager::reportEvent(ManagedStreamInterface*         stream,
                                    const RTCPReceptionReportBlock* report,
                                    const cardinal                  layer)
 {
-   // ====== Update StreamDescription =======================================
+   // ====== Queue event for the bandwidth manager's thread =================
+   if(running()) {
+      QoSEvent event;
+      event.Type         = QoSEvent::QET_Report;
+      event.Stream       = stream;
+      event.Layer        = layer;
+      event.FractionLost = report->getFractionLost();
+      event.Jitter       = report->getJitter();
+      event.TimeStamp    = (SimulatorTime == 0) ? getMicroTime() : SimulatorTime;
+      if(EventQueue.push(event)) {
+         return;
+      }
+   }
+
+   // ====== Thread not running or queue full -> update StreamDescription ===
    synchronized();
    std::multimap<ManagedStreamInterface*,StreamDescription*>::iterator found =
       StreamSet.find(stream);
    if(found != StreamSet.end()) {
       StreamDescription* streamDescription = found->second;
-      if(layer < streamDescription->Layers) {
-         smoothedUpdate(streamDescription->ReportedLossRate[layer],
-                        report->getFractionLost(),
-                        AlphaLossRate);
-         smoothedUpdate(streamDescription->ReportedJitter[layer],
-                        report->getJitter(),
-                        AlphaJitter);
+      if(applyReport(streamDescription, layer,
+                     report->getFractionLost(), report->getJitter())) {
          getRoundTripTimes(streamDescription);
+      }
+   }
+   unsynchronized();
+}
 
-         // ====== Write log entry =============================================
-         if(Log) {
-            *Log << ((SimulatorTime == 0) ? getMicroTime() : SimulatorTime) - LogStartupTimeStamp << " ReportEvent"
-                 << " #=" << streamDescription->StreamID
-                 << " S=" << streamDescription->Session->SessionID
-                 << " L=" << streamDescription->ReportedLossRate[layer]
-                 << " J=" << streamDescription->ReportedJitter[layer] << std::endl;
-         }
+
+// ###### Apply report to stream description ################################
+bool BandwidthManager::applyReport(StreamDescription* streamDescription,
+                                   const cardinal     layer,
+                                   const double       fractionLost,
+                                   const card32       jitter)
+{
+   if(layer < streamDescription->Layers) {
+      smoothedUpdate(streamDescription->ReportedLossRate[layer],
+                     fractionLost,
+                     AlphaLossRate);
+      smoothedUpdate(streamDescription->ReportedJitter[layer],
+                     jitter,
+                     AlphaJitter);
+
+      // ====== Write log entry =============================================
+      if(Log) {
+         *Log << ((SimulatorTime == 0) ? getMicroTime() : SimulatorTime) - LogStartupTimeStamp << " ReportEvent"
+              << " #=" << streamDescription->StreamID
+              << " S=" << streamDescription->Session->SessionID
+              << " L=" << streamDescription->ReportedLossRate[layer]
+              << " J=" << streamDescription->ReportedJitter[layer] << std::endl;
+      }
 #ifdef PRINT_REPORT
-         char str[256];
-         snprintf((char*)&str,sizeof(str),"Report: L%d  Loss=%1.2f Jitter=%1.2f -> Loss=%1.2f Jitter=%1.2f",
-                    layer,
-                    report->getFractionLost(),
-                    report->getJitter(),
-                    streamDescription->ReportedLossRate[layer],
-                    streamDescription->ReportedJitter[layer]);
-         std::cout << str << std::endl;
+      char str[256];
+      snprintf((char*)&str,sizeof(str),"Report: L%d  Loss=%1.2f Jitter=%1.2f -> Loss=%1.2f Jitter=%1.2f",
+                 layer,
+                 fractionLost,
+                 (double)jitter,
+                 streamDescription->ReportedLossRate[layer],
+                 streamDescription->ReportedJitter[layer]);
+      std::cout << str << std::endl;
 #endif
-      }
+      return(true);
    }
-   unsynchronized();
+   return(false);
 }
 
 
@@ -567,23 +634,103 @@ void BandwidthManager::reportEvent(ManagedStreamInterface*         stream,
 void BandwidthManager::bufferFlushEvent(ManagedStreamInterface* stream,
                                         const cardinal          layer)
 {
+   // ====== Queue event for the bandwidth manager's thread =================
+   if(running()) {
+      QoSEvent event;
+      event.Type         = QoSEvent::QET_BufferFlush;
+      event.Stream       = stream;
+      event.Layer        = layer;
+      event.FractionLost = 0.0;
+      event.Jitter       = 0;
+      event.TimeStamp    = (SimulatorTime == 0) ? getMicroTime() : SimulatorTime;
+      if(EventQueue.push(event)) {
+         return;
+      }
+   }
+
+   // ====== Thread not running or queue full -> update StreamDescription ===
    synchronized();
    std::multimap<ManagedStreamInterface*,StreamDescription*>::iterator found =
       StreamSet.find(stream);
    if(found != StreamSet.end()) {
-      StreamDescription* streamDescription = found->second;
-      streamDescription->BufferFlushes++;
+      applyBufferFlush(found->second,layer);
+   }
+   TotalBufferFlushes++;
+   Statistics.set(StatBufferFlushes,TotalBufferFlushes);
+   unsynchronized();
+}
 
 
-      // ====== Write log entry =============================================
-      if(Log) {
-         *Log << ((SimulatorTime == 0) ? getMicroTime() : SimulatorTime) - LogStartupTimeStamp << " BufferFlushEvent"
-              << " #=" << streamDescription->StreamID
-              << " S=" << streamDescription->Session->SessionID
-              << " L=" << layer << std::endl;
+// ###### Apply buffer flush to stream description ##########################
+void BandwidthManager::applyBufferFlush(StreamDescription* streamDescription,
+                                        const cardinal     layer)
+{
+   streamDescription->BufferFlushes++;
+
+   // ====== Write log entry ================================================
+   if(Log) {
+      *Log << ((SimulatorTime == 0) ? getMicroTime() : SimulatorTime) - LogStartupTimeStamp << " BufferFlushEvent"
+           << " #=" << streamDescription->StreamID
+           << " S=" << streamDescription->Session->SessionID
+           << " L=" << layer << std::endl;
+   }
+}
+
+
+// ###### Process queued events #############################################
+void BandwidthManager::processEvents()
+{
+   synchronized();
+
+   // ====== Apply queued events ============================================
+   std::set<StreamDescription*> updatedStreams;
+   card64                       timeStamps[MaxEventBatchSize];
+   cardinal                     events = 0;
+   QoSEvent                     event;
+   while((events < MaxEventBatchSize) && (EventQueue.pop(event))) {
+      timeStamps[events++] = event.TimeStamp;
+
+      std::multimap<ManagedStreamInterface*,StreamDescription*>::iterator found =
+         StreamSet.find(event.Stream);
+      if(found != StreamSet.end()) {
+         StreamDescription* streamDescription = found->second;
+         switch(event.Type) {
+            case QoSEvent::QET_Report:
+               if(applyReport(streamDescription, event.Layer,
+                              event.FractionLost, event.Jitter)) {
+                  if(updatedStreams.insert(streamDescription).second == false) {
+                     Statistics.add(StatCoalescedEvents);
+                  }
+               }
+             break;
+            case QoSEvent::QET_BufferFlush:
+               applyBufferFlush(streamDescription,event.Layer);
+             break;
+         }
+      }
+      if(event.Type == QoSEvent::QET_BufferFlush) {
+         TotalBufferFlushes++;
+         Statistics.set(StatBufferFlushes,TotalBufferFlushes);
       }
    }
-   TotalBufferFlushes++;
+
+   // ====== Update round trip times once per stream ========================
+   for(std::set<StreamDescription*>::iterator iterator = updatedStreams.begin();
+       iterator != updatedStreams.end(); iterator++) {
+      getRoundTripTimes(*iterator);
+   }
+
+   // ====== Update event-to-reaction latency statistics ====================
+   if(events > 0) {
+      const card64 now = (SimulatorTime == 0) ? getMicroTime() : SimulatorTime;
+      for(cardinal i = 0;i < events;i++) {
+         Statistics.record(StatEventLatency,
+                           (now > timeStamps[i]) ? (now - timeStamps[i]) : 0);
+      }
+      Statistics.add(StatProcessedEvents,events);
+      Statistics.set(StatEventQueueOverflows,EventQueue.getOverflows());
+   }
+
    unsynchronized();
 }
 
@@ -1146,6 +1293,9 @@ void BandwidthManager::doCompleteRemapping()
    // ====== Write statistics ===============================================
    const card64 endTimeStamp = getMicroTime();
    LastCompleteRemappingDuration = endTimeStamp - startTimeStamp;
+   Statistics.set(StatCompleteRemappings,CompleteRemappings);
+   Statistics.set(StatTotalBandwidth,TotalBandwidth);
+   Statistics.record(StatRemappingTime,LastCompleteRemappingDuration);
 
 
    // ====== Unsynchronize ==================================================
@@ -1191,6 +1341,7 @@ bool BandwidthManager::doPartialRemapping(StreamDescription* streamDescription)
 #endif
             streamDescription->PartialRemappings++;
             PartialRemappings++;
+            Statistics.set(StatPartialRemappings,PartialRemappings);
             success = true;
 
             // ====== Write log entry =======================================
@@ -46,7 +46,9 @@
 #include "streamdescription.h"
 #include "sessiondescription.h"
 #include "roundtriptimepinger.h"
+#include "qoseventqueue.h"
 #include "rtcppacket.h"
+#include "statisticsslot.h"
 
 
 #include <map>
@@ -276,7 +278,9 @@ class BandwidthManager : virtual public QoSManagerInterface,
                             const bool              newRUList);
 
    /**
-     * Report reception for given layer.
+     * Report reception for given layer. If the bandwidth manager's thread
+     * is running, the report is only queued and processed asynchronously
+     * by processEvents(); the caller does not wait for the QoS computation.
      *
      * @param stream Stream.
      * @param report Report.
@@ -287,13 +291,24 @@ class BandwidthManager : virtual public QoSManagerInterface,
                     const cardinal                  layer);
 
    /**
-     * Buffer flush for a given layer.
+     * Buffer flush for a given layer. If the bandwidth manager's thread
+     * is running, the event is only queued and processed asynchronously
+     * by processEvents().
      *
      * @param stream Stream.
+     * @param layer Layer.
      */
    void bufferFlushEvent(ManagedStreamInterface* stream,
                          const cardinal          layer);
 
+   /**
+     * Process queued report and buffer flush events. Multiple reports for
+     * the same stream are coalesced, i.e. the round trip times are updated
+     * only once per stream and batch. This method is called by timerEvent();
+     * it only has to be called directly when the thread is not running.
+     */
+   void processEvents();
+
    /**
      * Implementation of TimedThread's timerEvent() method.
      *
@@ -403,6 +418,26 @@ class BandwidthManager : virtual public QoSManagerInterface,
    cardinal TotalBufferFlushes;
 
 
+   // ====== Information about event processing =============================
+   /**
+     * Maximum number of events handled by one processEvents() batch.
+     */
+   static const cardinal MaxEventBatchSize = 1024;
+
+
+   // ====== Published statistics ===========================================
+   StatisticsSlot Statistics;
+   cardinal       StatCompleteRemappings;
+   cardinal       StatPartialRemappings;
+   cardinal       StatBufferFlushes;
+   cardinal       StatTotalBandwidth;
+   cardinal       StatProcessedEvents;
+   cardinal       StatCoalescedEvents;
+   cardinal       StatEventQueueOverflows;
+   cardinal       StatRemappingTime;
+   cardinal       StatEventLatency;
+
+
    // ====== Simulator variables ============================================
    static card64 SimulatorTime;
 
@@ -464,7 +499,15 @@ class BandwidthManager : virtual public QoSManagerInterface,
    bool doPartialRemapping(StreamDescription* streamDescription);
    void doCompleteRemapping();
 
+   bool applyReport(StreamDescription* streamDescription,
+                    const cardinal     layer,
+                    const double       fractionLost,
+                    const card32       jitter);
+   void applyBufferFlush(StreamDescription* streamDescription,
+                         const cardinal     layer);
+
 
+   QoSEventQueue        EventQueue;
    RoundTripTimePinger* RTTP;
    std::ostream*        Log;
    card64               LogStartupTimeStamp;
@@ -169,7 +169,13 @@ bool Condition::timedWait(const card64 microseconds)
       result = 0;
    }
    else {
+#ifdef SYNCHRONIZABLE_PROFILING
+      profileReleased();
+#endif
       result = pthread_cond_timedwait(&ConditionVariable,&Mutex,&timeout);
+#ifdef SYNCHRONIZABLE_PROFILING
+      profileAcquired();
+#endif
       while(result == EINTR) {
          unsynchronized();
          Thread::setCancelState(oldstate);
@@ -183,7 +189,13 @@ bool Condition::timedWait(const card64 microseconds)
             result = 0;
          }
          else {
+#ifdef SYNCHRONIZABLE_PROFILING
+            profileReleased();
+#endif
             result = pthread_cond_timedwait(&ConditionVariable,&Mutex,&timeout);
+#ifdef SYNCHRONIZABLE_PROFILING
+            profileAcquired();
+#endif
          }
       }
    }
@@ -0,0 +1,65 @@
+// ##########################################################################
+// ####                                                                  ####
+// ####                      RTP Audio Server Project                    ####
+// ####                    ============================                  ####
+// ####                                                                  ####
+// #### Decode-Ahead Reader                                              ####
+// ####                                                                  ####
+// ####           Copyright (C) 1999-2026 by Thomas Dreibholz            ####
+// ####                                                                  ####
+// #### Contact:                                                         ####
+// ####    EMail: thomas.dreibholz@gmail.com                             ####
+// ####    WWW:   https://www.nntb.no/~dreibh/rtpaudio                   ####
+// ####                                                                  ####
+// #### ---------------------------------------------------------------- ####
+// ####                                                                  ####
+// #### This program is free software: you can redistribute it and/or    ####
+// #### modify it under the terms of the GNU General Public License as   ####
+// #### published by the Free Software Foundation, either version 3 of   ####
+// #### the License, or (at your option) any later version.              ####
+// ####                                                                  ####
+// #### This program is distributed in the hope that it will be useful,  ####
+// #### but WITHOUT ANY WARRANTY; without even the implied warranty of   ####
+// #### MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    ####
+// #### GNU General Public License for more details.                     ####
+// ####                                                                  ####
+// #### You should have received a copy of the GNU General Public        ####
+// #### License along with this program.  If not, see                    ####
+// #### <http://www.gnu.org/licenses/>.                                  ####
+// ####                                                                  ####
+// ##########################################################################
+
+
+#include "tdsystem.h"
+#include "decodeaheadreader.h"
+
+
+
+// ###### Static attributes #################################################
+MP3DecoderPool* DecodeAheadReader::DefaultPool = NULL;
+
+
+// ###### Constructor #######################################################
+DecodeAheadReader::DecodeAheadReader(const char* name)
+   : FrameReady(name)
+{
+   Pool          = NULL;
+   QueueSlots    = 0;
+   QueueDecoding = false;
+   QueueEnd      = false;
+   QueueHead     = 0;
+   QueueTail     = 0;
+}
+
+
+// ###### Destructor ########################################################
+DecodeAheadReader::~DecodeAheadReader()
+{
+}
+
+
+// ###### Set decoder pool for new readers ##################################
+void DecodeAheadReader::setDecoderPool(MP3DecoderPool* pool)
+{
+   DefaultPool = pool;
+}
@@ -0,0 +1,127 @@
+// ##########################################################################
+// ####                                                                  ####
+// ####                      RTP Audio Server Project                    ####
+// ####                    ============================                  ####
+// ####                                                                  ####
+// #### Decode-Ahead Reader                                              ####
+// ####                                                                  ####
+// ####           Copyright (C) 1999-2026 by Thomas Dreibholz            ####
+// ####                                                                  ####
+// #### Contact:                                                         ####
+// ####    EMail: thomas.dreibholz@gmail.com                             ####
+// ####    WWW:   https://www.nntb.no/~dreibh/rtpaudio                   ####
+// ####                                                                  ####
+// #### ---------------------------------------------------------------- ####
+// ####                                                                  ####
+// #### This program is free software: you can redistribute it and/or    ####
+// #### modify it under the terms of the GNU General Public License as   ####
+// #### published by the Free Software Foundation, either version 3 of   ####
+// #### the License, or (at your option) any later version.              ####
+// ####                                                                  ####
+// #### This program is distributed in the hope that it will be useful,  ####
+// #### but WITHOUT ANY WARRANTY; without even the implied warranty of   ####
+// #### MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    ####
+// #### GNU General Public License for more details.                     ####
+// ####                                                                  ####
+// #### You should have received a copy of the GNU General Public        ####
+// #### License along with this program.  If not, see                    ####
+// #### <http://www.gnu.org/licenses/>.                                  ####
+// ####                                                                  ####
+// ##########################################################################
+
+
+#ifndef DECODEAHEADREADER_H
+#define DECODEAHEADREADER_H
+
+
+#include "tdsystem.h"
+#include "condition.h"
+
+
+#include <atomic>
+
+
+class MP3DecoderPool;
+
+
+/**
+  * This class is the base of audio readers decoding ahead by the threads
+  * of an MP3DecoderPool. It keeps the positions of the reader's queue of
+  * decoded blocks; the blocks themselves are stored by the subclass, which
+  * fills them in decodeAhead().
+  *
+  * @short   Decode-Ahead Reader
+  * @author  Thomas Dreibholz (thomas.dreibholz@gmail.com)
+  * @version 1.0
+  *
+  * @see MP3DecoderPool
+  */
+class DecodeAheadReader
+{
+   // ====== Decoder pool ===================================================
+   public:
+   /**
+     * Set the decoder pool for readers opening their media afterwards.
+     * With a pool, blocks are decoded ahead by the pool's threads and
+     * getNextBlock() only takes them from a queue. NULL (default) lets
+     * getNextBlock() decode synchronously.
+     *
+     * @param pool MP3DecoderPool or NULL.
+     */
+   static void setDecoderPool(MP3DecoderPool* pool);
+
+
+   // ====== Constructor/Destructor =========================================
+   protected:
+   /**
+     * Constructor.
+     *
+     * @param name Name of the reader's block condition.
+     */
+   DecodeAheadReader(const char* name);
+
+   /**
+     * Destructor.
+     */
+   virtual ~DecodeAheadReader();
+
+
+   // ====== Decode-ahead queue =============================================
+   /**
+     * Decode the next block into the queue. Only one thread at a time
+     * decodes for a reader; MP3DecoderPool ensures this.
+     *
+     * @return true, if a block has been decoded; false otherwise.
+     */
+   virtual bool decodeAhead() = 0;
+
+   /**
+     * Get number of decoded blocks in queue.
+     *
+     * @return Number of blocks.
+     */
+   inline cardinal getFramesQueued() const;
+
+   /**
+     * Empty the queue, e.g. after repositioning.
+     */
+   inline void resetQueue();
+
+
+   friend class MP3DecoderPool;
+
+   static MP3DecoderPool*          DefaultPool;
+   MP3DecoderPool*                 Pool;
+   cardinal                        QueueSlots;
+   bool                            QueueDecoding;
+   std::atomic<bool>               QueueEnd;
+   alignas(64) std::atomic<card64> QueueHead;
+   alignas(64) std::atomic<card64> QueueTail;
+   Condition                       FrameReady;
+};
+
+
+#include "decodeaheadreader.icc"
+
+
+#endif
@@ -0,0 +1,156 @@
+// ##########################################################################
+// ####                                                                  ####
+// ####                      RTP Audio Server Project                    ####
+// ####                    ============================                  ####
+// ####                                                                  ####
+// #### MP3 Decoder Benchmark                                            ####
+// ####                                                                  ####
+// ####           Copyright (C) 1999-2026 by Thomas Dreibholz            ####
+// ####                                                                  ####
+// #### Contact:                                                         ####
+// ####    EMail: thomas.dreibholz@gmail.com                             ####
+// ####    WWW:   https://www.nntb.no/~dreibh/rtpaudio                   ####
+// ####                                                                  ####
+// #### ---------------------------------------------------------------- ####
+// ####                                                                  ####
+// #### This program is free software: you can redistribute it and/or    ####
+// #### modify it under the terms of the GNU General Public License as   ####
+// #### published by the Free Software Foundation, either version 3 of   ####
+// #### the License, or (at your option) any later version.              ####
+// ####                                                                  ####
+// #### This program is distributed in the hope that it will be useful,  ####
+// #### but WITHOUT ANY WARRANTY; without even the implied warranty of   ####
+// #### MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    ####
+// #### GNU General Public License for more details.                     ####
+// ####                                                                  ####
+// #### You should have received a copy of the GNU General Public        ####
+// #### License along with this program.  If not, see                    ####
+// #### <http://www.gnu.org/licenses/>.                                  ####
+// ####                                                                  ####
+// ##########################################################################
+
+
+#include "tdsystem.h"
+#include "tools.h"
+#include "mp3audioreader.h"
+#include "mp3decoderpool.h"
+
+
+// ###### Decode a file and return the decoded duration in microseconds #####
+static card64 decodeFile(const char* name, card64& decodeTime)
+{
+   MP3AudioReader reader(name);
+   if(!reader.ready()) {
+      std::cerr << "ERROR: Unable to open <" << name << ">!" << std::endl;
+      return(0);
+   }
+
+   const card64 bytesPerSecond = reader.getBytesPerSecond();
+   char         buffer[16384];
+   card64       bytes = 0;
+   const card64 start = getMicroTime();
+   for(;;) {
+      const cardinal got = reader.getNextBlock((void*)&buffer,sizeof(buffer));
+      bytes += got;
+      if(got < sizeof(buffer)) {
+         break;
+      }
+   }
+   decodeTime = getMicroTime() - start;
+   return((bytesPerSecond > 0) ? (1000000 * bytes) / bytesPerSecond : 0);
+}
+
+
+
+// ###### Main program ######################################################
+int main(int argc, char* argv[])
+{
+   // ====== Check arguments ================================================
+   int      kernel      = SK_AUTO;
+   bool     lookup      = true;
+   cardinal rounds      = 1;
+   cardinal files       = 0;
+   cardinal decoders    = 0;
+   cardinal decodeAhead = 8;
+   for(cardinal i = 1;i < (cardinal)argc;i++) {
+      if(!(strcasecmp(argv[i],"-kernel=auto")))           kernel      = SK_AUTO;
+      else if(!(strcasecmp(argv[i],"-kernel=scalar")))    kernel      = SK_SCALAR;
+      else if(!(strcasecmp(argv[i],"-kernel=sse")))       kernel      = SK_SSE;
+      else if(!(strcasecmp(argv[i],"-kernel=avx")))       kernel      = SK_AVX;
+      else if(!(strcasecmp(argv[i],"-huffman=lookup")))   lookup      = true;
+      else if(!(strcasecmp(argv[i],"-huffman=tree")))     lookup      = false;
+      else if(!(strncasecmp(argv[i],"-rounds=",8)))       rounds      = std::max((cardinal)atol(&argv[i][8]),(cardinal)1);
+      else if(!(strncasecmp(argv[i],"-decoders=",10)))    decoders    = (cardinal)atol(&argv[i][10]);
+      else if(!(strncasecmp(argv[i],"-decodeahead=",13))) decodeAhead = (cardinal)atol(&argv[i][13]);
+      else if(argv[i][0] == '-') {
+         std::cerr << "Usage: " << argv[0] << " {-kernel=auto|scalar|sse|avx} {-huffman=lookup|tree} {-rounds=count} {-decoders=threads} {-decodeahead=frames} [MP3 file] ..." << std::endl;
+         exit(1);
+      }
+      else {
+         files++;
+      }
+   }
+   if(files == 0) {
+      std::cerr << "Usage: " << argv[0] << " {-kernel=auto|scalar|sse|avx} {-huffman=lookup|tree} {-rounds=count} {-decoders=threads} {-decodeahead=frames} [MP3 file] ..." << std::endl;
+      exit(1);
+   }
+   if(!Mpegtoraw::setsynthesiskernel(kernel)) {
+      std::cerr << "ERROR: Kernel not supported by this CPU!" << std::endl;
+      exit(1);
+   }
+   Mpegtoraw::sethuffmanlookup(lookup);
+
+
+   MP3DecoderPool* pool = NULL;
+   if(decoders > 0) {
+      pool = new MP3DecoderPool(decoders,decodeAhead);
+      if(!pool->ready()) {
+         std::cerr << "ERROR: Unable to start decoder threads!" << std::endl;
+         exit(1);
+      }
+      MP3AudioReader::setDecoderPool(pool);
+   }
+
+
+   // ====== Decode files ===================================================
+   static const char* kernelNames[] = { "auto", "scalar", "sse", "avx" };
+   std::cout << "Kernel: " << kernelNames[Mpegtoraw::getsynthesiskernel()]
+             << ", Huffman: " << (Mpegtoraw::gethuffmanlookup() ? "lookup" : "tree")
+             << ", rounds: " << rounds
+             << ", decoder threads: " << decoders << std::endl;
+
+   card64 totalMedia  = 0;
+   card64 totalDecode = 0;
+   for(cardinal i = 1;i < (cardinal)argc;i++) {
+      if(argv[i][0] == '-') {
+         continue;
+      }
+      card64 media  = 0;
+      card64 decode = 0;
+      for(cardinal r = 0;r < rounds;r++) {
+         card64 decodeTime;
+         media  += decodeFile(argv[i],decodeTime);
+         decode += decodeTime;
+      }
+      totalMedia  += media;
+      totalDecode += decode;
+
+      char str[256];
+      snprintf((char*)&str,sizeof(str),"%-40s %10.3f s  %10.3f s  %8.1fx",
+               argv[i],media / 1000000.0,decode / 1000000.0,
+               (decode > 0) ? (double)media / (double)decode : 0.0);
+      std::cout << str << std::endl;
+   }
+
+   char str[256];
+   snprintf((char*)&str,sizeof(str),"%-40s %10.3f s  %10.3f s  %8.1fx",
+            "Total",totalMedia / 1000000.0,totalDecode / 1000000.0,
+            (totalDecode > 0) ? (double)totalMedia / (double)totalDecode : 0.0);
+   std::cout << str << std::endl;
+
+   if(pool != NULL) {
+      MP3AudioReader::setDecoderPool(NULL);
+      delete pool;
+   }
+   return(0);
+}
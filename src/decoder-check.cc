@@ -0,0 +1,165 @@
+// ##########################################################################
+// ####                                                                  ####
+// ####                      RTP Audio Server Project                    ####
+// ####                    ============================                  ####
+// ####                                                                  ####
+// #### MP3 Decoder Check                                                ####
+// ####                                                                  ####
+// ####           Copyright (C) 1999-2026 by Thomas Dreibholz            ####
+// ####                                                                  ####
+// #### Contact:                                                         ####
+// ####    EMail: thomas.dreibholz@gmail.com                             ####
+// ####    WWW:   https://www.nntb.no/~dreibh/rtpaudio                   ####
+// ####                                                                  ####
+// #### ---------------------------------------------------------------- ####
+// ####                                                                  ####
+// #### This program is free software: you can redistribute it and/or    ####
+// #### modify it under the terms of the GNU General Public License as   ####
+// #### published by the Free Software Foundation, either version 3 of   ####
+// #### the License, or (at your option) any later version.              ####
+// ####                                                                  ####
+// #### This program is distributed in the hope that it will be useful,  ####
+// #### but WITHOUT ANY WARRANTY; without even the implied warranty of   ####
+// #### MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    ####
+// #### GNU General Public License for more details.                     ####
+// ####                                                                  ####
+// #### You should have received a copy of the GNU General Public        ####
+// #### License along with this program.  If not, see                    ####
+// #### <http://www.gnu.org/licenses/>.                                  ####
+// ####                                                                  ####
+// ##########################################################################
+
+
+
+#include "tdsystem.h"
+#include "mp3audioreader.h"
+
+#include <vector>
+
+
+// ###### Decode a file with the given kernel and Huffman decoder ##########
+static bool decodeFile(const char*         name,
+                       const int           kernel,
+                       const bool          huffmanLookup,
+                       std::vector<int16>& samples)
+{
+   if(!Mpegtoraw::setsynthesiskernel(kernel)) {
+      return(false);
+   }
+   Mpegtoraw::sethuffmanlookup(huffmanLookup);
+   MP3AudioReader reader(name);
+   if(!reader.ready()) {
+      std::cerr << "ERROR: Unable to open <" << name << ">!" << std::endl;
+      return(false);
+   }
+
+   int16 buffer[8192];
+   samples.clear();
+   for(;;) {
+      const cardinal got = reader.getNextBlock((void*)&buffer,sizeof(buffer));
+      samples.insert(samples.end(),buffer,buffer + got / sizeof(int16));
+      if(got < sizeof(buffer)) {
+         break;
+      }
+   }
+   return(true);
+}
+
+
+
+// ###### Main program ######################################################
+int main(int argc, char* argv[])
+{
+   // ====== Check arguments ================================================
+   cardinal tolerance = 64;
+   cardinal files     = 0;
+   for(cardinal i = 1;i < (cardinal)argc;i++) {
+      if(!(strncasecmp(argv[i],"-tolerance=",11))) tolerance = (cardinal)atol(&argv[i][11]);
+      else if(argv[i][0] == '-') {
+         std::cerr << "Usage: " << argv[0] << " {-tolerance=LSBs} [MP3 file] ..." << std::endl;
+         exit(1);
+      }
+      else {
+         files++;
+      }
+   }
+   if(files == 0) {
+      std::cerr << "Usage: " << argv[0] << " {-tolerance=LSBs} [MP3 file] ..." << std::endl;
+      exit(1);
+   }
+
+
+   // ====== Compare the decoders with the reference ========================
+   // The reference is the scalar kernel with the Huffman tree walk. The
+   // Huffman lookup tables must give identical results. The SIMD kernels
+   // compute the same 16 window products per sample, but add them in a
+   // different order. Each order's 15 float additions are off by at most
+   // 15*2^-24 of S, the sum of the products' magnitudes. The scaling by
+   // SCALE is exact and the truncation adds at most 1 LSB, so a sample
+   // may differ by 1 + 30*2^-24*S LSB (S in LSB). For S below 2^19 (16
+   // times full scale), that is 1 LSB. But S is not bounded by the output,
+   // since the window taps cancel, and grows with the overload. The default
+   // tolerance of 64 LSB is not derived from this bound; it is the
+   // largest difference seen on heavily clipped test streams, where S
+   // reaches 2^29 and all differences above 1 LSB were next to clipped
+   // samples. Anything beyond the tolerance, or a different number of
+   // samples, is an error.
+   struct Variant {
+      const char* Name;
+      int         Kernel;
+      bool        Exact;
+   };
+   static const Variant variants[] = {
+      { "lookup", SK_SCALAR, true  },
+      { "sse",    SK_SSE,    false },
+      { "avx",    SK_AVX,    false }
+   };
+   bool failed = false;
+   for(cardinal i = 1;i < (cardinal)argc;i++) {
+      if(argv[i][0] == '-') {
+         continue;
+      }
+      std::vector<int16> reference;
+      if(!decodeFile(argv[i],SK_SCALAR,false,reference)) {
+         failed = true;
+         continue;
+      }
+      for(cardinal v = 0;v < sizeof(variants) / sizeof(Variant);v++) {
+         std::vector<int16> samples;
+         if(!Mpegtoraw::setsynthesiskernel(variants[v].Kernel)) {
+            std::cout << argv[i] << ": " << variants[v].Name
+                      << " not supported by this CPU" << std::endl;
+            continue;
+         }
+         if(!decodeFile(argv[i],variants[v].Kernel,true,samples)) {
+            failed = true;
+            continue;
+         }
+
+         card64   differing  = 0;
+         cardinal difference = 0;
+         for(size_t j = 0;j < std::min(samples.size(),reference.size());j++) {
+            const cardinal d = (cardinal)abs((integer)samples[j] - (integer)reference[j]);
+            if(d > 0) {
+               differing++;
+               difference = std::max(difference,d);
+            }
+         }
+         const bool ok = (samples.size() == reference.size()) &&
+                         (difference <= (variants[v].Exact ? 0 : tolerance));
+         char str[256];
+         snprintf((char*)&str,sizeof(str),"%-40s %-6s %10llu samples  %8llu differing  max %5u LSB  %s",
+                  argv[i],variants[v].Name,(unsigned long long)samples.size(),
+                  (unsigned long long)differing,difference,
+                  ok ? "OK" : ((samples.size() != reference.size()) ? "LENGTH MISMATCH" : "FAILED"));
+         std::cout << str << std::endl;
+         if(!ok) {
+            failed = true;
+         }
+      }
+   }
+
+   Mpegtoraw::setsynthesiskernel(SK_AUTO);
+   Mpegtoraw::sethuffmanlookup(true);
+   return(failed ? 1 : 0);
+}
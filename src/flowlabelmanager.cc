@@ -0,0 +1,118 @@
+// ##########################################################################
+// ####                                                                  ####
+// ####                      RTP Audio Server Project                    ####
+// ####                    ============================                  ####
+// ####                                                                  ####
+// #### Flow Label Manager                                               ####
+// ####                                                                  ####
+// ####           Copyright (C) 1999-2026 by Thomas Dreibholz            ####
+// ####                                                                  ####
+// #### Contact:                                                         ####
+// ####    EMail: thomas.dreibholz@gmail.com                             ####
+// ####    WWW:   https://www.nntb.no/~dreibh/rtpaudio                   ####
+// ####                                                                  ####
+// #### ---------------------------------------------------------------- ####
+// ####                                                                  ####
+// #### This program is free software: you can redistribute it and/or    ####
+// #### modify it under the terms of the GNU General Public License as   ####
+// #### published by the Free Software Foundation, either version 3 of   ####
+// #### the License, or (at your option) any later version.              ####
+// ####                                                                  ####
+// #### This program is distributed in the hope that it will be useful,  ####
+// #### but WITHOUT ANY WARRANTY; without even the implied warranty of   ####
+// #### MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    ####
+// #### GNU General Public License for more details.                     ####
+// ####                                                                  ####
+// #### You should have received a copy of the GNU General Public        ####
+// #### License along with this program.  If not, see                    ####
+// #### <http://www.gnu.org/licenses/>.                                  ####
+// ####                                                                  ####
+// ##########################################################################
+
+
+#include "tdsystem.h"
+#include "flowlabelmanager.h"
+
+
+
+// ###### Constructor #######################################################
+FlowLabelManager::FlowLabelManager(const cardinal expires,
+                                   const card64   renewalWindow)
+   : TimedThread(renewalWindow / RenewalBatches,"FlowLabelManager")
+{
+   Expires         = expires;
+   NextReservation = 0;
+   setFastStart(false);
+}
+
+
+// ###### Destructor ########################################################
+FlowLabelManager::~FlowLabelManager()
+{
+   stop();
+   for(std::vector<Reservation>::iterator iterator = Reservations.begin();
+       iterator != Reservations.end();iterator++) {
+      iterator->Owner->freeFlow(iterator->Flow);
+   }
+}
+
+
+// ###### Allocate flow #####################################################
+InternetFlow FlowLabelManager::allocFlow(Socket*                socket,
+                                         const InternetAddress& address,
+                                         const card32           flowLabel,
+                                         const card8            shareLevel)
+{
+   InternetFlow flow = socket->allocFlow(address,flowLabel,shareLevel);
+   if(flow.getFlowLabel() != 0) {
+      Reservation reservation;
+      reservation.Owner = socket;
+      reservation.Flow  = flow;
+
+      synchronized();
+      Reservations.push_back(reservation);
+      unsynchronized();
+      if(!running()) {
+         start();
+      }
+   }
+   return(flow);
+}
+
+
+// ###### Free flow #########################################################
+void FlowLabelManager::freeFlow(Socket* socket, InternetFlow& flow)
+{
+   if(flow.getFlowLabel() == 0) {
+      return;
+   }
+
+   synchronized();
+   for(std::vector<Reservation>::iterator iterator = Reservations.begin();
+       iterator != Reservations.end();iterator++) {
+      if((iterator->Owner == socket) &&
+         (iterator->Flow.getFlowLabel() == flow.getFlowLabel())) {
+         Reservations.erase(iterator);
+         break;
+      }
+   }
+   socket->freeFlow(flow);
+   unsynchronized();
+}
+
+
+// ###### Renew next batch of reservations ##################################
+void FlowLabelManager::timerEvent()
+{
+   synchronized();
+   const cardinal reservations = Reservations.size();
+   const cardinal batchSize    = (reservations + RenewalBatches - 1) / RenewalBatches;
+   for(cardinal i = 0;i < batchSize;i++) {
+      if(NextReservation >= reservations) {
+         NextReservation = 0;
+      }
+      Reservation& reservation = Reservations[NextReservation++];
+      reservation.Owner->renewFlow(reservation.Flow,Expires);
+   }
+   unsynchronized();
+}
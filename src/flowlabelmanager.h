@@ -0,0 +1,146 @@
+// ##########################################################################
+// ####                                                                  ####
+// ####                      RTP Audio Server Project                    ####
+// ####                    ============================                  ####
+// ####                                                                  ####
+// #### Flow Label Manager                                               ####
+// ####                                                                  ####
+// ####           Copyright (C) 1999-2026 by Thomas Dreibholz            ####
+// ####                                                                  ####
+// #### Contact:                                                         ####
+// ####    EMail: thomas.dreibholz@gmail.com                             ####
+// ####    WWW:   https://www.nntb.no/~dreibh/rtpaudio                   ####
+// ####                                                                  ####
+// #### ---------------------------------------------------------------- ####
+// ####                                                                  ####
+// #### This program is free software: you can redistribute it and/or    ####
+// #### modify it under the terms of the GNU General Public License as   ####
+// #### published by the Free Software Foundation, either version 3 of   ####
+// #### the License, or (at your option) any later version.              ####
+// ####                                                                  ####
+// #### This program is distributed in the hope that it will be useful,  ####
+// #### but WITHOUT ANY WARRANTY; without even the implied warranty of   ####
+// #### MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    ####
+// #### GNU General Public License for more details.                     ####
+// ####                                                                  ####
+// #### You should have received a copy of the GNU General Public        ####
+// #### License along with this program.  If not, see                    ####
+// #### <http://www.gnu.org/licenses/>.                                  ####
+// ####                                                                  ####
+// ##########################################################################
+
+
+#ifndef FLOWLABELMANAGER_H
+#define FLOWLABELMANAGER_H
+
+
+#include "tdsystem.h"
+#include "timedthread.h"
+#include "tdsocket.h"
+#include "internetaddress.h"
+#include "internetflow.h"
+
+
+#include <vector>
+
+
+
+/**
+  * This class owns the IPv6 flow label reservations of a process. Flows
+  * are allocated and freed by the manager instead of the socket, only
+  * flows having a flow label are registered. The manager's own thread
+  * renews the reservations in batches: the renewal window is split into
+  * RenewalBatches slices and each timer event renews the next slice, so
+  * that every reservation is renewed once per window. The thread is
+  * started on the first reservation; without flow labels, nothing is done
+  * at all.
+  *
+  * @short   Flow Label Manager
+  * @author  Thomas Dreibholz (thomas.dreibholz@gmail.com)
+  * @version 1.0
+  *
+  * @see Socket#allocFlow
+  * @see Socket#renewFlow
+  */
+class FlowLabelManager : public TimedThread
+{
+   // ====== Constructor/Destructor =========================================
+   public:
+   /**
+     * Constructor.
+     *
+     * @param expires Seconds until a reservation expires without renewal.
+     * @param renewalWindow Window in microseconds in which all reservations are renewed once.
+     */
+   FlowLabelManager(const cardinal expires       = 10,
+                    const card64   renewalWindow = 5000000);
+
+   /**
+     * Destructor. All reservations are freed.
+     */
+   ~FlowLabelManager();
+
+
+   // ====== Reservation functions ==========================================
+   /**
+     * Allocate a flow to a given destination on a given socket. The
+     * returned flow has flow label 0, if no label could be allocated. In
+     * this case, the flow is not registered.
+     *
+     * @param socket Socket to allocate the flow label on.
+     * @param address Address of the destination.
+     * @param flowLabel Flow label; 0 for random value.
+     * @param shareLevel Share level for flow label.
+     * @return InternetFlow.
+     *
+     * @see Socket#allocFlow
+     */
+   InternetFlow allocFlow(Socket*                socket,
+                          const InternetAddress& address,
+                          const card32           flowLabel  = 0,
+                          const card8            shareLevel = 2);
+
+   /**
+     * Free a flow allocated by allocFlow(). Flows without flow label are
+     * ignored.
+     *
+     * @param socket Socket the flow has been allocated on.
+     * @param flow Flow to be freed.
+     */
+   void freeFlow(Socket* socket, InternetFlow& flow);
+
+   /**
+     * Get number of registered reservations.
+     *
+     * @return Number of reservations.
+     */
+   inline cardinal getReservations();
+
+
+   // ====== Constants ======================================================
+   /**
+     * Number of slices the renewal window is split into.
+     */
+   static const cardinal RenewalBatches = 10;
+
+
+   // ====== Private data ===================================================
+   private:
+   void timerEvent();
+
+
+   struct Reservation {
+      Socket*      Owner;
+      InternetFlow Flow;
+   };
+
+   std::vector<Reservation> Reservations;
+   cardinal                 NextReservation;
+   cardinal                 Expires;
+};
+
+
+#include "flowlabelmanager.icc"
+
+
+#endif
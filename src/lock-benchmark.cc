@@ -0,0 +1,190 @@
+// ##########################################################################
+// ####                                                                  ####
+// ####                      RTP Audio Server Project                    ####
+// ####                    ============================                  ####
+// ####                                                                  ####
+// #### Lock Benchmark                                                   ####
+// ####                                                                  ####
+// ####           Copyright (C) 1999-2026 by Thomas Dreibholz            ####
+// ####                                                                  ####
+// #### Contact:                                                         ####
+// ####    EMail: thomas.dreibholz@gmail.com                             ####
+// ####    WWW:   https://www.nntb.no/~dreibh/rtpaudio                   ####
+// ####                                                                  ####
+// #### ---------------------------------------------------------------- ####
+// ####                                                                  ####
+// #### This program is free software: you can redistribute it and/or    ####
+// #### modify it under the terms of the GNU General Public License as   ####
+// #### published by the Free Software Foundation, either version 3 of   ####
+// #### the License, or (at your option) any later version.              ####
+// ####                                                                  ####
+// #### This program is distributed in the hope that it will be useful,  ####
+// #### but WITHOUT ANY WARRANTY; without even the implied warranty of   ####
+// #### MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    ####
+// #### GNU General Public License for more details.                     ####
+// ####                                                                  ####
+// #### You should have received a copy of the GNU General Public        ####
+// #### License along with this program.  If not, see                    ####
+// #### <http://www.gnu.org/licenses/>.                                  ####
+// ####                                                                  ####
+// ##########################################################################
+
+
+#include "tdsystem.h"
+#include "tools.h"
+#include "thread.h"
+#include "synchronizable.h"
+
+
+#include <atomic>
+#include <vector>
+#include <iomanip>
+
+
+// ###### Lock worker #######################################################
+class LockWorker : public Thread
+{
+   public:
+   LockWorker(Synchronizable*          lock,
+              const std::atomic<bool>* go,
+              const cardinal           operations,
+              const cardinal           insideWork,
+              const cardinal           outsideWork);
+
+   card64 Duration;
+
+   private:
+   void run();
+
+   Synchronizable*          Lock;
+   const std::atomic<bool>* Go;
+   cardinal                 Operations;
+   cardinal                 InsideWork;
+   cardinal                 OutsideWork;
+};
+
+
+// Work to be done inside and outside of the critical section.
+static volatile cardinal SharedCounter = 0;
+
+
+// ###### Constructor #######################################################
+LockWorker::LockWorker(Synchronizable*          lock,
+                       const std::atomic<bool>* go,
+                       const cardinal           operations,
+                       const cardinal           insideWork,
+                       const cardinal           outsideWork)
+   : Thread("LockWorker")
+{
+   Lock        = lock;
+   Go          = go;
+   Operations  = operations;
+   InsideWork  = insideWork;
+   OutsideWork = outsideWork;
+   Duration    = 0;
+}
+
+
+// ###### Worker loop #######################################################
+void LockWorker::run()
+{
+   while(!Go->load(std::memory_order_acquire)) {
+      yield();
+   }
+
+   const card64 start = getMicroTime();
+   volatile cardinal local = 0;
+   for(cardinal i = 0;i < Operations;i++) {
+      Lock->synchronized();
+      for(cardinal j = 0;j < InsideWork;j++) {
+         SharedCounter = SharedCounter + 1;
+      }
+      Lock->unsynchronized();
+      for(cardinal j = 0;j < OutsideWork;j++) {
+         local = local + 1;
+      }
+   }
+   Duration = getMicroTime() - start;
+}
+
+
+// ###### Run benchmark for one lock type ###################################
+static void runBenchmark(const char*                    name,
+                         const Synchronizable::LockType type,
+                         const cardinal                 threads,
+                         const cardinal                 operations,
+                         const cardinal                 insideWork,
+                         const cardinal                 outsideWork)
+{
+   Synchronizable           lock(name,type);
+   std::atomic<bool>        go(false);
+   std::vector<LockWorker*> workers;
+   for(cardinal i = 0;i < threads;i++) {
+      LockWorker* worker = new LockWorker(&lock,&go,operations,insideWork,outsideWork);
+      worker->start();
+      workers.push_back(worker);
+   }
+
+   const card64 start = getMicroTime();
+   go.store(true,std::memory_order_release);
+   card64 threadTime = 0;
+   for(std::vector<LockWorker*>::iterator iterator = workers.begin();
+       iterator != workers.end();iterator++) {
+      (*iterator)->join();
+      threadTime += (*iterator)->Duration;
+      delete *iterator;
+   }
+   const card64 duration = getMicroTime() - start;
+
+   // Throughput cost: wall time per operation of all threads.
+   // Latency cost: time per operation as seen by each thread.
+   const double totalOperations = (double)threads * (double)operations;
+   std::cout << "   " << std::setw(12) << std::left << name << std::right
+             << std::setw(12) << std::fixed << std::setprecision(1)
+             << (1000.0 * (double)duration / totalOperations)
+             << std::setw(16)
+             << (1000.0 * (double)threadTime / totalOperations) << std::endl;
+}
+
+
+// ###### Print usage and exit ##############################################
+static void usage(const char* program)
+{
+   std::cerr << "Usage: " << program << " {-threads=count} {-operations=count} {-inside=iterations} {-outside=iterations}" << std::endl;
+   exit(1);
+}
+
+
+
+// ###### Main program ######################################################
+int main(int argc, char* argv[])
+{
+   // ====== Check arguments ================================================
+   cardinal threads     = 4;
+   cardinal operations  = 1000000;
+   cardinal insideWork  = 10;
+   cardinal outsideWork = 100;
+   for(cardinal i = 1;i < (cardinal)argc;i++) {
+      if(!(strncasecmp(argv[i],"-threads=",9)))         threads     = std::max((cardinal)atol(&argv[i][9]),(cardinal)1);
+      else if(!(strncasecmp(argv[i],"-operations=",12))) operations  = std::max((cardinal)atol(&argv[i][12]),(cardinal)1);
+      else if(!(strncasecmp(argv[i],"-inside=",8)))      insideWork  = (cardinal)atol(&argv[i][8]);
+      else if(!(strncasecmp(argv[i],"-outside=",9)))     outsideWork = (cardinal)atol(&argv[i][9]);
+      else {
+         usage(argv[0]);
+      }
+   }
+
+   std::cout << "Threads: " << threads
+             << ", operations per thread: " << operations
+             << ", work inside: " << insideWork
+             << ", outside: " << outsideWork << std::endl
+             << "   Lock type    ns/op (all)  ns/op (thread)" << std::endl;
+
+
+   // ====== Run benchmarks =================================================
+   runBenchmark("Recursive", Synchronizable::LT_Recursive, threads, operations, insideWork, outsideWork);
+   runBenchmark("Normal",    Synchronizable::LT_Normal,    threads, operations, insideWork, outsideWork);
+   runBenchmark("Adaptive",  Synchronizable::LT_Adaptive,  threads, operations, insideWork, outsideWork);
+   runBenchmark("SpinPark",  Synchronizable::LT_SpinPark,  threads, operations, insideWork, outsideWork);
+   return(0);
+}
@@ -0,0 +1,202 @@
+// ##########################################################################
+// ####                                                                  ####
+// ####                      RTP Audio Server Project                    ####
+// ####                    ============================                  ####
+// ####                                                                  ####
+// #### Lock Profiler                                                    ####
+// ####                                                                  ####
+// ####           Copyright (C) 1999-2026 by Thomas Dreibholz            ####
+// ####                                                                  ####
+// #### Contact:                                                         ####
+// ####    EMail: thomas.dreibholz@gmail.com                             ####
+// ####    WWW:   https://www.nntb.no/~dreibh/rtpaudio                   ####
+// ####                                                                  ####
+// #### ---------------------------------------------------------------- ####
+// ####                                                                  ####
+// #### This program is free software: you can redistribute it and/or    ####
+// #### modify it under the terms of the GNU General Public License as   ####
+// #### published by the Free Software Foundation, either version 3 of   ####
+// #### the License, or (at your option) any later version.              ####
+// ####                                                                  ####
+// #### This program is distributed in the hope that it will be useful,  ####
+// #### but WITHOUT ANY WARRANTY; without even the implied warranty of   ####
+// #### MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    ####
+// #### GNU General Public License for more details.                     ####
+// ####                                                                  ####
+// #### You should have received a copy of the GNU General Public        ####
+// #### License along with this program.  If not, see                    ####
+// #### <http://www.gnu.org/licenses/>.                                  ####
+// ####                                                                  ####
+// ##########################################################################
+
+
+#include "tdsystem.h"
+#include "lockprofiler.h"
+
+
+#include <algorithm>
+#include <iomanip>
+
+
+
+// ###### Static data #######################################################
+thread_local LockProfiler::ThreadCountersHolder LockProfiler::LocalCounters;
+pthread_mutex_t                                 LockProfiler::RegistryMutex = PTHREAD_MUTEX_INITIALIZER;
+char                                            LockProfiler::Names[LockProfiler::MaxSlots][64] = { "(other)" };
+cardinal                                        LockProfiler::Slots         = 1;
+LockProfiler::ThreadCounters*                   LockProfiler::ThreadList    = NULL;
+LockProfiler::Statistics                        LockProfiler::Finished[LockProfiler::MaxSlots];
+LockProfiler::ThreadCounters                    LockProfiler::Discarded;
+volatile sig_atomic_t                           LockProfiler::DumpRequested = 0;
+
+
+// ###### Create calling thread's counters ##################################
+LockProfiler::ThreadCountersHolder::ThreadCountersHolder()
+{
+   Counters = new ThreadCounters;
+   for(cardinal i = 0;i < MaxSlots;i++) {
+      Counters->Slot[i].Acquisitions.store(0);
+      Counters->Slot[i].ContendedAcquisitions.store(0);
+      Counters->Slot[i].TotalWaitTime.store(0);
+      Counters->Slot[i].MaxHoldTime.store(0);
+   }
+
+   pthread_mutex_lock(&RegistryMutex);
+   Counters->Next = ThreadList;
+   ThreadList     = Counters;
+   pthread_mutex_unlock(&RegistryMutex);
+}
+
+
+// ###### Collect counters of finished thread ###############################
+LockProfiler::ThreadCountersHolder::~ThreadCountersHolder()
+{
+   ThreadCounters* counters = Counters;
+   Counters = &Discarded;
+
+   pthread_mutex_lock(&RegistryMutex);
+   collect(counters,Finished);
+   ThreadCounters** prev = &ThreadList;
+   while(*prev != NULL) {
+      if(*prev == counters) {
+         *prev = counters->Next;
+         break;
+      }
+      prev = &(*prev)->Next;
+   }
+   pthread_mutex_unlock(&RegistryMutex);
+
+   delete counters;
+}
+
+
+// ###### Get slot number for lock name #####################################
+cardinal LockProfiler::getSlot(const char* name)
+{
+   cardinal slot = 0;
+   pthread_mutex_lock(&RegistryMutex);
+   for(cardinal i = 1;i < Slots;i++) {
+      if(strcmp(Names[i],name) == 0) {
+         slot = i;
+         break;
+      }
+   }
+   if((slot == 0) && (Slots < MaxSlots)) {
+      slot = Slots++;
+      snprintf((char*)&Names[slot],sizeof(Names[slot]),"%s",name);
+   }
+   pthread_mutex_unlock(&RegistryMutex);
+   return(slot);
+}
+
+
+// ###### Add thread's counters to statistics ###############################
+void LockProfiler::collect(const ThreadCounters* counters, Statistics* statistics)
+{
+   for(cardinal i = 0;i < MaxSlots;i++) {
+      const Counter& counter = counters->Slot[i];
+      statistics[i].Acquisitions          += counter.Acquisitions.load(std::memory_order_relaxed);
+      statistics[i].ContendedAcquisitions += counter.ContendedAcquisitions.load(std::memory_order_relaxed);
+      statistics[i].TotalWaitTime         += counter.TotalWaitTime.load(std::memory_order_relaxed);
+      statistics[i].MaxHoldTime            = std::max(statistics[i].MaxHoldTime,
+                                                      counter.MaxHoldTime.load(std::memory_order_relaxed));
+   }
+}
+
+
+// ###### Compare statistics by total wait time #############################
+static bool hasLongerWaitTime(const LockProfiler::Statistics& a,
+                              const LockProfiler::Statistics& b)
+{
+   return(a.TotalWaitTime > b.TotalWaitTime);
+}
+
+
+// ###### Get aggregated statistics #########################################
+void LockProfiler::getStatistics(std::vector<Statistics>& statistics)
+{
+   Statistics aggregated[MaxSlots];
+
+   pthread_mutex_lock(&RegistryMutex);
+   memcpy((void*)&aggregated,(const void*)&Finished,sizeof(aggregated));
+   for(const ThreadCounters* counters = ThreadList;counters != NULL;counters = counters->Next) {
+      collect(counters,aggregated);
+   }
+   const cardinal slots = Slots;
+   for(cardinal i = 0;i < slots;i++) {
+      memcpy((void*)&aggregated[i].Name,(const void*)&Names[i],sizeof(aggregated[i].Name));
+   }
+   pthread_mutex_unlock(&RegistryMutex);
+
+   statistics.clear();
+   for(cardinal i = 0;i < slots;i++) {
+      if(aggregated[i].Acquisitions > 0) {
+         statistics.push_back(aggregated[i]);
+      }
+   }
+   std::sort(statistics.begin(),statistics.end(),hasLongerWaitTime);
+}
+
+
+// ###### Print aggregated statistics #######################################
+void LockProfiler::dump(std::ostream& os)
+{
+   std::vector<Statistics> statistics;
+   getStatistics(statistics);
+
+   os << "Lock Statistics:" << std::endl
+      << "   Name                            Acquisitions    Contended    Wait [us]    Max Hold [us]" << std::endl;
+   for(std::vector<Statistics>::iterator iterator = statistics.begin();
+       iterator != statistics.end();iterator++) {
+      os << "   " << std::setw(32) << std::left  << iterator->Name
+                 << std::setw(12) << std::right << iterator->Acquisitions
+         << " " << std::setw(12) << iterator->ContendedAcquisitions
+         << " " << std::setw(12) << (iterator->TotalWaitTime / 1000)
+         << " " << std::setw(16) << (iterator->MaxHoldTime / 1000) << std::endl;
+   }
+}
+
+
+// ###### Signal handler ####################################################
+void LockProfiler::dumpSignalHandler(int)
+{
+   DumpRequested = 1;
+}
+
+
+// ###### Install dump signal handler #######################################
+void LockProfiler::installDumpSignal(const int signum)
+{
+   signal(signum,&dumpSignalHandler);
+}
+
+
+// ###### Check for dump request ############################################
+bool LockProfiler::dumpRequested()
+{
+   if(DumpRequested) {
+      DumpRequested = 0;
+      return(true);
+   }
+   return(false);
+}
@@ -0,0 +1,203 @@
+// ##########################################################################
+// ####                                                                  ####
+// ####                      RTP Audio Server Project                    ####
+// ####                    ============================                  ####
+// ####                                                                  ####
+// #### Lock Profiler                                                    ####
+// ####                                                                  ####
+// ####           Copyright (C) 1999-2026 by Thomas Dreibholz            ####
+// ####                                                                  ####
+// #### Contact:                                                         ####
+// ####    EMail: thomas.dreibholz@gmail.com                             ####
+// ####    WWW:   https://www.nntb.no/~dreibh/rtpaudio                   ####
+// ####                                                                  ####
+// #### ---------------------------------------------------------------- ####
+// ####                                                                  ####
+// #### This program is free software: you can redistribute it and/or    ####
+// #### modify it under the terms of the GNU General Public License as   ####
+// #### published by the Free Software Foundation, either version 3 of   ####
+// #### the License, or (at your option) any later version.              ####
+// ####                                                                  ####
+// #### This program is distributed in the hope that it will be useful,  ####
+// #### but WITHOUT ANY WARRANTY; without even the implied warranty of   ####
+// #### MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    ####
+// #### GNU General Public License for more details.                     ####
+// ####                                                                  ####
+// #### You should have received a copy of the GNU General Public        ####
+// #### License along with this program.  If not, see                    ####
+// #### <http://www.gnu.org/licenses/>.                                  ####
+// ####                                                                  ####
+// ##########################################################################
+
+
+#ifndef LOCKPROFILER_H
+#define LOCKPROFILER_H
+
+
+#include "tdsystem.h"
+
+
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
+#include <atomic>
+#include <vector>
+
+
+
+/**
+  * This class records lock contention statistics of Synchronizable objects,
+  * if compiled with SYNCHRONIZABLE_PROFILING (CMake option
+  * USE_LOCK_PROFILING). Locks are identified by their name: all locks of
+  * the same name share one slot. The counters are written into per-thread
+  * slots without any locking and are only aggregated on demand by
+  * getStatistics() or dump(). Counters of finished threads are added to a
+  * global slot set.
+  *
+  * @short   Lock Profiler
+  * @author  Thomas Dreibholz (thomas.dreibholz@gmail.com)
+  * @version 1.0
+  *
+  * @see Synchronizable
+  */
+class LockProfiler
+{
+   // ====== Statistics =====================================================
+   public:
+   /**
+     * Aggregated statistics of a lock name.
+     */
+   struct Statistics {
+      char   Name[64];
+      card64 Acquisitions;
+      card64 ContendedAcquisitions;
+      card64 TotalWaitTime;            // in nanoseconds
+      card64 MaxHoldTime;              // in nanoseconds
+   };
+
+   /**
+     * Get aggregated statistics of all lock names, sorted by total wait
+     * time.
+     *
+     * @param statistics Vector to store statistics into.
+     */
+   static void getStatistics(std::vector<Statistics>& statistics);
+
+   /**
+     * Print aggregated statistics.
+     *
+     * @param os Output stream.
+     */
+   static void dump(std::ostream& os);
+
+
+   // ====== Dump on signal =================================================
+   /**
+     * Install handler for a signal requesting a dump. Since dump() is not
+     * async signal safe, the handler only sets a flag to be checked by
+     * dumpRequested().
+     *
+     * @param signum Signal number (default SIGUSR1).
+     */
+   static void installDumpSignal(const int signum = SIGUSR1);
+
+   /**
+     * Check, if a dump has been requested by the signal. The request is
+     * reset.
+     *
+     * @return true, if a dump has been requested; false otherwise.
+     */
+   static bool dumpRequested();
+
+
+   // ====== Functions for Synchronizable ===================================
+   /**
+     * Get slot number for a lock name.
+     *
+     * @param name Lock name.
+     * @return Slot number.
+     */
+   static cardinal getSlot(const char* name);
+
+   /**
+     * Get monotonic time in nanoseconds.
+     *
+     * @return Time.
+     */
+   inline static card64 getTime();
+
+   /**
+     * Record an acquisition.
+     *
+     * @param slot Slot number.
+     * @return Acquisition time.
+     */
+   inline static card64 acquired(const cardinal slot);
+
+   /**
+     * Record waiting time of a contended acquisition.
+     *
+     * @param slot Slot number.
+     * @param waitTime Waiting time in nanoseconds.
+     */
+   inline static void contended(const cardinal slot, const card64 waitTime);
+
+   /**
+     * Record a release.
+     *
+     * @param slot Slot number.
+     * @param acquireTime Acquisition time returned by acquired().
+     */
+   inline static void released(const cardinal slot, const card64 acquireTime);
+
+
+   // ====== Constants ======================================================
+   /**
+     * Maximum number of lock names. Further names share slot 0.
+     */
+   static const cardinal MaxSlots = 256;
+
+
+   // ====== Private data ===================================================
+   private:
+   struct Counter {
+      std::atomic<card64> Acquisitions;
+      std::atomic<card64> ContendedAcquisitions;
+      std::atomic<card64> TotalWaitTime;
+      std::atomic<card64> MaxHoldTime;
+   };
+
+   struct ThreadCounters {
+      Counter         Slot[MaxSlots];
+      ThreadCounters* Next;
+   };
+
+   class ThreadCountersHolder {
+      public:
+      ThreadCountersHolder();
+      ~ThreadCountersHolder();
+
+      ThreadCounters* Counters;
+   };
+
+   inline static Counter& getCounter(const cardinal slot);
+   inline static void add(std::atomic<card64>& counter, const card64 value);
+   static void collect(const ThreadCounters* counters, Statistics* statistics);
+   static void dumpSignalHandler(int signum);
+
+
+   static thread_local ThreadCountersHolder LocalCounters;
+   static pthread_mutex_t                   RegistryMutex;
+   static char                              Names[MaxSlots][64];
+   static cardinal                          Slots;
+   static ThreadCounters*                   ThreadList;
+   static Statistics                        Finished[MaxSlots];
+   static ThreadCounters                    Discarded;   // Used at thread exit
+   static volatile sig_atomic_t             DumpRequested;
+};
+
+
+#include "lockprofiler.icc"
+
+
+#endif
@@ -75,6 +75,16 @@ class ManagedStreamInterface
      */
    virtual void updateQuality(const AbstractQoSDescription* aqd) = 0;
 
+   /**
+     * Get round trip time for given traffic class, passively estimated
+     * from the stream's RTCP reports. The default implementation provides
+     * no estimate.
+     *
+     * @param trafficClass Traffic class.
+     * @return Round trip time in microseconds; (cardinal)-1, if there is no estimate.
+     */
+   virtual cardinal getRoundTripTime(const card8) { return((cardinal)-1); }
+
 
    /**
      * Lock stream.
@@ -32,6 +32,7 @@
 
 #include "tdsystem.h"
 #include "mp3audioreader.h"
+#include "mp3decoderpool.h"
 
 
 #include <stdarg.h>
@@ -43,11 +44,19 @@
 
 // ###### Constructor #######################################################
 MP3AudioReader::MP3AudioReader(const char* name)
-   : AudioQuality(0,0,0,BYTE_ORDER)
+   : AudioQuality(0,0,0,BYTE_ORDER),
+     DecodeAheadReader("MP3AudioReader::FrameReady")
 {
    BufferPos   = 0;
    BufferSize  = 0;
 
+   DecodedSamplingRate = 0;
+   DecodedBits         = 0;
+   DecodedChannels     = 0;
+
+   Queue      = NULL;
+   QueueInput = NULL;
+
    FramesPerSecond = 1.0;
    Position        = 0;
    MaxPosition     = 0;
@@ -81,13 +90,24 @@ bool MP3AudioReader::openMedia(const char* name)
       return(false);
    }
 
-   // ====== Create Soundinputstreamfromfile object and open file ===========
-   MP3Source = new Soundinputstreamfromfile();
+   // ====== Create Soundinputstream object and open file ==================
+   // The file is memory mapped and shared with other readers of the same
+   // file. Reading through stdio is the fallback, if mapping fails.
+   MP3Source = new Soundinputstreamfrommap();
    if(MP3Source == NULL) {
       closeMedia();
       return(false);
    }
    bool ok = MP3Source->open((char*)&fileName);
+   if(ok == false) {
+      delete MP3Source;
+      MP3Source = new Soundinputstreamfromfile();
+      if(MP3Source == NULL) {
+         closeMedia();
+         return(false);
+      }
+      ok = MP3Source->open((char*)&fileName);
+   }
    if(ok == false) {
       closeMedia();
       return(false);
@@ -116,6 +136,9 @@ bool MP3AudioReader::openMedia(const char* name)
                                FramesPerSecond);
    Error = ME_NoError;
 
+   if(DefaultPool != NULL) {
+      attachPool();
+   }
    return(true);
 }
 
@@ -123,6 +146,7 @@ bool MP3AudioReader::openMedia(const char* name)
 // ###### Close input #######################################################
 void MP3AudioReader::closeMedia()
 {
+   detachPool();
    if(MP3Decoder) {
       delete MP3Decoder;
       MP3Decoder = NULL;
@@ -231,6 +255,13 @@ void MP3AudioReader::setPosition(const card64 position)
       else
          Position = position;
 
+      // The decoder must not be used by the pool while repositioning
+      MP3DecoderPool* pool = Pool;
+      if(pool != NULL) {
+         pool->removeReader(this);
+         resetQueue();
+      }
+
       const cardinal frame =
          (cardinal)(floor(((double)(Position / (PositionStepsPerSecond / 1000)) * FramesPerSecond) / 1000.0));
       MP3Decoder->setframe(frame);
@@ -238,6 +269,10 @@ void MP3AudioReader::setPosition(const card64 position)
       // NOTE: It seems to be necessary to re-initialize the decoder after
       //       changing the position!
       MP3Decoder->run(-1);
+
+      if(pool != NULL) {
+         pool->addReader(this);
+      }
    }
 }
 
@@ -248,6 +283,31 @@ bool MP3AudioReader::readNextFrame()
    if(MP3Decoder == NULL)
       return(false);
 
+   // ====== Take frame from decode-ahead queue =============================
+   if(Pool != NULL) {
+      BufferSize = 0;
+      if(Pool->waitForFrame(this) == false) {
+         return(false);
+      }
+      const card64        head  = QueueHead.load(std::memory_order_relaxed);
+      const DecodedFrame* frame = &Queue[head % QueueSlots];
+      if(frame->SamplingRate != getSamplingRate()) {
+         setSamplingRate(frame->SamplingRate);
+      }
+      if(frame->Bits != getBits()) {
+         setBits(frame->Bits);
+      }
+      if(frame->Channels != getChannels()) {
+         setChannels(frame->Channels);
+      }
+      memcpy((void*)&Buffer,(const void*)&frame->Data,frame->Size);
+      BufferPos  = 0;
+      BufferSize = frame->Size;
+      QueueHead.store(head + 1,std::memory_order_release);
+      Pool->frameTaken();
+      return(BufferSize > 0);
+   }
+
    // Try to read frame
    BufferSize = 0;
    MP3Decoder->run(1);
@@ -264,6 +324,65 @@ bool MP3AudioReader::readNextFrame()
 }
 
 
+// ###### Attach to default decoder pool ####################################
+void MP3AudioReader::attachPool()
+{
+   QueueSlots = std::max(DefaultPool->getFramesAhead(),(cardinal)1);
+   Queue      = new DecodedFrame[QueueSlots];
+   if(Queue == NULL) {
+      QueueSlots = 0;
+      return;
+   }
+   resetQueue();
+   Pool = DefaultPool;
+   Pool->addReader(this);
+}
+
+
+// ###### Detach from decoder pool ##########################################
+void MP3AudioReader::detachPool()
+{
+   if(Pool != NULL) {
+      Pool->removeReader(this);
+      Pool = NULL;
+      delete [] Queue;
+      Queue      = NULL;
+      QueueSlots = 0;
+   }
+}
+
+
+// ###### Decode next frame into decode-ahead queue #########################
+// Called by MP3DecoderPool, which ensures that only one thread at a time
+// decodes for this reader.
+bool MP3AudioReader::decodeAhead()
+{
+   const card64 tail = QueueTail.load(std::memory_order_relaxed);
+   if((QueueEnd.load(std::memory_order_relaxed)) ||
+      (tail - QueueHead.load(std::memory_order_acquire) >= QueueSlots)) {
+      return(false);
+   }
+
+   DecodedFrame* frame = &Queue[tail % QueueSlots];
+   frame->Size = 0;
+   QueueInput  = frame;
+   MP3Decoder->run(1);
+   QueueInput  = NULL;
+
+   int error = MP3Decoder->geterrorcode();
+   if((error < -1) || (error > 0)) {
+      std::cerr << "WARNING: Mpegtoraw errorcode #" << error << std::endl;
+      frame->Size = 0;
+   }
+   if(frame->Size == 0) {
+      QueueEnd.store(true,std::memory_order_release);
+      return(false);
+   }
+   QueueTail.store(tail + 1,std::memory_order_release);
+   return(true);
+}
+
+
 // ###### Read block from file ##############################################
 cardinal MP3AudioReader::getNextBlock(void* buffer, const cardinal blockSize)
 {
@@ -321,9 +440,17 @@ bool MP3AudioReader::initialize(char* filename)
 // ###### Soundplayer: setsoundtype #########################################
 bool MP3AudioReader::setsoundtype(int stereo, int samplesize, int speed)
 {
-   setSamplingRate(speed);
-   setBits(samplesize);
-   setChannels((stereo) ? 2 : 1);
+   DecodedSamplingRate = speed;
+   DecodedBits         = samplesize;
+   DecodedChannels     = (stereo) ? 2 : 1;
+
+   // A frame decoded ahead gets its quality applied when it is taken
+   // from the queue.
+   if(QueueInput == NULL) {
+      setSamplingRate(DecodedSamplingRate);
+      setBits(DecodedBits);
+      setChannels(DecodedChannels);
+   }
    return(true);
 }
 
@@ -338,10 +465,7 @@ void MP3AudioReader::set8bitmode()
 // ###### Soundplayer: putblock - copy block into buffer ####################
 bool MP3AudioReader::putblock(void* buffer, int size)
 {
-
-   memcpy((void*)&Buffer,buffer,size);
-   BufferPos  = 0;
-   BufferSize = size;
+   putblock_nt(buffer,size);
    return(true);
 }
 
@@ -349,6 +473,14 @@ bool MP3AudioReader::putblock(void* buffer, int size)
 // ###### Soundplayer: putblock_nt - copy block into buffer #################
 int MP3AudioReader::putblock_nt(void* buffer, int size)
 {
+   if(QueueInput != NULL) {
+      memcpy((void*)&QueueInput->Data,buffer,size);
+      QueueInput->Size         = size;
+      QueueInput->SamplingRate = DecodedSamplingRate;
+      QueueInput->Bits         = DecodedBits;
+      QueueInput->Channels     = DecodedChannels;
+      return(size);
+   }
    memcpy((void*)&Buffer,buffer,size);
    BufferPos  = 0;
    BufferSize = size;
@@ -37,6 +37,7 @@
 #include "tdsystem.h"
 #include "audioreaderinterface.h"
 #include "audioquality.h"
+#include "decodeaheadreader.h"
 
 
 // IMPORTANT: PTHREADEDMPEG *must* be defined, if libmpegsound.a is
@@ -47,6 +48,7 @@
 #include "mpegsound.h"
 
 
+
 /**
   * This class is a reader for MP3 audio files.
   *
@@ -56,7 +58,8 @@
   */
 class MP3AudioReader : public AudioReaderInterface,
                        public AudioQuality,
-                       public Soundplayer
+                       public Soundplayer,
+                       public DecodeAheadReader
 {
    // ====== Constructor/Destructor =========================================
    public:
@@ -150,12 +153,27 @@ class MP3AudioReader : public AudioReaderInterface,
    bool attachdevice();
 
 
+   // ====== Decode-ahead queue (used by MP3DecoderPool) ====================
+   private:
+   struct DecodedFrame {
+      cardinal Size;
+      card16   SamplingRate;
+      card8    Bits;
+      card8    Channels;
+      char     Data[RAWDATASIZE * sizeof(short int)];
+   };
+
+   void attachPool();
+   void detachPool();
+   bool decodeAhead();
+
+
    // ====== Private data ===================================================
    private:
    bool readNextFrame();
 
    Mpegtoraw*                MP3Decoder;
-   Soundinputstreamfromfile* MP3Source;
+   Soundinputstream*         MP3Source;
 
    cardinal                  BufferPos;
    cardinal                  BufferSize;
@@ -166,6 +184,13 @@ class MP3AudioReader : public AudioReaderInterface,
    MediaError                Error;
 
    char                      Buffer[RAWDATASIZE * sizeof(short int)];
+
+   card16                    DecodedSamplingRate;
+   card8                     DecodedBits;
+   card8                     DecodedChannels;
+
+   DecodedFrame*             Queue;
+   DecodedFrame*             QueueInput;
 };
 
 
@@ -0,0 +1,226 @@
+// ##########################################################################
+// ####                                                                  ####
+// ####                      RTP Audio Server Project                    ####
+// ####                    ============================                  ####
+// ####                                                                  ####
+// #### MP3 Decoder Pool Implementation                                  ####
+// ####                                                                  ####
+// ####           Copyright (C) 1999-2026 by Thomas Dreibholz            ####
+// ####                                                                  ####
+// #### Contact:                                                         ####
+// ####    EMail: thomas.dreibholz@gmail.com                             ####
+// ####    WWW:   https://www.nntb.no/~dreibh/rtpaudio                   ####
+// ####                                                                  ####
+// #### ---------------------------------------------------------------- ####
+// ####                                                                  ####
+// #### This program is free software: you can redistribute it and/or    ####
+// #### modify it under the terms of the GNU General Public License as   ####
+// #### published by the Free Software Foundation, either version 3 of   ####
+// #### the License, or (at your option) any later version.              ####
+// ####                                                                  ####
+// #### This program is distributed in the hope that it will be useful,  ####
+// #### but WITHOUT ANY WARRANTY; without even the implied warranty of   ####
+// #### MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    ####
+// #### GNU General Public License for more details.                     ####
+// ####                                                                  ####
+// #### You should have received a copy of the GNU General Public        ####
+// #### License along with this program.  If not, see                    ####
+// #### <http://www.gnu.org/licenses/>.                                  ####
+// ####                                                                  ####
+// ##########################################################################
+
+
+#include "tdsystem.h"
+#include "mp3decoderpool.h"
+#include "decodeaheadreader.h"
+
+
+#include <algorithm>
+
+
+
+// ###### Constructor #######################################################
+MP3DecoderPool::MP3DecoderPool(const cardinal workers,
+                               const cardinal framesAhead)
+   : Synchronizable("MP3DecoderPool"),
+     WorkAvailable("MP3DecoderPool::WorkAvailable")
+{
+   FramesAhead = std::max(framesAhead,(cardinal)1);
+   Running     = true;
+   for(cardinal i = 0;i < std::max(workers,(cardinal)1);i++) {
+      Worker* worker = new Worker(this);
+      if(worker == NULL) {
+         break;
+      }
+      if(worker->start() == false) {
+         delete worker;
+         break;
+      }
+      Workers.push_back(worker);
+   }
+   if(Workers.size() == 0) {
+      Running = false;
+   }
+}
+
+
+// ###### Destructor ########################################################
+MP3DecoderPool::~MP3DecoderPool()
+{
+   synchronized();
+   Running = false;
+   unsynchronized();
+   WorkAvailable.broadcast();
+
+   for(std::vector<Worker*>::iterator iterator = Workers.begin();
+       iterator != Workers.end();iterator++) {
+      (*iterator)->join();
+      delete *iterator;
+   }
+   Workers.clear();
+   if(Readers.size() > 0) {
+      std::cerr << "WARNING: MP3DecoderPool::~MP3DecoderPool() - "
+                << Readers.size() << " readers still attached!" << std::endl;
+   }
+}
+
+
+// ###### Attach reader #####################################################
+void MP3DecoderPool::addReader(DecodeAheadReader* reader)
+{
+   synchronized();
+   Readers.push_back(reader);
+   unsynchronized();
+   WorkAvailable.broadcast();
+}
+
+
+// ###### Detach reader #####################################################
+void MP3DecoderPool::removeReader(DecodeAheadReader* reader)
+{
+   synchronized();
+   std::vector<DecodeAheadReader*>::iterator found =
+      std::find(Readers.begin(),Readers.end(),reader);
+   if(found != Readers.end()) {
+      Readers.erase(found);
+   }
+
+   // ====== Wait for a worker still decoding for this reader ===============
+   while(reader->QueueDecoding) {
+      unsynchronized();
+      reader->FrameReady.wait();
+      synchronized();
+   }
+   unsynchronized();
+}
+
+
+// ###### Claim reader with emptiest queue for a worker #####################
+DecodeAheadReader* MP3DecoderPool::claimReader()
+{
+   DecodeAheadReader* reader = NULL;
+   cardinal           queued = FramesAhead;
+
+   synchronized();
+   if(Running) {
+      for(std::vector<DecodeAheadReader*>::iterator iterator = Readers.begin();
+          iterator != Readers.end();iterator++) {
+         DecodeAheadReader* candidate = *iterator;
+         if((!candidate->QueueDecoding) &&
+            (!candidate->QueueEnd.load(std::memory_order_relaxed))) {
+            const cardinal candidateQueued = candidate->getFramesQueued();
+            if(candidateQueued < std::min(queued,candidate->QueueSlots)) {
+               reader = candidate;
+               queued = candidateQueued;
+            }
+         }
+      }
+      if(reader != NULL) {
+         reader->QueueDecoding = true;
+      }
+   }
+   unsynchronized();
+
+   return(reader);
+}
+
+
+// ###### Claim given reader ################################################
+bool MP3DecoderPool::claimReader(DecodeAheadReader* reader)
+{
+   synchronized();
+   const bool claimed = !reader->QueueDecoding;
+   reader->QueueDecoding = true;
+   unsynchronized();
+   return(claimed);
+}
+
+
+// ###### Release reader ####################################################
+void MP3DecoderPool::releaseReader(DecodeAheadReader* reader)
+{
+   synchronized();
+   reader->QueueDecoding = false;
+   unsynchronized();
+   reader->FrameReady.signal();
+}
+
+
+// ###### Wait for a decoded frame ##########################################
+bool MP3DecoderPool::waitForFrame(DecodeAheadReader* reader)
+{
+   for(;;) {
+      if(reader->getFramesQueued() > 0) {
+         return(true);
+      }
+      if(reader->QueueEnd.load(std::memory_order_acquire)) {
+         return(false);
+      }
+
+      // ====== Queue underrun: decode here or wait for the worker ==========
+      if(claimReader(reader)) {
+         reader->decodeAhead();
+         releaseReader(reader);
+      }
+      else {
+         reader->FrameReady.wait();
+      }
+   }
+}
+
+
+// ###### Worker loop #######################################################
+void MP3DecoderPool::work()
+{
+   for(;;) {
+      DecodeAheadReader* reader = claimReader();
+      if(reader != NULL) {
+         reader->decodeAhead();
+         releaseReader(reader);
+      }
+      else {
+         synchronized();
+         const bool running = Running;
+         unsynchronized();
+         if(!running) {
+            break;
+         }
+         WorkAvailable.timedWait(100000);
+      }
+   }
+}
+
+
+// ###### Worker constructor ################################################
+MP3DecoderPool::Worker::Worker(MP3DecoderPool* pool)
+   : Thread("MP3DecoderPool::Worker")
+{
+   Pool = pool;
+}
+
+
+// ###### Worker thread #####################################################
+void MP3DecoderPool::Worker::run()
+{
+   Pool->work();
+}
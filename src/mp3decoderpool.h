@@ -0,0 +1,167 @@
+// ##########################################################################
+// ####                                                                  ####
+// ####                      RTP Audio Server Project                    ####
+// ####                    ============================                  ####
+// ####                                                                  ####
+// #### MP3 Decoder Pool                                                 ####
+// ####                                                                  ####
+// ####           Copyright (C) 1999-2026 by Thomas Dreibholz            ####
+// ####                                                                  ####
+// #### Contact:                                                         ####
+// ####    EMail: thomas.dreibholz@gmail.com                             ####
+// ####    WWW:   https://www.nntb.no/~dreibh/rtpaudio                   ####
+// ####                                                                  ####
+// #### ---------------------------------------------------------------- ####
+// ####                                                                  ####
+// #### This program is free software: you can redistribute it and/or    ####
+// #### modify it under the terms of the GNU General Public License as   ####
+// #### published by the Free Software Foundation, either version 3 of   ####
+// #### the License, or (at your option) any later version.              ####
+// ####                                                                  ####
+// #### This program is distributed in the hope that it will be useful,  ####
+// #### but WITHOUT ANY WARRANTY; without even the implied warranty of   ####
+// #### MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    ####
+// #### GNU General Public License for more details.                     ####
+// ####                                                                  ####
+// #### You should have received a copy of the GNU General Public        ####
+// #### License along with this program.  If not, see                    ####
+// #### <http://www.gnu.org/licenses/>.                                  ####
+// ####                                                                  ####
+// ##########################################################################
+
+
+#ifndef MP3DECODERPOOL_H
+#define MP3DECODERPOOL_H
+
+
+#include "tdsystem.h"
+#include "thread.h"
+#include "condition.h"
+
+
+#include <vector>
+
+
+class DecodeAheadReader;
+
+
+/**
+  * This class is a pool of decoder threads for MP3AudioReader and
+  * OggAudioReader objects. Each reader attached to the pool keeps a queue
+  * of decoded frames, which the workers try to keep filled. The reader's
+  * getNextBlock() only takes frames from this queue, so decoding is moved
+  * out of the sender's timer and may use otherwise idle processors.
+  *
+  * @short   MP3 Decoder Pool
+  * @author  Thomas Dreibholz (thomas.dreibholz@gmail.com)
+  * @version 1.0
+  *
+  * @see DecodeAheadReader#setDecoderPool
+  */
+class MP3DecoderPool : public Synchronizable
+{
+   // ====== Constructor/Destructor =========================================
+   public:
+   /**
+     * Constructor.
+     *
+     * @param workers Number of decoder threads.
+     * @param framesAhead Number of frames to decode ahead for each reader.
+     */
+   MP3DecoderPool(const cardinal workers     = 2,
+                  const cardinal framesAhead = 8);
+
+   /**
+     * Destructor. All readers have to be detached before.
+     */
+   ~MP3DecoderPool();
+
+
+   // ====== Status functions ===============================================
+   /**
+     * Check, if the pool's threads are running.
+     *
+     * @return true, if pool is ready; false otherwise.
+     */
+   inline bool ready() const;
+
+   /**
+     * Get number of frames to decode ahead for each reader.
+     *
+     * @return Number of frames.
+     */
+   inline cardinal getFramesAhead() const;
+
+   /**
+     * Get number of decoder threads.
+     *
+     * @return Number of threads.
+     */
+   inline cardinal getWorkers() const;
+
+
+   // ====== Reader management (called by DecodeAheadReader subclasses) =====
+   /**
+     * Attach reader to the pool.
+     *
+     * @param reader DecodeAheadReader.
+     */
+   void addReader(DecodeAheadReader* reader);
+
+   /**
+     * Detach reader from the pool. When this method returns, no worker
+     * accesses the reader's decoder anymore.
+     *
+     * @param reader DecodeAheadReader.
+     */
+   void removeReader(DecodeAheadReader* reader);
+
+   /**
+     * Wait until the given reader has a decoded frame or has reached its
+     * end. If no worker is decoding for the reader, the frame is decoded
+     * by the calling thread.
+     *
+     * @param reader DecodeAheadReader.
+     * @return true, if a frame is available; false otherwise.
+     */
+   bool waitForFrame(DecodeAheadReader* reader);
+
+   /**
+     * Notify the workers that a reader has taken a frame from its queue.
+     */
+   inline void frameTaken();
+
+
+   // ====== Private data ===================================================
+   private:
+   class Worker : public Thread
+   {
+      public:
+      Worker(MP3DecoderPool* pool);
+
+      protected:
+      void run();
+
+      private:
+      MP3DecoderPool* Pool;
+   };
+   friend class Worker;
+
+   DecodeAheadReader* claimReader();
+   bool claimReader(DecodeAheadReader* reader);
+   void releaseReader(DecodeAheadReader* reader);
+   void work();
+
+
+   std::vector<Worker*>            Workers;
+   std::vector<DecodeAheadReader*> Readers;
+   Condition                       WorkAvailable;
+   cardinal                        FramesAhead;
+   bool                            Running;
+};
+
+
+#include "mp3decoderpool.icc"
+
+
+#endif
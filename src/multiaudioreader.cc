@@ -34,17 +34,28 @@
 #include "multiaudioreader.h"
 #include "wavaudioreader.h"
 #include "mp3audioreader.h"
+#ifdef HAVE_VORBISFILE
+#include "oggaudioreader.h"
+#endif
+#include "renditioncache.h"
+#include "renditionreader.h"
+
+
+
+RenditionCache* MultiAudioReader::Cache = NULL;
 
 
 // ###### Constructor #######################################################
 MultiAudioReader::MultiAudioReader(const char* name, const cardinal level)
    : AudioQuality(0,0,0)
 {
-   Error       = ME_NoMedia;
-   MaxPosition = 0;
-   Position    = 0;
-   Reader      = NULL;
-   Level       = level;
+   Error        = ME_NoMedia;
+   MaxPosition  = 0;
+   Position     = 0;
+   Reader       = NULL;
+   NextReader   = NULL;
+   NextPrepared = false;
+   Level        = level;
    if(name != NULL) openMedia(name);
 }
 
@@ -65,13 +76,18 @@ void MultiAudioReader::closeMedia()
       AudioReaderInterface* reader = ReaderIterator->second.Reader;
       reader->closeMedia();
       delete reader;
+      if(ReaderIterator->second.Renditions != NULL) {
+         delete ReaderIterator->second.Renditions;
+      }
       ReaderSet.erase(ReaderIterator);
    }
 
-   Reader      = NULL;
-   Error       = ME_NoMedia;
-   Position    = 0;
-   MaxPosition = 0;
+   Reader       = NULL;
+   NextReader   = NULL;
+   NextPrepared = false;
+   Error        = ME_NoMedia;
+   Position     = 0;
+   MaxPosition  = 0;
 }
 
 
@@ -155,10 +171,12 @@ bool MultiAudioReader::openMedia(const char* name)
                   }
                }
                name = name + input;
-               AudioReaderInterface* reader = getAudioReader(name.getData(),Level);
+               RenditionReader*      renditions;
+               AudioReaderInterface* reader = getAudioReader(name.getData(),Level,&renditions);
                if(reader != NULL) {
                   ReaderEntry readerEntry;
                   readerEntry.Reader            = reader;
+                  readerEntry.Renditions        = renditions;
                   readerEntry.OverwriteSettings = overwriteSettings;
                   if(overwriteSettings) {
                      readerEntry.Title   = title;
@@ -188,9 +206,8 @@ bool MultiAudioReader::openMedia(const char* name)
 
    // ###### Initialize AudioReader #########################################
    if(ReaderSet.size() > 0) {
-      std::multimap<const card64, ReaderEntry>::iterator firstReader =
-         ReaderSet.begin();
-      Reader = firstReader->second.Reader;
+      ReaderIterator = ReaderSet.begin();
+      Reader         = ReaderIterator->second.Reader;
 
       setQuality(*Reader);
 
@@ -219,10 +236,11 @@ card64 MultiAudioReader::getMaxPosition() const
 void MultiAudioReader::getMediaInfo(MediaInfo& mediaInfo) const
 {
    if(Reader != NULL) {
+      const AudioReaderInterface* reader = ReaderIterator->second.Reader;
       mediaInfo.StartTimeStamp = ReaderIterator->first;
-      mediaInfo.EndTimeStamp   = mediaInfo.StartTimeStamp + Reader->getMaxPosition();
+      mediaInfo.EndTimeStamp   = mediaInfo.StartTimeStamp + reader->getMaxPosition();
       if(!ReaderIterator->second.OverwriteSettings) {
-         Reader->getMediaInfo(mediaInfo);
+         reader->getMediaInfo(mediaInfo);
       }
       else {
          strcpy((char*)&mediaInfo.Title,ReaderIterator->second.Title.getData());
@@ -256,17 +274,17 @@ card64 MultiAudioReader::getPosition() const
 void MultiAudioReader::setPosition(const card64 position)
 {
    if((Reader != NULL) && (Error < ME_UnrecoverableError)) {
+      const bool useRenditions = (Reader == ReaderIterator->second.Renditions);
       Position = MaxPosition;
 
       ReaderIterator = ReaderSet.begin();
       bool ok = false;
       while(ReaderIterator != ReaderSet.end()) {
          Position = ReaderIterator->first;
-         Reader   = ReaderIterator->second.Reader;
+         AudioReaderInterface* reader = ReaderIterator->second.Reader;
 
          // Search for AudioReader containing the given position
-         if((position >= Position) && (position < Position + Reader->getMaxPosition())) {
-            Reader->setPosition(position - Position);
+         if((position >= Position) && (position < Position + reader->getMaxPosition())) {
             ok = true;
             break;
          }
@@ -276,11 +294,17 @@ void MultiAudioReader::setPosition(const card64 position)
          ReaderIterator = ReaderSet.end();
          ReaderIterator--;
          Position = ReaderIterator->first;
-         Reader   = ReaderIterator->second.Reader;
-         Reader->setPosition(Reader->getMaxPosition());
       }
 
-      setQuality(*Reader);
+      // Seeking in renditions is cheaper than in an MP3 file
+      ReaderEntry& entry = ReaderIterator->second;
+      Reader = ((useRenditions) && (entry.Renditions != NULL)) ? entry.Renditions : entry.Reader;
+      Reader->setPosition(std::min(position - std::min(position,Position),
+                                   entry.Reader->getMaxPosition()));
+
+      setQuality(*entry.Reader);
+      NextReader   = NULL;
+      NextPrepared = false;
    }
 }
 
@@ -289,20 +313,39 @@ void MultiAudioReader::setPosition(const card64 position)
 cardinal MultiAudioReader::getNextBlock(void* buffer, const cardinal blockSize)
 {
    if((Reader != NULL) && (Error < ME_UnrecoverableError)) {
+      prepareNextReader();
       cardinal result = Reader->getNextBlock(buffer,blockSize);
 
       // ====== Move to next AudioReader ====================================
       if(result < blockSize) {
+         const bool         useRenditions = (Reader == ReaderIterator->second.Renditions);
+         const AudioQuality quality(*Reader);
          ReaderIterator++;
          if(ReaderIterator != ReaderSet.end()) {
-            Position = ReaderIterator->first;
-            Reader   = ReaderIterator->second.Reader;
-
-            // Start playing from position 0 of the new AudioReader
-            Reader->setPosition(0);
-            setQuality(*Reader);
+            ReaderEntry&                entry    = ReaderIterator->second;
+            AudioReaderInterface* const prepared = NextReader;
+            Position     = ReaderIterator->first;
+            Reader       = getEntryReader(entry,quality,useRenditions);
+            NextReader   = NULL;
+            NextPrepared = false;
+
+            // Start playing from position 0 of the new AudioReader. A
+            // prepared reader is already there, with its decoder primed.
+            if((Reader != prepared) &&
+               ((Reader->getPosition() != 0) || (Reader->getErrorCode() != ME_NoError))) {
+               Reader->setPosition(0);
+            }
+            setQuality(*entry.Reader);
 
-            result = Reader->getNextBlock(buffer,blockSize);
+            // In the same quality, the block continues with the new file's
+            // first samples. Otherwise, it starts over in the new quality.
+            if(AudioQuality(*Reader) == quality) {
+               result += Reader->getNextBlock((void*)&((card8*)buffer)[result],
+                                              blockSize - result);
+            }
+            else {
+               result = Reader->getNextBlock(buffer,blockSize);
+            }
          }
          else {
             // Restore old (=last) AudioReader
@@ -317,21 +360,136 @@ cardinal MultiAudioReader::getNextBlock(void* buffer, const cardinal blockSize)
 }
 
 
+// ###### Get view of next block ############################################
+const void* MultiAudioReader::getNextBlockView(const cardinal blockSize)
+{
+   if((Reader != NULL) && (Error < ME_UnrecoverableError)) {
+      prepareNextReader();
+      const void* data = Reader->getNextBlockView(blockSize);
+      if(data != NULL) {
+         Error = Reader->getErrorCode();
+      }
+      return(data);
+   }
+   return(NULL);
+}
+
+
+// ###### Select quality of the following blocks ############################
+AudioQuality MultiAudioReader::selectQuality(const AudioQualityInterface& quality)
+{
+   if(Reader != NULL) {
+      ReaderEntry& entry = ReaderIterator->second;
+      if((entry.Renditions != NULL) && (entry.Renditions->hasQuality(quality))) {
+         useReader(entry.Renditions);
+      }
+      else {
+         useReader(entry.Reader);
+      }
+      return(Reader->selectQuality(quality));
+   }
+   return(AudioReaderInterface::selectQuality(quality));
+}
+
+
+// ###### Get AudioReader to continue with for a ReaderSet entry ############
+AudioReaderInterface* MultiAudioReader::getEntryReader(ReaderEntry&        entry,
+                                                       const AudioQuality& quality,
+                                                       const bool          useRenditions)
+{
+   // Continue in the same quality, if the file has it
+   if((useRenditions) && (entry.Renditions != NULL) &&
+      (entry.Renditions->hasQuality(quality))) {
+      entry.Renditions->selectQuality(quality);
+      return(entry.Renditions);
+   }
+   return(entry.Reader);
+}
+
+
+// ###### Prepare next AudioReader for the transition #######################
+// This is done once, in the last seconds of the current file.
+void MultiAudioReader::prepareNextReader()
+{
+   if((NextPrepared) ||
+      (Reader->getPosition() + PrepareTime < ReaderIterator->second.Reader->getMaxPosition())) {
+      return;
+   }
+   NextPrepared = true;
+   std::multimap<const card64, ReaderEntry>::iterator next = ReaderIterator;
+   next++;
+   if(next != ReaderSet.end()) {
+      // Positioning starts decode-ahead by the MP3DecoderPool resp.
+      // read-ahead of the file, both working in the background. A reader
+      // not used yet is already at its beginning, with its decoder fresh.
+      NextReader = getEntryReader(next->second,AudioQuality(*Reader),
+                                  (Reader == ReaderIterator->second.Renditions));
+      if((NextReader->getPosition() != 0) || (NextReader->getErrorCode() != ME_NoError)) {
+         NextReader->setPosition(0);
+      }
+   }
+}
+
+
+// ###### Switch between file and its renditions ############################
+void MultiAudioReader::useReader(AudioReaderInterface* reader)
+{
+   if(reader != Reader) {
+      reader->setPosition(Reader->getPosition());
+      Reader = reader;
+   }
+}
+
+
+// ###### Set rendition cache ###############################################
+void MultiAudioReader::setRenditionCache(RenditionCache* cache)
+{
+   Cache = cache;
+}
+
+
 // ###### Get AudioReader for given file ####################################
-AudioReaderInterface* MultiAudioReader::getAudioReader(const char*    name,
-                                                       const cardinal level)
+AudioReaderInterface* MultiAudioReader::getAudioReader(const char*       name,
+                                                       const cardinal    level,
+                                                       RenditionReader** renditions)
 {
+   if(renditions != NULL) {
+      *renditions = NULL;
+   }
+
    // ====== Try to load file with WAV reader ===============================
    WavAudioReader* wavreader = new WavAudioReader(name);
    if(wavreader->ready()) {
+      if((renditions != NULL) && (Cache != NULL)) {
+         *renditions = Cache->openRenditions(name);
+      }
       return(wavreader);
    }
    delete wavreader;
 
 
+#ifdef HAVE_VORBISFILE
+   // ====== Try to load file with Ogg reader ===============================
+   // This has to be done before trying MP3: the Ogg reader only accepts
+   // files starting with an Ogg page, while the MP3 reader searches for
+   // frame headers anywhere in the file.
+   OggAudioReader* oggreader = new OggAudioReader(name);
+   if(oggreader->ready()) {
+      if((renditions != NULL) && (Cache != NULL)) {
+         *renditions = Cache->openRenditions(name);
+      }
+      return(oggreader);
+   }
+   delete oggreader;
+#endif
+
+
    // ====== Try to load file with MP3 reader ===============================
    MP3AudioReader* mp3reader = new MP3AudioReader(name);
    if(mp3reader->ready()) {
+      if((renditions != NULL) && (Cache != NULL)) {
+         *renditions = Cache->openRenditions(name);
+      }
       return(mp3reader);
    }
    delete mp3reader;
@@ -42,6 +42,10 @@
 #include <map>
 
 
+class RenditionCache;
+class RenditionReader;
+
+
 /**
   * This class is a reader for multiple audio files from a list.
   *
@@ -133,6 +137,24 @@ class MultiAudioReader : virtual public AudioReaderInterface,
      */
    cardinal getNextBlock(void* buffer, const cardinal blockSize);
 
+   /**
+     * getNextBlockView() implementation of AudioReaderInterface.
+     * The current file's reader provides the view, moving on to the next
+     * file is left to getNextBlock().
+     *
+     * @see AudioReaderInterface#getNextBlockView
+     */
+   const void* getNextBlockView(const cardinal blockSize);
+
+   /**
+     * selectQuality() implementation of AudioReaderInterface. If the current
+     * file has a rendition of at least the requested quality, the blocks
+     * are read from the rendition instead of the file itself.
+     *
+     * @see AudioReaderInterface#selectQuality
+     */
+   AudioQuality selectQuality(const AudioQualityInterface& quality);
+
 
    // ====== Static functions ===============================================
    /**
@@ -140,15 +162,35 @@ class MultiAudioReader : virtual public AudioReaderInterface,
      *
      * @param name File name.
      * @param level Recursion level (normally 0).
+     * @param renditions Reference to store RenditionReader for the file's renditions (NULL if there are none) or NULL.
      * @return AudioReaderInterface, if load was successfull; NULL otherwise.
      */
-   AudioReaderInterface* getAudioReader(const char* name, const cardinal level);
+   AudioReaderInterface* getAudioReader(const char*       name,
+                                        const cardinal    level,
+                                        RenditionReader** renditions = NULL);
+
+   /**
+     * Set rendition cache for all MultiAudioReader objects opened from now.
+     *
+     * @param cache RenditionCache or NULL to read all files themselves.
+     */
+   static void setRenditionCache(RenditionCache* cache);
+
+
+   // ====== Constants ======================================================
+   /**
+     * Time before the end of a file at which the next file is positioned
+     * to its beginning, so that its decoder or read-ahead is primed in the
+     * background before the transition.
+     */
+   static const card64 PrepareTime = 2 * PositionStepsPerSecond;
 
 
    // ====== Private data ===================================================
    private:
    struct ReaderEntry {
       AudioReaderInterface* Reader;
+      RenditionReader*      Renditions;
       bool                  OverwriteSettings;
       String                Title;
       String                Artist;
@@ -157,13 +199,24 @@ class MultiAudioReader : virtual public AudioReaderInterface,
 
 
    AudioReaderInterface*                              Reader;
+   AudioReaderInterface*                              NextReader;
+   bool                                               NextPrepared;
    std::multimap<const card64, ReaderEntry>           ReaderSet;
    std::multimap<const card64, ReaderEntry>::iterator ReaderIterator;
 
+   void useReader(AudioReaderInterface* reader);
+   AudioReaderInterface* getEntryReader(ReaderEntry&        entry,
+                                        const AudioQuality& quality,
+                                        const bool          useRenditions);
+   void prepareNextReader();
+
+
    MediaError Error;
    card64     Position;
    card64     MaxPosition;
    cardinal   Level;
+
+   static RenditionCache* Cache;
 };
 
 
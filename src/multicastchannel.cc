@@ -0,0 +1,143 @@
+// ##########################################################################
+// ####                                                                  ####
+// ####                      RTP Audio Server Project                    ####
+// ####                    ============================                  ####
+// ####                                                                  ####
+// #### Multicast Channel Implementation                                 ####
+// ####                                                                  ####
+// ####           Copyright (C) 1999-2026 by Thomas Dreibholz            ####
+// ####                                                                  ####
+// #### Contact:                                                         ####
+// ####    EMail: thomas.dreibholz@gmail.com                             ####
+// ####    WWW:   https://www.nntb.no/~dreibh/rtpaudio                   ####
+// ####                                                                  ####
+// #### ---------------------------------------------------------------- ####
+// ####                                                                  ####
+// #### This program is free software: you can redistribute it and/or    ####
+// #### modify it under the terms of the GNU General Public License as   ####
+// #### published by the Free Software Foundation, either version 3 of   ####
+// #### the License, or (at your option) any later version.              ####
+// ####                                                                  ####
+// #### This program is distributed in the hope that it will be useful,  ####
+// #### but WITHOUT ANY WARRANTY; without even the implied warranty of   ####
+// #### MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    ####
+// #### GNU General Public License for more details.                     ####
+// ####                                                                  ####
+// #### You should have received a copy of the GNU General Public        ####
+// #### License along with this program.  If not, see                    ####
+// #### <http://www.gnu.org/licenses/>.                                  ####
+// ####                                                                  ####
+// ##########################################################################
+
+
+#include "tdsystem.h"
+#include "multicastchannel.h"
+#include "advancedaudioencoder.h"
+#include "advancedaudiopacket.h"
+#include "randomizer.h"
+
+
+
+// ###### Constructor #######################################################
+MulticastChannel::MulticastChannel(const InternetAddress& group,
+                                   const char*            mediaName,
+                                   const char*            interface,
+                                   const card8            ttl,
+                                   const cardinal         maxPacketSize)
+   : TimedThread(1000000,"MulticastChannel")
+{
+   Group     = group;
+   MediaName = String(mediaName);
+   Ready     = false;
+
+   // ====== Create sender socket ===========================================
+   SenderSocket.create(Group.isIPv4() ? Socket::IPv4 : Socket::IPv6,
+                       Socket::Datagram);
+   if(!SenderSocket.ready()) {
+      std::cerr << "WARNING: MulticastChannel::MulticastChannel() - Unable to create socket!" << std::endl;
+      return;
+   }
+   SenderSocket.setBlockingMode(false);
+   SenderSocket.setMulticastTTL(ttl);
+   SenderSocket.setMulticastLoop(true);
+   if((interface != NULL) && (SenderSocket.setMulticastInterface(interface) == false)) {
+      std::cerr << "WARNING: MulticastChannel::MulticastChannel() - Unable to use interface "
+                << interface << "!" << std::endl;
+      return;
+   }
+
+   // ====== Create encoder and open media ==================================
+   Repository.setAutoDelete(true);
+   if(Repository.addEncoder(new AdvancedAudioEncoder(&Reader)) == false) {
+      std::cerr << "WARNING: MulticastChannel::MulticastChannel() - Out of memory!" << std::endl;
+      return;
+   }
+   Repository.selectEncoderForTypeID(AdvancedAudioPacket::AdvancedAudioTypeID);
+   Repository.setSamplingRate(AudioQuality::HighestSamplingRate);
+   Repository.setBits(AudioQuality::HighestBits);
+   Repository.setChannels(AudioQuality::HighestChannels);
+   if(Reader.openMedia(mediaName) == false) {
+      std::cerr << "WARNING: MulticastChannel::MulticastChannel() - Unable to open media "
+                << mediaName << "!" << std::endl;
+      return;
+   }
+
+   // ====== Initialize RTPSender with one group per layer ==================
+   Randomizer random;
+   InternetFlow flow(Group,0,0);
+   flow.setTrafficClass(AudioServerDefaultTrafficClass);
+   Sender.init(flow,random.random32(),
+               &Repository,&SenderSocket,
+               RTPAudioControlPPID,RTPAudioDataPPID,
+               maxPacketSize);
+   for(cardinal i = 0;i < AdvancedAudioPacket::AdvancedAudioMaxQualityLayers;i++) {
+      InternetFlow layerFlow(getLayerMulticastAddress(Group,i),0,0);
+      layerFlow.setTrafficClass(AudioServerDefaultTrafficClass);
+      Sender.setLayerFlow(i,layerFlow);
+   }
+
+   // NOTE: getQoSDescription() will set frame rate!
+   Sender.getQoSDescription(0);
+   Ready = true;
+}
+
+
+// ###### Destructor ########################################################
+MulticastChannel::~MulticastChannel()
+{
+   stop();
+}
+
+
+// ###### Start channel #####################################################
+bool MulticastChannel::start(const char* name)
+{
+   if(Ready == false) {
+      return(false);
+   }
+   if(Sender.start() == false) {
+      return(false);
+   }
+   return(TimedThread::start(name));
+}
+
+
+// ###### Stop channel ######################################################
+void* MulticastChannel::stop()
+{
+   void* result = TimedThread::stop();
+   Sender.stop();
+   return(result);
+}
+
+
+// ###### Repeat media at its end ###########################################
+void MulticastChannel::timerEvent()
+{
+   Sender.synchronized();
+   if(Reader.getErrorCode() == ME_EOF) {
+      Reader.setPosition(0);
+      Sender.leaveCorrectionLoop();
+   }
+   Sender.unsynchronized();
+}
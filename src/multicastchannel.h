@@ -0,0 +1,153 @@
+// ##########################################################################
+// ####                                                                  ####
+// ####                      RTP Audio Server Project                    ####
+// ####                    ============================                  ####
+// ####                                                                  ####
+// #### Multicast Channel                                                ####
+// ####                                                                  ####
+// ####           Copyright (C) 1999-2026 by Thomas Dreibholz            ####
+// ####                                                                  ####
+// #### Contact:                                                         ####
+// ####    EMail: thomas.dreibholz@gmail.com                             ####
+// ####    WWW:   https://www.nntb.no/~dreibh/rtpaudio                   ####
+// ####                                                                  ####
+// #### ---------------------------------------------------------------- ####
+// ####                                                                  ####
+// #### This program is free software: you can redistribute it and/or    ####
+// #### modify it under the terms of the GNU General Public License as   ####
+// #### published by the Free Software Foundation, either version 3 of   ####
+// #### the License, or (at your option) any later version.              ####
+// ####                                                                  ####
+// #### This program is distributed in the hope that it will be useful,  ####
+// #### but WITHOUT ANY WARRANTY; without even the implied warranty of   ####
+// #### MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    ####
+// #### GNU General Public License for more details.                     ####
+// ####                                                                  ####
+// #### You should have received a copy of the GNU General Public        ####
+// #### License along with this program.  If not, see                    ####
+// #### <http://www.gnu.org/licenses/>.                                  ####
+// ####                                                                  ####
+// ##########################################################################
+
+
+#ifndef MULTICASTCHANNEL_H
+#define MULTICASTCHANNEL_H
+
+
+#include "tdsystem.h"
+#include "timedthread.h"
+#include "tdsocket.h"
+#include "internetaddress.h"
+#include "multiaudioreader.h"
+#include "audioencoderrepository.h"
+#include "rtpsender.h"
+#include "audioclientapppacket.h"
+
+
+
+/**
+  * This class is a layered multicast channel. It encodes a media with
+  * AdvancedAudioEncoder once and sends each quality layer to its own
+  * multicast group (see getLayerMulticastAddress()). Receivers select
+  * their quality by joining or leaving the layers' groups, so the
+  * server's bandwidth and CPU load do not depend on the number of
+  * receivers. The media is repeated at its end.
+  *
+  * @short   Multicast Channel
+  * @author  Thomas Dreibholz (thomas.dreibholz@gmail.com)
+  * @version 1.0
+  *
+  * @see AudioServer
+  * @see MulticastLayerManager
+  */
+class MulticastChannel : public TimedThread
+{
+   // ====== Constructor/Destructor =========================================
+   public:
+   /**
+     * Constructor. The channel has to be started by calling start()!
+     *
+     * @param group Base group address and port.
+     * @param mediaName Media name, e.g. "AudioFiles/Test1.list".
+     * @param interface Outgoing interface name (NULL for default).
+     * @param ttl Multicast TTL.
+     * @param maxPacketSize Maximum packet size.
+     */
+   MulticastChannel(const InternetAddress& group,
+                    const char*            mediaName,
+                    const char*            interface     = NULL,
+                    const card8            ttl           = AudioServerDefaultMulticastTTL,
+                    const cardinal         maxPacketSize = 1500);
+
+   /**
+     * Destructor.
+     */
+   ~MulticastChannel();
+
+
+   // ====== Status functions ===============================================
+   /**
+     * Check, if the channel's socket and media are ready.
+     *
+     * @return true, if the channel is ready; false otherwise.
+     */
+   inline bool ready() const;
+
+   /**
+     * Get base group address and port.
+     *
+     * @return Group address.
+     */
+   inline const InternetAddress& getGroup() const;
+
+   /**
+     * Get media name.
+     *
+     * @return Media name.
+     */
+   inline const char* getMediaName() const;
+
+   /**
+     * Get number of bytes sent.
+     *
+     * @return Bytes sent.
+     */
+   inline card64 getBytesSent();
+
+
+   // ====== Start/stop =====================================================
+   /**
+     * Start the channel's sender and its media repeat timer.
+     *
+     * @param name Thread name.
+     * @return true for success; false otherwise.
+     */
+   bool start(const char* name = NULL);
+
+   /**
+     * Stop the channel.
+     *
+     * @return Result of the timer thread.
+     */
+   void* stop();
+
+
+   // ====== Private data ===================================================
+   private:
+   void timerEvent();
+
+
+   InternetAddress        Group;
+   String                 MediaName;
+   Socket                 SenderSocket;
+   MultiAudioReader       Reader;
+   AudioEncoderRepository Repository;
+   RTPSender              Sender;
+   bool                   Ready;
+};
+
+
+#include "multicastchannel.icc"
+
+
+#endif
@@ -0,0 +1,213 @@
+// ##########################################################################
+// ####                                                                  ####
+// ####                      RTP Audio Server Project                    ####
+// ####                    ============================                  ####
+// ####                                                                  ####
+// #### Multicast Layer Manager Implementation                           ####
+// ####                                                                  ####
+// ####           Copyright (C) 1999-2026 by Thomas Dreibholz            ####
+// ####                                                                  ####
+// #### Contact:                                                         ####
+// ####    EMail: thomas.dreibholz@gmail.com                             ####
+// ####    WWW:   https://www.nntb.no/~dreibh/rtpaudio                   ####
+// ####                                                                  ####
+// #### ---------------------------------------------------------------- ####
+// ####                                                                  ####
+// #### This program is free software: you can redistribute it and/or    ####
+// #### modify it under the terms of the GNU General Public License as   ####
+// #### published by the Free Software Foundation, either version 3 of   ####
+// #### the License, or (at your option) any later version.              ####
+// ####                                                                  ####
+// #### This program is distributed in the hope that it will be useful,  ####
+// #### but WITHOUT ANY WARRANTY; without even the implied warranty of   ####
+// #### MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    ####
+// #### GNU General Public License for more details.                     ####
+// ####                                                                  ####
+// #### You should have received a copy of the GNU General Public        ####
+// #### License along with this program.  If not, see                    ####
+// #### <http://www.gnu.org/licenses/>.                                  ####
+// ####                                                                  ####
+// ##########################################################################
+
+
+#include "tdsystem.h"
+#include "multicastlayermanager.h"
+#include "audioclientapppacket.h"
+#include "tools.h"
+
+
+
+// ###### Constructor #######################################################
+MulticastLayerManager::MulticastLayerManager(RTPReceiver*           receiver,
+                                             Socket*                receiverSocket,
+                                             const InternetAddress& group,
+                                             const char*            interface)
+   : TimedThread(1000000,"MulticastLayerManager")
+{
+   Receiver       = receiver;
+   ReceiverSocket = receiverSocket;
+   Group          = group;
+   Interface      = String((interface != NULL) ? interface : "");
+   BandwidthLimit = (card64)-1;
+   Layers         = 0;
+   LastUpdate     = 0;
+   for(cardinal i = 0;i < RTPConstants::RTPMaxQualityLayers;i++) {
+      LastBytes[i]   = 0;
+      LastPackets[i] = 0;
+      LastLost[i]    = 0;
+      ByteRate[i]    = 0;
+      JoinDelay[i]   = MinJoinDelay;
+      NextJoin[i]    = 0;
+      JoinTime[i]    = 0;
+   }
+}
+
+
+// ###### Destructor ########################################################
+MulticastLayerManager::~MulticastLayerManager()
+{
+   stop();
+}
+
+
+// ###### Join layer 0 and start thread #####################################
+bool MulticastLayerManager::start(const char* name)
+{
+   synchronized();
+   const card64 now = getMicroTime();
+   LastUpdate = now;
+   for(cardinal i = 1;i < RTPConstants::RTPMaxQualityLayers;i++) {
+      NextJoin[i] = now + JoinDelay[i];
+   }
+   const bool joined = (Layers > 0) || joinLayer(0);
+   unsynchronized();
+   if(joined == false) {
+      return(false);
+   }
+   return(TimedThread::start(name));
+}
+
+
+// ###### Stop thread and leave all layers ##################################
+void* MulticastLayerManager::stop()
+{
+   void* result = TimedThread::stop();
+   synchronized();
+   const char* interface = (Interface.length() > 0) ? Interface.getData() : NULL;
+   while(Layers > 0) {
+      Layers--;
+      ReceiverSocket->dropMulticastMembership(
+         getLayerMulticastAddress(Group,Layers),interface);
+   }
+   unsynchronized();
+   return(result);
+}
+
+
+// ###### Get number of joined layers #######################################
+cardinal MulticastLayerManager::getJoinedLayers()
+{
+   synchronized();
+   const cardinal layers = Layers;
+   unsynchronized();
+   return(layers);
+}
+
+
+// ###### Set bandwidth limit ###############################################
+void MulticastLayerManager::setBandwidthLimit(const card64 bandwidthLimit)
+{
+   synchronized();
+   BandwidthLimit = bandwidthLimit;
+   unsynchronized();
+}
+
+
+// ###### Join layer ########################################################
+bool MulticastLayerManager::joinLayer(const cardinal layer)
+{
+   const InternetAddress address = getLayerMulticastAddress(Group,layer);
+   const char* interface = (Interface.length() > 0) ? Interface.getData() : NULL;
+   if(ReceiverSocket->addMulticastMembership(address,interface) == false) {
+      std::cerr << "WARNING: MulticastLayerManager::joinLayer() - Unable to join group "
+                << address << "!" << std::endl;
+      NextJoin[layer] = getMicroTime() + JoinDelay[layer];
+      return(false);
+   }
+
+   // Sequence numbers continued while the layer was not joined.
+   Receiver->resetSSI(layer);
+   LastBytes[layer]   = Receiver->getBytesReceived(layer);
+   LastPackets[layer] = Receiver->getPacketsReceived(layer);
+   LastLost[layer]    = 0;
+   JoinTime[layer]    = getMicroTime();
+   Layers             = layer + 1;
+   return(true);
+}
+
+
+// ###### Leave layer #######################################################
+void MulticastLayerManager::leaveLayer(const cardinal layer, const card64 now)
+{
+   const char* interface = (Interface.length() > 0) ? Interface.getData() : NULL;
+   ReceiverSocket->dropMulticastMembership(getLayerMulticastAddress(Group,layer),
+                                           interface);
+   JoinDelay[layer] = (2 * JoinDelay[layer] < MaxJoinDelay) ? 2 * JoinDelay[layer] : MaxJoinDelay;
+   NextJoin[layer]  = now + JoinDelay[layer];
+   JoinTime[layer]  = 0;
+   Layers           = layer;
+}
+
+
+// ###### Update layer memberships ##########################################
+void MulticastLayerManager::timerEvent()
+{
+   synchronized();
+
+   // ====== Get loss and byte rates of joined layers =======================
+   const card64 now      = getMicroTime();
+   const card64 interval = (now > LastUpdate) ? (now - LastUpdate) : 1;
+   LastUpdate = now;
+   card64 received  = 0;
+   card64 lost      = 0;
+   card64 totalRate = 0;
+   for(cardinal i = 0;i < Layers;i++) {
+      const card64 bytes      = Receiver->getBytesReceived(i);
+      const card64 packets    = Receiver->getPacketsReceived(i);
+      const card64 layerLost  = Receiver->getSSI(i).getPacketsLost();
+      ByteRate[i] = (bytes - LastBytes[i]) * 1000000 / interval;
+      totalRate  += ByteRate[i];
+      received   += packets - LastPackets[i];
+      // Duplicates decrease the loss count of SeqNumValidator.
+      if(layerLost > LastLost[i]) {
+         lost += layerLost - LastLost[i];
+      }
+      LastBytes[i]   = bytes;
+      LastPackets[i] = packets;
+      LastLost[i]    = layerLost;
+   }
+
+   // ====== Leave highest layer on loss or bandwidth limit =================
+   const bool congestion = (100 * lost > MaxLossPercent * (received + lost));
+   if((Layers > 1) && ((congestion) || (totalRate > BandwidthLimit))) {
+      leaveLayer(Layers - 1,now);
+   }
+
+   // ====== Join next layer ================================================
+   else if((lost == 0) && (Layers > 0)) {
+      const cardinal top = Layers - 1;
+      if((top > 0) && (JoinTime[top] != 0) && (now - JoinTime[top] >= DetectionTime)) {
+         JoinDelay[top] = (JoinDelay[top] / 2 > MinJoinDelay) ? JoinDelay[top] / 2 : MinJoinDelay;
+         JoinTime[top]  = 0;
+      }
+
+      const cardinal available = std::min(Receiver->getLayers(),
+                                          RTPConstants::RTPMaxQualityLayers);
+      if((Layers < available) && (now >= NextJoin[Layers]) &&
+         ((ByteRate[Layers] == 0) || (totalRate + ByteRate[Layers] <= BandwidthLimit))) {
+         joinLayer(Layers);
+      }
+   }
+
+   unsynchronized();
+}
@@ -0,0 +1,168 @@
+// ##########################################################################
+// ####                                                                  ####
+// ####                      RTP Audio Server Project                    ####
+// ####                    ============================                  ####
+// ####                                                                  ####
+// #### Multicast Layer Manager                                          ####
+// ####                                                                  ####
+// ####           Copyright (C) 1999-2026 by Thomas Dreibholz            ####
+// ####                                                                  ####
+// #### Contact:                                                         ####
+// ####    EMail: thomas.dreibholz@gmail.com                             ####
+// ####    WWW:   https://www.nntb.no/~dreibh/rtpaudio                   ####
+// ####                                                                  ####
+// #### ---------------------------------------------------------------- ####
+// ####                                                                  ####
+// #### This program is free software: you can redistribute it and/or    ####
+// #### modify it under the terms of the GNU General Public License as   ####
+// #### published by the Free Software Foundation, either version 3 of   ####
+// #### the License, or (at your option) any later version.              ####
+// ####                                                                  ####
+// #### This program is distributed in the hope that it will be useful,  ####
+// #### but WITHOUT ANY WARRANTY; without even the implied warranty of   ####
+// #### MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    ####
+// #### GNU General Public License for more details.                     ####
+// ####                                                                  ####
+// #### You should have received a copy of the GNU General Public        ####
+// #### License along with this program.  If not, see                    ####
+// #### <http://www.gnu.org/licenses/>.                                  ####
+// ####                                                                  ####
+// ##########################################################################
+
+
+#ifndef MULTICASTLAYERMANAGER_H
+#define MULTICASTLAYERMANAGER_H
+
+
+#include "tdsystem.h"
+#include "timedthread.h"
+#include "tdsocket.h"
+#include "internetaddress.h"
+#include "rtpreceiver.h"
+#include "rtppacket.h"
+
+
+
+/**
+  * This class manages the layer group memberships of a layered multicast
+  * channel receiver (receiver-driven layered multicast). Layer 0 is always
+  * joined. Every second, the loss and byte rate of the joined layers are
+  * checked: on loss above MaxLossPercent or when the bandwidth limit is
+  * exceeded, the highest layer is left and its join timer is doubled.
+  * Without loss, the next layer is joined when its join timer has expired
+  * and its last known byte rate fits into the bandwidth limit. A layer
+  * kept for DetectionTime without loss halves its join timer again.
+  *
+  * @short   Multicast Layer Manager
+  * @author  Thomas Dreibholz (thomas.dreibholz@gmail.com)
+  * @version 1.0
+  *
+  * @see MulticastChannel
+  * @see AudioClient
+  */
+class MulticastLayerManager : public TimedThread
+{
+   // ====== Constructor/Destructor =========================================
+   public:
+   /**
+     * Constructor. The layer groups are joined on the given receiver
+     * socket, which has to be bound to the channel's port.
+     *
+     * @param receiver RTPReceiver reading from the receiver socket.
+     * @param receiverSocket Receiver socket.
+     * @param group Base group address and port of the channel.
+     * @param interface Interface name to join the groups on (NULL for default).
+     */
+   MulticastLayerManager(RTPReceiver*           receiver,
+                         Socket*                receiverSocket,
+                         const InternetAddress& group,
+                         const char*            interface = NULL);
+
+   /**
+     * Destructor.
+     */
+   ~MulticastLayerManager();
+
+
+   // ====== Start/stop =====================================================
+   /**
+     * Join layer 0 and start the manager's thread.
+     *
+     * @param name Thread name.
+     * @return true for success; false otherwise.
+     */
+   bool start(const char* name = NULL);
+
+   /**
+     * Stop the manager's thread and leave all layer groups.
+     *
+     * @return Result of the timer thread.
+     */
+   void* stop();
+
+
+   // ====== Settings =======================================================
+   /**
+     * Get number of joined layers.
+     *
+     * @return Number of joined layers.
+     */
+   cardinal getJoinedLayers();
+
+   /**
+     * Set bandwidth limit.
+     *
+     * @param bandwidthLimit Bandwidth limit in bytes/s ((card64)-1 for none).
+     */
+   void setBandwidthLimit(const card64 bandwidthLimit);
+
+
+   // ====== Constants ======================================================
+   /**
+     * Loss rate in percent above which the highest layer is left.
+     */
+   static const cardinal MaxLossPercent = 5;
+
+   /**
+     * Minimum join timer in microseconds.
+     */
+   static const card64 MinJoinDelay = 2000000;
+
+   /**
+     * Maximum join timer in microseconds.
+     */
+   static const card64 MaxJoinDelay = 120000000;
+
+   /**
+     * Time in microseconds a newly joined layer has to be kept without loss
+     * for its join timer to be decreased.
+     */
+   static const card64 DetectionTime = 3000000;
+
+
+   // ====== Private data ===================================================
+   private:
+   void timerEvent();
+   bool joinLayer(const cardinal layer);
+   void leaveLayer(const cardinal layer, const card64 now);
+
+
+   RTPReceiver*    Receiver;
+   Socket*         ReceiverSocket;
+   InternetAddress Group;
+   String          Interface;
+   card64          BandwidthLimit;
+   cardinal        Layers;
+   card64          LastUpdate;
+
+   card64          LastBytes[RTPConstants::RTPMaxQualityLayers];
+   card64          LastPackets[RTPConstants::RTPMaxQualityLayers];
+   card64          LastLost[RTPConstants::RTPMaxQualityLayers];
+   card64          ByteRate[RTPConstants::RTPMaxQualityLayers];
+   card64          JoinDelay[RTPConstants::RTPMaxQualityLayers];
+   card64          NextJoin[RTPConstants::RTPMaxQualityLayers];
+   card64          JoinTime[RTPConstants::RTPMaxQualityLayers];
+};
+
+
+#endif
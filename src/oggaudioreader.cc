@@ -0,0 +1,497 @@
+// ##########################################################################
+// ####                                                                  ####
+// ####                      RTP Audio Server Project                    ####
+// ####                    ============================                  ####
+// ####                                                                  ####
+// #### Ogg Vorbis Audio Reader                                          ####
+// ####                                                                  ####
+// ####           Copyright (C) 1999-2026 by Thomas Dreibholz            ####
+// ####                                                                  ####
+// #### Contact:                                                         ####
+// ####    EMail: thomas.dreibholz@gmail.com                             ####
+// ####    WWW:   https://www.nntb.no/~dreibh/rtpaudio                   ####
+// ####                                                                  ####
+// #### ---------------------------------------------------------------- ####
+// ####                                                                  ####
+// #### This program is free software: you can redistribute it and/or    ####
+// #### modify it under the terms of the GNU General Public License as   ####
+// #### published by the Free Software Foundation, either version 3 of   ####
+// #### the License, or (at your option) any later version.              ####
+// ####                                                                  ####
+// #### This program is distributed in the hope that it will be useful,  ####
+// #### but WITHOUT ANY WARRANTY; without even the implied warranty of   ####
+// #### MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    ####
+// #### GNU General Public License for more details.                     ####
+// ####                                                                  ####
+// #### You should have received a copy of the GNU General Public        ####
+// #### License along with this program.  If not, see                    ####
+// #### <http://www.gnu.org/licenses/>.                                  ####
+// ####                                                                  ####
+// ##########################################################################
+
+
+#include "tdsystem.h"
+#include "oggaudioreader.h"
+#include "mp3decoderpool.h"
+#include "soundfilemapping.h"
+
+
+#include <vorbis/vorbisfile.h>
+
+
+
+// Minimum size of a read-ahead request and how far read-ahead reaches
+static const card64 ReadAheadStep   = 256 * 1024;
+static const card64 ReadAheadWindow = 1024 * 1024;
+
+
+// ###### Vorbis decoder's callbacks ########################################
+struct OggAudioReader::Callbacks
+{
+   static size_t read(void* ptr, size_t size, size_t nmemb, void* source);
+   static int seek(void* source, ogg_int64_t offset, int whence);
+   static long tell(void* source);
+};
+
+
+// ###### Constructor #######################################################
+OggAudioReader::OggAudioReader(const char* name)
+   : AudioQuality(0,16,0,LITTLE_ENDIAN),
+     DecodeAheadReader("OggAudioReader::FrameReady")
+{
+   Error             = ME_NoMedia;
+   Mapping           = NULL;
+   File              = NULL;
+   FileOpened        = false;
+   BitStream         = 0;
+   PlayableLinks     = 0;
+   FileLength        = 0;
+   FilePosition      = 0;
+   ReadAheadPosition = 0;
+   SamplePosition    = 0;
+   MaxSamplePosition = 0;
+   BytesPerSample    = 0;
+   Queue             = NULL;
+   BufferPos         = 0;
+   Title[0]          = 0x00;
+   Artist[0]         = 0x00;
+   Comment[0]        = 0x00;
+   if(name != NULL) openMedia(name);
+}
+
+
+// ###### Destructor ########################################################
+OggAudioReader::~OggAudioReader()
+{
+   closeMedia();
+}
+
+
+// ###### Close file ########################################################
+void OggAudioReader::closeMedia()
+{
+   detachPool();
+   if(FileOpened) {
+      ov_clear(File);
+      FileOpened = false;
+   }
+   if(File != NULL) {
+      delete File;
+      File = NULL;
+   }
+   if(Mapping != NULL) {
+      Soundfilemapping::detach(Mapping);
+      Mapping = NULL;
+   }
+   Error             = ME_NoMedia;
+   BitStream         = 0;
+   PlayableLinks     = 0;
+   FileLength        = 0;
+   FilePosition      = 0;
+   ReadAheadPosition = 0;
+   SamplePosition    = 0;
+   MaxSamplePosition = 0;
+   BytesPerSample    = 0;
+   BufferPos         = 0;
+   Title[0]          = 0x00;
+   Artist[0]         = 0x00;
+   Comment[0]        = 0x00;
+   setSamplingRate(0);
+   setChannels(0);
+}
+
+
+// ###### Open new file #####################################################
+bool OggAudioReader::openMedia(const char* name)
+{
+   // ###### Open file ######################################################
+   closeMedia();
+   Error = ME_BadMedia;
+   // The file is memory mapped and shared with other readers of the same file.
+   Mapping = Soundfilemapping::attach(name);
+   if(Mapping == NULL) {
+      std::cerr << "WARNING: Unable to open input file <" << name << ">!" << std::endl;
+      return(false);
+   }
+   FileLength = (card64)Mapping->getsize();
+
+   // ###### Check for Ogg stream ###########################################
+   // Other formats are rejected here, before the decoder is set up.
+   if((Mapping->available(0,4) < 4) || strncmp((const char*)Mapping->getdata(),"OggS",4)) {
+      return(false);
+   }
+   ReadAheadPosition = 0;
+   readAhead();
+
+   // ###### Set up Vorbis decoder ##########################################
+   File = new OggVorbis_File;
+   if(File == NULL) {
+      return(false);
+   }
+   ov_callbacks callbacks;
+   callbacks.read_func  = Callbacks::read;
+   callbacks.seek_func  = Callbacks::seek;
+   callbacks.close_func = NULL;
+   callbacks.tell_func  = Callbacks::tell;
+   if(ov_open_callbacks((void*)this,File,NULL,0,callbacks) != 0) {
+      std::cerr << "OggAudioReader::openMedia() - Bad Ogg Vorbis stream in file "
+                << name << "!" << std::endl;
+      return(false);
+   }
+   FileOpened = true;
+
+   const vorbis_info* info = ov_info(File,-1);
+   if((info == NULL) || (info->channels < 1) || (info->channels > 2) ||
+      (info->rate < 1)) {
+      std::cerr << "OggAudioReader::openMedia() - Bad format in file " << name
+                << "!" << std::endl;
+      return(false);
+   }
+
+   // AudioQuality only covers multiples of 2205 Hz. Any other rate
+   // (e.g. 48000 Hz) would be played at the wrong speed.
+   if((info->rate > 0xffff) ||
+      (setSamplingRate((card16)info->rate) != (card16)info->rate)) {
+      std::cerr << "OggAudioReader::openMedia() - Unsupported sampling rate "
+                << info->rate << " in file " << name << "!" << std::endl;
+      return(false);
+   }
+   setChannels((card8)info->channels);
+
+   // ###### Find links in the format of the first one ######################
+   // A chained stream may continue in another format, which would change
+   // the quality within the file. Playback ends before the first such link.
+   const long links = ov_streams(File);
+   PlayableLinks     = 0;
+   MaxSamplePosition = 0;
+   while(PlayableLinks < links) {
+      const vorbis_info* linkInfo = ov_info(File,PlayableLinks);
+      if((linkInfo == NULL) || (linkInfo->rate != info->rate) ||
+         (linkInfo->channels != info->channels)) {
+         break;
+      }
+      const ogg_int64_t total = ov_pcm_total(File,PlayableLinks);
+      if(total > 0) {
+         MaxSamplePosition += (card64)total;
+      }
+      PlayableLinks++;
+   }
+   BytesPerSample = getBitsPerSample() / 8;
+
+   // ###### Get media info from Vorbis comments ############################
+   vorbis_comment* comments = ov_comment(File,-1);
+   if(comments != NULL) {
+      const char* title  = vorbis_comment_query(comments,(char*)"TITLE",0);
+      const char* artist = vorbis_comment_query(comments,(char*)"ARTIST",0);
+      const char* date   = vorbis_comment_query(comments,(char*)"DATE",0);
+      if(title != NULL) {
+         snprintf((char*)&Title,sizeof(Title),"%s",title);
+      }
+      if((artist != NULL) && (date != NULL)) {
+         snprintf((char*)&Artist,sizeof(Artist),"%s, %.4s",artist,date);
+      }
+      else if(artist != NULL) {
+         snprintf((char*)&Artist,sizeof(Artist),"%s",artist);
+      }
+      const char* comment = vorbis_comment_query(comments,(char*)"COMMENT",0);
+      if(comment != NULL) {
+         snprintf((char*)&Comment,sizeof(Comment),"%s",comment);
+      }
+   }
+
+   // ###### Set up decode-ahead queue ######################################
+   attachPool();
+   if(Queue == NULL) {
+      return(false);
+   }
+
+   Error = ME_NoError;
+   return(true);
+}
+
+
+// ###### Vorbis decoder's read function ###################################
+// Accessing the mapping beyond the end of a file truncated meanwhile raises
+// SIGBUS. So the file is checked for the bytes to be read, and a truncated
+// file ends where it has been cut.
+size_t OggAudioReader::Callbacks::read(void* ptr, size_t size, size_t nmemb, void* source)
+{
+   OggAudioReader* reader = (OggAudioReader*)source;
+   if((size == 0) || (reader->FilePosition >= reader->FileLength)) {
+      return(0);
+   }
+   size_t bytes = (size_t)std::min((card64)nmemb,
+                                   (reader->FileLength - reader->FilePosition) / size) * size;
+   const size_t available = reader->Mapping->available(reader->FilePosition,bytes);
+   if(available < bytes) {
+      reader->FileLength = reader->FilePosition + available;
+      bytes              = available - (available % size);
+   }
+   memcpy(ptr,reader->Mapping->getdata() + reader->FilePosition,bytes);
+   reader->FilePosition += bytes;
+   reader->readAhead();
+   return(bytes / size);
+}
+
+
+// ###### Vorbis decoder's seek function ###################################
+int OggAudioReader::Callbacks::seek(void* source, ogg_int64_t offset, int whence)
+{
+   OggAudioReader* reader = (OggAudioReader*)source;
+   switch(whence) {
+      case SEEK_CUR:
+         offset += (ogg_int64_t)reader->FilePosition;
+       break;
+      case SEEK_END:
+         offset += (ogg_int64_t)reader->FileLength;
+       break;
+   }
+   if((offset < 0) || ((card64)offset > reader->FileLength)) {
+      return(-1);
+   }
+   reader->FilePosition      = (card64)offset;
+   reader->ReadAheadPosition = reader->FilePosition;
+   return(0);
+}
+
+
+// ###### Vorbis decoder's tell function ###################################
+long OggAudioReader::Callbacks::tell(void* source)
+{
+   return((long)((OggAudioReader*)source)->FilePosition);
+}
+
+
+// ###### Request read-ahead of upcoming pages #############################
+void OggAudioReader::readAhead()
+{
+   if(ReadAheadPosition + ReadAheadStep < FilePosition + ReadAheadWindow) {
+      const card64 from = std::max(ReadAheadPosition,FilePosition);
+      Mapping->readahead(from,FilePosition + ReadAheadWindow - from);
+      ReadAheadPosition = FilePosition + ReadAheadWindow;
+   }
+}
+
+
+// ###### Set up decode-ahead queue #########################################
+// Without a decoder pool, the queue holds the one block getNextBlock()
+// decodes synchronously.
+void OggAudioReader::attachPool()
+{
+   QueueSlots = (DefaultPool != NULL) ? std::max(DefaultPool->getFramesAhead(),(cardinal)1) : 1;
+   Queue      = new DecodedBlock[QueueSlots];
+   if(Queue == NULL) {
+      QueueSlots = 0;
+      return;
+   }
+   resetQueue();
+   BufferPos = 0;
+   if(DefaultPool != NULL) {
+      Pool = DefaultPool;
+      Pool->addReader(this);
+   }
+}
+
+
+// ###### Detach from decoder pool ##########################################
+void OggAudioReader::detachPool()
+{
+   if(Pool != NULL) {
+      Pool->removeReader(this);
+      Pool = NULL;
+   }
+   delete [] Queue;
+   Queue      = NULL;
+   QueueSlots = 0;
+}
+
+
+// ###### Decode next block into decode-ahead queue #########################
+// Called by MP3DecoderPool, which ensures that only one thread at a time
+// decodes for this reader, or by getNextBlock() without a pool.
+bool OggAudioReader::decodeAhead()
+{
+   const card64 tail = QueueTail.load(std::memory_order_relaxed);
+   if((QueueEnd.load(std::memory_order_relaxed)) ||
+      (tail - QueueHead.load(std::memory_order_acquire) >= QueueSlots)) {
+      return(false);
+   }
+
+   // Once the decoder has reached a link in another format, the stream
+   // has ended until the next setPosition() call.
+   DecodedBlock* block = &Queue[tail % QueueSlots];
+   block->Size = 0;
+   while((block->Size < DecodeBlockSize) && (BitStream < PlayableLinks)) {
+      const long result = ov_read(File,(char*)&block->Data[block->Size],
+                                  (int)(DecodeBlockSize - block->Size),
+                                  0,2,1,&BitStream);
+      if(result == OV_HOLE) {
+         // Lost or corrupt pages: the decoder continues behind them.
+         continue;
+      }
+      if((result <= 0) || (BitStream >= PlayableLinks)) {
+         break;
+      }
+      block->Size += (cardinal)result;
+   }
+   if(block->Size == 0) {
+      QueueEnd.store(true,std::memory_order_release);
+      return(false);
+   }
+   QueueTail.store(tail + 1,std::memory_order_release);
+   return(true);
+}
+
+
+// ###### Wait for a decoded block ##########################################
+bool OggAudioReader::waitForBlock()
+{
+   if(Pool != NULL) {
+      return(Pool->waitForFrame(this));
+   }
+   return((getFramesQueued() > 0) || (decodeAhead()));
+}
+
+
+// ###### Get OggAudioReader status #########################################
+bool OggAudioReader::ready() const
+{
+   return((Error == ME_NoError));
+}
+
+
+// ###### Get maximum position ##############################################
+card64 OggAudioReader::getMaxPosition() const
+{
+   const cardinal rate = getSamplingRate();
+   if(rate > 0)
+      return( (MaxSamplePosition * PositionStepsPerSecond) / (card64)rate );
+   else
+      return(0);
+}
+
+
+// ###### Get media info ###################################################
+void OggAudioReader::getMediaInfo(MediaInfo& mediaInfo) const
+{
+   mediaInfo.reset();
+   if(FileOpened) {
+      mediaInfo.StartTimeStamp = 0;
+      mediaInfo.EndTimeStamp   = getMaxPosition();
+      strcpy((char*)&mediaInfo.Title,(Title[0] != 0x00) ? Title : "Untitled");
+      strcpy((char*)&mediaInfo.Artist,(Artist[0] != 0x00) ? Artist : "Unknown");
+      strcpy((char*)&mediaInfo.Comment,(Comment[0] != 0x00) ? Comment : "Ogg Vorbis Audio File");
+   }
+}
+
+
+// ###### Get error code ###################################################
+MediaError OggAudioReader::getErrorCode() const
+{
+   return(Error);
+}
+
+
+// ###### Get position ######################################################
+card64 OggAudioReader::getPosition() const
+{
+   const cardinal rate = getSamplingRate();
+   if(rate > 0)
+      return( (SamplePosition * PositionStepsPerSecond) / (card64)rate );
+   else
+      return(0);
+}
+
+
+// ###### Set position ######################################################
+void OggAudioReader::setPosition(const card64 position)
+{
+   if(FileOpened && (Queue != NULL) && (Error < ME_UnrecoverableError)) {
+      card64 sample = (position * (card64)getSamplingRate()) / PositionStepsPerSecond;
+      if(sample > MaxSamplePosition) {
+         sample = MaxSamplePosition;
+      }
+
+      // The decoder must not be used by the pool while repositioning
+      MP3DecoderPool* pool = Pool;
+      if(pool != NULL) {
+         pool->removeReader(this);
+      }
+
+      // The decoder bisects over the granule positions of the pages, so
+      // that only the target page has to be decoded.
+      if(ov_pcm_seek(File,(ogg_int64_t)sample) == 0) {
+         SamplePosition = sample;
+         BitStream      = 0;
+         BufferPos      = 0;
+         resetQueue();
+         if(Error == ME_EOF) {
+            Error = ME_NoError;
+         }
+      }
+
+      if(pool != NULL) {
+         pool->addReader(this);
+      }
+   }
+}
+
+
+// ###### Read block from file ##############################################
+cardinal OggAudioReader::getNextBlock(void* buffer, const cardinal blockSize)
+{
+   if(FileOpened && (Queue != NULL) && (Error < ME_UnrecoverableError)) {
+      if((blockSize % BytesPerSample) != 0) {
+         std::cerr << "WARNING: OggAudioReader::getNextBlock() - Unaligned blockSize value "
+                   << blockSize << "!" << std::endl;
+         return(0);
+      }
+
+      cardinal copied = 0;
+      while(copied < blockSize) {
+         if(!waitForBlock()) {
+            Error = ME_EOF;
+            break;
+         }
+         const card64        head   = QueueHead.load(std::memory_order_relaxed);
+         const DecodedBlock* block  = &Queue[head % QueueSlots];
+         const cardinal      length = std::min(blockSize - copied,block->Size - BufferPos);
+         memcpy((void*)&((card8*)buffer)[copied],(const void*)&block->Data[BufferPos],length);
+         BufferPos += length;
+         copied    += length;
+         if(BufferPos >= block->Size) {
+            BufferPos = 0;
+            QueueHead.store(head + 1,std::memory_order_release);
+            if(Pool != NULL) {
+               Pool->frameTaken();
+            }
+         }
+      }
+
+      // The last samples of a truncated stream may be incomplete.
+      copied -= copied % BytesPerSample;
+      SamplePosition += copied / BytesPerSample;
+      return(copied);
+   }
+   return(0);
+}
@@ -0,0 +1,193 @@
+// ##########################################################################
+// ####                                                                  ####
+// ####                      RTP Audio Server Project                    ####
+// ####                    ============================                  ####
+// ####                                                                  ####
+// #### Ogg Vorbis Audio Reader                                          ####
+// ####                                                                  ####
+// ####           Copyright (C) 1999-2026 by Thomas Dreibholz            ####
+// ####                                                                  ####
+// #### Contact:                                                         ####
+// ####    EMail: thomas.dreibholz@gmail.com                             ####
+// ####    WWW:   https://www.nntb.no/~dreibh/rtpaudio                   ####
+// ####                                                                  ####
+// #### ---------------------------------------------------------------- ####
+// ####                                                                  ####
+// #### This program is free software: you can redistribute it and/or    ####
+// #### modify it under the terms of the GNU General Public License as   ####
+// #### published by the Free Software Foundation, either version 3 of   ####
+// #### the License, or (at your option) any later version.              ####
+// ####                                                                  ####
+// #### This program is distributed in the hope that it will be useful,  ####
+// #### but WITHOUT ANY WARRANTY; without even the implied warranty of   ####
+// #### MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    ####
+// #### GNU General Public License for more details.                     ####
+// ####                                                                  ####
+// #### You should have received a copy of the GNU General Public        ####
+// #### License along with this program.  If not, see                    ####
+// #### <http://www.gnu.org/licenses/>.                                  ####
+// ####                                                                  ####
+// ##########################################################################
+
+
+#ifndef OGGAUDIOREADER_H
+#define OGGAUDIOREADER_H
+
+
+#include "tdsystem.h"
+#include "audioreaderinterface.h"
+#include "audioquality.h"
+#include "decodeaheadreader.h"
+
+
+class Soundfilemapping;
+struct OggVorbis_File;
+
+
+/**
+  * This class is a reader for Ogg Vorbis audio files. The file is decoded
+  * from a shared memory mapping into a queue of decoded blocks. With a
+  * decoder pool (see DecodeAheadReader::setDecoderPool), the pool's
+  * threads keep the queue filled and getNextBlock() only takes blocks from
+  * it; otherwise, getNextBlock() decodes synchronously. Seeking uses the
+  * granule positions of the Ogg pages.
+  *
+  * @short   Ogg Vorbis Audio Reader
+  * @author  Thomas Dreibholz (thomas.dreibholz@gmail.com)
+  * @version 1.0
+  */
+class OggAudioReader : virtual public AudioReaderInterface,
+                       public AudioQuality,
+                       public DecodeAheadReader
+{
+   // ====== Constructor/Destructor =========================================
+   public:
+   /**
+     * Constructor.
+     *
+     * @param name Name of Ogg Vorbis file or NULL.
+     */
+   OggAudioReader(const char* name = NULL);
+
+   /**
+     * Destructor.
+     */
+   ~OggAudioReader();
+
+
+   // ====== Initialize =====================================================
+   /**
+     * openMedia() implementation of AudioReaderInterface.
+     *
+     * @see AudioReaderInterface#openMedia
+     */
+   bool openMedia(const char* name);
+
+   /**
+     * closeMedia() implementation of AudioReaderInterface.
+     *
+     * @see AudioReaderInterface#closeMedia
+     */
+   void closeMedia();
+
+   /**
+     * ready() implementation of AudioReaderInterface.
+     *
+     * @see AudioReaderInterface#ready
+     */
+   bool ready() const;
+
+
+   // ====== Input functions ================================================
+   /**
+     * getMediaInfo() implementation of AudioReaderInterface.
+     *
+     * @see AudioReaderInterface#getMediaInfo
+     */
+   void getMediaInfo(MediaInfo& mediaInfo) const;
+
+   /**
+     * getErrorCode() implementation of AudioReaderInterface.
+     *
+     * @see AudioReaderInterface#getErrorCode
+     */
+   MediaError getErrorCode() const;
+
+   /**
+     * getPosition() implementation of AudioReaderInterface.
+     *
+     * @see AudioReaderInterface#getPosition
+     */
+   card64 getPosition() const;
+
+   /**
+     * getMaxPosition() implementation of AudioReaderInterface.
+     *
+     * @see AudioReaderInterface#getMaxPosition
+     */
+   card64 getMaxPosition() const;
+
+   /**
+     * setPosition() implementation of AudioReaderInterface.
+     *
+     * @see AudioReaderInterface#setPosition
+     */
+   void setPosition(const card64 position);
+
+   /**
+     * getNextBlock() implementation of AudioReaderInterface.
+     *
+     * @see AudioReaderInterface#getNextBlock
+     */
+   cardinal getNextBlock(void* buffer, const cardinal blockSize);
+
+
+   // ====== Constants ======================================================
+   /**
+     * Number of bytes of decoded samples in each block of the queue.
+     */
+   static const cardinal DecodeBlockSize = 8192;
+
+
+   // ====== Decode-ahead queue (used by MP3DecoderPool) ====================
+   private:
+   struct DecodedBlock {
+      cardinal Size;
+      card8    Data[DecodeBlockSize];
+   };
+
+   void attachPool();
+   void detachPool();
+   bool decodeAhead();
+   bool waitForBlock();
+
+
+   // ====== Private data ===================================================
+   private:
+   struct Callbacks;
+   friend struct Callbacks;
+
+   void readAhead();
+
+
+   MediaError        Error;
+   Soundfilemapping* Mapping;
+   OggVorbis_File*   File;
+   bool              FileOpened;
+   int               BitStream;
+   int               PlayableLinks;
+   card64            FileLength;
+   card64            FilePosition;
+   card64            ReadAheadPosition;
+   card64            SamplePosition;
+   card64            MaxSamplePosition;
+   cardinal          BytesPerSample;
+   DecodedBlock*     Queue;
+   cardinal          BufferPos;
+   char              Title[32];
+   char              Artist[32];
+   char              Comment[32];
+};
+
+
+#endif
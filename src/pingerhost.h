@@ -65,35 +65,15 @@ struct PingerHost
    String AddressString;
 
    /**
-     * Timestamp of last sent ping.
+     * Slot of the host's entry in the RoundTripTimeTable.
      */
-   card64 LastPingTimeStamp;
-
-   /**
-     * Timestamp of last received ping.
-     */
-   card64 LastEchoTimeStamp;
-
-   /**
-     * Round trip time.
-     */
-   cardinal RoundTripTime;
-
-   /**
-     * Maximum raw round trip time (directly calculated from packet).
-     */
-   cardinal MaxRawRoundTripTime;
+   cardinal Slot;
 
    /**
      * User counter (number of addHost() calls for this destination).
      */
    cardinal UserCount;
 
-   /**
-     * Sequence number.
-     */
-   card16 SeqNum;
-
    /**
      * Traffic class.
      */
@@ -0,0 +1,65 @@
+// ##########################################################################
+// ####                                                                  ####
+// ####                   Master Thesis Implementation                   ####
+// ####  Management of Layered Variable Bitrate Multimedia Streams over  ####
+// ####                 DiffServ with A Priori Knowledge                 ####
+// ####                                                                  ####
+// #### ================================================================ ####
+// ####                                                                  ####
+// ####                                                                  ####
+// #### QoS Event Queue                                                  ####
+// ####                                                                  ####
+// ####           Copyright (C) 1999-2026 by Thomas Dreibholz            ####
+// ####                                                                  ####
+// #### Contact:                                                         ####
+// ####    EMail: thomas.dreibholz@gmail.com                             ####
+// ####    WWW:   https://www.nntb.no/~dreibh/rtpaudio                   ####
+// ####                                                                  ####
+// #### ---------------------------------------------------------------- ####
+// ####                                                                  ####
+// #### This program is free software: you can redistribute it and/or    ####
+// #### modify it under the terms of the GNU General Public License as   ####
+// #### published by the Free Software Foundation, either version 3 of   ####
+// #### the License, or (at your option) any later version.              ####
+// ####                                                                  ####
+// #### This program is distributed in the hope that it will be useful,  ####
+// #### but WITHOUT ANY WARRANTY; without even the implied warranty of   ####
+// #### MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    ####
+// #### GNU General Public License for more details.                     ####
+// ####                                                                  ####
+// #### You should have received a copy of the GNU General Public        ####
+// #### License along with this program.  If not, see                    ####
+// #### <http://www.gnu.org/licenses/>.                                  ####
+// ####                                                                  ####
+// ##########################################################################
+
+
+#include "tdsystem.h"
+#include "qoseventqueue.h"
+
+
+
+// ###### Constructor #######################################################
+QoSEventQueue::QoSEventQueue(const cardinal capacity)
+{
+   size_t size = 2;
+   while(size < (size_t)capacity) {
+      size <<= 1;
+   }
+   Buffer = new Cell[size];
+   Mask   = size - 1;
+   for(size_t i = 0;i < size;i++) {
+      Buffer[i].Sequence.store(i,std::memory_order_relaxed);
+   }
+   EnqueuePosition.store(0,std::memory_order_relaxed);
+   DequeuePosition = 0;
+   Overflows.store(0,std::memory_order_relaxed);
+}
+
+
+// ###### Destructor ########################################################
+QoSEventQueue::~QoSEventQueue()
+{
+   delete [] Buffer;
+   Buffer = NULL;
+}
@@ -0,0 +1,180 @@
+// ##########################################################################
+// ####                                                                  ####
+// ####                   Master Thesis Implementation                   ####
+// ####  Management of Layered Variable Bitrate Multimedia Streams over  ####
+// ####                 DiffServ with A Priori Knowledge                 ####
+// ####                                                                  ####
+// #### ================================================================ ####
+// ####                                                                  ####
+// ####                                                                  ####
+// #### QoS Event Queue                                                  ####
+// ####                                                                  ####
+// ####           Copyright (C) 1999-2026 by Thomas Dreibholz            ####
+// ####                                                                  ####
+// #### Contact:                                                         ####
+// ####    EMail: thomas.dreibholz@gmail.com                             ####
+// ####    WWW:   https://www.nntb.no/~dreibh/rtpaudio                   ####
+// ####                                                                  ####
+// #### ---------------------------------------------------------------- ####
+// ####                                                                  ####
+// #### This program is free software: you can redistribute it and/or    ####
+// #### modify it under the terms of the GNU General Public License as   ####
+// #### published by the Free Software Foundation, either version 3 of   ####
+// #### the License, or (at your option) any later version.              ####
+// ####                                                                  ####
+// #### This program is distributed in the hope that it will be useful,  ####
+// #### but WITHOUT ANY WARRANTY; without even the implied warranty of   ####
+// #### MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    ####
+// #### GNU General Public License for more details.                     ####
+// ####                                                                  ####
+// #### You should have received a copy of the GNU General Public        ####
+// #### License along with this program.  If not, see                    ####
+// #### <http://www.gnu.org/licenses/>.                                  ####
+// ####                                                                  ####
+// ##########################################################################
+
+
+#ifndef QOSEVENTQUEUE_H
+#define QOSEVENTQUEUE_H
+
+
+#include "tdsystem.h"
+#include "managedstreaminterface.h"
+
+
+#include <atomic>
+
+
+/**
+  * This is an event for the QoS manager, queued by a sender thread
+  * and processed later by the QoS manager's thread.
+  *
+  * @short   QoS Event
+  * @author  Thomas Dreibholz (thomas.dreibholz@gmail.com)
+  * @version 1.0
+*/
+struct QoSEvent
+{
+   // ====== Constants ======================================================
+   /**
+     * Event types.
+     */
+   enum QoSEventType {
+      QET_Report      = 1,
+      QET_BufferFlush = 2
+   };
+
+
+   // ====== Event data =====================================================
+   /**
+     * Event type.
+     */
+   QoSEventType Type;
+
+   /**
+     * Stream.
+     */
+   ManagedStreamInterface* Stream;
+
+   /**
+     * Layer.
+     */
+   cardinal Layer;
+
+   /**
+     * Reported fraction lost (for QET_Report only).
+     */
+   double FractionLost;
+
+   /**
+     * Reported jitter (for QET_Report only).
+     */
+   card32 Jitter;
+
+   /**
+     * Time stamp of event creation.
+     */
+   card64 TimeStamp;
+};
+
+
+
+/**
+  * This class is a bounded, lock-free multi-producer/single-consumer queue
+  * for QoS events. Any number of threads may call push() concurrently;
+  * pop() may only be called by a single thread at a time.
+  *
+  * @short   QoS Event Queue
+  * @author  Thomas Dreibholz (thomas.dreibholz@gmail.com)
+  * @version 1.0
+*/
+class QoSEventQueue
+{
+   // ====== Constructor/Destructor =========================================
+   public:
+   /**
+     * Constructor.
+     *
+     * @param capacity Queue capacity (rounded up to a power of 2).
+     */
+   QoSEventQueue(const cardinal capacity = 4096);
+
+   /**
+     * Destructor.
+     */
+   ~QoSEventQueue();
+
+
+   // ====== Queue operations ===============================================
+   /**
+     * Add event to queue. This method is lock-free and may be called by
+     * multiple threads concurrently.
+     *
+     * @param event Event.
+     * @return true for success; false, if the queue is full.
+     */
+   inline bool push(const QoSEvent& event);
+
+   /**
+     * Remove event from queue. This method may only be called by a
+     * single thread at a time.
+     *
+     * @param event Reference to store event to.
+     * @return true for success; false, if the queue is empty.
+     */
+   inline bool pop(QoSEvent& event);
+
+   /**
+     * Get queue capacity.
+     *
+     * @return Capacity.
+     */
+   inline cardinal getCapacity() const;
+
+   /**
+     * Get number of push() calls failed due to full queue.
+     *
+     * @return Number of overflows.
+     */
+   inline card64 getOverflows() const;
+
+
+   // ====== Private data ===================================================
+   private:
+   struct Cell {
+      std::atomic<size_t> Sequence;
+      QoSEvent            Event;
+   };
+
+   Cell*                           Buffer;
+   size_t                          Mask;
+   alignas(64) std::atomic<size_t> EnqueuePosition;
+   alignas(64) size_t              DequeuePosition;
+   std::atomic<card64>             Overflows;
+};
+
+
+#include "qoseventqueue.icc"
+
+
+#endif
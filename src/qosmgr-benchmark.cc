@@ -0,0 +1,516 @@
+// ##########################################################################
+// ####                                                                  ####
+// ####                   Master Thesis Implementation                   ####
+// ####  Management of Layered Variable Bitrate Multimedia Streams over  ####
+// ####                 DiffServ with A Priori Knowledge                 ####
+// ####                                                                  ####
+// #### ================================================================ ####
+// ####                                                                  ####
+// ####                                                                  ####
+// #### QoS Manager Benchmark                                            ####
+// ####                                                                  ####
+// ####           Copyright (C) 1999-2026 by Thomas Dreibholz            ####
+// ####                                                                  ####
+// #### Contact:                                                         ####
+// ####    EMail: thomas.dreibholz@gmail.com                             ####
+// ####    WWW:   https://www.nntb.no/~dreibh/rtpaudio                   ####
+// ####                                                                  ####
+// #### ---------------------------------------------------------------- ####
+// ####                                                                  ####
+// #### This program is free software: you can redistribute it and/or    ####
+// #### modify it under the terms of the GNU General Public License as   ####
+// #### published by the Free Software Foundation, either version 3 of   ####
+// #### the License, or (at your option) any later version.              ####
+// ####                                                                  ####
+// #### This program is distributed in the hope that it will be useful,  ####
+// #### but WITHOUT ANY WARRANTY; without even the implied warranty of   ####
+// #### MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    ####
+// #### GNU General Public License for more details.                     ####
+// ####                                                                  ####
+// #### You should have received a copy of the GNU General Public        ####
+// #### License along with this program.  If not, see                    ####
+// #### <http://www.gnu.org/licenses/>.                                  ####
+// ####                                                                  ####
+// ##########################################################################
+
+
+#include "tdsystem.h"
+#include "tools.h"
+#include "randomizer.h"
+#include "bandwidthmanager.h"
+#include "servicelevelagreement.h"
+#include "syntheticstream.h"
+
+
+#include <sys/resource.h>
+#include <fstream>
+#include <vector>
+#include <map>
+
+
+/*
+   Trace file format (one event per line, "#" starts a comment):
+
+   <Time/us> ADD <StreamID> <SessionID> [<Layers> [<RU Points> [<Priority>]]]
+   <Time/us> REMOVE <StreamID>
+   <Time/us> REPORT <StreamID> <Layer> <Fraction Lost> <Jitter>
+   <Time/us> FLUSH <StreamID> <Layer>
+   <Time/us> REMAP
+   <Time/us> STATISTICS
+
+   The time stamps are used as BandwidthManager::SimulatorTime, i.e. the
+   replay is deterministic and independent of the real time.
+*/
+
+
+// ###### Trace event #######################################################
+struct TraceEvent
+{
+   enum TraceEventType {
+      TET_Add        = 0,
+      TET_Remove     = 1,
+      TET_Report     = 2,
+      TET_Flush      = 3,
+      TET_Remap      = 4,
+      TET_Statistics = 5
+   };
+   static const cardinal TraceEventTypes = 6;
+
+   TraceEventType         Type;
+   card64                 TimeStamp;
+   cardinal               StreamID;
+   cardinal               SessionID;
+   cardinal               Layer;
+   double                 FractionLost;
+   card32                 Jitter;
+   SyntheticStreamProfile Profile;
+};
+
+
+// ###### Operation latency statistics ######################################
+struct OperationStatistics
+{
+   card64 Count;
+   card64 TotalTime;
+   card64 MaxTime;
+};
+
+
+static const char* TraceEventName[TraceEvent::TraceEventTypes] = {
+   "Add", "Remove", "Report", "Flush", "Remap", "Statistics"
+};
+
+
+// ###### Get maximum resident set size in KiB ##############################
+static long getMaxResidentSetSize()
+{
+   struct rusage usage;
+   if(getrusage(RUSAGE_SELF,&usage) == 0) {
+      return(usage.ru_maxrss);
+   }
+   return(-1);
+}
+
+
+// ###### Read trace file ###################################################
+static bool readTrace(const char*                    fileName,
+                      const SyntheticStreamProfile&  defaultProfile,
+                      std::vector<TraceEvent>&       trace)
+{
+   FILE* inputFD = fopen(fileName,"r");
+   if(inputFD == NULL) {
+      std::cerr << "ERROR: Unable to open trace file <" << fileName << ">!" << std::endl;
+      return(false);
+   }
+
+   char     str[256];
+   cardinal line = 0;
+   while(fgets((char*)&str,sizeof(str),inputFD) != NULL) {
+      line++;
+      if((str[0] == '#') || (str[0] == '\n') || (str[0] == 0x00)) {
+         continue;
+      }
+
+      unsigned long long timeStamp;
+      char               command[32];
+      int                position;
+      if(sscanf(str,"%llu %31s %n",&timeStamp,(char*)&command,&position) < 2) {
+         std::cerr << "ERROR: Bad trace entry, line " << line << "!" << std::endl;
+         fclose(inputFD);
+         return(false);
+      }
+
+      TraceEvent event;
+      event.TimeStamp    = (card64)timeStamp;
+      event.StreamID     = 0;
+      event.SessionID    = 0;
+      event.Layer        = 0;
+      event.FractionLost = 0.0;
+      event.Jitter       = 0;
+      event.Profile      = defaultProfile;
+
+      const char* arguments = &str[position];
+      unsigned int a = 0, b = 0, c = 0, d = 0;
+      int          priority = 0;
+      int          result   = -1;
+      if(!(strcasecmp(command,"ADD"))) {
+         event.Type = TraceEvent::TET_Add;
+         result = sscanf(arguments,"%u %u %u %u %d",&a,&b,&c,&d,&priority);
+         if(result >= 2) {
+            event.StreamID  = a;
+            event.SessionID = b;
+            if(result >= 3) event.Profile.Layers         = c;
+            if(result >= 4) event.Profile.RUPoints       = d;
+            if(result >= 5) event.Profile.StreamPriority = (int8)priority;
+         }
+         result = (result >= 2) ? 1 : -1;
+      }
+      else if(!(strcasecmp(command,"REMOVE"))) {
+         event.Type = TraceEvent::TET_Remove;
+         result = (sscanf(arguments,"%u",&a) == 1) ? 1 : -1;
+         event.StreamID = a;
+      }
+      else if(!(strcasecmp(command,"REPORT"))) {
+         event.Type = TraceEvent::TET_Report;
+         result = (sscanf(arguments,"%u %u %lf %u",&a,&b,&event.FractionLost,&c) == 4) ? 1 : -1;
+         event.StreamID = a;
+         event.Layer    = b;
+         event.Jitter   = c;
+      }
+      else if(!(strcasecmp(command,"FLUSH"))) {
+         event.Type = TraceEvent::TET_Flush;
+         result = (sscanf(arguments,"%u %u",&a,&b) == 2) ? 1 : -1;
+         event.StreamID = a;
+         event.Layer    = b;
+      }
+      else if(!(strcasecmp(command,"REMAP"))) {
+         event.Type = TraceEvent::TET_Remap;
+         result = 1;
+      }
+      else if(!(strcasecmp(command,"STATISTICS"))) {
+         event.Type = TraceEvent::TET_Statistics;
+         result = 1;
+      }
+      if(result < 0) {
+         std::cerr << "ERROR: Bad trace entry, line " << line << "!" << std::endl;
+         fclose(inputFD);
+         return(false);
+      }
+      trace.push_back(event);
+   }
+   fclose(inputFD);
+   return(true);
+}
+
+
+// ###### Generate synthetic trace ##########################################
+static void generateTrace(Randomizer&                   random,
+                          const SyntheticStreamProfile& defaultProfile,
+                          const cardinal                streams,
+                          const cardinal                streamsPerSession,
+                          const cardinal                reportRounds,
+                          std::vector<TraceEvent>&      trace)
+{
+   TraceEvent event;
+   event.TimeStamp    = 0;
+   event.Layer        = 0;
+   event.FractionLost = 0.0;
+   event.Jitter       = 0;
+   event.Profile      = defaultProfile;
+
+   // ====== Add streams with randomized profiles ===========================
+   for(cardinal i = 1;i <= streams;i++) {
+      event.Type      = TraceEvent::TET_Add;
+      event.StreamID  = i;
+      event.SessionID = 1 + ((i - 1) / std::max(streamsPerSession,(cardinal)1));
+      event.Profile   = defaultProfile;
+      event.Profile.StreamPriority = (int8)((integer)(random.random32() % 17) - 8);
+      for(cardinal j = 0;j < event.Profile.Layers;j++) {
+         const double factor = 0.5 + random.random();
+         event.Profile.MinFrameSize[j] = (cardinal)(factor * defaultProfile.MinFrameSize[j]);
+         event.Profile.MaxFrameSize[j] = (cardinal)(factor * defaultProfile.MaxFrameSize[j]);
+      }
+      event.Profile.UtilizationExponent = 0.25 + (0.75 * random.random());
+      trace.push_back(event);
+      event.TimeStamp += 1000;
+   }
+   event.Type = TraceEvent::TET_Statistics;
+   trace.push_back(event);
+
+   // ====== Report rounds ==================================================
+   for(cardinal r = 0;r < reportRounds;r++) {
+      for(cardinal i = 1;i <= streams;i++) {
+         event.Type         = TraceEvent::TET_Report;
+         event.StreamID     = i;
+         event.Layer        = random.random32() % defaultProfile.Layers;
+         event.FractionLost = 0.05 * random.random();
+         event.Jitter       = random.random32() % 200;
+         trace.push_back(event);
+         if((random.random32() % 100) == 0) {
+            event.Type = TraceEvent::TET_Flush;
+            trace.push_back(event);
+         }
+         event.TimeStamp += 1000000 / std::max(streams,(cardinal)1);
+      }
+      event.Type = TraceEvent::TET_Remap;
+      trace.push_back(event);
+   }
+   event.Type = TraceEvent::TET_Statistics;
+   trace.push_back(event);
+
+   // ====== Remove streams =================================================
+   for(cardinal i = 1;i <= streams;i++) {
+      event.Type     = TraceEvent::TET_Remove;
+      event.StreamID = i;
+      trace.push_back(event);
+      event.TimeStamp += 1000;
+   }
+}
+
+
+// ###### Print allocation statistics #######################################
+static void printAllocationStatistics(const BandwidthManager*      manager,
+                                      const ServiceLevelAgreement* sla,
+                                      const card64                 timeStamp)
+{
+   // The streams never call intervalChangeEvent(), therefore the new
+   // allocation (not the applied reservation) is evaluated here.
+   cardinal streams           = 0;
+   double   utilizationSum    = 0.0;
+   double   utilizationSquare = 0.0;
+   card64   bandwidth         = 0;
+   double   costPerSecond     = 0.0;
+   std::multimap<ManagedStreamInterface*,StreamDescription*>::const_iterator iterator =
+      manager->StreamSet.begin();
+   while(iterator != manager->StreamSet.end()) {
+      const StreamDescription* sd = iterator->second;
+      if(sd->NewQuality.Utilization >= 0.0) {
+         utilizationSum    += sd->NewQuality.Utilization;
+         utilizationSquare += sd->NewQuality.Utilization * sd->NewQuality.Utilization;
+      }
+      bandwidth     += sd->NewQuality.Bandwidth;
+      costPerSecond += sd->NewCostPerSecond;
+      streams++;
+      iterator++;
+   }
+   card64 slaBandwidth = 0;
+   for(cardinal i = 0;i < sla->Classes;i++) {
+      slaBandwidth += sla->Class[i].BytesPerSecond;
+   }
+
+   // Jain's fairness index of the stream utilizations.
+   const double fairness = (utilizationSquare > 0.0) ?
+      ((utilizationSum * utilizationSum) / ((double)streams * utilizationSquare)) : 0.0;
+
+   char str[256];
+   snprintf((char*)&str,sizeof(str),
+            "T=%llu  Streams=%u  UtilizationSum=%1.3f  MeanUtilization=%1.4f  Fairness=%1.4f  Bandwidth=%llu (%1.2f%% of SLA)  Cost=%1.0f/s  MaxRSS=%ld KiB",
+            (unsigned long long)timeStamp,
+            (unsigned int)streams,
+            utilizationSum,
+            (streams > 0) ? (utilizationSum / (double)streams) : 0.0,
+            fairness,
+            (unsigned long long)bandwidth,
+            (slaBandwidth > 0) ? (100.0 * (double)bandwidth / (double)slaBandwidth) : 0.0,
+            costPerSecond,
+            getMaxResidentSetSize());
+   std::cout << str << std::endl;
+}
+
+
+// ###### Main program ######################################################
+int main(int argc, char* argv[])
+{
+   // ===== Initialize ======================================================
+   const char* slaFile                = "SLA.config";
+   const char* traceFile              = NULL;
+   const char* logName                = NULL;
+   cardinal    streams                = 100;
+   cardinal    streamsPerSession      = 1;
+   cardinal    reportRounds           = 10;
+   cardinal    seed                   = 1;
+   cardinal    maxRUPoints            = 32;
+   bool        prEnabled              = true;
+   double      fairnessSession        = 0.0;
+   double      fairnessStream         = 1.0;
+   SyntheticStreamProfile defaultProfile;
+   defaultProfile.reset();
+
+
+   // ===== Check arguments =================================================
+   for(cardinal i = 1;i < (cardinal)argc;i++) {
+      if(!(strncasecmp(argv[i],"-sla=",5)))              slaFile                  = &argv[i][5];
+      else if(!(strncasecmp(argv[i],"-trace=",7)))       traceFile                = &argv[i][7];
+      else if(!(strncasecmp(argv[i],"-log=",5)))         logName                  = &argv[i][5];
+      else if(!(strncasecmp(argv[i],"-streams=",9)))     streams                  = (cardinal)atol(&argv[i][9]);
+      else if(!(strncasecmp(argv[i],"-session=",9)))     streamsPerSession        = (cardinal)atol(&argv[i][9]);
+      else if(!(strncasecmp(argv[i],"-rounds=",8)))      reportRounds             = (cardinal)atol(&argv[i][8]);
+      else if(!(strncasecmp(argv[i],"-seed=",6)))        seed                     = (cardinal)atol(&argv[i][6]);
+      else if(!(strncasecmp(argv[i],"-layers=",8)))      defaultProfile.Layers    = (cardinal)atol(&argv[i][8]);
+      else if(!(strncasecmp(argv[i],"-points=",8)))      defaultProfile.RUPoints  = (cardinal)atol(&argv[i][8]);
+      else if(!(strncasecmp(argv[i],"-maxrupoints=",13))) maxRUPoints             = (cardinal)atol(&argv[i][13]);
+      else if(!(strncasecmp(argv[i],"-fairness=",10)))   sscanf(&argv[i][10],"%lf,%lf",&fairnessSession,&fairnessStream);
+      else if(!(strcasecmp(argv[i],"-disable-pr")))      prEnabled = false;
+      else if(!(strcasecmp(argv[i],"-enable-pr")))       prEnabled = true;
+      else {
+         std::cerr << "Usage: " << argv[0] << " {-sla=file} {-trace=file} {-log=file} {-streams=count} {-session=streams per session} {-rounds=report rounds} {-seed=number} {-layers=count} {-points=count} {-maxrupoints=count} {-fairness=session,stream} {-disable-pr|-enable-pr}" << std::endl;
+         exit(1);
+      }
+   }
+   defaultProfile.Layers = std::min(std::max(defaultProfile.Layers,(cardinal)1),
+                                    RTPConstants::RTPMaxQualityLayers);
+   if(streamsPerSession > ResourceUtilizationMultiPoint::MaxStreamsPerSession) {
+      streamsPerSession = ResourceUtilizationMultiPoint::MaxStreamsPerSession;
+   }
+
+
+   // ====== Load SLA =======================================================
+   ServiceLevelAgreement sla;
+   if(sla.load(slaFile) == false) {
+      std::cerr << "ERROR: Unable to load SLA configuration file <"
+                << slaFile << ">!" << std::endl;
+      exit(1);
+   }
+
+
+   // ====== Get trace ======================================================
+   std::vector<TraceEvent> trace;
+   Randomizer              random;
+   random.setSeed(seed);
+   if(traceFile != NULL) {
+      if(readTrace(traceFile,defaultProfile,trace) == false) {
+         exit(1);
+      }
+   }
+   else {
+      generateTrace(random,defaultProfile,streams,streamsPerSession,reportRounds,trace);
+   }
+
+
+   // ====== Initialize bandwidth manager ===================================
+   std::ofstream* logStream = NULL;
+   if(logName != NULL) {
+      logStream = new std::ofstream(logName);
+      if((logStream == NULL) || (!logStream->good())) {
+         std::cerr << "ERROR: Unable to create log file!" << std::endl;
+         exit(1);
+      }
+   }
+   BandwidthManager::SimulatorTime = 1;
+   BandwidthManager* manager = new BandwidthManager(&sla,NULL);
+   if(manager == NULL) {
+      std::cerr << "ERROR: Out of memory!" << std::endl;
+      exit(1);
+   }
+   manager->setLogStream(logStream);
+   manager->setFairness(fairnessSession,fairnessStream);
+   manager->setQoSOptimizationParameters(maxRUPoints,0.01,(card64)-1,50000.0,false);
+   manager->setPartialRemapping(prEnabled,0.1,0.05,5000000.0);
+   // The manager's thread is *not* started: all events are processed
+   // synchronously, in trace order.
+
+
+   // ====== Replay trace ===================================================
+   std::map<cardinal,SyntheticStream*> streamMap;
+   OperationStatistics statistics[TraceEvent::TraceEventTypes];
+   for(cardinal i = 0;i < TraceEvent::TraceEventTypes;i++) {
+      statistics[i].Count     = 0;
+      statistics[i].TotalTime = 0;
+      statistics[i].MaxTime   = 0;
+   }
+   const long   startRSS       = getMaxResidentSetSize();
+   const card64 startTimeStamp = getMicroTime();
+   for(std::vector<TraceEvent>::const_iterator iterator = trace.begin();
+       iterator != trace.end(); iterator++) {
+      const TraceEvent& event = *iterator;
+      BandwidthManager::SimulatorTime = event.TimeStamp + 1;   // 0 = real time!
+
+      std::map<cardinal,SyntheticStream*>::iterator found = streamMap.find(event.StreamID);
+      SyntheticStream* stream = (found != streamMap.end()) ? found->second : NULL;
+
+      const card64 operationStart = getMicroTime();
+      switch(event.Type) {
+         case TraceEvent::TET_Add:
+            if(stream == NULL) {
+               char name[32];
+               snprintf((char*)&name,sizeof(name),"Synthetic-%u",event.StreamID);
+               stream = new SyntheticStream(event.Profile);
+               streamMap.insert(std::pair<cardinal,SyntheticStream*>(event.StreamID,stream));
+               manager->addStream(stream,event.SessionID,name);
+            }
+          break;
+         case TraceEvent::TET_Remove:
+            if(stream != NULL) {
+               manager->removeStream(stream);
+               streamMap.erase(found);
+               delete stream;
+            }
+          break;
+         case TraceEvent::TET_Report:
+            if(stream != NULL) {
+               RTCPReceptionReportBlock report(event.StreamID);
+               report.setFractionLost(event.FractionLost);
+               report.setJitter(event.Jitter);
+               manager->reportEvent(stream,&report,event.Layer);
+            }
+          break;
+         case TraceEvent::TET_Flush:
+            if(stream != NULL) {
+               manager->bufferFlushEvent(stream,event.Layer);
+            }
+          break;
+         case TraceEvent::TET_Remap:
+            manager->forceCompleteRemapping();
+          break;
+         case TraceEvent::TET_Statistics:
+            printAllocationStatistics(manager,&sla,event.TimeStamp);
+          break;
+      }
+      const card64 operationTime = getMicroTime() - operationStart;
+
+      if(event.Type != TraceEvent::TET_Statistics) {
+         statistics[event.Type].Count++;
+         statistics[event.Type].TotalTime += operationTime;
+         statistics[event.Type].MaxTime = std::max(statistics[event.Type].MaxTime,
+                                                   operationTime);
+      }
+   }
+   const card64 runTime = getMicroTime() - startTimeStamp;
+
+
+   // ====== Print results ==================================================
+   std::cout << std::endl
+             << "Operation    Count     Mean/us       Max/us" << std::endl;
+   for(cardinal i = 0;i < TraceEvent::TraceEventTypes;i++) {
+      if(statistics[i].Count > 0) {
+         char str[256];
+         snprintf((char*)&str,sizeof(str),"%-10s %7llu %11.1f %12llu",
+                  TraceEventName[i],
+                  (unsigned long long)statistics[i].Count,
+                  (double)statistics[i].TotalTime / (double)statistics[i].Count,
+                  (unsigned long long)statistics[i].MaxTime);
+         std::cout << str << std::endl;
+      }
+   }
+   std::cout << std::endl
+             << "Trace Events:           " << trace.size() << std::endl
+             << "Run Time:               " << runTime << " [us]" << std::endl
+             << "Complete Remappings:    " << manager->CompleteRemappings << std::endl
+             << "Partial Remappings:     " << manager->PartialRemappings << std::endl
+             << "Last Remapping Time:    " << manager->LastCompleteRemappingDuration << " [us]" << std::endl
+             << "Buffer Flushes:         " << manager->TotalBufferFlushes << std::endl
+             << "Max RSS Growth:         " << (getMaxResidentSetSize() - startRSS) << " [KiB]" << std::endl;
+
+
+   // ====== Clean up =======================================================
+   manager->setLogStream(NULL);
+   delete manager;
+   for(std::map<cardinal,SyntheticStream*>::iterator iterator = streamMap.begin();
+       iterator != streamMap.end(); iterator++) {
+      delete iterator->second;
+   }
+   if(logStream != NULL) {
+      delete logStream;
+   }
+   return(0);
+}
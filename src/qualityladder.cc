@@ -0,0 +1,170 @@
+// ##########################################################################
+// ####                                                                  ####
+// ####                      RTP Audio Server Project                    ####
+// ####                    ============================                  ####
+// ####                                                                  ####
+// #### Quality Ladder                                                   ####
+// ####                                                                  ####
+// ####           Copyright (C) 1999-2026 by Thomas Dreibholz            ####
+// ####                                                                  ####
+// #### Contact:                                                         ####
+// ####    EMail: thomas.dreibholz@gmail.com                             ####
+// ####    WWW:   https://www.nntb.no/~dreibh/rtpaudio                   ####
+// ####                                                                  ####
+// #### ---------------------------------------------------------------- ####
+// ####                                                                  ####
+// #### This program is free software: you can redistribute it and/or    ####
+// #### modify it under the terms of the GNU General Public License as   ####
+// #### published by the Free Software Foundation, either version 3 of   ####
+// #### the License, or (at your option) any later version.              ####
+// ####                                                                  ####
+// #### This program is distributed in the hope that it will be useful,  ####
+// #### but WITHOUT ANY WARRANTY; without even the implied warranty of   ####
+// #### MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    ####
+// #### GNU General Public License for more details.                     ####
+// ####                                                                  ####
+// #### You should have received a copy of the GNU General Public        ####
+// #### License along with this program.  If not, see                    ####
+// #### <http://www.gnu.org/licenses/>.                                  ####
+// ####                                                                  ####
+// ##########################################################################
+
+
+#include "tdsystem.h"
+#include "qualityladder.h"
+
+
+
+// ###### Constructor #######################################################
+QualityLadder::QualityLadder(RequirementsFunction function,
+                             const cardinal       requirements,
+                             const cardinal       minSteps)
+{
+   Function                = function;
+   Requirements            = (requirements < MaxRequirements) ? requirements : MaxRequirements;
+   MinSteps                = minSteps;
+   NetworkQualityDecrement = 0;
+   HeaderSize              = 0;
+   MaxPacketSize           = 0;
+   Valid                   = false;
+   Decreasing              = false;
+   ResultValid             = false;
+   for(cardinal i = 0;i < MaxRequirements;i++) {
+      Limits[i] = 0;
+   }
+}
+
+
+// ###### Build ladder from given start quality #############################
+void QualityLadder::build(const AudioQuality& start,
+                          const cardinal      headerSize,
+                          const cardinal      maxPacketSize)
+{
+   Steps.clear();
+   AudioQuality quality = start;
+   for(;;) {
+      Step step;
+      step.Quality = quality;
+      for(cardinal i = 0;i < MaxRequirements;i++) {
+         step.Required[i] = 0;
+      }
+      Function(quality,headerSize,maxPacketSize,(card64*)&step.Required);
+      Steps.push_back(step);
+      if((quality.isLowest()) && (Steps.size() > MinSteps)) {
+         break;
+      }
+      quality--;
+   }
+
+   // ====== Check, if binary search is possible ============================
+   // The last step is the result if no other one fulfills the limits, so
+   // it does not matter here.
+   Decreasing = true;
+   for(cardinal i = 1;i + 1 < Steps.size();i++) {
+      for(cardinal j = 0;j < Requirements;j++) {
+         if(Steps[i].Required[j] > Steps[i - 1].Required[j]) {
+            Decreasing = false;
+         }
+      }
+   }
+}
+
+
+// ###### Check, if step fulfills limits ####################################
+bool QualityLadder::fulfills(const Step& step, const card64* limits) const
+{
+   for(cardinal i = 0;i < Requirements;i++) {
+      if(step.Required[i] > limits[i]) {
+         return(false);
+      }
+   }
+   return(true);
+}
+
+
+// ###### Find first step fulfilling limits #################################
+cardinal QualityLadder::findStep(const card64* limits) const
+{
+   const cardinal last = Steps.size() - 1;
+   if(Decreasing) {
+      cardinal low  = 0;
+      cardinal high = last;
+      while(low < high) {
+         const cardinal middle = (low + high) / 2;
+         if(fulfills(Steps[middle],limits)) {
+            high = middle;
+         }
+         else {
+            low = middle + 1;
+         }
+      }
+      return(low);
+   }
+   for(cardinal i = 0;i < last;i++) {
+      if(fulfills(Steps[i],limits)) {
+         return(i);
+      }
+   }
+   return(last);
+}
+
+
+// ###### Calculate quality for limits ######################################
+AudioQuality QualityLadder::getQualityForLimits(const AudioQualityInterface& userSetting,
+                                                const AudioQualityInterface& inputQuality,
+                                                const card64*                limits,
+                                                const cardinal               networkQualityDecrement,
+                                                const cardinal               headerSize,
+                                                const cardinal               maxPacketSize)
+{
+   // ====== Rebuild ladder, if necessary ===================================
+   if((!Valid) ||
+      (UserSetting != userSetting) || (InputQuality != inputQuality) ||
+      (NetworkQualityDecrement != networkQualityDecrement) ||
+      (HeaderSize != headerSize) || (MaxPacketSize != maxPacketSize)) {
+      UserSetting             = userSetting;
+      InputQuality            = inputQuality;
+      NetworkQualityDecrement = networkQualityDecrement;
+      HeaderSize              = headerSize;
+      MaxPacketSize           = maxPacketSize;
+
+      AudioQuality networkQuality = userSetting;
+      networkQuality.decrease(networkQualityDecrement);
+      build(networkQuality - inputQuality,headerSize,maxPacketSize);
+      Valid       = true;
+      ResultValid = false;
+   }
+
+   // ====== Look up quality, if limits have changed ========================
+   for(cardinal i = 0;i < Requirements;i++) {
+      if(Limits[i] != limits[i]) {
+         Limits[i]   = limits[i];
+         ResultValid = false;
+      }
+   }
+   if(!ResultValid) {
+      Result      = Steps[findStep(limits)].Quality;
+      ResultValid = true;
+   }
+   return(Result);
+}
@@ -0,0 +1,152 @@
+// ##########################################################################
+// ####                                                                  ####
+// ####                      RTP Audio Server Project                    ####
+// ####                    ============================                  ####
+// ####                                                                  ####
+// #### Quality Ladder                                                   ####
+// ####                                                                  ####
+// ####           Copyright (C) 1999-2026 by Thomas Dreibholz            ####
+// ####                                                                  ####
+// #### Contact:                                                         ####
+// ####    EMail: thomas.dreibholz@gmail.com                             ####
+// ####    WWW:   https://www.nntb.no/~dreibh/rtpaudio                   ####
+// ####                                                                  ####
+// #### ---------------------------------------------------------------- ####
+// ####                                                                  ####
+// #### This program is free software: you can redistribute it and/or    ####
+// #### modify it under the terms of the GNU General Public License as   ####
+// #### published by the Free Software Foundation, either version 3 of   ####
+// #### the License, or (at your option) any later version.              ####
+// ####                                                                  ####
+// #### This program is distributed in the hope that it will be useful,  ####
+// #### but WITHOUT ANY WARRANTY; without even the implied warranty of   ####
+// #### MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    ####
+// #### GNU General Public License for more details.                     ####
+// ####                                                                  ####
+// #### You should have received a copy of the GNU General Public        ####
+// #### License along with this program.  If not, see                    ####
+// #### <http://www.gnu.org/licenses/>.                                  ####
+// ####                                                                  ####
+// ##########################################################################
+
+
+#ifndef QUALITYLADDER_H
+#define QUALITYLADDER_H
+
+
+#include "tdsystem.h"
+#include "audioquality.h"
+
+#include <vector>
+
+
+/**
+  * This class is a precomputed quality ladder for the
+  * calculateQualityForLimits() functions of the audio packet formats.
+  * It holds the qualities reached by stepping down from a start quality,
+  * together with their byte rate requirements. The quality for given
+  * limits is the first step fulfilling them, found by binary search if
+  * the requirements decrease along the ladder. The ladder is rebuilt only
+  * when its start quality, header size or maximum packet size changes,
+  * the result is kept until one of the limits changes.
+  *
+  * @short   Quality Ladder
+  * @author  Thomas Dreibholz (thomas.dreibholz@gmail.com)
+  * @version 1.0
+  *
+  * @see AdvancedAudioPacket#calculateRequirements
+  * @see SimpleAudioPacket#calculateRequirements
+  */
+class QualityLadder
+{
+   // ====== Definitions ====================================================
+   public:
+   /**
+     * Maximum number of byte rate requirements per quality.
+     */
+   static const cardinal MaxRequirements = 4;
+
+   /**
+     * Function calculating the byte rate requirements of a quality.
+     *
+     * @param quality Quality.
+     * @param headerSize Header size (eg. IP + UDP + RTP).
+     * @param maxPacketSize Maximum packet size.
+     * @param required Array to store the requirements into.
+     */
+   typedef void (*RequirementsFunction)(const AudioQualityInterface& quality,
+                                        const cardinal               headerSize,
+                                        const cardinal               maxPacketSize,
+                                        card64*                      required);
+
+
+   // ====== Constructor ====================================================
+   /**
+     * Constructor.
+     *
+     * @param function Function calculating the requirements of a quality.
+     * @param requirements Number of requirements (at most MaxRequirements).
+     * @param minSteps Number of steps down taken even if the start quality is already the lowest one.
+     */
+   QualityLadder(RequirementsFunction function,
+                 const cardinal       requirements,
+                 const cardinal       minSteps = 0);
+
+
+   // ====== Quality calculation ============================================
+   /**
+     * Quality calculation for given user quality limited by input quality,
+     * byte rate limits and network quality decrement with given header size
+     * and maximum packet size. The result equals the one of the packet
+     * format's calculateQualityForLimits() function.
+     *
+     * @param userSetting User's quality setting.
+     * @param inputQuality Input source's quality.
+     * @param limits Byte rate limits, in the order of the requirements.
+     * @param networkQualityDecrement Number of steps for decrement of user's quality.
+     * @param headerSize Header size (eg. IP + UDP + RTP).
+     * @param maxPacketSize Maximum packet size.
+     * @return The calculated quality.
+     */
+   AudioQuality getQualityForLimits(const AudioQualityInterface& userSetting,
+                                    const AudioQualityInterface& inputQuality,
+                                    const card64*                limits,
+                                    const cardinal               networkQualityDecrement,
+                                    const cardinal               headerSize,
+                                    const cardinal               maxPacketSize);
+
+
+   // ====== Private data ===================================================
+   private:
+   struct Step {
+      AudioQuality Quality;
+      card64       Required[MaxRequirements];
+   };
+
+   void build(const AudioQuality& start,
+              const cardinal      headerSize,
+              const cardinal      maxPacketSize);
+   bool fulfills(const Step& step, const card64* limits) const;
+   cardinal findStep(const card64* limits) const;
+
+
+   RequirementsFunction Function;
+   cardinal             Requirements;
+   cardinal             MinSteps;
+
+   AudioQuality         UserSetting;
+   AudioQuality         InputQuality;
+   cardinal             NetworkQualityDecrement;
+   cardinal             HeaderSize;
+   cardinal             MaxPacketSize;
+   bool                 Valid;
+   std::vector<Step>    Steps;
+   bool                 Decreasing;
+
+   card64               Limits[MaxRequirements];
+   bool                 ResultValid;
+   AudioQuality         Result;
+};
+
+
+#endif
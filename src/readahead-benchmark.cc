@@ -0,0 +1,229 @@
+// ##########################################################################
+// ####                                                                  ####
+// ####                      RTP Audio Server Project                    ####
+// ####                    ============================                  ####
+// ####                                                                  ####
+// #### Media Read-Ahead Benchmark                                       ####
+// ####                                                                  ####
+// ####           Copyright (C) 1999-2026 by Thomas Dreibholz            ####
+// ####                                                                  ####
+// #### Contact:                                                         ####
+// ####    EMail: thomas.dreibholz@gmail.com                             ####
+// ####    WWW:   https://www.nntb.no/~dreibh/rtpaudio                   ####
+// ####                                                                  ####
+// #### ---------------------------------------------------------------- ####
+// ####                                                                  ####
+// #### This program is free software: you can redistribute it and/or    ####
+// #### modify it under the terms of the GNU General Public License as   ####
+// #### published by the Free Software Foundation, either version 3 of   ####
+// #### the License, or (at your option) any later version.              ####
+// ####                                                                  ####
+// #### This program is distributed in the hope that it will be useful,  ####
+// #### but WITHOUT ANY WARRANTY; without even the implied warranty of   ####
+// #### MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    ####
+// #### GNU General Public License for more details.                     ####
+// ####                                                                  ####
+// #### You should have received a copy of the GNU General Public        ####
+// #### License along with this program.  If not, see                    ####
+// #### <http://www.gnu.org/licenses/>.                                  ####
+// ####                                                                  ####
+// ##########################################################################
+
+
+#include "tdsystem.h"
+#include "tools.h"
+#include "wavaudioreader.h"
+#include "mp3audioreader.h"
+#include "soundreadahead.h"
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <vector>
+#include <algorithm>
+
+
+// ###### Drop a file from the page cache ###################################
+static void dropFromCache(const char* name)
+{
+   const int fd = open(name,O_RDONLY);
+   if(fd >= 0) {
+      fdatasync(fd);
+      posix_fadvise(fd,0,0,POSIX_FADV_DONTNEED);
+      close(fd);
+   }
+}
+
+
+// ###### Open a WAV or MP3 file ############################################
+static AudioReaderInterface* openReader(const char* name)
+{
+   WavAudioReader* wavReader = new WavAudioReader(name);
+   if(wavReader->ready()) {
+      return(wavReader);
+   }
+   delete wavReader;
+
+   MP3AudioReader* mp3Reader = new MP3AudioReader(name);
+   if(mp3Reader->ready()) {
+      return(mp3Reader);
+   }
+   delete mp3Reader;
+   return(NULL);
+}
+
+
+// ###### Get number of major page faults ###################################
+static long getMajorFaults()
+{
+   struct rusage usage;
+   if(getrusage(RUSAGE_SELF,&usage) == 0) {
+      return(usage.ru_majflt);
+   }
+   return(0);
+}
+
+
+// ###### Print usage and exit ##############################################
+static void usage(const char* program)
+{
+   std::cerr << "Usage: " << program << " {-readahead=requests} {-readers=count} {-blocksize=bytes} {-interval=microseconds} {-warm} [WAV or MP3 file] ..." << std::endl;
+   exit(1);
+}
+
+
+
+// ###### Main program ######################################################
+int main(int argc, char* argv[])
+{
+   // ====== Check arguments ================================================
+   cardinal readAheadRequests = 0;
+   cardinal readers           = 1;
+   cardinal blockSize         = 4096;
+   card64   interval          = 10000;
+   bool     cold              = true;
+   cardinal files             = 0;
+   for(cardinal i = 1;i < (cardinal)argc;i++) {
+      if(!(strncasecmp(argv[i],"-readahead=",11)))      readAheadRequests = (cardinal)atol(&argv[i][11]);
+      else if(!(strncasecmp(argv[i],"-readers=",9)))    readers           = std::max((cardinal)atol(&argv[i][9]),(cardinal)1);
+      else if(!(strncasecmp(argv[i],"-blocksize=",11))) blockSize         = std::max((cardinal)atol(&argv[i][11]),(cardinal)4);
+      else if(!(strncasecmp(argv[i],"-interval=",10)))  interval          = (card64)atoll(&argv[i][10]);
+      else if(!(strcasecmp(argv[i],"-warm")))           cold              = false;
+      else if(argv[i][0] == '-') {
+         usage(argv[0]);
+      }
+      else {
+         files++;
+      }
+   }
+   if(files == 0) {
+      usage(argv[0]);
+   }
+   blockSize -= (blockSize % 4);
+
+   if(readAheadRequests > 0) {
+      if(!Soundreadahead::start(readAheadRequests,128 * 1024)) {
+         std::cerr << "ERROR: io_uring is not available!" << std::endl;
+         exit(1);
+      }
+   }
+
+
+   // ====== Open readers ===================================================
+   // A file's readers start at evenly spread positions, like clients
+   // listening to different parts of the same title.
+   std::vector<AudioReaderInterface*> readerSet;
+   for(cardinal i = 1;i < (cardinal)argc;i++) {
+      if(argv[i][0] == '-') {
+         continue;
+      }
+      if(cold) {
+         dropFromCache(argv[i]);
+      }
+      for(cardinal r = 0;r < readers;r++) {
+         AudioReaderInterface* reader = openReader(argv[i]);
+         if(reader == NULL) {
+            std::cerr << "ERROR: Unable to open <" << argv[i] << ">!" << std::endl;
+            exit(1);
+         }
+         if(r > 0) {
+            reader->setPosition((reader->getMaxPosition() / readers) * r);
+         }
+         readerSet.push_back(reader);
+      }
+   }
+
+   std::cout << "Read-ahead: " << ((readAheadRequests > 0) ? "io_uring" : "kernel")
+             << ", page cache: " << (cold ? "cold" : "warm")
+             << ", readers: " << readerSet.size()
+             << ", block size: " << blockSize << " bytes"
+             << ", interval: " << interval << " us" << std::endl;
+
+
+   // ====== Read blocks in rounds, like the senders ========================
+   char*              buffer = new char[blockSize];
+   std::vector<card64> latencies;
+   const long         faults = getMajorFaults();
+   const card64       start  = getMicroTime();
+   card64             next   = start;
+   cardinal           active = readerSet.size();
+   while(active > 0) {
+      active = 0;
+      for(std::vector<AudioReaderInterface*>::iterator iterator = readerSet.begin();
+          iterator != readerSet.end();iterator++) {
+         if(*iterator == NULL) {
+            continue;
+         }
+         const card64   t0  = getMicroTime();
+         const cardinal got = (*iterator)->getNextBlock((void*)buffer,blockSize);
+         latencies.push_back(getMicroTime() - t0);
+         if(got < blockSize) {
+            delete *iterator;
+            *iterator = NULL;
+         }
+         else {
+            active++;
+         }
+      }
+
+      next += interval;
+      const card64 now = getMicroTime();
+      if(next > now) {
+         usleep((useconds_t)(next - now));
+      }
+   }
+   const card64 duration    = getMicroTime() - start;
+   const long   majorFaults = getMajorFaults() - faults;
+   delete [] buffer;
+   Soundreadahead::stop();
+
+
+   // ====== Print results ==================================================
+   std::sort(latencies.begin(),latencies.end());
+   card64   sum  = 0;
+   cardinal slow = 0;
+   for(std::vector<card64>::iterator iterator = latencies.begin();
+       iterator != latencies.end();iterator++) {
+      sum += *iterator;
+      if(*iterator >= 1000) {
+         slow++;
+      }
+   }
+   const size_t count = latencies.size();
+   if(count == 0) {
+      return(0);
+   }
+   char str[256];
+   snprintf((char*)&str,sizeof(str),
+            "Blocks: %u, mean: %1.1f us, median: %llu us, 99%%: %llu us, 99.9%%: %llu us, max: %llu us",
+            (unsigned int)count,(double)sum / (double)count,
+            (unsigned long long)latencies[count / 2],
+            (unsigned long long)latencies[(count * 99) / 100],
+            (unsigned long long)latencies[(count * 999) / 1000],
+            (unsigned long long)latencies[count - 1]);
+   std::cout << str << std::endl;
+   snprintf((char*)&str,sizeof(str),
+            "Blocks >= 1 ms: %u, major page faults: %ld, duration: %1.3f s",
+            slow,majorFaults,duration / 1000000.0);
+   std::cout << str << std::endl;
+   return(0);
+}
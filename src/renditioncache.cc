@@ -0,0 +1,393 @@
+// ##########################################################################
+// ####                                                                  ####
+// ####                      RTP Audio Server Project                    ####
+// ####                    ============================                  ####
+// ####                                                                  ####
+// #### PCM Rendition Cache                                              ####
+// ####                                                                  ####
+// ####           Copyright (C) 1999-2026 by Thomas Dreibholz            ####
+// ####                                                                  ####
+// #### Contact:                                                         ####
+// ####    EMail: thomas.dreibholz@gmail.com                             ####
+// ####    WWW:   https://www.nntb.no/~dreibh/rtpaudio                   ####
+// ####                                                                  ####
+// #### ---------------------------------------------------------------- ####
+// ####                                                                  ####
+// #### This program is free software: you can redistribute it and/or    ####
+// #### modify it under the terms of the GNU General Public License as   ####
+// #### published by the Free Software Foundation, either version 3 of   ####
+// #### the License, or (at your option) any later version.              ####
+// ####                                                                  ####
+// #### This program is distributed in the hope that it will be useful,  ####
+// #### but WITHOUT ANY WARRANTY; without even the implied warranty of   ####
+// #### MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    ####
+// #### GNU General Public License for more details.                     ####
+// ####                                                                  ####
+// #### You should have received a copy of the GNU General Public        ####
+// #### License along with this program.  If not, see                    ####
+// #### <http://www.gnu.org/licenses/>.                                  ####
+// ####                                                                  ####
+// ##########################################################################
+
+
+#include "tdsystem.h"
+#include "renditioncache.h"
+#include "renditionreader.h"
+#include "audioconverter.h"
+#include "wavaudioreader.h"
+#include "mp3audioreader.h"
+#ifdef HAVE_VORBISFILE
+#include "oggaudioreader.h"
+#endif
+
+#include <sys/stat.h>
+#include <vector>
+
+
+
+// ###### Quality ladder ####################################################
+const AudioQuality RenditionCache::LadderTable[] = {
+   AudioQuality(44100,16,2,BYTE_ORDER),
+   AudioQuality(35280,16,2,BYTE_ORDER),
+   AudioQuality(22050,12,2,BYTE_ORDER),
+   AudioQuality(11025,8,2,BYTE_ORDER),
+   AudioQuality(8820,8,1,BYTE_ORDER),
+   AudioQuality(4410,4,1,BYTE_ORDER)
+};
+const cardinal RenditionCache::LadderLevels =
+   sizeof(RenditionCache::LadderTable) / sizeof(AudioQuality);
+
+
+// Alignment of the renditions' PCM data in the rendition file
+static const card64 RenditionAlignment = 4096;
+
+
+// ###### Constructor #######################################################
+RenditionCache::RenditionCache(const char* directory)
+   : Thread("RenditionCache"),
+     UpdateRequested("RenditionCache::UpdateRequested")
+{
+   Directory = directory;
+   Running   = false;
+
+   struct stat status;
+   if((stat(directory,&status) != 0) || (!S_ISDIR(status.st_mode)) ||
+      (access(directory,W_OK) != 0)) {
+      std::cerr << "WARNING: RenditionCache::RenditionCache() - Unable to use directory <"
+                << directory << ">!" << std::endl;
+      return;
+   }
+   Running = true;
+   if(start() == false) {
+      Running = false;
+   }
+}
+
+
+// ###### Destructor ########################################################
+RenditionCache::~RenditionCache()
+{
+   synchronized();
+   const bool running = Running;
+   Running = false;
+   unsynchronized();
+   if(running) {
+      UpdateRequested.broadcast();
+      join();
+   }
+}
+
+
+// ###### Get rendition file name ###########################################
+String RenditionCache::getRenditionFileName(const char* source) const
+{
+   // ====== Hash the canonical source name (FNV-1a) ========================
+   char*       canonical = realpath(source,NULL);
+   const char* name      = (canonical != NULL) ? canonical : source;
+   card64      hash      = 14695981039346656037ULL;
+   for(const char* c = name;*c != 0x00;c++) {
+      hash = (hash ^ (card8)*c) * 1099511628211ULL;
+   }
+   free(canonical);
+
+   char str[32];
+   snprintf((char*)&str,sizeof(str),"/%016llx.rendition",(unsigned long long)hash);
+   return(Directory + String((char*)&str));
+}
+
+
+// ###### Read header of rendition file #####################################
+static bool readRenditionFileHeader(const char* name, RenditionFileHeader& header)
+{
+   FILE* inputFD = fopen(name,"r");
+   if(inputFD == NULL) {
+      return(false);
+   }
+   const bool ok = (fread((void*)&header,sizeof(header),1,inputFD) == 1) &&
+                   (!strncmp(header.ID,"RTPAREND",8)) &&
+                   (header.Version == 1) &&
+                   (header.ByteOrder == BYTE_ORDER);
+   fclose(inputFD);
+   return(ok);
+}
+
+
+// ###### Open renditions of source file ####################################
+RenditionReader* RenditionCache::openRenditions(const char* source)
+{
+   if(!Running) {
+      return(NULL);
+   }
+   struct stat status;
+   char*       canonical = realpath(source,NULL);
+   if((canonical == NULL) || (stat(canonical,&status) != 0)) {
+      free(canonical);
+      return(NULL);
+   }
+
+   // ====== Check, if rendition file is up to date =========================
+   const String        name = getRenditionFileName(canonical);
+   RenditionFileHeader header;
+   const bool upToDate = (readRenditionFileHeader(name.getData(),header)) &&
+                         (header.SourceSize     == (card64)status.st_size) &&
+                         (header.SourceModified == (card64)status.st_mtime) &&
+                         (!strncmp(header.Source,canonical,sizeof(header.Source)));
+   free(canonical);
+   if(!upToDate) {
+      update(source);
+      return(NULL);
+   }
+
+   // ====== Open renditions, if there are any for this source ==============
+   if(header.Renditions > 0) {
+      RenditionReader* reader = new RenditionReader(name.getData());
+      if(reader->ready()) {
+         return(reader);
+      }
+      delete reader;
+   }
+   return(NULL);
+}
+
+
+// ###### Schedule creation of rendition file ###############################
+void RenditionCache::update(const char* source)
+{
+   synchronized();
+   const String name(source);
+   if(Queued.find(name) == Queued.end()) {
+      Queued.insert(name);
+      Queue.push_back(name);
+   }
+   unsynchronized();
+   UpdateRequested.signal();
+}
+
+
+// ###### Cache thread ######################################################
+void RenditionCache::run()
+{
+   for(;;) {
+      synchronized();
+      if(!Running) {
+         unsynchronized();
+         break;
+      }
+      if(Queue.empty()) {
+         unsynchronized();
+         UpdateRequested.timedWait(1000000);
+         continue;
+      }
+      const String source = Queue.front();
+      Queue.pop_front();
+      unsynchronized();
+
+      const String name = getRenditionFileName(source.getData());
+      if(createRenditionFile(source.getData(),name.getData())) {
+         std::cout << "Created renditions of <" << source << "> in <" << name << ">" << std::endl;
+      }
+
+      synchronized();
+      Queued.erase(source);
+      unsynchronized();
+   }
+}
+
+
+// ###### Create rendition file #############################################
+bool RenditionCache::createRenditionFile(const char* source, const char* name)
+{
+   // ====== Open source ====================================================
+   struct stat status;
+   char*       canonical = realpath(source,NULL);
+   if((canonical == NULL) || (stat(canonical,&status) != 0)) {
+      free(canonical);
+      return(false);
+   }
+   RenditionFileHeader header;
+   memset((void*)&header,0,sizeof(header));
+   memcpy((void*)&header.ID,"RTPAREND",8);
+   header.Version        = 1;
+   header.ByteOrder      = BYTE_ORDER;
+   header.SourceSize     = (card64)status.st_size;
+   header.SourceModified = (card64)status.st_mtime;
+   snprintf((char*)&header.Source,sizeof(header.Source),"%s",canonical);
+   free(canonical);
+
+   bool                  isWav  = true;
+   AudioReaderInterface* reader = new WavAudioReader(source);
+   if(!reader->ready()) {
+      delete reader;
+      isWav  = false;
+#ifdef HAVE_VORBISFILE
+      reader = new OggAudioReader(source);
+      if(!reader->ready()) {
+         delete reader;
+         reader = new MP3AudioReader(source);
+      }
+#else
+      reader = new MP3AudioReader(source);
+#endif
+      if(!reader->ready()) {
+         // Not a supported file: an empty rendition file marks it as done.
+         delete reader;
+         reader = NULL;
+      }
+   }
+
+   // ====== Choose ladder levels ===========================================
+   // A WAV file is served from its own PCM data, an MP3 or Ogg Vorbis file
+   // gets an additional rendition in its own quality to save the decoding.
+   std::vector<AudioQuality> levels;
+   AudioQuality              sourceQuality;
+   if(reader != NULL) {
+      sourceQuality = AudioQuality(*reader);
+      if(!isWav) {
+         levels.push_back(AudioQuality(sourceQuality.getSamplingRate(),
+                                       sourceQuality.getBits(),
+                                       sourceQuality.getChannels(),BYTE_ORDER));
+      }
+      for(cardinal i = 0;i < LadderLevels;i++) {
+         const AudioQuality& level = LadderTable[i];
+         cardinal a, b;
+         float    c;
+         if((level.getSamplingRate() <= sourceQuality.getSamplingRate()) &&
+            (level.getBits()         <= sourceQuality.getBits())         &&
+            (level.getChannels()     <= sourceQuality.getChannels())     &&
+            (getConvParams(sourceQuality.getSamplingRate(),level.getSamplingRate(),a,b,c)) &&
+            ((level.getSamplingRate() != sourceQuality.getSamplingRate()) ||
+             (level.getBits()         != sourceQuality.getBits())         ||
+             (level.getChannels()     != sourceQuality.getChannels()))) {
+            levels.push_back(level);
+         }
+      }
+   }
+   header.Renditions = levels.size();
+
+   // ====== Decode and convert source ======================================
+   // Each rendition is written into a temporary file first, blocks of
+   // 1/5 s are converted like frames by the encoders.
+   std::vector<RenditionFileEntry> entries(levels.size());
+   std::vector<FILE*>              tempFiles(levels.size(),(FILE*)NULL);
+   bool ok = true;
+   for(cardinal i = 0;i < levels.size();i++) {
+      memset((void*)&entries[i],0,sizeof(RenditionFileEntry));
+      entries[i].SamplingRate = levels[i].getSamplingRate();
+      entries[i].Bits         = levels[i].getBits();
+      entries[i].Channels     = levels[i].getChannels();
+      entries[i].ByteOrder    = levels[i].getByteOrder();
+      tempFiles[i] = tmpfile();
+      if(tempFiles[i] == NULL) {
+         ok = false;
+      }
+   }
+   if((ok) && (levels.size() > 0)) {
+      const cardinal blockSize = getAlignedLength(sourceQuality,sourceQuality,
+                                                  sourceQuality.getBytesPerSecond() / 5);
+      card8* input  = new card8[blockSize];
+      card8* output = new card8[blockSize];
+      for(;;) {
+         synchronized();
+         const bool running = Running;
+         unsynchronized();
+         if(!running) {
+            ok = false;
+            break;
+         }
+
+         const cardinal length = getAlignedLength(sourceQuality,sourceQuality,
+                                                  reader->getNextBlock((void*)input,blockSize));
+         if(length == 0) {
+            break;
+         }
+         for(cardinal i = 0;i < levels.size();i++) {
+            const cardinal converted = AudioConverter(sourceQuality,levels[i],
+                                                      input,output,length,blockSize);
+            if(fwrite((void*)output,converted,1,tempFiles[i]) != 1) {
+               ok = false;
+            }
+            entries[i].Length += converted;
+         }
+         if((!ok) || (length < blockSize)) {
+            break;
+         }
+      }
+      delete [] input;
+      delete [] output;
+   }
+   delete reader;
+
+   // ====== Write rendition file ===========================================
+   // It is written under a temporary name and renamed, so that readers
+   // never see a partial file. Readers of a previous version keep their
+   // mapping of the old file.
+   const String tempName = String(name) + String(".tmp");
+   FILE*        outputFD = (ok) ? fopen(tempName.getData(),"w") : NULL;
+   if(outputFD != NULL) {
+      card64 offset = sizeof(RenditionFileHeader) + levels.size() * sizeof(RenditionFileEntry);
+      for(cardinal i = 0;i < levels.size();i++) {
+         offset = (offset + RenditionAlignment - 1) & ~(RenditionAlignment - 1);
+         entries[i].Offset = offset;
+         offset += entries[i].Length;
+      }
+      ok = (fwrite((void*)&header,sizeof(header),1,outputFD) == 1);
+      for(cardinal i = 0;(ok) && (i < levels.size());i++) {
+         ok = (fwrite((void*)&entries[i],sizeof(RenditionFileEntry),1,outputFD) == 1);
+      }
+      for(cardinal i = 0;(ok) && (i < levels.size());i++) {
+         ok = (fseek(outputFD,(long)entries[i].Offset,SEEK_SET) == 0);
+         rewind(tempFiles[i]);
+         char   buffer[65536];
+         size_t bytes;
+         while((ok) && ((bytes = fread((void*)&buffer,1,sizeof(buffer),tempFiles[i])) > 0)) {
+            ok = (fwrite((void*)&buffer,bytes,1,outputFD) == 1);
+         }
+      }
+      ok = (fclose(outputFD) == 0) && (ok);
+
+      // ====== Discard result, if source has been changed meanwhile =======
+      struct stat newStatus;
+      if((ok) &&
+         (stat(source,&newStatus) == 0) &&
+         ((card64)newStatus.st_size  == header.SourceSize) &&
+         ((card64)newStatus.st_mtime == header.SourceModified)) {
+         ok = (rename(tempName.getData(),name) == 0);
+      }
+      else {
+         ok = false;
+      }
+      if(!ok) {
+         unlink(tempName.getData());
+      }
+   }
+   else {
+      ok = false;
+   }
+
+   for(cardinal i = 0;i < levels.size();i++) {
+      if(tempFiles[i] != NULL) {
+         fclose(tempFiles[i]);
+      }
+   }
+   return(ok);
+}
@@ -0,0 +1,167 @@
+// ##########################################################################
+// ####                                                                  ####
+// ####                      RTP Audio Server Project                    ####
+// ####                    ============================                  ####
+// ####                                                                  ####
+// #### PCM Rendition Cache                                              ####
+// ####                                                                  ####
+// ####           Copyright (C) 1999-2026 by Thomas Dreibholz            ####
+// ####                                                                  ####
+// #### Contact:                                                         ####
+// ####    EMail: thomas.dreibholz@gmail.com                             ####
+// ####    WWW:   https://www.nntb.no/~dreibh/rtpaudio                   ####
+// ####                                                                  ####
+// #### ---------------------------------------------------------------- ####
+// ####                                                                  ####
+// #### This program is free software: you can redistribute it and/or    ####
+// #### modify it under the terms of the GNU General Public License as   ####
+// #### published by the Free Software Foundation, either version 3 of   ####
+// #### the License, or (at your option) any later version.              ####
+// ####                                                                  ####
+// #### This program is distributed in the hope that it will be useful,  ####
+// #### but WITHOUT ANY WARRANTY; without even the implied warranty of   ####
+// #### MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    ####
+// #### GNU General Public License for more details.                     ####
+// ####                                                                  ####
+// #### You should have received a copy of the GNU General Public        ####
+// #### License along with this program.  If not, see                    ####
+// #### <http://www.gnu.org/licenses/>.                                  ####
+// ####                                                                  ####
+// ##########################################################################
+
+
+#ifndef RENDITIONCACHE_H
+#define RENDITIONCACHE_H
+
+
+#include "tdsystem.h"
+#include "thread.h"
+#include "condition.h"
+#include "audioquality.h"
+#include "tdstrings.h"
+
+#include <deque>
+#include <set>
+
+
+class RenditionReader;
+
+
+/**
+  * This class manages a directory of rendition files. A rendition file
+  * holds a title pre-decoded and converted to the standard quality levels
+  * of the ladder, so that readers may serve these qualities without
+  * decoding and conversion. Missing or outdated rendition files are created
+  * by the cache's thread in the background; a rendition file is outdated
+  * when the size or modification time of its source has changed.
+  *
+  * @short   PCM Rendition Cache
+  * @author  Thomas Dreibholz (thomas.dreibholz@gmail.com)
+  * @version 1.0
+  *
+  * @see RenditionReader
+  * @see MultiAudioReader#setRenditionCache
+  */
+class RenditionCache : public Thread
+{
+   // ====== Constructor/Destructor =========================================
+   public:
+   /**
+     * Constructor.
+     *
+     * @param directory Directory for the rendition files.
+     */
+   RenditionCache(const char* directory);
+
+   /**
+     * Destructor.
+     */
+   ~RenditionCache();
+
+
+   // ====== Status functions ===============================================
+   /**
+     * Check, if the cache directory is usable and the thread is running.
+     *
+     * @return true, if cache is ready; false otherwise.
+     */
+   inline bool ready() const;
+
+   /**
+     * Get cache directory.
+     *
+     * @return Directory.
+     */
+   inline const String& getDirectory() const;
+
+
+   // ====== Renditions =====================================================
+   /**
+     * Open the renditions of a source file. If there is no up-to-date
+     * rendition file, its creation is scheduled and NULL is returned.
+     *
+     * @param source Name of the source file.
+     * @return RenditionReader (to be deleted by the caller) or NULL.
+     */
+   RenditionReader* openRenditions(const char* source);
+
+   /**
+     * Schedule creation of the rendition file for a source file.
+     *
+     * @param source Name of the source file.
+     */
+   void update(const char* source);
+
+   /**
+     * Get name of the rendition file for a source file.
+     *
+     * @param source Name of the source file.
+     * @return Name of the rendition file.
+     */
+   String getRenditionFileName(const char* source) const;
+
+   /**
+     * Create rendition file for a source file. Renditions are created for
+     * all ladder levels not exceeding the source's quality. The creation
+     * is aborted when the cache is deleted.
+     *
+     * @param source Name of the source file.
+     * @param name Name of the rendition file.
+     * @return true, if the file has been created; false otherwise.
+     */
+   bool createRenditionFile(const char* source, const char* name);
+
+
+   // ====== Constants ======================================================
+   /**
+     * Quality levels of the ladder, from highest to lowest. All levels are
+     * steps of AudioQuality's operator--, so each quality reached by
+     * decreasing is covered by the next higher level.
+     */
+   static const AudioQuality LadderTable[];
+
+   /**
+     * Number of quality levels in LadderTable.
+     */
+   static const cardinal LadderLevels;
+
+
+   // ====== Protected data =================================================
+   protected:
+   void run();
+
+
+   // ====== Private data ===================================================
+   private:
+   String                 Directory;
+   std::deque<String>     Queue;
+   std::set<String>       Queued;
+   Condition              UpdateRequested;
+   bool                   Running;
+};
+
+
+#include "renditioncache.icc"
+
+
+#endif
@@ -0,0 +1,315 @@
+// ##########################################################################
+// ####                                                                  ####
+// ####                      RTP Audio Server Project                    ####
+// ####                    ============================                  ####
+// ####                                                                  ####
+// #### PCM Rendition Reader                                             ####
+// ####                                                                  ####
+// ####           Copyright (C) 1999-2026 by Thomas Dreibholz            ####
+// ####                                                                  ####
+// #### Contact:                                                         ####
+// ####    EMail: thomas.dreibholz@gmail.com                             ####
+// ####    WWW:   https://www.nntb.no/~dreibh/rtpaudio                   ####
+// ####                                                                  ####
+// #### ---------------------------------------------------------------- ####
+// ####                                                                  ####
+// #### This program is free software: you can redistribute it and/or    ####
+// #### modify it under the terms of the GNU General Public License as   ####
+// #### published by the Free Software Foundation, either version 3 of   ####
+// #### the License, or (at your option) any later version.              ####
+// ####                                                                  ####
+// #### This program is distributed in the hope that it will be useful,  ####
+// #### but WITHOUT ANY WARRANTY; without even the implied warranty of   ####
+// #### MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    ####
+// #### GNU General Public License for more details.                     ####
+// ####                                                                  ####
+// #### You should have received a copy of the GNU General Public        ####
+// #### License along with this program.  If not, see                    ####
+// #### <http://www.gnu.org/licenses/>.                                  ####
+// ####                                                                  ####
+// ##########################################################################
+
+
+#include "tdsystem.h"
+#include "renditionreader.h"
+#include "soundfilemapping.h"
+
+
+
+// Minimum size of a read-ahead request and how far read-ahead reaches
+static const card64 ReadAheadStep   = 256 * 1024;
+static const card64 ReadAheadWindow = 1024 * 1024;
+
+
+// ###### Get number of bytes holding a whole number of samples #############
+static cardinal getSampleAlignment(const AudioQualityInterface& quality)
+{
+   switch(quality.getBits()) {
+      case 4:
+         return((quality.getChannels() > 1) ? 2 : 1);
+      case 12:
+         return((quality.getChannels() > 1) ? 6 : 3);
+      case 16:
+         return(2 * quality.getChannels());
+   }
+   return(quality.getChannels());
+}
+
+
+// ###### Constructor #######################################################
+RenditionReader::RenditionReader(const char* name)
+   : AudioQuality(0,0,0,LITTLE_ENDIAN)
+{
+   Error             = ME_NoMedia;
+   Mapping           = NULL;
+   Header            = NULL;
+   Entries           = NULL;
+   Rendition         = NULL;
+   Data              = NULL;
+   Position          = 0;
+   MaxPosition       = 0;
+   ReadAheadPosition = 0;
+   if(name != NULL) openMedia(name);
+}
+
+
+// ###### Destructor ########################################################
+RenditionReader::~RenditionReader()
+{
+   closeMedia();
+}
+
+
+// ###### Close file ########################################################
+void RenditionReader::closeMedia()
+{
+   if(Mapping != NULL) {
+      Soundfilemapping::detach(Mapping);
+      Mapping = NULL;
+   }
+   Error             = ME_NoMedia;
+   Header            = NULL;
+   Entries           = NULL;
+   Rendition         = NULL;
+   Data              = NULL;
+   Position          = 0;
+   MaxPosition       = 0;
+   ReadAheadPosition = 0;
+   setSamplingRate(0);
+   setBits(0);
+   setChannels(0);
+}
+
+
+// ###### Open new file #####################################################
+bool RenditionReader::openMedia(const char* name)
+{
+   closeMedia();
+   Error = ME_BadMedia;
+   Mapping = Soundfilemapping::attach(name);
+   if(Mapping == NULL) {
+      return(false);
+   }
+
+   // ====== Check header ===================================================
+   const card8* data = Mapping->getdata();
+   const size_t size = Mapping->getsize();
+   const RenditionFileHeader* header = (const RenditionFileHeader*)data;
+   if((size < sizeof(RenditionFileHeader)) ||
+      (strncmp(header->ID,"RTPAREND",8)) ||
+      (header->Version != 1) ||
+      (header->ByteOrder != BYTE_ORDER) ||
+      (header->Renditions < 1) ||
+      (sizeof(RenditionFileHeader) + header->Renditions * sizeof(RenditionFileEntry) > size)) {
+      std::cerr << "WARNING: RenditionReader::openMedia() - Bad rendition file <"
+                << name << ">!" << std::endl;
+      return(false);
+   }
+   const RenditionFileEntry* entries =
+      (const RenditionFileEntry*)(data + sizeof(RenditionFileHeader));
+   for(cardinal i = 0;i < header->Renditions;i++) {
+      if((entries[i].Offset > size) || (entries[i].Length > size - entries[i].Offset) ||
+         (AudioQuality(entries[i].SamplingRate,entries[i].Bits,entries[i].Channels).getBytesPerSecond() == 0)) {
+         std::cerr << "WARNING: RenditionReader::openMedia() - Bad rendition in file <"
+                   << name << ">!" << std::endl;
+         return(false);
+      }
+   }
+
+   Header  = header;
+   Entries = entries;
+   useRendition(&Entries[0]);
+   Error = ME_NoError;
+   return(true);
+}
+
+
+// ###### Get RenditionReader status ########################################
+bool RenditionReader::ready() const
+{
+   return((Error == ME_NoError));
+}
+
+
+// ###### Find smallest rendition of at least the given quality #############
+const RenditionFileEntry* RenditionReader::findRendition(
+                             const AudioQualityInterface& quality) const
+{
+   const RenditionFileEntry* found = NULL;
+   cardinal                  bps   = 0;
+   if(Header != NULL) {
+      for(cardinal i = 0;i < Header->Renditions;i++) {
+         const AudioQuality candidate(Entries[i].SamplingRate,Entries[i].Bits,Entries[i].Channels);
+         if((candidate.getSamplingRate() >= quality.getSamplingRate()) &&
+            (candidate.getBits()         >= quality.getBits())         &&
+            (candidate.getChannels()     >= quality.getChannels())     &&
+            ((found == NULL) || (candidate.getBytesPerSecond() < bps))) {
+            found = &Entries[i];
+            bps   = candidate.getBytesPerSecond();
+         }
+      }
+   }
+   return(found);
+}
+
+
+// ###### Check, if there is a rendition for the given quality ##############
+bool RenditionReader::hasQuality(const AudioQualityInterface& quality) const
+{
+   return(findRendition(quality) != NULL);
+}
+
+
+// ###### Switch to another rendition, keeping the position #################
+void RenditionReader::useRendition(const RenditionFileEntry* entry)
+{
+   if(entry != Rendition) {
+      const card64 position = getPosition();
+      Rendition = entry;
+      Data      = Mapping->getdata() + entry->Offset;
+      setSamplingRate(entry->SamplingRate);
+      setBits(entry->Bits);
+      setChannels(entry->Channels);
+      setByteOrder((card16)entry->ByteOrder);
+      // The alignment is the one of the new rendition's quality.
+      MaxPosition = entry->Length - (entry->Length % getSampleAlignment(*this));
+      setPosition(position);
+   }
+}
+
+
+// ###### Select rendition ##################################################
+AudioQuality RenditionReader::selectQuality(const AudioQualityInterface& quality)
+{
+   const RenditionFileEntry* entry = findRendition(quality);
+   if(entry != NULL) {
+      useRendition(entry);
+   }
+   AudioQuality result(*this);
+   // Byte order only matters for 16-bit samples
+   if(getBits() != 16) {
+      result.setByteOrder(quality.getByteOrder());
+   }
+   return(result);
+}
+
+
+// ###### Get maximum position ##############################################
+card64 RenditionReader::getMaxPosition() const
+{
+   const cardinal bps = getBytesPerSecond();
+   if(bps > 0)
+      return( ((MaxPosition * 1000) / (card64)bps) * (PositionStepsPerSecond / 1000) ) ;
+   else
+      return(0);
+}
+
+
+// ###### Get media info ###################################################
+void RenditionReader::getMediaInfo(MediaInfo& mediaInfo) const
+{
+   mediaInfo.reset();
+   mediaInfo.StartTimeStamp = 0;
+   mediaInfo.EndTimeStamp   = getMaxPosition();
+   strcpy((char*)&mediaInfo.Title,"Untitled");
+   strcpy((char*)&mediaInfo.Artist,"Unknown");
+   strcpy((char*)&mediaInfo.Comment,"PCM Rendition");
+}
+
+
+// ###### Get error code ###################################################
+MediaError RenditionReader::getErrorCode() const
+{
+   return(Error);
+}
+
+
+// ###### Get position ######################################################
+card64 RenditionReader::getPosition() const
+{
+   const cardinal bps = getBytesPerSecond();
+   if(bps > 0)
+      return( ((Position * 1000) / (card64)bps) * (PositionStepsPerSecond / 1000) ) ;
+   else
+      return(0);
+}
+
+
+// ###### Set position ######################################################
+void RenditionReader::setPosition(const card64 position)
+{
+   if((Rendition != NULL) && (Error < ME_UnrecoverableError)) {
+      Position = ((position / (PositionStepsPerSecond / 1000)) * getBytesPerSecond()) / 1000;
+      Position = std::min(Position,MaxPosition);
+
+      // Avoid misaligned position!
+      Position -= (Position % getSampleAlignment(*this));
+
+      ReadAheadPosition = 0;
+      if(Error == ME_EOF) {
+         Error = ME_NoError;
+      }
+   }
+}
+
+
+// ###### Get view of next block in mapped file #############################
+const void* RenditionReader::getNextBlockView(const cardinal blockSize)
+{
+   if((Rendition != NULL) && (Error < ME_UnrecoverableError)) {
+      if(Position + blockSize <= MaxPosition) {
+         const card64 offset = Rendition->Offset + Position;
+         if(ReadAheadPosition + ReadAheadStep < offset + ReadAheadWindow) {
+            const card64 from = std::max(ReadAheadPosition,offset);
+            Mapping->readahead(from,offset + ReadAheadWindow - from);
+            ReadAheadPosition = offset + ReadAheadWindow;
+         }
+         const card8* data = Data + Position;
+         Position += blockSize;
+         return((const void*)data);
+      }
+      else {
+         Error = ME_EOF;
+      }
+   }
+   return(NULL);
+}
+
+
+// ###### Read block from file ##############################################
+cardinal RenditionReader::getNextBlock(void* buffer, const cardinal blockSize)
+{
+   if((Rendition != NULL) && (Error < ME_UnrecoverableError)) {
+      // At the end of the rendition, the remaining samples are delivered.
+      const cardinal length = (cardinal)std::min((card64)blockSize,MaxPosition - Position);
+      const void*    data   = getNextBlockView(length);
+      if(data != NULL) {
+         memcpy(buffer,data,length);
+         if(length < blockSize) {
+            Error = ME_EOF;
+         }
+         return(length);
+      }
+   }
+   return(0);
+}
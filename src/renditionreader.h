@@ -0,0 +1,229 @@
+// ##########################################################################
+// ####                                                                  ####
+// ####                      RTP Audio Server Project                    ####
+// ####                    ============================                  ####
+// ####                                                                  ####
+// #### PCM Rendition Reader                                             ####
+// ####                                                                  ####
+// ####           Copyright (C) 1999-2026 by Thomas Dreibholz            ####
+// ####                                                                  ####
+// #### Contact:                                                         ####
+// ####    EMail: thomas.dreibholz@gmail.com                             ####
+// ####    WWW:   https://www.nntb.no/~dreibh/rtpaudio                   ####
+// ####                                                                  ####
+// #### ---------------------------------------------------------------- ####
+// ####                                                                  ####
+// #### This program is free software: you can redistribute it and/or    ####
+// #### modify it under the terms of the GNU General Public License as   ####
+// #### published by the Free Software Foundation, either version 3 of   ####
+// #### the License, or (at your option) any later version.              ####
+// ####                                                                  ####
+// #### This program is distributed in the hope that it will be useful,  ####
+// #### but WITHOUT ANY WARRANTY; without even the implied warranty of   ####
+// #### MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    ####
+// #### GNU General Public License for more details.                     ####
+// ####                                                                  ####
+// #### You should have received a copy of the GNU General Public        ####
+// #### License along with this program.  If not, see                    ####
+// #### <http://www.gnu.org/licenses/>.                                  ####
+// ####                                                                  ####
+// ##########################################################################
+
+
+#ifndef RENDITIONREADER_H
+#define RENDITIONREADER_H
+
+
+#include "tdsystem.h"
+#include "audioreaderinterface.h"
+#include "audioquality.h"
+
+
+class Soundfilemapping;
+
+
+/**
+  * Header of a rendition file. A rendition file contains a title decoded
+  * and converted to several audio qualities. The header is followed by
+  * RenditionFileEntry structures, one for each rendition. The renditions'
+  * PCM data follows, each one starting at a page boundary. The structures
+  * are stored in host byte order, the file is a cache for the local host
+  * only.
+  */
+struct RenditionFileHeader
+{
+   char   ID[8];
+   card32 Version;
+   card32 ByteOrder;
+   card32 Renditions;
+   card32 Reserved;
+   card64 SourceSize;
+   card64 SourceModified;
+   char   Source[1024];
+};
+
+
+/**
+  * Description of one rendition in a rendition file.
+  */
+struct RenditionFileEntry
+{
+   card16 SamplingRate;
+   card8  Bits;
+   card8  Channels;
+   card32 ByteOrder;
+   card64 Offset;
+   card64 Length;
+};
+
+
+/**
+  * This class is a reader for rendition files created by RenditionCache.
+  * It reads the rendition selected by selectQuality() straight from the
+  * memory mapped file; the position is kept when switching renditions.
+  *
+  * @short   PCM Rendition Reader
+  * @author  Thomas Dreibholz (thomas.dreibholz@gmail.com)
+  * @version 1.0
+  *
+  * @see RenditionCache
+  */
+class RenditionReader : virtual public AudioReaderInterface,
+                        public AudioQuality
+{
+   // ====== Constructor/Destructor =========================================
+   public:
+   /**
+     * Constructor.
+     *
+     * @param name Name of rendition file or NULL.
+     */
+   RenditionReader(const char* name = NULL);
+
+   /**
+     * Destructor.
+     */
+   ~RenditionReader();
+
+
+   // ====== Initialize =====================================================
+   /**
+     * openMedia() implementation of AudioReaderInterface.
+     *
+     * @see AudioReaderInterface#openMedia
+     */
+   bool openMedia(const char* name);
+
+   /**
+     * closeMedia() implementation of AudioReaderInterface.
+     *
+     * @see AudioReaderInterface#closeMedia
+     */
+   void closeMedia();
+
+   /**
+     * ready() implementation of AudioReaderInterface.
+     *
+     * @see AudioReaderInterface#ready
+     */
+   bool ready() const;
+
+
+   // ====== Rendition information ==========================================
+   /**
+     * Get header of the rendition file.
+     *
+     * @return Header or NULL, if no file is opened.
+     */
+   inline const RenditionFileHeader* getHeader() const;
+
+   /**
+     * Check, if there is a rendition of at least the given quality.
+     *
+     * @param quality Quality.
+     * @return true, if there is such a rendition; false otherwise.
+     */
+   bool hasQuality(const AudioQualityInterface& quality) const;
+
+
+   // ====== Input functions ================================================
+   /**
+     * getMediaInfo() implementation of AudioReaderInterface.
+     *
+     * @see AudioReaderInterface#getMediaInfo
+     */
+   void getMediaInfo(MediaInfo& mediaInfo) const;
+
+   /**
+     * getErrorCode() implementation of AudioReaderInterface.
+     *
+     * @see AudioReaderInterface#getErrorCode
+     */
+   MediaError getErrorCode() const;
+
+   /**
+     * getPosition() implementation of AudioReaderInterface.
+     *
+     * @see AudioReaderInterface#getPosition
+     */
+   card64 getPosition() const;
+
+   /**
+     * getMaxPosition() implementation of AudioReaderInterface.
+     *
+     * @see AudioReaderInterface#getMaxPosition
+     */
+   card64 getMaxPosition() const;
+
+   /**
+     * setPosition() implementation of AudioReaderInterface.
+     *
+     * @see AudioReaderInterface#setPosition
+     */
+   void setPosition(const card64 position);
+
+   /**
+     * getNextBlock() implementation of AudioReaderInterface.
+     *
+     * @see AudioReaderInterface#getNextBlock
+     */
+   cardinal getNextBlock(void* buffer, const cardinal blockSize);
+
+   /**
+     * getNextBlockView() implementation of AudioReaderInterface.
+     *
+     * @see AudioReaderInterface#getNextBlockView
+     */
+   const void* getNextBlockView(const cardinal blockSize);
+
+   /**
+     * selectQuality() implementation of AudioReaderInterface. The smallest
+     * rendition having at least the requested quality is selected.
+     *
+     * @see AudioReaderInterface#selectQuality
+     */
+   AudioQuality selectQuality(const AudioQualityInterface& quality);
+
+
+   // ====== Private data ===================================================
+   private:
+   const RenditionFileEntry* findRendition(const AudioQualityInterface& quality) const;
+   void useRendition(const RenditionFileEntry* entry);
+
+
+   MediaError                 Error;
+   Soundfilemapping*          Mapping;
+   const RenditionFileHeader* Header;
+   const RenditionFileEntry*  Entries;
+   const RenditionFileEntry*  Rendition;
+   const card8*               Data;
+   card64                     Position;
+   card64                     MaxPosition;
+   card64                     ReadAheadPosition;
+};
+
+
+#include "renditionreader.icc"
+
+
+#endif
@@ -0,0 +1,163 @@
+// ##########################################################################
+// ####                                                                  ####
+// ####                      RTP Audio Server Project                    ####
+// ####                    ============================                  ####
+// ####                                                                  ####
+// #### Round Trip Time Estimator Implementation                         ####
+// ####                                                                  ####
+// ####           Copyright (C) 1999-2026 by Thomas Dreibholz            ####
+// ####                                                                  ####
+// #### Contact:                                                         ####
+// ####    EMail: thomas.dreibholz@gmail.com                             ####
+// ####    WWW:   https://www.nntb.no/~dreibh/rtpaudio                   ####
+// ####                                                                  ####
+// #### ---------------------------------------------------------------- ####
+// ####                                                                  ####
+// #### This program is free software: you can redistribute it and/or    ####
+// #### modify it under the terms of the GNU General Public License as   ####
+// #### published by the Free Software Foundation, either version 3 of   ####
+// #### the License, or (at your option) any later version.              ####
+// ####                                                                  ####
+// #### This program is distributed in the hope that it will be useful,  ####
+// #### but WITHOUT ANY WARRANTY; without even the implied warranty of   ####
+// #### MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    ####
+// #### GNU General Public License for more details.                     ####
+// ####                                                                  ####
+// #### You should have received a copy of the GNU General Public        ####
+// #### License along with this program.  If not, see                    ####
+// #### <http://www.gnu.org/licenses/>.                                  ####
+// ####                                                                  ####
+// ##########################################################################
+
+
+#include "tdsystem.h"
+#include "roundtriptimeestimator.h"
+#include "tools.h"
+
+
+// Debug mode: Print round trip time samples
+// #define DEBUG
+
+
+// ###### Constructor #######################################################
+RoundTripTimeEstimator::RoundTripTimeEstimator()
+   : Synchronizable("RoundTripTimeEstimator",Synchronizable::LT_SpinPark)
+{
+   RoundTripTimeAlpha = 7.0 / 8.0;
+   reset();
+}
+
+
+// ###### Reset #############################################################
+void RoundTripTimeEstimator::reset()
+{
+   synchronized();
+   for(cardinal i = 0;i < SenderReportHistory;i++) {
+      Sent[i].CompactNTP   = 0;
+      Sent[i].TrafficClass = 0x00;
+   }
+   for(cardinal i = 0;i < 256;i++) {
+      Class[i].UpdateTimeStamp = 0;
+      Class[i].RoundTripTime   = (cardinal)-1;
+   }
+   NextSent = 0;
+   LastLSR  = 0;
+   LastDLSR = 0;
+   unsynchronized();
+}
+
+
+// ###### Record sent sender report #########################################
+void RoundTripTimeEstimator::senderReportSent(const card64 ntpTimeStamp,
+                                              const card8  trafficClass)
+{
+   synchronized();
+   Sent[NextSent].CompactNTP   = getCompactNTP(ntpTimeStamp);
+   Sent[NextSent].TrafficClass = trafficClass;
+   NextSent = (NextSent + 1) % SenderReportHistory;
+   unsynchronized();
+}
+
+
+// ###### Update estimate using reception report ############################
+bool RoundTripTimeEstimator::receptionReport(const RTCPReceptionReportBlock* report,
+                                             const card64                    arrivalTime)
+{
+   const card32 lsr  = report->getLSR();
+   const card32 dlsr = report->getDLSR();
+   if(lsr == 0) {
+      // No sender report has been received by the remote side yet.
+      return(false);
+   }
+
+   synchronized();
+
+   // ====== Skip duplicates ================================================
+   // The report blocks of all layers carry the same LSR/DLSR pair.
+   if((lsr == LastLSR) && (dlsr == LastDLSR)) {
+      unsynchronized();
+      return(false);
+   }
+   LastLSR  = lsr;
+   LastDLSR = dlsr;
+
+   // ====== Find sender report =============================================
+   cardinal i;
+   for(i = 0;i < SenderReportHistory;i++) {
+      if(Sent[i].CompactNTP == lsr) {
+         break;
+      }
+   }
+   if(i >= SenderReportHistory) {
+      unsynchronized();
+      return(false);
+   }
+   const card8 trafficClass = Sent[i].TrafficClass;
+
+   // ====== Calculate sample ===============================================
+   // RTT = A - LSR - DLSR in units of 1/65536s (RFC 3550, section 6.4.1).
+   const card32 arrival = getCompactNTP(microTimeToNTP(arrivalTime));
+   const int32  delta   = (int32)(arrival - lsr - dlsr);
+   if(delta < 0) {
+      unsynchronized();
+      return(false);
+   }
+   const cardinal sample = (cardinal)std::min(
+      ((card64)delta * (card64)1000000) / 65536,(card64)MaxRoundTripTime);
+
+#ifdef DEBUG
+   std::cout << "RTT sample for class " << (cardinal)trafficClass
+             << " is " << sample << "." << std::endl;
+#endif
+
+   // ====== Update estimate ================================================
+   Estimate& estimate = Class[trafficClass];
+   if((estimate.RoundTripTime == (cardinal)-1) ||
+      (arrivalTime - estimate.UpdateTimeStamp > MaxEstimateAge)) {
+      estimate.RoundTripTime = sample;
+   }
+   else {
+      estimate.RoundTripTime = (cardinal)
+         (RoundTripTimeAlpha * (double)estimate.RoundTripTime +
+         (1.0 - RoundTripTimeAlpha) * (double)sample);
+   }
+   estimate.UpdateTimeStamp = arrivalTime;
+
+   unsynchronized();
+   return(true);
+}
+
+
+// ###### Get round trip time ###############################################
+cardinal RoundTripTimeEstimator::getRoundTripTime(const card8 trafficClass)
+{
+   synchronized();
+   const Estimate& estimate = Class[trafficClass];
+   cardinal rtt = (cardinal)-1;
+   if((estimate.RoundTripTime != (cardinal)-1) &&
+      (getMicroTime() - estimate.UpdateTimeStamp <= MaxEstimateAge)) {
+      rtt = estimate.RoundTripTime;
+   }
+   unsynchronized();
+   return(rtt);
+}
@@ -0,0 +1,184 @@
+// ##########################################################################
+// ####                                                                  ####
+// ####                      RTP Audio Server Project                    ####
+// ####                    ============================                  ####
+// ####                                                                  ####
+// #### Round Trip Time Estimator                                        ####
+// ####                                                                  ####
+// ####           Copyright (C) 1999-2026 by Thomas Dreibholz            ####
+// ####                                                                  ####
+// #### Contact:                                                         ####
+// ####    EMail: thomas.dreibholz@gmail.com                             ####
+// ####    WWW:   https://www.nntb.no/~dreibh/rtpaudio                   ####
+// ####                                                                  ####
+// #### ---------------------------------------------------------------- ####
+// ####                                                                  ####
+// #### This program is free software: you can redistribute it and/or    ####
+// #### modify it under the terms of the GNU General Public License as   ####
+// #### published by the Free Software Foundation, either version 3 of   ####
+// #### the License, or (at your option) any later version.              ####
+// ####                                                                  ####
+// #### This program is distributed in the hope that it will be useful,  ####
+// #### but WITHOUT ANY WARRANTY; without even the implied warranty of   ####
+// #### MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    ####
+// #### GNU General Public License for more details.                     ####
+// ####                                                                  ####
+// #### You should have received a copy of the GNU General Public        ####
+// #### License along with this program.  If not, see                    ####
+// #### <http://www.gnu.org/licenses/>.                                  ####
+// ####                                                                  ####
+// ##########################################################################
+
+
+#ifndef ROUNDTRIPTIMEESTIMATOR_H
+#define ROUNDTRIPTIMEESTIMATOR_H
+
+
+#include "tdsystem.h"
+#include "synchronizable.h"
+#include "rtcppacket.h"
+
+
+/**
+  * This class implements a passive round trip time estimator, using the
+  * LSR and DLSR fields of RTCP reception report blocks (see RFC 3550,
+  * section 6.4.1). The RTP sender records the compact NTP time stamp and
+  * traffic class of each sender report it sends. A receiver report
+  * echoing this time stamp yields a round trip time sample for the
+  * sender report's traffic class.
+  * Note: The estimator uses its own lock and calls no other objects
+  * while holding it, i.e. it may be used from any other lock context.
+  *
+  * @short   Round Trip Time Estimator
+  * @author  Thomas Dreibholz (thomas.dreibholz@gmail.com)
+  * @version 1.0
+  *
+  * @see RTPSender
+  * @see RoundTripTimePinger
+  */
+class RoundTripTimeEstimator : public Synchronizable
+{
+   // ====== Constructor ====================================================
+   public:
+   /**
+     * Constructor.
+     */
+   RoundTripTimeEstimator();
+
+
+   // ====== Reset ==========================================================
+   /**
+     * Reset all estimates.
+     */
+   void reset();
+
+
+   // ====== Estimation =====================================================
+   /**
+     * Record a sent sender report.
+     *
+     * @param ntpTimeStamp NTP time stamp of the sender report.
+     * @param trafficClass Traffic class the sender report has been sent with.
+     */
+   void senderReportSent(const card64 ntpTimeStamp,
+                         const card8  trafficClass);
+
+   /**
+     * Update estimate using a received reception report block.
+     *
+     * @param report Reception report block.
+     * @param arrivalTime Arrival time of the report in microseconds.
+     * @return true, if the report contained a new sample; false otherwise.
+     */
+   bool receptionReport(const RTCPReceptionReportBlock* report,
+                        const card64                    arrivalTime);
+
+   /**
+     * Get round trip time for given traffic class.
+     *
+     * @param trafficClass Traffic class.
+     * @return Round trip time in microseconds; (cardinal)-1, if there is no recent estimate.
+     */
+   cardinal getRoundTripTime(const card8 trafficClass);
+
+
+   // ====== Get/set alpha ==================================================
+   /**
+     * Get constant alpha: RTT = alpha * oldValue + (1 - alpha) * newValue.
+     *
+     * @return alpha.
+     */
+   inline double getAlpha();
+
+   /**
+     * Set constant alpha: RTT = alpha * oldValue + (1 - alpha) * newValue.
+     *
+     * @param alpha Alpha.
+     */
+   inline void setAlpha(const double alpha);
+
+
+   // ====== NTP time stamp conversion ======================================
+   /**
+     * Convert microseconds since 1970-01-01 into 64-bit NTP time stamp.
+     *
+     * @param microTime Time in microseconds.
+     * @return NTP time stamp.
+     */
+   inline static card64 microTimeToNTP(const card64 microTime);
+
+   /**
+     * Get compact NTP time stamp (middle 32 bits, as used for LSR).
+     *
+     * @param ntpTimeStamp NTP time stamp.
+     * @return Compact NTP time stamp.
+     */
+   inline static card32 getCompactNTP(const card64 ntpTimeStamp);
+
+
+   // ====== Constants ======================================================
+   /**
+     * Number of sender reports to be remembered.
+     */
+   static const cardinal SenderReportHistory = 16;
+
+   /**
+     * Maximum age of an estimate in microseconds.
+     */
+   static const card64 MaxEstimateAge = 30000000;
+
+   /**
+     * Maximum round trip time sample in microseconds.
+     */
+   static const cardinal MaxRoundTripTime = 180000000;
+
+   /**
+     * Difference between NTP epoch (1900-01-01) and Unix epoch in seconds.
+     */
+   static const card64 NTPEpochOffset = 2208988800ULL;
+
+
+   // ====== Private data ===================================================
+   private:
+   struct SentReport {
+      card32 CompactNTP;
+      card8  TrafficClass;
+   };
+   struct Estimate {
+      card64   UpdateTimeStamp;
+      cardinal RoundTripTime;
+   };
+
+   double     RoundTripTimeAlpha;
+   SentReport Sent[SenderReportHistory];
+   cardinal   NextSent;
+   card32     LastLSR;
+   card32     LastDLSR;
+   Estimate   Class[256];
+};
+
+
+#include "roundtriptimeestimator.icc"
+
+
+#endif
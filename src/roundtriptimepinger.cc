@@ -35,7 +35,7 @@
 #include "tdsocket.h"
 #include "internetaddress.h"
 #include "breakdetector.h"
-#include "timedthread.h"
+#include "thread.h"
 #include "rtppacket.h"
 #include "strings.h"
 #include "trafficclassvalues.h"
@@ -45,6 +45,15 @@
 // #define DEBUG
 
 
+// The pinger thread waits for echos using epoll. This requires the sockets
+// to be kernel sockets; with the SCTP library's socket API, poll is used.
+#if (SYSTEM == OS_Linux) && defined(HAVE_KERNEL_SCTP)
+#define USE_EPOLL
+#include <sys/epoll.h>
+#endif
+#include <climits>
+
+
 
 #define ICMP_FILTER 1
 
@@ -57,17 +66,24 @@ struct icmp_filter {
 RoundTripTimePinger::RoundTripTimePinger(Socket*      ping4socket,
                                          Socket*      ping6socket,
                                          const card64 delay)
-   : TimedThread(delay)
+   : Thread("RoundTripTimePinger")
 {
    // ====== Initialize =====================================================
-   Ready              = false;
-   Logger             = false;
-   RoundTripTimeAlpha = 7.0 / 8.0;
-   Ping4Socket        = ping4socket;
-   Ping6Socket        = ping6socket;
-   MaxPingDelay       = delay;
-   setTimerCorrection(0);
-   setFastStart(false);
+   Ready                = false;
+   Logger               = false;
+   RoundTripTimeAlpha   = 7.0 / 8.0;
+   Ping4Socket          = ping4socket;
+   Ping6Socket          = ping6socket;
+   PollFD               = -1;
+   MaxPingDelay         = delay;
+   HostSetGeneration    = 0;
+   ProbeHostsGeneration = (card64)-1;
+   ProbeAlpha           = RoundTripTimeAlpha;
+   ProbeMaxPingDelay    = delay;
+
+   // Pings are sent in batches and their echos arrive in bursts.
+   // Therefore, the socket buffers should be large enough to hold them.
+   const int bufferSize = 1024 * 1024;
 
    // ====== Set ICMPv4 filter ==============================================
    if(Ping4Socket != NULL) {
@@ -82,6 +98,8 @@ RoundTripTimePinger::RoundTripTimePinger(Socket*      ping4socket,
 
       // ====== Set non-blocking mode =======================================
       Ping4Socket->setBlockingMode(false);
+      Ping4Socket->setSocketOption(SOL_SOCKET,SO_SNDBUF,&bufferSize,sizeof(bufferSize));
+      Ping4Socket->setSocketOption(SOL_SOCKET,SO_RCVBUF,&bufferSize,sizeof(bufferSize));
 
       // ====== Send a ping to IPv4 localhost ===============================
       // Send one ping to IPv4 localhost. The result is, that the first real ping
@@ -114,6 +132,8 @@ RoundTripTimePinger::RoundTripTimePinger(Socket*      ping4socket,
 
       // ====== Set non-blocking mode =======================================
       Ping6Socket->setBlockingMode(false);
+      Ping6Socket->setSocketOption(SOL_SOCKET,SO_SNDBUF,&bufferSize,sizeof(bufferSize));
+      Ping6Socket->setSocketOption(SOL_SOCKET,SO_RCVBUF,&bufferSize,sizeof(bufferSize));
 
       // ====== Send a ping to IPv6 localhost ===============================
       // Send one ping to IPv4 localhost. The result is, that the first real ping
@@ -125,6 +145,28 @@ RoundTripTimePinger::RoundTripTimePinger(Socket*      ping4socket,
       }
    }
 
+#ifdef USE_EPOLL
+   // ====== Create epoll instance ==========================================
+   PollFD = epoll_create1(EPOLL_CLOEXEC);
+   if(PollFD < 0) {
+      std::cerr << "ERROR: Unable to create epoll instance!" << std::endl;
+      return;
+   }
+   Socket* socketArray[2] = { Ping4Socket, Ping6Socket };
+   for(cardinal i = 0;i < 2;i++) {
+      if(socketArray[i] != NULL) {
+         epoll_event event;
+         event.events   = EPOLLIN;
+         event.data.ptr = (void*)socketArray[i];
+         if(epoll_ctl(PollFD,EPOLL_CTL_ADD,
+                      socketArray[i]->getSystemSocketDescriptor(),&event) < 0) {
+            std::cerr << "ERROR: Unable to add ping socket to epoll instance!" << std::endl;
+            return;
+         }
+      }
+   }
+#endif
+
    Ready = true;
 }
 
@@ -133,6 +175,10 @@ RoundTripTimePinger::RoundTripTimePinger(Socket*      ping4socket,
 RoundTripTimePinger::~RoundTripTimePinger()
 {
    stop();
+   if(PollFD >= 0) {
+      close(PollFD);
+      PollFD = -1;
+   }
 }
 
 
@@ -155,23 +201,26 @@ bool RoundTripTimePinger::addHost(const InternetAddress& address,
    }
 
    PingerHost host;
-   host.Address             = address;
+   host.Address       = address;
    host.Address.setPort(0);
-   host.AddressString       = host.Address.getAddressString();
-   host.TrafficClass        = trafficClass;
-   host.RoundTripTime       = (cardinal)-1;
-   host.MaxRawRoundTripTime = 0;
-   host.SeqNum              = 1;
-   host.IsIPv6              = isIPv6;
-   host.LastPingTimeStamp   = 0;
-   host.LastEchoTimeStamp   = 0;
-   host.UserCount           = 1;
+   host.AddressString = host.Address.getAddressString();
+   host.TrafficClass  = trafficClass;
+   host.Slot          = RoundTripTimeTable::NoSlot;
+   host.IsIPv6        = isIPv6;
+   host.UserCount     = 1;
 
    synchronized();
    bool added = false;
-   std::multiset<PingerHost>::iterator found = find(HostSet.begin(),HostSet.end(),host);
+   std::set<PingerHost>::iterator found = HostSet.find(host);
    if(found == HostSet.end()) {
+      host.Slot = Table.allocate();
+      if(host.Slot == RoundTripTimeTable::NoSlot) {
+         std::cerr << "WARNING: RoundTripTimePinger::addHost() - Too many hosts!" << std::endl;
+         unsynchronized();
+         return(false);
+      }
       HostSet.insert(host);
+      HostSetGeneration++;
       added = true;
    }
    else {
@@ -193,14 +242,19 @@ void RoundTripTimePinger::removeHost(const InternetAddress& address,
 
    PingerHost findHost;
    findHost.Address      = address;
+   findHost.Address.setPort(0);
    findHost.TrafficClass = trafficClass;
 
-   std::multiset<PingerHost>::iterator found = find(HostSet.begin(),HostSet.end(),findHost);
+   std::set<PingerHost>::iterator found = HostSet.find(findHost);
    if(found != HostSet.end()) {
       PingerHost& host = (PingerHost&)*found;
       host.UserCount--;
       if(host.UserCount <= 0) {
+         // The pinger thread may still use the slot until it updates
+         // its host list.
+         Table.release(host.Slot,running());
          HostSet.erase(found);
+         HostSetGeneration++;
       }
       deactivateLogger();
    }
@@ -216,13 +270,16 @@ cardinal RoundTripTimePinger::getRoundTripTime(
 {
    PingerHost findHost;
    findHost.Address      = address;
+   findHost.Address.setPort(0);
    findHost.TrafficClass = trafficClass;
 
    synchronized();
    cardinal rtt = (cardinal)-1;
-   std::multiset<PingerHost>::iterator found = find(HostSet.begin(),HostSet.end(),findHost);
+   std::set<PingerHost>::iterator found = HostSet.find(findHost);
    if(found != HostSet.end()) {
-      rtt = found->RoundTripTime;
+      RoundTripTimeRecord record;
+      Table.read(found->Slot,record);
+      rtt = record.RoundTripTime;
    }
    unsynchronized();
 
@@ -243,44 +300,46 @@ void RoundTripTimePinger::calculateRoundTripTime(
       roundTripTime = MaxRoundTripTime;
 
    // ====== Find PingerHost in list ========================================
+   // ProbeHosts is private to the pinger thread and sorted like HostSet.
    PingerHost findHost;
    findHost.Address      = address;
    findHost.TrafficClass = trafficClass;
 
-   synchronized();
-   std::multiset<PingerHost>::iterator found = find(HostSet.begin(),HostSet.end(),findHost);
-   if(found != HostSet.end()) {
-      PingerHost& host = (PingerHost&)*found;
+   std::vector<PingerHost>::const_iterator found =
+      std::lower_bound(ProbeHosts.begin(),ProbeHosts.end(),findHost);
+   if((found != ProbeHosts.end()) && (*found == findHost)) {
+      RoundTripTimeRecord record;
+      Table.read(found->Slot,record);
 
       // ====== Check for outdated reply ====================================
-      if((host.LastEchoTimeStamp < arrivalTime) && (sendTime <= getMicroTime())) {
+      if((record.LastEchoTimeStamp < arrivalTime) && (sendTime <= getMicroTime())) {
 
 #ifdef DEBUG
    cout << "RTT for " << address << " is " << roundTripTime << "." << std::endl;
 #endif
 
-         // ====== Update PingerHost data ===================================
-         host.LastEchoTimeStamp   = arrivalTime;
-         host.MaxRawRoundTripTime = std::max(host.MaxRawRoundTripTime,(cardinal)roundTripTime);
+         // ====== Update round trip time record ============================
+         record.LastEchoTimeStamp   = arrivalTime;
+         record.MaxRawRoundTripTime = std::max(record.MaxRawRoundTripTime,(cardinal)roundTripTime);
 
          // Set RoundTripTime to *calculated* value, if there is no valid
          // round trip time set (unreachable or update for the first time)
-         if(host.RoundTripTime >= MaxRoundTripTime) {
-            host.RoundTripTime = roundTripTime;
+         if(record.RoundTripTime >= MaxRoundTripTime) {
+            record.RoundTripTime = roundTripTime;
          }
 
          // Else, use update calculation RTT = alpha*oldRTT + (1 - alpha)*newRTT
          else {
-            host.RoundTripTime = (cardinal)
-               (RoundTripTimeAlpha * (double)host.RoundTripTime +
-               (1.0 - RoundTripTimeAlpha) * (double)roundTripTime);
+            record.RoundTripTime = (cardinal)
+               (ProbeAlpha * (double)record.RoundTripTime +
+               (1.0 - ProbeAlpha) * (double)roundTripTime);
          }
+         Table.write(found->Slot,record);
       }
       else {
          std::cerr << "Outdated echo received!" << std::endl;
       }
    }
-   unsynchronized();
 }
 
 
@@ -333,7 +392,6 @@ card64 RoundTripTimePinger::sendPing4(const InternetAddress& destination,
    packet.Header.icmp_seq   = sequenceNumber;
    packet.Header.icmp_id    = 0x3300 | (card16)trafficClass;
 
-   Thread::yield();
    packet.TimeStamp         = getMicroTime();
    packet.Header.icmp_cksum = calculateChecksum((card16*)&packet,sizeof(packet),0);
    ssize_t sent = Ping4Socket->sendTo((void*)&packet,sizeof(packet),0,
@@ -360,7 +418,6 @@ card64 RoundTripTimePinger::sendPing6(const InternetAddress& destination,
    packet.Header.icmp6_seq   = sequenceNumber;
    packet.Header.icmp6_id    = 0x3300 | (card16)trafficClass;
 
-   Thread::yield();
    packet.TimeStamp = getMicroTime();
    ssize_t sent = Ping6Socket->sendTo((void*)&packet,sizeof(packet),0,
                                       destination,trafficClass);
@@ -468,94 +525,167 @@ bool RoundTripTimePinger::receiveEcho6()
 }
 
 
-// ###### Check host for being unreachable ##################################
-void RoundTripTimePinger::checkUnreachable(PingerHost& host)
+// ###### Check hosts for being unreachable ################################
+void RoundTripTimePinger::checkUnreachable()
 {
-   if((host.RoundTripTime >= MaxRoundTripTime) || (host.LastEchoTimeStamp == 0)) {
-      // Host is unreachable.
-   }
-   else {
-      // Assume current round trip time to be diff = now - host.LastEchoTimeStamp, if
-      // diff > MinUnreachableAsumption (for OS delay) or
-      // diff > UnreachableFactor * MaxRawRoundTripTime (for real network delay).
-      const card64 now  = getMicroTime();
-      const card64 diff = now - host.LastEchoTimeStamp;
+   const card64 now = getMicroTime();
+   for(std::vector<PingerHost>::const_iterator hostIterator = ProbeHosts.begin();
+       hostIterator != ProbeHosts.end(); hostIterator++) {
+      RoundTripTimeRecord record;
+      Table.read(hostIterator->Slot,record);
+      if((record.RoundTripTime >= MaxRoundTripTime) || (record.LastEchoTimeStamp == 0)) {
+         // Host is unreachable.
+      }
+      else {
+         // Assume current round trip time to be diff = now - host.LastEchoTimeStamp, if
+         // diff > MinUnreachableAsumption (for OS delay) or
+         // diff > UnreachableFactor * MaxRawRoundTripTime (for real network delay).
+         const card64 diff = now - record.LastEchoTimeStamp;
 
-      if((diff > MinUnreachableAsumption) &&
-         (diff > (card64)((double)UnreachableFactor * (double)host.MaxRawRoundTripTime))) {
+         if((diff > MinUnreachableAsumption) &&
+            (diff > (card64)((double)UnreachableFactor * (double)record.MaxRawRoundTripTime))) {
 
 #ifdef DEBUG
-   cout << "Assumed RTT for unreachable " << host.Address
+   cout << "Assumed RTT for unreachable " << hostIterator->Address
         << " is " << diff << "." << std::endl;
 #endif
 
-         host.RoundTripTime = (cardinal)
-            (RoundTripTimeAlpha * (double)host.RoundTripTime +
-            (1.0 - RoundTripTimeAlpha) * (double)diff);
-         if(host.RoundTripTime > MaxRoundTripTime)
-            host.RoundTripTime = MaxRoundTripTime;
+            record.RoundTripTime = (cardinal)
+               (ProbeAlpha * (double)record.RoundTripTime +
+               (1.0 - ProbeAlpha) * (double)diff);
+            if(record.RoundTripTime > MaxRoundTripTime)
+               record.RoundTripTime = MaxRoundTripTime;
+            Table.write(hostIterator->Slot,record);
+         }
       }
    }
 }
 
 
-// ###### timerEvent() implementation #######################################
-void RoundTripTimePinger::timerEvent()
+// ###### Update pinger thread's copy of host list and settings #############
+bool RoundTripTimePinger::updateProbeHosts()
 {
+   bool updated = false;
    synchronized();
+   ProbeAlpha        = RoundTripTimeAlpha;
+   ProbeMaxPingDelay = std::max(MaxPingDelay,(card64)1);
+   if(ProbeHostsGeneration != HostSetGeneration) {
+      ProbeHosts.assign(HostSet.begin(),HostSet.end());
+      ProbeHostsGeneration = HostSetGeneration;
+      // Slots of removed hosts are not used by the pinger thread anymore.
+      Table.recycle();
+      updated = true;
+   }
+   unsynchronized();
+   return(updated);
+}
 
-   std::multiset<PingerHost>::iterator hostIterator = HostSet.begin();
-   while(hostIterator != HostSet.end()) {
-      PingerHost& host = (PingerHost&)*hostIterator;
 
-      // ====== Send pings ==================================================
+// ###### Send pings to all hosts ###########################################
+void RoundTripTimePinger::sendPings()
+{
+   for(std::vector<PingerHost>::const_iterator hostIterator = ProbeHosts.begin();
+       hostIterator != ProbeHosts.end(); hostIterator++) {
+      const PingerHost& host = *hostIterator;
+      card16& seqNum = Table.getSeqNum(host.Slot);
       if(host.IsIPv6) {
-         const card64 timeStamp = sendPing6(host.Address,host.TrafficClass,host.SeqNum++);
+         const card64 timeStamp = sendPing6(host.Address,host.TrafficClass,seqNum++);
          if(timeStamp == 0) {
             std::cerr << "WARNING: Ping6 to " << host.Address << " failed!" << std::endl;
          }
          else {
-            host.LastPingTimeStamp = timeStamp;
+            Table.getLastPingTimeStamp(host.Slot) = timeStamp;
          }
       }
       else {
-         const card64 timeStamp = sendPing4(host.Address,host.TrafficClass,host.SeqNum++);
+         const card64 timeStamp = sendPing4(host.Address,host.TrafficClass,seqNum++);
          if(timeStamp == 0) {
             std::cerr << "WARNING: Ping4 to " << host.Address << " failed!" << std::endl;
          }
          else {
-            host.LastPingTimeStamp = timeStamp;
+            Table.getLastPingTimeStamp(host.Slot) = timeStamp;
          }
       }
+   }
+}
 
-      // ====== Receive echos ===============================================
-      bool received4 = false;
-      bool received6 = false;
-      do {
-         if(Ping6Socket != NULL) {
-            received6 = receiveEcho6();
-         }
-         if(Ping4Socket != NULL) {
-            received4 = receiveEcho4();
+
+// ###### Wait for echos and receive them ###################################
+void RoundTripTimePinger::waitForEchos(const card64 timeout)
+{
+   const int timeoutMS = (int)std::min((timeout + 999) / 1000,(card64)INT_MAX);
+
+#ifdef USE_EPOLL
+   epoll_event events[2];
+   const int result = epoll_wait(PollFD,(epoll_event*)&events,2,timeoutMS);
+   for(int i = 0;i < result;i++) {
+      if(events[i].data.ptr == (void*)Ping4Socket) {
+         while(receiveEcho4()) { }
+      }
+      else if(events[i].data.ptr == (void*)Ping6Socket) {
+         while(receiveEcho6()) { }
+      }
+   }
+#else
+   pollfd   pollFDs[2];
+   Socket*  pollSockets[2];
+   cardinal count = 0;
+   if(Ping4Socket != NULL) {
+      pollFDs[count].fd     = Ping4Socket->getSystemSocketDescriptor();
+      pollFDs[count].events = POLLIN;
+      pollSockets[count++]  = Ping4Socket;
+   }
+   if(Ping6Socket != NULL) {
+      pollFDs[count].fd     = Ping6Socket->getSystemSocketDescriptor();
+      pollFDs[count].events = POLLIN;
+      pollSockets[count++]  = Ping6Socket;
+   }
+   const int result = ext_poll((pollfd*)&pollFDs,count,timeoutMS);
+   if(result > 0) {
+      for(cardinal i = 0;i < count;i++) {
+         if(pollFDs[i].revents & POLLIN) {
+            if(pollSockets[i] == Ping4Socket) {
+               while(receiveEcho4()) { }
+            }
+            else {
+               while(receiveEcho6()) { }
+            }
          }
-      } while((received6 == true) || (received4 == true));
+      }
+   }
+#endif
+}
 
 
-      // ====== Check, if host is unreachable ===============================
-      checkUnreachable(host);
+// ###### Pinger thread #####################################################
+void RoundTripTimePinger::run()
+{
+   for(;;) {
+      // ====== Get current host list and settings ==========================
+      updateProbeHosts();
+
+      // ====== Send pings to all hosts in one batch ========================
+      sendPings();
+
+      // ====== Receive echos until next round ==============================
+      const card64 nextRound = getMicroTime() + 1 +
+                                  (Random.random64() % ProbeMaxPingDelay);
+      card64 now = getMicroTime();
+      while(now < nextRound) {
+         waitForEchos(nextRound - now);
+         now = getMicroTime();
+      }
 
-      hostIterator++;
-   }
+      // ====== Check, if hosts are unreachable =============================
+      checkUnreachable();
 
-   // ====== Do logging =====================================================
-   if(Logger) {
-      writeGPData(*LoggerDataStream);
+      // ====== Do logging ==================================================
+      synchronized();
+      if(Logger) {
+         writeGPData(*LoggerDataStream);
+      }
+      unsynchronized();
    }
-
-   const card64 newInterval = Random.random64() % MaxPingDelay;
-   setInterval(newInterval + 1);
-
-   unsynchronized();
 }
 
 
@@ -595,7 +725,7 @@ void RoundTripTimePinger::writeGPHeader(std::ostream&  os,
    GPHeaderTimeStamp = getMicroTime();
 
    synchronized();
-   std::multiset<PingerHost>::iterator hostIterator = HostSet.begin();
+   std::set<PingerHost>::iterator hostIterator = HostSet.begin();
    cardinal number = 0;
    while(hostIterator != HostSet.end()) {
       PingerHost host = *hostIterator;
@@ -637,10 +767,11 @@ void RoundTripTimePinger::writeGPData(std::ostream& os)
 {
    synchronized();
    const card64 now = getMicroTime();
-   std::multiset<PingerHost>::iterator hostIterator = HostSet.begin();
+   std::set<PingerHost>::iterator hostIterator = HostSet.begin();
    while(hostIterator != HostSet.end()) {
-      PingerHost host = *hostIterator;
-      double rtt = (host.RoundTripTime) / 1000.0;
+      RoundTripTimeRecord record;
+      Table.read(hostIterator->Slot,record);
+      double rtt = (record.RoundTripTime) / 1000.0;
       if(rtt >= 5000.0)
          os << "0 0 ";
       else
@@ -658,9 +789,11 @@ std::ostream& operator<<(std::ostream& os, RoundTripTimePinger& pinger)
    pinger.synchronized();
 
    cardinal number = 1;
-   std::multiset<PingerHost>::iterator hostIterator = pinger.HostSet.begin();
+   std::set<PingerHost>::iterator hostIterator = pinger.HostSet.begin();
    while(hostIterator != pinger.HostSet.end()) {
-      PingerHost host = *hostIterator;
+      const PingerHost& host = *hostIterator;
+      RoundTripTimeRecord record;
+      pinger.Table.read(host.Slot,record);
       String hostName = host.AddressString;
 
       char str[256];
@@ -676,7 +809,7 @@ std::ostream& operator<<(std::ostream& os, RoundTripTimePinger& pinger)
       snprintf((char*)&str,sizeof(str),"#%02d:  %4s  %8d  %-32s",
                           (int)number,
                           tcString,
-                          (int)host.RoundTripTime,
+                          (int)record.RoundTripTime,
                           hostName.getData());
       os << str << std::endl;
 
@@ -37,13 +37,15 @@
 #include "tdsystem.h"
 #include "tdsocket.h"
 #include "internetaddress.h"
-#include "timedthread.h"
+#include "thread.h"
 #include "rtppacket.h"
 #include "pingerhost.h"
+#include "roundtriptimetable.h"
 #include "randomizer.h"
 
 
 #include <set>
+#include <vector>
 #include <algorithm>
 #include <fstream>
 
@@ -54,13 +56,18 @@
 
 
 /**
-  * This class implements a round trip time pinger.
+  * This class implements a round trip time pinger. In each round, the
+  * pinger thread sends pings to all hosts in one batch. Then, it waits for
+  * echos using epoll (poll on other systems) until the next round starts.
+  * Round trip times are published in a RoundTripTimeTable, i.e.
+  * getRoundTripTime() never waits for the probe loop, and the probe loop
+  * only takes the host set lock at the beginning of a round.
   *
   * @short   Round Trip Time Pinger
   * @author  Thomas Dreibholz (thomas.dreibholz@gmail.com)
   * @version 1.0
   */
-class RoundTripTimePinger : public TimedThread
+class RoundTripTimePinger : public Thread
 {
    // ====== Constructor ===================================================
    public:
@@ -130,6 +137,7 @@ class RoundTripTimePinger : public TimedThread
    /**
      * Get round trip time for given host and traffic class.
      *
+     * @param address Host address.
      * @param trafficClass Traffic class.
      * @return Round trip time in microseconds; -1 for hosts not in list or unreachable.
      */
@@ -232,7 +240,11 @@ class RoundTripTimePinger : public TimedThread
 
    // ====== Private data ===================================================
    private:
-   void timerEvent();
+   void run();
+   bool updateProbeHosts();
+   void sendPings();
+   void waitForEchos(const card64 timeout);
+   void checkUnreachable();
    void calculateRoundTripTime(const InternetAddress& address,
                                const card8            trafficClass,
                                const card64           sendTime,
@@ -248,7 +260,6 @@ class RoundTripTimePinger : public TimedThread
                     const card16           sequenceNumber);
    bool receiveEcho4();
    bool receiveEcho6();
-   void checkUnreachable(PingerHost& host);
 
 
    struct Ping4Packet
@@ -266,8 +277,17 @@ class RoundTripTimePinger : public TimedThread
 
    Socket*                   Ping4Socket;
    Socket*                   Ping6Socket;
+   int                       PollFD;
    double                    RoundTripTimeAlpha;
-   std::multiset<PingerHost> HostSet;
+   std::set<PingerHost>      HostSet;
+   card64                    HostSetGeneration;
+   RoundTripTimeTable        Table;
+
+   // The following variables are private to the pinger thread.
+   std::vector<PingerHost>   ProbeHosts;
+   card64                    ProbeHostsGeneration;
+   double                    ProbeAlpha;
+   card64                    ProbeMaxPingDelay;
    card64                    GPHeaderTimeStamp;
    bool                      Ready;
    bool                      Logger;
@@ -0,0 +1,112 @@
+// ##########################################################################
+// ####                                                                  ####
+// ####                      RTP Audio Server Project                    ####
+// ####                    ============================                  ####
+// ####                                                                  ####
+// #### Round Trip Time Table Implementation                             ####
+// ####                                                                  ####
+// ####           Copyright (C) 1999-2026 by Thomas Dreibholz            ####
+// ####                                                                  ####
+// #### Contact:                                                         ####
+// ####    EMail: thomas.dreibholz@gmail.com                             ####
+// ####    WWW:   https://www.nntb.no/~dreibh/rtpaudio                   ####
+// ####                                                                  ####
+// #### ---------------------------------------------------------------- ####
+// ####                                                                  ####
+// #### This program is free software: you can redistribute it and/or    ####
+// #### modify it under the terms of the GNU General Public License as   ####
+// #### published by the Free Software Foundation, either version 3 of   ####
+// #### the License, or (at your option) any later version.              ####
+// ####                                                                  ####
+// #### This program is distributed in the hope that it will be useful,  ####
+// #### but WITHOUT ANY WARRANTY; without even the implied warranty of   ####
+// #### MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    ####
+// #### GNU General Public License for more details.                     ####
+// ####                                                                  ####
+// #### You should have received a copy of the GNU General Public        ####
+// #### License along with this program.  If not, see                    ####
+// #### <http://www.gnu.org/licenses/>.                                  ####
+// ####                                                                  ####
+// ##########################################################################
+
+
+#include "tdsystem.h"
+#include "roundtriptimetable.h"
+
+
+// ###### Constructor #######################################################
+RoundTripTimeTable::RoundTripTimeTable()
+{
+   Chunks   = 0;
+   NextSlot = 0;
+   for(cardinal i = 0;i < MaxChunks;i++) {
+      Chunk[i] = NULL;
+   }
+}
+
+
+// ###### Destructor ########################################################
+RoundTripTimeTable::~RoundTripTimeTable()
+{
+   for(cardinal i = 0;i < Chunks;i++) {
+      delete [] Chunk[i];
+      Chunk[i] = NULL;
+   }
+   Chunks = 0;
+}
+
+
+// ###### Allocate slot #####################################################
+cardinal RoundTripTimeTable::allocate()
+{
+   cardinal slot;
+   if(!FreeSlots.empty()) {
+      slot = FreeSlots.back();
+      FreeSlots.pop_back();
+   }
+   else {
+      if(NextSlot >= Chunks * ChunkSize) {
+         if(Chunks >= MaxChunks) {
+            return(NoSlot);
+         }
+         Chunk[Chunks] = new Entry[ChunkSize];
+         if(Chunk[Chunks] == NULL) {
+            return(NoSlot);
+         }
+         for(cardinal i = 0;i < ChunkSize;i++) {
+            Chunk[Chunks][i].Sequence.store(0,std::memory_order_relaxed);
+         }
+         Chunks++;
+      }
+      slot = NextSlot++;
+   }
+
+   RoundTripTimeRecord record;
+   record.LastEchoTimeStamp   = 0;
+   record.RoundTripTime       = (cardinal)-1;
+   record.MaxRawRoundTripTime = 0;
+   write(slot,record);
+   getSeqNum(slot)            = 1;
+   getLastPingTimeStamp(slot) = 0;
+   return(slot);
+}
+
+
+// ###### Release slot ######################################################
+void RoundTripTimeTable::release(const cardinal slot, const bool deferred)
+{
+   if(deferred) {
+      DeferredSlots.push_back(slot);
+   }
+   else {
+      FreeSlots.push_back(slot);
+   }
+}
+
+
+// ###### Recycle deferred released slots ###################################
+void RoundTripTimeTable::recycle()
+{
+   FreeSlots.insert(FreeSlots.end(),DeferredSlots.begin(),DeferredSlots.end());
+   DeferredSlots.clear();
+}
@@ -0,0 +1,204 @@
+// ##########################################################################
+// ####                                                                  ####
+// ####                      RTP Audio Server Project                    ####
+// ####                    ============================                  ####
+// ####                                                                  ####
+// #### Round Trip Time Table                                            ####
+// ####                                                                  ####
+// ####           Copyright (C) 1999-2026 by Thomas Dreibholz            ####
+// ####                                                                  ####
+// #### Contact:                                                         ####
+// ####    EMail: thomas.dreibholz@gmail.com                             ####
+// ####    WWW:   https://www.nntb.no/~dreibh/rtpaudio                   ####
+// ####                                                                  ####
+// #### ---------------------------------------------------------------- ####
+// ####                                                                  ####
+// #### This program is free software: you can redistribute it and/or    ####
+// #### modify it under the terms of the GNU General Public License as   ####
+// #### published by the Free Software Foundation, either version 3 of   ####
+// #### the License, or (at your option) any later version.              ####
+// ####                                                                  ####
+// #### This program is distributed in the hope that it will be useful,  ####
+// #### but WITHOUT ANY WARRANTY; without even the implied warranty of   ####
+// #### MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    ####
+// #### GNU General Public License for more details.                     ####
+// ####                                                                  ####
+// #### You should have received a copy of the GNU General Public        ####
+// #### License along with this program.  If not, see                    ####
+// #### <http://www.gnu.org/licenses/>.                                  ####
+// ####                                                                  ####
+// ##########################################################################
+
+
+#ifndef ROUNDTRIPTIMETABLE_H
+#define ROUNDTRIPTIMETABLE_H
+
+
+#include "tdsystem.h"
+
+
+#include <atomic>
+#include <vector>
+
+
+/**
+  * This structure contains a consistent copy of a round trip time
+  * table entry.
+  *
+  * @short   Round Trip Time Record
+  * @author  Thomas Dreibholz (thomas.dreibholz@gmail.com)
+  * @version 1.0
+  */
+struct RoundTripTimeRecord
+{
+   /**
+     * Timestamp of last received echo.
+     */
+   card64 LastEchoTimeStamp;
+
+   /**
+     * Round trip time.
+     */
+   cardinal RoundTripTime;
+
+   /**
+     * Maximum raw round trip time (directly calculated from packet).
+     */
+   cardinal MaxRawRoundTripTime;
+};
+
+
+/**
+  * This class implements the round trip time table of RoundTripTimePinger.
+  * Each host has a fixed slot. The slot's record is written by one single
+  * writer (the pinger thread) and protected by a sequence lock, i.e.
+  * readers never block the writer; they simply retry when a concurrent
+  * update has been detected. Slot allocation and release have to be
+  * serialized by the caller. The table grows in chunks which are never
+  * moved, so a slot remains valid while the writer is using it.
+  *
+  * @short   Round Trip Time Table
+  * @author  Thomas Dreibholz (thomas.dreibholz@gmail.com)
+  * @version 1.0
+  */
+class RoundTripTimeTable
+{
+   // ====== Constructor/Destructor =========================================
+   public:
+   /**
+     * Constructor.
+     */
+   RoundTripTimeTable();
+
+   /**
+     * Destructor.
+     */
+   ~RoundTripTimeTable();
+
+
+   // ====== Slot management ================================================
+   /**
+     * Allocate a slot. The slot's record is initialized to an unreachable
+     * host. Note: The caller has to serialize calls of allocate(),
+     * release() and recycle().
+     *
+     * @return Slot number or NoSlot, if the table is full.
+     */
+   cardinal allocate();
+
+   /**
+     * Release a slot. If the writer may still use the slot, it will not be
+     * reused before the next call of recycle().
+     *
+     * @param slot Slot number.
+     * @param deferred true to defer reuse until recycle(); false otherwise.
+     */
+   void release(const cardinal slot, const bool deferred);
+
+   /**
+     * Make all deferred released slots available again. This has to be
+     * called by the writer, when it does not use released slots anymore.
+     */
+   void recycle();
+
+
+   // ====== Reading and writing ============================================
+   /**
+     * Read a consistent copy of a slot's record. This function never
+     * blocks the writer.
+     *
+     * @param slot Slot number.
+     * @param record Reference to store the record to.
+     */
+   inline void read(const cardinal slot, RoundTripTimeRecord& record) const;
+
+   /**
+     * Write a slot's record. Only one writer is allowed at a time.
+     *
+     * @param slot Slot number.
+     * @param record Record to be written.
+     */
+   inline void write(const cardinal slot, const RoundTripTimeRecord& record);
+
+   /**
+     * Get sequence number of the last ping sent for given slot.
+     * This value is private to the writer.
+     *
+     * @param slot Slot number.
+     * @return Reference to sequence number.
+     */
+   inline card16& getSeqNum(const cardinal slot);
+
+   /**
+     * Get time stamp of the last ping sent for given slot.
+     * This value is private to the writer.
+     *
+     * @param slot Slot number.
+     * @return Reference to time stamp.
+     */
+   inline card64& getLastPingTimeStamp(const cardinal slot);
+
+
+   // ====== Constants ======================================================
+   /**
+     * Number of slots per chunk.
+     */
+   static const cardinal ChunkSize = 256;
+
+   /**
+     * Maximum number of chunks.
+     */
+   static const cardinal MaxChunks = 256;
+
+   /**
+     * Invalid slot number.
+     */
+   static const cardinal NoSlot = (cardinal)-1;
+
+
+   // ====== Private data ===================================================
+   private:
+   struct Entry {
+      std::atomic<card32>   Sequence;
+      std::atomic<card64>   LastEchoTimeStamp;
+      std::atomic<cardinal> RoundTripTime;
+      std::atomic<cardinal> MaxRawRoundTripTime;
+      card64                LastPingTimeStamp;
+      card16                SeqNum;
+   };
+
+   inline Entry& getEntry(const cardinal slot) const;
+
+
+   Entry*                Chunk[MaxChunks];
+   cardinal              Chunks;
+   cardinal              NextSlot;
+   std::vector<cardinal> FreeSlots;
+   std::vector<cardinal> DeferredSlots;
+};
+
+
+#include "roundtriptimetable.icc"
+
+
+#endif
@@ -39,6 +39,9 @@
 RTCPAbstractServer::RTCPAbstractServer()
    : TimedThread(1000000,"RTCPAbstractServer")
 {
+   // The thread's lock has to stay recursive: the client callbacks run with
+   // the lock held and may call getMembers(), and stop() calls
+   // receivedBye() with the lock held.
    DefaultTimeout = 8000000;
    setTimerCorrection(0);
    setFastStart(false);
@@ -111,11 +111,10 @@ void RTCPReceiver::run()
          std::cerr << "WARNING: RTCPReceiver::run() - Received too small RTCP header" << std::endl;
          continue;
       }
-      RTCPCommonHeader* header  = (RTCPCommonHeader*)&packetData;
-      const cardinal packetSize = header->getLength();
-      if(packetSize > receivedPacketSize) {
+      RTCPCommonHeader* header = (RTCPCommonHeader*)&packetData;
+      if(header->getLength() > receivedPacketSize) {
          std::cerr << "WARNING: RTCPReceiver::run() - Invalid length in RTCP header (expected "
-                   << receivedPacketSize << " but got " << packetSize << ")" << std::endl;
+                   << receivedPacketSize << " but got " << header->getLength() << ")" << std::endl;
          continue;
       }
 /*
@@ -135,7 +134,7 @@ void RTCPReceiver::run()
       }
 
       RTCPCommonHeader* r    = (RTCPCommonHeader*)&packetData;
-      RTCPCommonHeader* rend = (RTCPCommonHeader*)((long)r + (long)packetSize);
+      RTCPCommonHeader* rend = (RTCPCommonHeader*)((long)r + (long)receivedPacketSize);
       do {
          r = (RTCPCommonHeader*)((long)r + (long)r->getLength());
       } while((r < rend) && (r->getVersion() == RTPConstants::RTPVersion));
@@ -147,133 +146,139 @@ void RTCPReceiver::run()
       }
 
 
-      // ====== Get type and invoke server function =========================
+      // ====== Invoke server function for each packet of compound packet ===
+      // A compound packet (RFC 3550, section 6.1) contains several RTCP
+      // packets, e.g. a receiver report followed by SDES and APP.
       synchronized();
-      switch(header->getPacketType()) {
+      for(header = (RTCPCommonHeader*)&packetData;header < rend;
+          header = (RTCPCommonHeader*)((long)header + (long)header->getLength())) {
+         const cardinal packetSize = header->getLength();
+         switch(header->getPacketType()) {
 
-         // ====== Packet is a Receiver Report ==============================
-         case RTCP_RR:
-            {
-               RTCPReceiverReport* receiverReport = (RTCPReceiverReport*)&packetData;
-               cardinal bytes = sizeof(RTCPReceiverReport);
-               cardinal layer = 0;
-               card32   ssrc  = 0;
-               for(cardinal i = 0;i < receiverReport->getCount();i++) {
-                  if((bytes + sizeof(RTCPReceptionReportBlock)) <= packetSize) {
-                     if(receiverReport->rr[i].getSSRC() == ssrc) {
-                        layer++;
+            // ====== Packet is a Receiver Report ===========================
+            case RTCP_RR:
+               {
+                  RTCPReceiverReport* receiverReport = (RTCPReceiverReport*)header;
+                  cardinal bytes = sizeof(RTCPReceiverReport);
+                  cardinal layer = 0;
+                  card32   ssrc  = 0;
+                  for(cardinal i = 0;i < receiverReport->getCount();i++) {
+                     if((bytes + sizeof(RTCPReceptionReportBlock)) <= packetSize) {
+                        if(receiverReport->rr[i].getSSRC() == ssrc) {
+                           layer++;
+                        }
+                        else {
+                           layer = 0;
+                           ssrc  = receiverReport->rr[i].getSSRC();
+                        }
+                        Server->receivedReceiverReport(
+                           flow, receiverReport->getSSRC(),
+                           &receiverReport->rr[i], layer);
                      }
                      else {
-                        layer = 0;
-                        ssrc  = receiverReport->rr[i].getSSRC();
-                     }
-                     Server->receivedReceiverReport(
-                        flow, receiverReport->getSSRC(),
-                        &receiverReport->rr[i], layer);
-                  }
-                  else {
 #ifdef DEBUG
-                     std::cerr << "RTCP packet: Invalid receiver report length!" << std::endl;
+                        std::cerr << "RTCP packet: Invalid receiver report length!" << std::endl;
 #endif
-                     break;
+                        break;
+                     }
+                     bytes += sizeof(RTCPReceptionReportBlock);
                   }
-                  bytes += sizeof(RTCPReceptionReportBlock);
                }
-            }
-          break;
+             break;
 
-         // ====== Packet is a Sender Report ================================
-         case RTCP_SR:
-            {
-               RTCPSenderReport* senderReport = (RTCPSenderReport*)&packetData;
-               cardinal bytes = (long)&senderReport->rr[0] - (long)senderReport;
-               cardinal layer = 0;
-               card32   ssrc  = 0;
-               for(cardinal i = 0;i < senderReport->getCount();i++) {
-                  if((bytes + sizeof(RTCPReceptionReportBlock)) <= packetSize) {
-                     if(senderReport->rr[i].getSSRC() == ssrc) {
-                        layer++;
+            // ====== Packet is a Sender Report =============================
+            case RTCP_SR:
+               {
+                  RTCPSenderReport* senderReport = (RTCPSenderReport*)header;
+                  cardinal bytes = (long)&senderReport->rr[0] - (long)senderReport;
+                  cardinal layer = 0;
+                  card32   ssrc  = 0;
+                  for(cardinal i = 0;i < senderReport->getCount();i++) {
+                     if((bytes + sizeof(RTCPReceptionReportBlock)) <= packetSize) {
+                        if(senderReport->rr[i].getSSRC() == ssrc) {
+                           layer++;
+                        }
+                        else {
+                           layer = 0;
+                           ssrc  = senderReport->rr[i].getSSRC();
+                        }
+                        Server->receivedSenderReport(
+                           flow, senderReport->getSSRC(),
+                           &senderReport->rr[i], layer);
                      }
                      else {
-                        layer = 0;
-                        ssrc  = senderReport->rr[i].getSSRC();
-                     }
-                     Server->receivedSenderReport(
-                        flow, senderReport->getSSRC(),
-                        &senderReport->rr[i], layer);
-                  }
-                  else {
 #ifdef DEBUG
-                     std::cerr << "RTCP packet: Invalid sender report length!" << std::endl;
+                        std::cerr << "RTCP packet: Invalid sender report length!" << std::endl;
 #endif
-                     break;
+                        break;
+                     }
+                     bytes += sizeof(RTCPReceptionReportBlock);
                   }
-                  bytes += sizeof(RTCPReceptionReportBlock);
                }
-            }
-          break;
+             break;
 
-         // ====== Packet is a Source Description ===========================
-         case RTCP_SDES:
-            {
-               RTCPSourceDescription* sdes          = (RTCPSourceDescription*)&packetData;
-               const RTCPSourceDescriptionItem* end = (RTCPSourceDescriptionItem*)((long)sdes + sdes->getLength());
-               RTCPSourceDescriptionChunk* sd       = &sdes->Chunk[0];
-               RTCPSourceDescriptionItem* rsp;
-               RTCPSourceDescriptionItem* rspn;
-               integer count = sdes->getCount();
-               while(--count >= 0) {
-                  rsp = &sd->Item[0];
-                  if(rsp >= end) {
-                     break;
-                  }
-                  for ( ;rsp->Type;rsp = rspn) {
-                     rspn = (RTCPSourceDescriptionItem*)((long)rsp + (long)rsp->Length + (long)sizeof(RTCPSourceDescriptionItem));
-                     if(rspn <= end) {
-                        Server->receivedSourceDescription(
-                            flow, sd->SRC, rsp->Type, rsp->Data, rsp->Length);
-                     }
-                     else {
+            // ====== Packet is a Source Description ========================
+            case RTCP_SDES:
+               {
+                  RTCPSourceDescription* sdes          = (RTCPSourceDescription*)header;
+                  const RTCPSourceDescriptionItem* end = (RTCPSourceDescriptionItem*)((long)sdes + sdes->getLength());
+                  RTCPSourceDescriptionChunk* sd       = &sdes->Chunk[0];
+                  RTCPSourceDescriptionItem* rsp;
+                  RTCPSourceDescriptionItem* rspn;
+                  integer count = sdes->getCount();
+                  while(--count >= 0) {
+                     rsp = &sd->Item[0];
+                     if(rsp >= end) {
                         break;
                      }
+                     for ( ;rsp->Type;rsp = rspn) {
+                        rspn = (RTCPSourceDescriptionItem*)((long)rsp + (long)rsp->Length + (long)sizeof(RTCPSourceDescriptionItem));
+                        if(rspn <= end) {
+                           Server->receivedSourceDescription(
+                               flow, sd->SRC, rsp->Type, rsp->Data, rsp->Length);
+                        }
+                        else {
+                           break;
+                        }
+                     }
+                     rsp = (RTCPSourceDescriptionItem*)((long)sd + (((char*)rsp - (char*)sd) >> 2) + 1);
                   }
-                  rsp = (RTCPSourceDescriptionItem*)((long)sd + (((char*)rsp - (char*)sd) >> 2) + 1);
                }
-            }
-          break;
+             break;
 
-         // ====== Packet is a Bye message ==================================
-         case RTCP_BYE:
-            {
-               RTCPBye* bye = (RTCPBye*)&packetData;
-               for(cardinal i = 0;i < bye->getCount();i++) {
-                  Server->receivedBye(flow, bye->getSource(i),
-                                      RTCPAbstractServer::DeleteReason_UserBye);
+            // ====== Packet is a Bye message ===============================
+            case RTCP_BYE:
+               {
+                  RTCPBye* bye = (RTCPBye*)header;
+                  for(cardinal i = 0;i < bye->getCount();i++) {
+                     Server->receivedBye(flow, bye->getSource(i),
+                                         RTCPAbstractServer::DeleteReason_UserBye);
+                  }
                }
-            }
-           break;
+              break;
 
-         // ====== Packet is an App message =================================
-         case RTCP_APP:
-            {
-               RTCPApp* app = (RTCPApp*)&packetData;
-               Server->receivedApp(flow,
-                                   app->getSource(),
-                                   app->getName(),
-                                   (void*)app->getData(),
-                                   packetSize - sizeof(RTCPCommonHeader) - 8);
-            }
-           break;
+            // ====== Packet is an App message ==============================
+            case RTCP_APP:
+               {
+                  RTCPApp* app = (RTCPApp*)header;
+                  Server->receivedApp(flow,
+                                      app->getSource(),
+                                      app->getName(),
+                                      (void*)app->getData(),
+                                      packetSize - sizeof(RTCPCommonHeader) - 8);
+               }
+              break;
 
-         // ====== Packet type is unknown ===================================
-         default:
-            receivedPacketSize = 0;
+            // ====== Packet type is unknown ================================
+            default:
+               receivedPacketSize = 0;
 #ifdef DEBUG
-            std::cerr << "RTCP packet: Unknown SDES type "
-                      << header->getPacketType() << std::endl;
+               std::cerr << "RTCP packet: Unknown SDES type "
+                         << header->getPacketType() << std::endl;
 #endif
-          break;
+             break;
 
+         }
       }
       unsynchronized();
       AverageRTCPSize = (1.0/16.0) * receivedPacketSize + (15.0/16.0) * AverageRTCPSize;
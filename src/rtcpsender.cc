@@ -41,6 +41,9 @@ RTCPSender::RTCPSender()
 {
    SenderSocket = NULL;
    Receiver     = NULL;
+   SDESChanged  = false;
+   SDESLength   = 0;
+   memset((void*)&SDESItemPresent,0,sizeof(SDESItemPresent));
 }
 
 
@@ -53,6 +56,9 @@ RTCPSender::RTCPSender(const InternetFlow& flow,
                        const card32        controlPPID)
    : TimedThread(1000000,"RTCPSender")
 {
+   SDESChanged = false;
+   SDESLength  = 0;
+   memset((void*)&SDESItemPresent,0,sizeof(SDESItemPresent));
    init(flow,ssrc,senderSocket,receiver,bandwidth,controlPPID);
 }
 
@@ -87,15 +93,6 @@ void RTCPSender::init(const InternetFlow& flow,
 RTCPSender::~RTCPSender()
 {
    stop();
-
-   // ====== Delete SDES item list ==========================================
-   while(SDESItemSet.begin() != SDESItemSet.end()) {
-       std::multimap<const card8,RTCPSourceDescriptionItem*>::iterator sdesIterator =
-          SDESItemSet.begin();
-       RTCPSourceDescriptionItem* item = sdesIterator->second;
-       SDESItemSet.erase(sdesIterator);
-       delete [] (char*)item;
-   }
 }
 
 
@@ -108,11 +105,28 @@ void RTCPSender::timerEvent()
       return;
    }
 
-   // ====== Renew flow label and send report ===============================
-   SenderSocket->renewFlow(10);
+   // ====== Send report and SDES items =====================================
    setInterval((card64)(computeTransmissionInterval() * 1000000.0));
    sendReport();
-   sendSDES();
+}
+
+
+// ###### Send RTCP packet #################################################
+integer RTCPSender::sendPacket(const void* packet, const cardinal length)
+{
+   SocketMessage<sizeof(sctp_sndrcvinfo)> message;
+   message.setBuffer((void*)packet, length);
+   message.setAddress(Flow, SenderSocket->getFamily());
+   if(SenderSocket->getProtocol() == IPPROTO_SCTP) {
+      sctp_sndrcvinfo* info = (sctp_sndrcvinfo*)message.addHeader(
+                                 sizeof(sctp_sndrcvinfo),IPPROTO_SCTP,SCTP_SNDRCV);
+      info->sinfo_assoc_id   = 0;
+      info->sinfo_stream     = 0;
+      info->sinfo_flags      = SCTP_UNORDERED;
+      info->sinfo_timetolive = 100;   // 100ms
+      info->sinfo_ppid       = htonl(ControlPPID);
+   }
+   return(SenderSocket->sendMsg(&message.Header,MSG_NOSIGNAL,Flow.getTrafficClass()));
 }
 
 
@@ -126,21 +140,7 @@ integer RTCPSender::sendBye()
       bye->init(1);
       bye->setSource(0,SSRC);
       bye->setLength(sizeof(packet));
-
-      // ====== Send packet =================================================
-      SocketMessage<sizeof(sctp_sndrcvinfo)> message;
-      message.setBuffer(&packet, sizeof(packet));
-      message.setAddress(Flow, SenderSocket->getFamily());
-      if(SenderSocket->getProtocol() == IPPROTO_SCTP) {
-         sctp_sndrcvinfo* info = (sctp_sndrcvinfo*)message.addHeader(
-                                    sizeof(sctp_sndrcvinfo),IPPROTO_SCTP,SCTP_SNDRCV);
-         info->sinfo_assoc_id   = 0;
-         info->sinfo_stream     = 0;
-         info->sinfo_flags      = SCTP_UNORDERED;
-         info->sinfo_timetolive = 100;   // 100ms
-         info->sinfo_ppid       = htonl(ControlPPID);
-      }
-      return(SenderSocket->sendMsg(&message.Header,MSG_NOSIGNAL,Flow.getTrafficClass()));
+      return(sendPacket(&packet, sizeof(packet)));
    }
    return(0);
 }
@@ -152,29 +152,30 @@ integer RTCPSender::sendApp(const char*    name,
                             const cardinal dataLength)
 {
    if(SenderSocket != NULL) {
-      char     packet[sizeof(RTCPApp) + dataLength];
-      RTCPApp* app = (RTCPApp*)&packet;
+      if(dataLength > MaxAppDataLength) {
+         std::cerr << "ERROR: RTCPSender::sendApp() - APP data too long!" << std::endl;
+         return(-1);
+      }
+
+      // ====== Create compound packet: RR, SDES and APP ====================
+      synchronized();
+      char*          buffer       = (char*)&TransmitBuffer;
+      const cardinal reportLength = writeReport();
+      const cardinal sdesLength   = updateSDES();
+      const cardinal appLength    = (sizeof(RTCPApp) + dataLength + 3) & ~3;
 
+      RTCPApp* app = (RTCPApp*)&buffer[MaxReportLength + sdesLength];
       app->init(0);
       app->setSource(SSRC);
       app->setName(name);
-      app->setLength(sizeof(packet));
+      app->setLength(appLength);
       memcpy(app->getData(),data,dataLength);
+      memset((void*)&app->getData()[dataLength],0,appLength - sizeof(RTCPApp) - dataLength);
 
-      // ====== Send packet =================================================
-      SocketMessage<sizeof(sctp_sndrcvinfo)> message;
-      message.setBuffer(&packet, sizeof(packet));
-      message.setAddress(Flow, SenderSocket->getFamily());
-      if(SenderSocket->getProtocol() == IPPROTO_SCTP) {
-         sctp_sndrcvinfo* info = (sctp_sndrcvinfo*)message.addHeader(
-                                    sizeof(sctp_sndrcvinfo),IPPROTO_SCTP,SCTP_SNDRCV);
-         info->sinfo_assoc_id   = 0;
-         info->sinfo_stream     = 0;
-         info->sinfo_flags      = SCTP_UNORDERED;
-         info->sinfo_timetolive = 100;   // 100ms
-         info->sinfo_ppid       = htonl(ControlPPID);
-      }
-      return(SenderSocket->sendMsg(&message.Header,MSG_NOSIGNAL,Flow.getTrafficClass()));
+      const integer result = sendPacket(&buffer[MaxReportLength - reportLength],
+                                        reportLength + sdesLength + appLength);
+      unsynchronized();
+      return(result);
    }
    return(0);
 }
@@ -185,28 +186,33 @@ bool RTCPSender::addSDESItem(const card8 type,
                              const void* data,
                              const card8 length)
 {
-   synchronized();
-
-   // ====== Initialize new packet ==========================================
-   card16 len = length;
-   if((len == 0) && (data != NULL)) len = strlen((char*)data);
-   char* ptr = new char[sizeof(RTCPSourceDescriptionItem) + len];
-   if(ptr == NULL) {
-      unsynchronized();
+   if((type == RTCP_SDES_END) || (type > SDESItemTypes)) {
       return(false);
    }
-   RTCPSourceDescriptionItem* packet = (RTCPSourceDescriptionItem*)ptr;
-   packet->Type   = type;
-   packet->Length = len;
-   if(data != NULL) {
-      memcpy(&packet->Data,data,len);
-   }
 
-   // ====== Remove old packet ==============================================
-   removeSDESItem(type);
+   // ====== Initialize new item ============================================
+   cardinal len = length;
+   if((len == 0) && (data != NULL)) {
+      len = std::min(strlen((char*)data),(size_t)255);
+   }
 
-   // ====== Add new packet =================================================
-   SDESItemSet.insert(std::pair<const card8,RTCPSourceDescriptionItem*>(type,packet));
+   synchronized();
+   RTCPSourceDescriptionItem* item = (RTCPSourceDescriptionItem*)&SDESItem[type - 1];
+
+   // ====== Update item, if it has been changed ============================
+   if( (!SDESItemPresent[type - 1]) || (item->Length != len) ||
+       ((data != NULL) && (memcmp(&item->Data,data,len) != 0)) ) {
+      item->Type   = type;
+      item->Length = len;
+      if(data != NULL) {
+         memcpy(&item->Data,data,len);
+      }
+      else {
+         memset(&item->Data,0,len);
+      }
+      SDESItemPresent[type - 1] = true;
+      SDESChanged               = true;
+   }
 
    unsynchronized();
    return(true);
@@ -216,92 +222,87 @@ bool RTCPSender::addSDESItem(const card8 type,
 // ###### Remove SDES item from item list ###################################
 void RTCPSender::removeSDESItem(const card8 type)
 {
-   synchronized();
-   std::multimap<const card8,RTCPSourceDescriptionItem*>::iterator sdesIterator =
-      SDESItemSet.find(type);
-   if(sdesIterator != SDESItemSet.end()) {
-       RTCPSourceDescriptionItem* item = sdesIterator->second;
-       SDESItemSet.erase(sdesIterator);
-       delete [] (char*)item;
+   if((type != RTCP_SDES_END) && (type <= SDESItemTypes)) {
+      synchronized();
+      if(SDESItemPresent[type - 1]) {
+         SDESItemPresent[type - 1] = false;
+         SDESChanged               = true;
+      }
+      unsynchronized();
    }
-   unsynchronized();
 }
 
 
-// ###### Send SDES messages ################################################
-integer RTCPSender::sendSDES()
+// ###### Update cached SDES packet #########################################
+cardinal RTCPSender::updateSDES()
 {
-   if(SenderSocket != NULL) {
-      synchronized();
-      if(SDESItemSet.size() > 0) {
-         // ====== Initialize packet ========================================
-         char ptr[256 * (SDESItemSet.size() + 1)];
-         RTCPSourceDescription* sdes = (RTCPSourceDescription*)ptr;
-         sdes->init(1);
-         sdes->Chunk[0].SRC = SSRC;
-
-         // Copy all SDES item into one packet
-         cardinal bytes = sizeof(RTCPSourceDescription);
-         char*    adr   = (char*)&sdes->Chunk[0].Item[0];
-
-         std::multimap<const card8,RTCPSourceDescriptionItem*>::iterator sdesIterator =
-            SDESItemSet.begin();
-         while(sdesIterator != SDESItemSet.end()) {
-            RTCPSourceDescriptionItem* item = sdesIterator->second;
+   if(SDESChanged) {
+      SDESChanged = false;
+      SDESLength  = 0;
+
+      // ====== Initialize packet ===========================================
+      RTCPSourceDescription* sdes = (RTCPSourceDescription*)&((char*)&TransmitBuffer)[MaxReportLength];
+      sdes->init(1);
+      sdes->Chunk[0].SRC = SSRC;
+
+      // ====== Copy all SDES items into one packet =========================
+      cardinal bytes = sizeof(RTCPSourceDescription);
+      char*    adr   = (char*)&sdes->Chunk[0].Item[0];
+      for(cardinal i = 0;i < SDESItemTypes;i++) {
+         if(SDESItemPresent[i]) {
+            const RTCPSourceDescriptionItem* item = (const RTCPSourceDescriptionItem*)&SDESItem[i];
             memcpy(adr,item,sizeof(RTCPSourceDescriptionItem) + item->Length);
-            adr = (char*)((long)adr + (long)sizeof(RTCPSourceDescriptionItem) +
-                          (long)item->Length);
+            adr   += sizeof(RTCPSourceDescriptionItem) + item->Length;
             bytes += sizeof(RTCPSourceDescriptionItem) + item->Length;
-            sdesIterator++;
          }
+      }
 
-         // ====== Mark the end of the SDES chunk ===========================
-         if(bytes % 4) {
-            adr[0] = RTCP_SDES_END;
-            adr[1] = RTCP_SDES_END;
-            adr[2] = RTCP_SDES_END;
-            bytes += 4 - (bytes % 4);
-         }
+      // ====== Mark the end of the SDES chunk ==============================
+      if(bytes > sizeof(RTCPSourceDescription)) {
+         const cardinal padding = 4 - (bytes % 4);
+         memset(adr,RTCP_SDES_END,padding);
+         bytes += padding;
          sdes->setLength(bytes);
+         SDESLength = bytes;
+      }
+   }
+   return(SDESLength);
+}
 
-         // ====== Send packet ==============================================
-         unsynchronized();
-         SocketMessage<sizeof(sctp_sndrcvinfo)> message;
-         message.setBuffer((void*)sdes, bytes);
-         message.setAddress(Flow, SenderSocket->getFamily());
-         if(SenderSocket->getProtocol() == IPPROTO_SCTP) {
-            sctp_sndrcvinfo* info = (sctp_sndrcvinfo*)message.addHeader(
-                                       sizeof(sctp_sndrcvinfo),IPPROTO_SCTP,SCTP_SNDRCV);
-            info->sinfo_assoc_id   = 0;
-            info->sinfo_stream     = 0;
-            info->sinfo_flags      = SCTP_UNORDERED;
-            info->sinfo_timetolive = 100;   // 100ms
-            info->sinfo_ppid       = htonl(ControlPPID);
-         }
-         return(SenderSocket->sendMsg(&message.Header,MSG_NOSIGNAL,Flow.getTrafficClass()));
+
+// ###### Send SDES messages ################################################
+integer RTCPSender::sendSDES()
+{
+   if(SenderSocket != NULL) {
+      synchronized();
+      const cardinal sdesLength = updateSDES();
+      integer        result     = 0;
+      if(sdesLength > 0) {
+         result = sendPacket(&((char*)&TransmitBuffer)[MaxReportLength], sdesLength);
       }
       unsynchronized();
+      return(result);
    }
    return(0);
 }
 
 
-// ###### Send Receiver Report ##############################################
-integer RTCPSender::sendReport()
+// ###### Write Receiver Report #############################################
+cardinal RTCPSender::writeReport()
 {
+   // The report is written in front of the cached SDES packet, i.e. it
+   // ends at offset MaxReportLength of the transmit buffer.
+   char*               buffer = (char*)&TransmitBuffer;
+   RTCPReceiverReport* report;
+   cardinal            length;
    if(Receiver != NULL) {
       Receiver->synchronized();
 
       // ====== Get report data from SourceStateInfos =======================
       const cardinal layers = std::min(Receiver->getLayers(),RTPConstants::RTPMaxQualityLayers);
-      cardinal length       = sizeof(RTCPReceiverReport);
-      length += layers * sizeof(RTCPReceptionReportBlock);
-
-      char* buffer[length];
-      RTCPReceiverReport* report = (RTCPReceiverReport*)&buffer;
+      length = sizeof(RTCPReceiverReport) + layers * sizeof(RTCPReceptionReportBlock);
+      report = (RTCPReceiverReport*)&buffer[MaxReportLength - length];
       report->init(SSRC,layers);
-      report->setLength(length);
-
       for(cardinal i = 0;i < layers;i++) {
          report->rr[i].setSSRC(Receiver->SSI[i].getSSRC());
          report->rr[i].setFractionLost(Receiver->SSI[i].calculateFractionLost());
@@ -313,44 +314,53 @@ integer RTCPSender::sendReport()
       }
 
       Receiver->unsynchronized();
+   }
+   else {
+      length = sizeof(RTCPReceiverReport);
+      report = (RTCPReceiverReport*)&buffer[MaxReportLength - length];
+      report->init(SSRC,0);
+   }
+   report->setLength(length);
 
 /*
-      std::cout << "RTCPReceiverReport" << std::endl;
-      std::cout << "   RTCP Common Header:" << std::endl;
-      std::cout << "      Version     = " << report->getVersion()    << std::endl;
-      std::cout << "      Padding     = " << report->getPadding()    << std::endl;
-      std::cout << "      Count       = " << report->getCount()      << std::endl;
-      std::cout << "      Packet Type = " << (cardinal)report->getPacketType() << std::endl;
-      std::cout << "      Length      = " << report->getLength()     << std::endl;
-      std::cout << "   RTCP Report:" << std::endl;
-      std::cout << "      SSRC = " << report->getSSRC() << std::endl;
-      for(cardinal i = 0;i < layers;i++) {
-         std::cout << "   RTCP Receiver Report #" << i << ":" << std::endl;
-         std::cout << "      SSRC            = " << report->rr[i].getSSRC()         << std::endl;
-         std::cout << "      Fraction Lost   = " << report->rr[i].getFractionLost() << std::endl;
-         std::cout << "      Packets Lost    = " << report->rr[i].getPacketsLost()  << std::endl;
-         std::cout << "      Last Seq Number = " << report->rr[i].getLastSeqNum()   << std::endl;
-         std::cout << "      Interar. Jitter = " << report->rr[i].getJitter()       << std::endl;
-         std::cout << "      LSR             = " << report->rr[i].getLSR()          << std::endl;
-         std::cout << "      DLSR            = " << report->rr[i].getDLSR()         << std::endl;
-      }
-      std::cout << std::endl;
+   std::cout << "RTCPReceiverReport" << std::endl;
+   std::cout << "   RTCP Common Header:" << std::endl;
+   std::cout << "      Version     = " << report->getVersion()    << std::endl;
+   std::cout << "      Padding     = " << report->getPadding()    << std::endl;
+   std::cout << "      Count       = " << report->getCount()      << std::endl;
+   std::cout << "      Packet Type = " << (cardinal)report->getPacketType() << std::endl;
+   std::cout << "      Length      = " << report->getLength()     << std::endl;
+   std::cout << "   RTCP Report:" << std::endl;
+   std::cout << "      SSRC = " << report->getSSRC() << std::endl;
+   for(cardinal i = 0;i < report->getCount();i++) {
+      std::cout << "   RTCP Receiver Report #" << i << ":" << std::endl;
+      std::cout << "      SSRC            = " << report->rr[i].getSSRC()         << std::endl;
+      std::cout << "      Fraction Lost   = " << report->rr[i].getFractionLost() << std::endl;
+      std::cout << "      Packets Lost    = " << report->rr[i].getPacketsLost()  << std::endl;
+      std::cout << "      Last Seq Number = " << report->rr[i].getLastSeqNum()   << std::endl;
+      std::cout << "      Interar. Jitter = " << report->rr[i].getJitter()       << std::endl;
+      std::cout << "      LSR             = " << report->rr[i].getLSR()          << std::endl;
+      std::cout << "      DLSR            = " << report->rr[i].getDLSR()         << std::endl;
+   }
+   std::cout << std::endl;
 */
+   return(length);
+}
 
-      // ====== Send packet ==============================================
-      SocketMessage<sizeof(sctp_sndrcvinfo)> message;
-      message.setBuffer((void*)report,length);
-      message.setAddress(Flow, SenderSocket->getFamily());
-      if(SenderSocket->getProtocol() == IPPROTO_SCTP) {
-         sctp_sndrcvinfo* info = (sctp_sndrcvinfo*)message.addHeader(
-                                    sizeof(sctp_sndrcvinfo),IPPROTO_SCTP,SCTP_SNDRCV);
-         info->sinfo_assoc_id   = 0;
-         info->sinfo_stream     = 0;
-         info->sinfo_flags      = SCTP_UNORDERED;
-         info->sinfo_timetolive = 100;   // 100ms
-         info->sinfo_ppid       = htonl(ControlPPID);
-      }
-      return(SenderSocket->sendMsg(&message.Header,MSG_NOSIGNAL,Flow.getTrafficClass()));
+
+// ###### Send Receiver Report ##############################################
+integer RTCPSender::sendReport()
+{
+   if(SenderSocket != NULL) {
+      // ====== Create compound packet: RR and SDES =========================
+      synchronized();
+      char*          buffer       = (char*)&TransmitBuffer;
+      const cardinal reportLength = writeReport();
+      const cardinal sdesLength   = updateSDES();
+      const integer  result       = sendPacket(&buffer[MaxReportLength - reportLength],
+                                               reportLength + sdesLength);
+      unsynchronized();
+      return(result);
    }
    return(0);
 }
@@ -41,7 +41,6 @@
 #include "rtpreceiver.h"
 #include "randomizer.h"
 
-#include <map>
 
 
 /**
@@ -109,7 +108,9 @@ class RTCPSender : public TimedThread
 
    // ====== RTCP packet sending functions ==================================
    /**
-     * Send RTCP APP message.
+     * Send RTCP APP message. The APP packet is sent in a compound packet
+     * (RFC 3550), following a receiver report and the SDES items. The APP
+     * data must not exceed 1024 bytes.
      *
      * @param name RTCP APP name.
      * @param data RTCP APP data.
@@ -127,7 +128,8 @@ class RTCPSender : public TimedThread
 
    /**
      * Send RTCP receiver report from the SourceStateInfo given in the
-     * constructor.
+     * constructor. The report is sent in a compound packet together with
+     * the SDES items given by addSDESItem().
      *
      * @return Bytes sent.
      */
@@ -145,12 +147,13 @@ class RTCPSender : public TimedThread
    /**
      * Add SDES item to SDES item list.
      * If a SDES item with the same type already exists in the list, the new
-     * item replaces the old item.
+     * item replaces the old item. The SDES packet is built once and only
+     * rebuilt after an item has been changed.
      *
      * @param type SDES item type.
      * @param data SDES item data.
      * @param length SDES item data length.
-     * @return true, if item has been added; false, if not.
+     * @return true, if item has been added; false, if type is invalid.
      *
      * @see sendSDES
      */
@@ -171,15 +174,36 @@ class RTCPSender : public TimedThread
    private:
    void timerEvent();
    double computeTransmissionInterval();
+   integer sendPacket(const void* packet, const cardinal length);
+   cardinal writeReport();
+   cardinal updateSDES();
+
+
+   static const cardinal MaxReportLength    = sizeof(RTCPReceiverReport) +
+                                                 RTPConstants::RTPMaxQualityLayers * sizeof(RTCPReceptionReportBlock);
+   static const cardinal SDESItemTypes      = RTCP_SDES_PRIV;
+   static const cardinal MaxSDESItemLength  = sizeof(RTCPSourceDescriptionItem) + 255;
+   static const cardinal MaxSDESLength      = sizeof(RTCPSourceDescription) +
+                                                 SDESItemTypes * MaxSDESItemLength + 4;
+   static const cardinal MaxAppDataLength   = 1024;
+   static const cardinal TransmitBufferSize = MaxReportLength + MaxSDESLength +
+                                                 sizeof(RTCPApp) + MaxAppDataLength;
 
    InternetFlow                                          Flow;
    Socket*                                               SenderSocket;
    RTPReceiver*                                          Receiver;
    card32                                                SSRC;
-   std::multimap<const card8,RTCPSourceDescriptionItem*> SDESItemSet;
+   char                                                  SDESItem[SDESItemTypes][MaxSDESItemLength];
+   bool                                                  SDESItemPresent[SDESItemTypes];
+   bool                                                  SDESChanged;
+   cardinal                                              SDESLength;
    Randomizer                                            Random;
    card32                                                ControlPPID;
 
+   // The transmit buffer contains the receiver report (ending at offset
+   // MaxReportLength), the cached SDES packet and the APP packet.
+   card32                                                TransmitBuffer[(TransmitBufferSize + 3) / 4];
+
    bool    Initial;         // True, if application has not yet sent an RTCP packet
    bool    WeSent;          // True, if data sent since 2nd previous RTCP report
    integer Senders;         // Most current estimate for nr. of session senders
@@ -190,7 +190,7 @@ int main(int argc, char* argv[])
    // ===== Check arguments =================================================
    if(argc < 2) {
       std::cerr << "Usage: " << argv[0] << std::endl
-           << "[URL] {[+/-]debug} {[+/-]null} {[+/-]device} {-encoding=number} {-prefix=name} {-info=infostring} {-force-ipv4}" << std::endl;
+           << "[URL] {[+/-]debug} {[+/-]null} {[+/-]device} {-encoding=number} {-prefix=name} {-info=infostring} {-bandwidth=bytes/s} {-mcastif=interface} {-force-ipv4}" << std::endl;
       exit(0);
    }
    bool            optAudioDevice = true;
@@ -203,6 +203,8 @@ int main(int argc, char* argv[])
    integer         rate           = AudioQuality::HighestSamplingRate;
    integer         bits           = AudioQuality::HighestBits;
    bool            stereo         = true;
+   card32          bandwidthLimit = (card32)-1;
+   const char*     mcastInterface = NULL;
    for(cardinal i = 1;i < (cardinal)argc;i++) {
       if(!(strcasecmp(argv[i],"+debug")))               optAudioDebug  = 1;
       else if(!(strcasecmp(argv[i],"+null")))           optAudioNull   = 1;
@@ -219,6 +221,8 @@ int main(int argc, char* argv[])
       else if(!(strcasecmp(argv[i],"-stereo")))         stereo        = true;
       else if(!(strcasecmp(argv[i],"-mono")))           stereo        = false;
       else if(!(strncasecmp(argv[i],"-encoding=",10)))  encoding      = atol(&argv[i][10]);
+      else if(!(strncasecmp(argv[i],"-bandwidth=",11))) bandwidthLimit = (card32)atol(&argv[i][11]);
+      else if(!(strncasecmp(argv[i],"-mcastif=",9)))    mcastInterface = &argv[i][9];
       else if(argv[i][0] == '-') {
          std::cerr << "Wrong parameter: " << argv[i] << std::endl;
       }
@@ -275,6 +279,8 @@ int main(int argc, char* argv[])
       }
    }
    client->setChannels((stereo == true) ? 2 : 1);
+   client->setBandwidthLimit(bandwidthLimit);
+   client->setMulticastInterface(mcastInterface);
 
 
    // ====== Start playing ==================================================
@@ -367,6 +373,9 @@ int main(int argc, char* argv[])
                 client->getBits(),
                 ((client->getChannels() == 2) ? "Stereo" : "Mono"),
                 client->getEncoding());
+         if(client->getJoinedLayers() > 0) {
+            printf("[Joined Layers: %u]  ",client->getJoinedLayers());
+         }
          fflush(stdout);
       }
 
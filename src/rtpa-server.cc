@@ -38,8 +38,15 @@
 #include "rtcpabstractserver.h"
 #include "audioclientapppacket.h"
 #include "audioserver.h"
+#include "multicastchannel.h"
 #include "tools.h"
 #include "breakdetector.h"
+#include "decodeaheadreader.h"
+#include "mp3decoderpool.h"
+#include "multiaudioreader.h"
+#include "renditioncache.h"
+#include "soundreadahead.h"
+#include "statisticsserver.h"
 
 #define WITH_QOSMGR
 #ifdef WITH_QOSMGR
@@ -51,6 +58,7 @@
 #endif
 
 #include <fstream>
+#include <vector>
 
 
 
@@ -67,6 +75,10 @@ static Socket*                pingSocket4       = NULL;
 static Socket*                pingSocket6       = NULL;
 static RoundTripTimePinger*   pinger            = NULL;
 static std::ofstream*         logStream         = NULL;
+static MP3DecoderPool*        decoderPool       = NULL;
+static RenditionCache*        renditionCache    = NULL;
+static StatisticsServer*      statisticsServer  = NULL;
+static std::vector<MulticastChannel*> channels;
 
 
 void cleanUp(const cardinal exitCode = 0);
@@ -78,6 +90,8 @@ void initAll(const char*    directory,
              const card64   timeout,
              const cardinal maxPacketSize,
              const bool     lossScalability,
+             const bool     broadcastGroups,
+             const cardinal sharedSockets,
              const bool     useSCTP)
 {
    const InternetAddress localAddress(port);
@@ -102,6 +116,11 @@ void initAll(const char*    directory,
    }
    server->setDefaultTimeout(timeout);
    server->setLossScalability(lossScalability);
+   server->setBroadcastGroups(broadcastGroups);
+   if(server->setSharedSockets(sharedSockets) == false) {
+      std::cerr << "ERROR: Server::initAll() - Unable to create shared sender sockets!" << std::endl;
+      cleanUp(1);
+   }
    rtcpReceiver = new RTCPReceiver(server,rtcpServerSocket);
    if(rtcpReceiver == NULL) {
       std::cerr << "ERROR: Server::initAll() - Out of memory!" << std::endl;
@@ -129,9 +148,58 @@ void initAll(const char*    directory,
 }
 
 
+// ###### Start layered multicast channels ##################################
+void initChannels(const std::vector<String>& channelList,
+                  const char*                interface,
+                  const card8                ttl,
+                  const cardinal             maxPacketSize)
+{
+   for(std::vector<String>::const_iterator iterator = channelList.begin();
+       iterator != channelList.end();iterator++) {
+      // ====== Get group and media name ====================================
+      String protocol("rtpa+mcast");
+      String host;
+      String mediaName;
+      InternetAddress group;
+      if(scanURL(*iterator,protocol,host,mediaName) == true) {
+         group = InternetAddress(host);
+         if((group.isValid()) && (group.getPort() == 0)) {
+            group.setPort(RTPAudioDefaultPort);
+         }
+      }
+      if((!group.isValid()) || (!group.isMulticast()) || (mediaName.length() == 0)) {
+         std::cerr << "ERROR: Bad channel <" << *iterator << ">!" << std::endl;
+         std::cerr << "       Syntax: -channel=<group>:<port>/<media>" << std::endl;
+         cleanUp(1);
+      }
+
+      // ====== Start channel ===============================================
+      MulticastChannel* channel = new MulticastChannel(group,mediaName.getData(),
+                                                       interface,ttl,maxPacketSize);
+      if(channel == NULL) {
+         std::cerr << "ERROR: Server::initChannels() - Out of memory!" << std::endl;
+         cleanUp(1);
+      }
+      channels.push_back(channel);
+      if(channel->start() == false) {
+         std::cerr << "ERROR: Unable to start channel <" << *iterator << ">!" << std::endl;
+         cleanUp(1);
+      }
+   }
+}
+
+
 // ###### Clean up ##########################################################
 void cleanUp(const cardinal exitCode)
 {
+   if(statisticsServer != NULL) {
+      delete statisticsServer;
+      statisticsServer = NULL;
+   }
+   while(!channels.empty()) {
+      delete channels.back();
+      channels.pop_back();
+   }
    if(rtcpReceiver != NULL) {
       rtcpReceiver->stop();
       delete rtcpReceiver;
@@ -150,6 +218,17 @@ void cleanUp(const cardinal exitCode)
       delete qosManager;
       qosManager = NULL;
    }
+   if(renditionCache != NULL) {
+      MultiAudioReader::setRenditionCache(NULL);
+      delete renditionCache;
+      renditionCache = NULL;
+   }
+   if(decoderPool != NULL) {
+      DecodeAheadReader::setDecoderPool(NULL);
+      delete decoderPool;
+      decoderPool = NULL;
+   }
+   Soundreadahead::stop();
    if(exitCode == 0) {
       std::cout << "Terminated!" << std::endl;
    }
@@ -164,6 +243,8 @@ int main(int argc, char* argv[])
    bool     optForceIPv4           = false;
    bool     optUseSCTP             = false;
    bool     lossScalability        = true;
+   bool     broadcastGroups        = false;
+   cardinal sharedSockets          = 0;
    bool     disableQM              = false;
    double   fairnessSession        = 0.0;
    double   fairnessStream         = 1.0;
@@ -177,11 +258,19 @@ int main(int argc, char* argv[])
    double   sdTolerance            = 50000.0;
    bool     unlayered              = false;
    cardinal maxPacketSize          = 1500;
+   cardinal decoders               = 0;
+   cardinal decodeAhead            = 8;
+   cardinal readAheadRequests      = 0;
    card64   timeout                = 10000000;
    card16   port                   = RTPAudioDefaultPort;
+   cardinal multicastTTL           = AudioServerDefaultMulticastTTL;
+   char*    multicastInterface     = NULL;
    char*    logName                = NULL;
+   char*    statisticsName         = NULL;
    String   slaFile("SLA.config");
    String   directory;
+   String   renditionDirectory;
+   std::vector<String> channelList;
 
 
    // ====== Read configuration from file ===================================
@@ -338,15 +427,28 @@ int main(int argc, char* argv[])
       else if(!(strncasecmp(argv[i],"-port=",6)))        port      = (card16)atol(&argv[i][6]);
       else if(!(strncasecmp(argv[i],"-timeout=",9)))     timeout   = 1000000 * (card64)atol(&argv[i][9]);
       else if(!(strncasecmp(argv[i],"-maxpktsize=",12))) maxPacketSize = (cardinal)atol(&argv[i][12]);
+      else if(!(strncasecmp(argv[i],"-decoders=",10)))   decoders      = (cardinal)atol(&argv[i][10]);
+      else if(!(strncasecmp(argv[i],"-decodeahead=",13))) decodeAhead   = (cardinal)atol(&argv[i][13]);
+      else if(!(strncasecmp(argv[i],"-readahead=",11)))  readAheadRequests = (cardinal)atol(&argv[i][11]);
       else if(!(strcasecmp(argv[i],"-disable-qm")))      disableQM = true;
       else if(!(strcasecmp(argv[i],"-enable-qm")))       disableQM = false;
       else if(!(strcasecmp(argv[i],"-disable-ls")))      lossScalability = false;
       else if(!(strcasecmp(argv[i],"-enable-ls")))       lossScalability = true;
+      else if(!(strcasecmp(argv[i],"-broadcast")))       broadcastGroups = true;
+      else if(!(strcasecmp(argv[i],"-nobroadcast")))     broadcastGroups = false;
+      else if(!(strcasecmp(argv[i],"-sharedsockets")))   sharedSockets = (cardinal)std::max(1L,sysconf(_SC_NPROCESSORS_ONLN));
+      else if(!(strncasecmp(argv[i],"-sharedsockets=",15))) sharedSockets = (cardinal)atol(&argv[i][15]);
+      else if(!(strcasecmp(argv[i],"-nosharedsockets"))) sharedSockets = 0;
       else if(!(strncasecmp(argv[i],"-sla=",5)))         slaFile       = &argv[i][5];
       else if(!(strncasecmp(argv[i],"-log=",5)))         logName      = &argv[i][5];
+      else if(!(strncasecmp(argv[i],"-stats=",7)))       statisticsName = &argv[i][7];
       else if(!(strncasecmp(argv[i],"-directory=",11)))  directory = String(&argv[i][11]);
+      else if(!(strncasecmp(argv[i],"-renditions=",12))) renditionDirectory = String(&argv[i][12]);
+      else if(!(strncasecmp(argv[i],"-channel=",9)))     channelList.push_back(String(&argv[i][9]));
+      else if(!(strncasecmp(argv[i],"-mcastif=",9)))     multicastInterface = &argv[i][9];
+      else if(!(strncasecmp(argv[i],"-mcastttl=",10)))   multicastTTL  = (cardinal)atol(&argv[i][10]);
       else {
-         std::cerr << "Usage: " << argv[0] << " {-port=port} {-directory=path} {-manager=host:port} {-timeout=secs} {-maxpktsize=bytes} {-disable-qm|-enable-qm} {-disable-ls|-enable-ls} {-force-ipv4|-use-ipv6}" << std::endl;
+         std::cerr << "Usage: " << argv[0] << " {-port=port} {-directory=path} {-renditions=path} {-manager=host:port} {-timeout=secs} {-maxpktsize=bytes} {-decoders=threads} {-decodeahead=frames} {-readahead=requests} {-stats=socket} {-disable-qm|-enable-qm} {-disable-ls|-enable-ls} {-broadcast|-nobroadcast} {-sharedsockets{=count}|-nosharedsockets} {-channel=group:port/media} {-mcastif=interface} {-mcastttl=ttl} {-force-ipv4|-use-ipv6}" << std::endl;
          exit(1);
       }
    }
@@ -372,6 +474,28 @@ int main(int argc, char* argv[])
    else if(maxPacketSize > 1024 * 1024) {
       maxPacketSize = 1024 * 1024;
    }
+   if(decoders > 64) {
+      decoders = 64;
+   }
+   if(decodeAhead < 1) {
+      decodeAhead = 1;
+   }
+   else if(decodeAhead > 1024) {
+      decodeAhead = 1024;
+   }
+   if(readAheadRequests > 4096) {
+      readAheadRequests = 4096;
+   }
+   if(sharedSockets > 1024) {
+      sharedSockets = 1024;
+   }
+   if((optUseSCTP) && (sharedSockets > 0)) {
+      std::cerr << "NOTE: Shared sockets are not supported with SCTP, using one socket per user." << std::endl;
+      sharedSockets = 0;
+   }
+   if(multicastTTL > 255) {
+      multicastTTL = 255;
+   }
 
 
    // ====== Initialize QoS manager =========================================
@@ -453,13 +577,58 @@ int main(int argc, char* argv[])
    }
 
 
+   // ====== Initialize decoder pool ========================================
+   if(decoders > 0) {
+      decoderPool = new MP3DecoderPool(decoders,decodeAhead);
+      if((decoderPool == NULL) || (!decoderPool->ready())) {
+         std::cerr << "ERROR: Unable to start decoder threads!" << std::endl;
+         cleanUp(1);
+      }
+      DecodeAheadReader::setDecoderPool(decoderPool);
+   }
+
+
+   // ====== Initialize rendition cache =====================================
+   // The path is resolved here, since initAll() changes the directory.
+   if(renditionDirectory.length() > 0) {
+      char* path = realpath(renditionDirectory.getData(),NULL);
+      renditionCache = new RenditionCache((path != NULL) ? path : renditionDirectory.getData());
+      free(path);
+      if((renditionCache == NULL) || (!renditionCache->ready())) {
+         std::cerr << "ERROR: Unable to use rendition directory <" << renditionDirectory << ">!" << std::endl;
+         cleanUp(1);
+      }
+      MultiAudioReader::setRenditionCache(renditionCache);
+   }
+
+
+   // ====== Initialize media file read-ahead ===============================
+   if(readAheadRequests > 0) {
+      if(!Soundreadahead::start(readAheadRequests,128 * 1024)) {
+         std::cerr << "WARNING: io_uring is not available, using kernel read-ahead!" << std::endl;
+      }
+   }
+
+
    // ====== Initialize =====================================================
    initAll(directory.getData(), port,
-           timeout, maxPacketSize, lossScalability,
-           optUseSCTP);
+           timeout, maxPacketSize, lossScalability, broadcastGroups,
+           sharedSockets, optUseSCTP);
+   initChannels(channelList, multicastInterface, (card8)multicastTTL, maxPacketSize);
+   if(statisticsName != NULL) {
+      statisticsServer = new StatisticsServer(statisticsName);
+      if((statisticsServer == NULL) || (!statisticsServer->ready()) ||
+         (!statisticsServer->start())) {
+         std::cerr << "ERROR: Unable to create statistics socket <" << statisticsName << ">!" << std::endl;
+         cleanUp(1);
+      }
+   }
 #ifndef FAST_BREAK
    installBreakDetector();
 #endif
+#ifdef SYNCHRONIZABLE_PROFILING
+   LockProfiler::installDumpSignal(SIGUSR1);
+#endif
 
    InternetAddress ourAddress;
    rtcpServerSocket->getSocketAddress(ourAddress);
@@ -484,7 +653,42 @@ int main(int argc, char* argv[])
              << "Input Directory:  " << directory << std::endl
              << "Max Packet Size:  " << maxPacketSize << std::endl
              << "Loss Scalability: " << (lossScalability ? "on" : "off") << std::endl
-             << std::endl;
+             << "Broadcast Groups: " << (broadcastGroups ? ((qosManager != NULL) ? "off (QoS manager)" : "on") : "off") << std::endl
+             << "Sender Sockets:   ";
+   if(sharedSockets > 0) {
+      std::cout << sharedSockets << " shared" << std::endl;
+   }
+   else {
+      std::cout << "one per user" << std::endl;
+   }
+   std::cout << "Decoders:         ";
+   if(decoders > 0) {
+      std::cout << decoders << " threads, " << decodeAhead << " frames ahead" << std::endl;
+   }
+   else {
+      std::cout << "synchronous" << std::endl;
+   }
+   std::cout << "Renditions:       "
+             << ((renditionCache != NULL) ? renditionCache->getDirectory().getData() : "off") << std::endl;
+   std::cout << "Read-Ahead:       ";
+   if(Soundreadahead::running()) {
+      std::cout << "io_uring, " << readAheadRequests << " requests" << std::endl;
+   }
+   else {
+      std::cout << "kernel" << std::endl;
+   }
+   std::cout << "Statistics:       "
+             << ((statisticsServer != NULL) ? statisticsServer->getPath().getData() : "off") << std::endl;
+   for(std::vector<MulticastChannel*>::iterator iterator = channels.begin();
+       iterator != channels.end();iterator++) {
+      std::cout << "Channel:          " << (*iterator)->getMediaName()
+                << " -> " << (*iterator)->getGroup()
+                << ", TTL " << multicastTTL << std::endl;
+   }
+#ifdef SYNCHRONIZABLE_PROFILING
+   std::cout << "Lock Profiling:   on (SIGUSR1 prints statistics)" << std::endl;
+#endif
+   std::cout << std::endl;
 
 
    // ====== Main loop ======================================================
@@ -493,7 +697,14 @@ int main(int argc, char* argv[])
       if(breakDetected())
          break;
 #endif
+#ifdef SYNCHRONIZABLE_PROFILING
+      if(LockProfiler::dumpRequested()) {
+         LockProfiler::dump(std::cerr);
+      }
+      Thread::delay(1000000,true);
+#else
       Thread::delay(10000000,true);
+#endif
    }
 
 
@@ -161,6 +161,12 @@ class RTPReceiver : public Thread
      */
    inline SourceStateInfo getSSI(const cardinal layer = 0);
 
+   /**
+     * Reset SourceStateInfo for given layer, e.g. when a layer's multicast
+     * group is joined again after a pause.
+     */
+   inline void resetSSI(const cardinal layer);
+
 
    /**
      * RTCPSender is a friend class to enable efficient update of
@@ -47,8 +47,10 @@
 RTPSender::RTPSender()
    : TimedThread(1000000,"RTPSender")
 {
-   Encoder      = NULL;
-   SenderSocket = NULL;
+   Encoder         = NULL;
+   SenderSocket    = NULL;
+   BroadcastSource = NULL;
+   Statistics      = NULL;
 }
 
 
@@ -63,6 +65,7 @@ RTPSender::RTPSender(const InternetFlow&  flow,
                      QoSManagerInterface* qosManager)
    : TimedThread(1000000,"RTPSender")
 {
+   Statistics = NULL;
    init(flow,ssrc,encoder,senderSocket,controlPPID,dataPPID,maxPacketSize,qosManager);
 }
 
@@ -79,6 +82,7 @@ void RTPSender::init(const InternetFlow&  flow,
 {
    Encoder            = encoder;
    SenderSocket       = senderSocket;
+   BroadcastSource    = NULL;
    QoSMgr             = qosManager;
    MaxPacketSize      = maxPacketSize;
    BytesSent          = 0;
@@ -86,13 +90,16 @@ void RTPSender::init(const InternetFlow&  flow,
    PayloadPacketsSent = 0;
    PayloadBytesSent   = 0;
    FramesPerSecond    = 0;
-   RenewCounter       = 0;
+   ReportCounter      = 0;
+   Layers             = 1;
+   SenderReportLayer  = 0;
    Pause              = false;
    TransmissionError  = false;
    TimeStamp          = getMicroTime();
    SSRC               = ssrc;
    ControlPPID        = controlPPID;
    DataPPID           = dataPPID;
+   RTTEstimator.reset();
    Randomizer random;
 
    for(cardinal i = 0;i < RTPConstants::RTPMaxQualityLayers;i++) {
@@ -165,6 +172,7 @@ void RTPSender::updateQuality(const AbstractQoSDescription* aqd)
       // ====== Update traffic constraints ==================================
       const cardinal layers    = std::min(aqd->getLayers(),RTPConstants::RTPMaxQualityLayers);
       const double   frameRate = aqd->getFrameRate();
+      Layers = std::max(layers,(cardinal)1);
       for(cardinal i = 0;i < layers;i++) {
          AbstractLayerDescription* ald = aqd->getLayer(i);
          Flow[i] = ald->getDestination();
@@ -190,6 +198,21 @@ void RTPSender::updateQuality(const AbstractQoSDescription* aqd)
 }
 
 
+// ###### Get round trip time ###############################################
+cardinal RTPSender::getRoundTripTime(const card8 trafficClass)
+{
+   // RTTEstimator has its own lock, RTPSender's lock is not required here.
+   return(RTTEstimator.getRoundTripTime(trafficClass));
+}
+
+
+// ###### Handle reception report ###########################################
+void RTPSender::receptionReport(const RTCPReceptionReportBlock* report)
+{
+   RTTEstimator.receptionReport(report,getMicroTime());
+}
+
+
 // ###### Update frame rate #################################################
 void RTPSender::updateFrameRate(const AbstractQoSDescription* aqd)
 {
@@ -211,6 +234,48 @@ void RTPSender::updateFrameRate(const AbstractQoSDescription* aqd)
 }
 
 
+// ###### Set flow of a quality layer #######################################
+void RTPSender::setLayerFlow(const cardinal layer, const InternetFlow& flow)
+{
+   if(layer < RTPConstants::RTPMaxQualityLayers) {
+      synchronized();
+      Flow[layer] = flow;
+      Layers      = std::max(Layers,layer + 1);
+      unsynchronized();
+   }
+}
+
+
+// ###### Add broadcast receiver ############################################
+void RTPSender::addBroadcastReceiver(RTPSender* receiver)
+{
+   synchronized();
+   receiver->synchronized();
+   receiver->BroadcastSource = this;
+   BroadcastReceivers.push_back(receiver);
+   receiver->unsynchronized();
+   unsynchronized();
+}
+
+
+// ###### Remove broadcast receiver #########################################
+void RTPSender::removeBroadcastReceiver(RTPSender* receiver)
+{
+   synchronized();
+   receiver->synchronized();
+   for(std::vector<RTPSender*>::iterator iterator = BroadcastReceivers.begin();
+       iterator != BroadcastReceivers.end();iterator++) {
+      if(*iterator == receiver) {
+         BroadcastReceivers.erase(iterator);
+         receiver->BroadcastSource = NULL;
+         break;
+      }
+   }
+   receiver->unsynchronized();
+   unsynchronized();
+}
+
+
 // ###### Lock sender #######################################################
 void RTPSender::lock()
 {
@@ -236,33 +301,36 @@ void RTPSender::timerEvent()
    synchronized();
 
 
-   // ==== Renew flow label reservation and send sender report every second =
-   RenewCounter++;
-   if(RenewCounter >= FramesPerSecond) {
-      // ====== Renew flow label ============================================
-      SenderSocket->renewFlow(10);
-      for(cardinal i = 0;i < RTPConstants::RTPMaxQualityLayers;i++) {
-         SenderSocket->renewFlow(Flow[i],10);
-      }
-      RenewCounter = 0;
+   // ====== Send sender report every second ================================
+   ReportCounter++;
+   if(ReportCounter >= FramesPerSecond) {
+      ReportCounter = 0;
 
       // ====== Create RTCP Sender Report ===================================
+      // The sender reports are sent using the layers' traffic classes in
+      // turn. The LSR/DLSR echo of the remote side's receiver reports
+      // then provides a round trip time estimate for each class.
+      SenderReportLayer = (SenderReportLayer + 1) % Layers;
+      const InternetFlow& reportFlow = Flow[SenderReportLayer];
       RTCPSenderReport report(SSRC,0);
       const card64 now = getMicroTime();
-      report.setNTPTimeStamp(now);
+      const card64 ntp = RoundTripTimeEstimator::microTimeToNTP(now);
+      report.setNTPTimeStamp(ntp);
       report.setRTPTimeStamp(
          (card32)rint((double)(now - TimeStamp) /
                       RTPConstants::RTPMicroSecondsPerTimeStamp) & 0xffffffff);
       report.setOctetsSent(PayloadBytesSent);
       report.setPacketsSent(PayloadPacketsSent);
+      RTTEstimator.senderReportSent(ntp,reportFlow.getTrafficClass());
 
       // ====== Send RTCP Sender Report =====================================
 #ifdef USE_TRAFFICSHAPER
       if(SenderReportBuffer.send(&report,sizeof(RTCPSenderReport),(cardinal)-1,(SenderSocket->getProtocol() == IPPROTO_SCTP) ? SCTP_UNORDERED|MSG_NOSIGNAL : MSG_NOSIGNAL) != sizeof(RTCPSenderReport)) {
+         const integer error = SenderSocket->getLastError();
 #else
       SocketMessage<sizeof(sctp_sndrcvinfo)> message;
       message.setBuffer(&report,sizeof(RTCPSenderReport));
-      message.setAddress(Flow[0],SenderSocket->getFamily());
+      message.setAddress(reportFlow,SenderSocket->getFamily());
       if(SenderSocket->getProtocol() == IPPROTO_SCTP) {
          sctp_sndrcvinfo* info = (sctp_sndrcvinfo*)message.addHeader(
                                     sizeof(sctp_sndrcvinfo),IPPROTO_SCTP,SCTP_SNDRCV);
@@ -272,9 +340,12 @@ void RTPSender::timerEvent()
          info->sinfo_timetolive = 100;   // 100ms
          info->sinfo_ppid       = htonl(ControlPPID);
       }
-      if(SenderSocket->sendMsg(&message.Header,MSG_NOSIGNAL,Flow[0].getTrafficClass()))  {
+      // The socket may be shared with other senders, so the error is taken
+      // from the result instead of the socket's last error.
+      const ssize_t result = SenderSocket->sendMsg(&message.Header,MSG_NOSIGNAL,reportFlow.getTrafficClass());
+      if(result < 0) {
+         const integer error = (integer)-result;
 #endif
-         const integer error = SenderSocket->getLastError();
          if((TransmissionError == false) && (error != EAGAIN) && (error != EINTR)) {
 #ifdef DEBUG
             std::cerr << "RTPSender::timerEvent() - Transmission of RTCP SR failed!" << std::endl;
@@ -285,6 +356,15 @@ void RTPSender::timerEvent()
    }
 
 
+   // ====== Update statistics once per second ==============================
+   if(Statistics != NULL) {
+      const card64 now = getMicroTime();
+      if(now - StatLastUpdate >= 1000000) {
+         updateStatistics(now);
+      }
+   }
+
+
    // ====== Transmit next frame ============================================
    RTPPacket packet;
    InternetAddress peerAddress;
@@ -299,7 +379,7 @@ void RTPSender::timerEvent()
       maxPacketSize - (headerSizeTransport + headerSizeRTP);
 
 
-   if(!Pause) {
+   if((!Pause) && (BroadcastSource == NULL)) {
       card64     nextInterval = (card64)-1;
       bool       newRUList    = false;
       const bool newInterval  = Encoder->checkInterval(nextInterval,newRUList);
@@ -312,8 +392,10 @@ void RTPSender::timerEvent()
 
 
    // ====== Prepare next frame for sending =================================
-   if((!Pause) && (Encoder->prepareNextFrame(headerSizeTransport + headerSizeRTP,
-                                             maxPacketSize) == true)) {
+   // A broadcast receiver gets its packets from its broadcast source.
+   if((!Pause) && (BroadcastSource == NULL) &&
+      (Encoder->prepareNextFrame(headerSizeTransport + headerSizeRTP,
+                                 maxPacketSize) == true)) {
 
       // ====== Get packet and transmit packet loop =========================
       cardinal bytesData = 0;
@@ -334,101 +416,21 @@ void RTPSender::timerEvent()
 
          // ====== Check, if frame has been transmitted completely ==========
          if(bytesData > 0) {
-            // ====== Initialize RTP packet header ==========================
-            packet.setMarker(encoderPacket.Marker);
-            packet.setPayloadType(encoderPacket.PayloadType);
-            packet.setSequenceNumber(SequenceNumber[encoderPacket.Layer]);
-            packet.setSSRC(SSRC);
-            packet.setTimeStamp((card32)rint((double)(getMicroTime() - TimeStamp) /
-                                RTPConstants::RTPMicroSecondsPerTimeStamp) & 0xffffffff);
-
-            // ====== Send packet via traffic shaper =========================
-            ssize_t sent;
-#ifdef USE_TRAFFICSHAPER
-            if(encoderPacket.ErrorCode >= ME_UnrecoverableError) {
-                sent = SenderReportBuffer.sendTo(
-                          &packet,
-                          packet.calculateHeaderSize() + bytesData,
-                          SequenceNumber[encoderPacket.Layer],
-                          (SenderSocket->getProtocol() == IPPROTO_SCTP) ? SCTP_UNORDERED : 0,
-                          Flow[encoderPacket.Layer],
-                          Flow[encoderPacket.Layer].getTrafficClass());
-            }
-            else {
-                sent = Shaper[encoderPacket.Layer].sendTo(
-                          &packet,
-                          packet.calculateHeaderSize() + bytesData,
-                          SequenceNumber[encoderPacket.Layer],
-                          (SenderSocket->getProtocol() == IPPROTO_SCTP) ? SCTP_UNORDERED : 0,
-                          Flow[encoderPacket.Layer],
-                          Flow[encoderPacket.Layer].getTrafficClass());
-            }
-            if(sent < 0) {
-               SequenceNumber[encoderPacket.Layer] = Shaper[encoderPacket.Layer].getLastSeqNum();
-               if(QoSMgr != NULL) {
-                  QoSMgr->bufferFlushEvent(this,encoderPacket.Layer);
-               }
-               packet.setSequenceNumber(SequenceNumber[encoderPacket.Layer]);
-               sent = Shaper[encoderPacket.Layer].sendTo(
-                         &packet,
-                         packet.calculateHeaderSize() + bytesData,
-                         SequenceNumber[encoderPacket.Layer],
-                         (SenderSocket->getProtocol() == IPPROTO_SCTP) ? SCTP_UNORDERED : 0,
-                         Flow[encoderPacket.Layer],
-                         Flow[encoderPacket.Layer].getTrafficClass());
+            const bool sent = sendPacket(packet,bytesData,encoderPacket,
+                                         headerSizeTransport);
+
+            // ====== Send packet to broadcast receivers ====================
+            // A transmission error of this sender must not starve its
+            // receivers. They get the rest of the frame until the server
+            // deletes this sender and they continue with their own encoders.
+            for(std::vector<RTPSender*>::iterator iterator = BroadcastReceivers.begin();
+                iterator != BroadcastReceivers.end();iterator++) {
+               (*iterator)->sendBroadcastPacket(packet,bytesData,encoderPacket,
+                                                headerSizeTransport);
             }
-
-            // ====== Send packet without traffic shaper ====================
-#else
-            SocketMessage<sizeof(sctp_sndrcvinfo)> message;
-            message.setBuffer(&packet, packet.calculateHeaderSize() + bytesData);
-            message.setAddress(Flow[encoderPacket.Layer], SenderSocket->getFamily());
-            if(SenderSocket->getProtocol() == IPPROTO_SCTP) {
-               sctp_sndrcvinfo* info = (sctp_sndrcvinfo*)message.addHeader(
-                                          sizeof(sctp_sndrcvinfo),IPPROTO_SCTP,SCTP_SNDRCV);
-               info->sinfo_assoc_id   = 0;
-               info->sinfo_stream     = (unsigned short)encoderPacket.Layer;
-               info->sinfo_flags      = SCTP_UNORDERED;
-               info->sinfo_timetolive = 100;   // 100ms
-               info->sinfo_ppid       = htonl(DataPPID);
-            }
-            sent = SenderSocket->sendMsg(&message.Header,MSG_NOSIGNAL,Flow[encoderPacket.Layer].getTrafficClass());
-#endif
-
-            // ====== Update counters and sequence number ===================
-            if(sent > 0) {
-               PayloadBytesSent += (card32)sent;
-               PayloadPacketsSent++;
-               BytesSent += sent + headerSizeTransport;
-               PacketsSent++;
-               SequenceNumber[encoderPacket.Layer]++;
-            }
-            else {
-               const integer error = SenderSocket->getLastError();
-               if((error != 0) && (TransmissionError == false) && (error != EAGAIN) && (error != EINTR)) {
-                  std::cerr << "WARNING: RTPSender::timerEvent() - "
-                            << "Unable to send " << packet.calculateHeaderSize() + bytesData
-                            << " bytes to " << Flow[encoderPacket.Layer] << std::endl
-                            << "Transmission error #"
-                            << error << ": " << strerror(error) << std::endl;
-                  TransmissionError = true;
-                  break;
-               }
-            }
-
-
-            // ====== Check for traffic shaper transmission errors ==========
-#ifdef USE_TRAFFICSHAPER
-            const integer error = SenderSocket->getLastError();
-            if((error > 0) && (error != -EINTR) && (TransmissionError == false)) {
-               if(error != -ECONNREFUSED) {
-                  std::cerr << "WARNING: RTPSender::timerEvent() - Transmission error #"
-                            << error << ": " << strerror(error) << std::endl;
-               }
-               TransmissionError = true;
+            if((sent == false) && (BroadcastReceivers.empty())) {
                break;
             }
-#endif
          }
          else {
             break;
@@ -450,3 +452,169 @@ void RTPSender::timerEvent()
 
    unsynchronized();
 }
+
+
+// ###### Set statistics slot ##############################################
+void RTPSender::setStatistics(StatisticsSlot* statistics)
+{
+   synchronized();
+   Statistics = statistics;
+   if(Statistics != NULL) {
+      StatBitrate           = Statistics->addCounter("Bitrate","bit/s");
+      StatBytesSent         = Statistics->addCounter("BytesSent","B");
+      StatPacketsSent       = Statistics->addCounter("PacketsSent");
+      StatPayloadBytesSent  = Statistics->addCounter("PayloadBytesSent","B");
+#ifdef USE_TRAFFICSHAPER
+      StatShaperQueueLength = Statistics->addCounter("ShaperQueueLength");
+#endif
+      StatLastBytesSent     = BytesSent;
+      StatLastUpdate        = getMicroTime();
+   }
+   unsynchronized();
+}
+
+
+// ###### Update statistics #################################################
+void RTPSender::updateStatistics(const card64 now)
+{
+   if((now > StatLastUpdate) && (BytesSent >= StatLastBytesSent)) {
+      Statistics->set(StatBitrate,
+                      (8 * (BytesSent - StatLastBytesSent) * 1000000) / (now - StatLastUpdate));
+   }
+   StatLastBytesSent = BytesSent;
+   StatLastUpdate    = now;
+   Statistics->set(StatBytesSent,BytesSent);
+   Statistics->set(StatPacketsSent,PacketsSent);
+   Statistics->set(StatPayloadBytesSent,PayloadBytesSent);
+#ifdef USE_TRAFFICSHAPER
+   cardinal queueLength = 0;
+   for(cardinal i = 0;i < Layers;i++) {
+      queueLength += Shaper[i].getQueueLength();
+   }
+   Statistics->set(StatShaperQueueLength,queueLength);
+#endif
+}
+
+
+// ###### Send packet #######################################################
+bool RTPSender::sendPacket(RTPPacket&           packet,
+                           const cardinal       bytesData,
+                           const EncoderPacket& encoderPacket,
+                           const cardinal       headerSizeTransport)
+{
+   // ====== Initialize RTP packet header ===================================
+   packet.setMarker(encoderPacket.Marker);
+   packet.setPayloadType(encoderPacket.PayloadType);
+   packet.setSequenceNumber(SequenceNumber[encoderPacket.Layer]);
+   packet.setSSRC(SSRC);
+   packet.setTimeStamp((card32)rint((double)(getMicroTime() - TimeStamp) /
+                       RTPConstants::RTPMicroSecondsPerTimeStamp) & 0xffffffff);
+
+   // ====== Send packet via traffic shaper =================================
+   ssize_t sent;
+#ifdef USE_TRAFFICSHAPER
+   if(encoderPacket.ErrorCode >= ME_UnrecoverableError) {
+       sent = SenderReportBuffer.sendTo(
+                 &packet,
+                 packet.calculateHeaderSize() + bytesData,
+                 SequenceNumber[encoderPacket.Layer],
+                 (SenderSocket->getProtocol() == IPPROTO_SCTP) ? SCTP_UNORDERED : 0,
+                 Flow[encoderPacket.Layer],
+                 Flow[encoderPacket.Layer].getTrafficClass());
+   }
+   else {
+       sent = Shaper[encoderPacket.Layer].sendTo(
+                 &packet,
+                 packet.calculateHeaderSize() + bytesData,
+                 SequenceNumber[encoderPacket.Layer],
+                 (SenderSocket->getProtocol() == IPPROTO_SCTP) ? SCTP_UNORDERED : 0,
+                 Flow[encoderPacket.Layer],
+                 Flow[encoderPacket.Layer].getTrafficClass());
+   }
+   if(sent < 0) {
+      SequenceNumber[encoderPacket.Layer] = Shaper[encoderPacket.Layer].getLastSeqNum();
+      if(QoSMgr != NULL) {
+         QoSMgr->bufferFlushEvent(this,encoderPacket.Layer);
+      }
+      packet.setSequenceNumber(SequenceNumber[encoderPacket.Layer]);
+      sent = Shaper[encoderPacket.Layer].sendTo(
+                &packet,
+                packet.calculateHeaderSize() + bytesData,
+                SequenceNumber[encoderPacket.Layer],
+                (SenderSocket->getProtocol() == IPPROTO_SCTP) ? SCTP_UNORDERED : 0,
+                Flow[encoderPacket.Layer],
+                Flow[encoderPacket.Layer].getTrafficClass());
+   }
+
+   // ====== Send packet without traffic shaper =============================
+#else
+   SocketMessage<sizeof(sctp_sndrcvinfo)> message;
+   message.setBuffer(&packet, packet.calculateHeaderSize() + bytesData);
+   message.setAddress(Flow[encoderPacket.Layer], SenderSocket->getFamily());
+   if(SenderSocket->getProtocol() == IPPROTO_SCTP) {
+      sctp_sndrcvinfo* info = (sctp_sndrcvinfo*)message.addHeader(
+                                 sizeof(sctp_sndrcvinfo),IPPROTO_SCTP,SCTP_SNDRCV);
+      info->sinfo_assoc_id   = 0;
+      info->sinfo_stream     = (unsigned short)encoderPacket.Layer;
+      info->sinfo_flags      = SCTP_UNORDERED;
+      info->sinfo_timetolive = 100;   // 100ms
+      info->sinfo_ppid       = htonl(DataPPID);
+   }
+   sent = SenderSocket->sendMsg(&message.Header,MSG_NOSIGNAL,Flow[encoderPacket.Layer].getTrafficClass());
+#endif
+
+   // ====== Update counters and sequence number ============================
+   if(sent > 0) {
+      PayloadBytesSent += (card32)sent;
+      PayloadPacketsSent++;
+      BytesSent += sent + headerSizeTransport;
+      PacketsSent++;
+      SequenceNumber[encoderPacket.Layer]++;
+   }
+   else {
+#ifdef USE_TRAFFICSHAPER
+      const integer error = SenderSocket->getLastError();
+#else
+      const integer error = (integer)-sent;
+#endif
+      if((error != 0) && (TransmissionError == false) && (error != EAGAIN) && (error != EINTR)) {
+         std::cerr << "WARNING: RTPSender::sendPacket() - "
+                   << "Unable to send " << packet.calculateHeaderSize() + bytesData
+                   << " bytes to " << Flow[encoderPacket.Layer] << std::endl
+                   << "Transmission error #"
+                   << error << ": " << strerror(error) << std::endl;
+         TransmissionError = true;
+         return(false);
+      }
+   }
+
+
+   // ====== Check for traffic shaper transmission errors ===================
+#ifdef USE_TRAFFICSHAPER
+   const integer error = SenderSocket->getLastError();
+   if((error > 0) && (error != -EINTR) && (TransmissionError == false)) {
+      if(error != -ECONNREFUSED) {
+         std::cerr << "WARNING: RTPSender::sendPacket() - Transmission error #"
+                   << error << ": " << strerror(error) << std::endl;
+      }
+      TransmissionError = true;
+      return(false);
+   }
+#endif
+
+   return(true);
+}
+
+
+// ###### Send packet of broadcast source ###################################
+void RTPSender::sendBroadcastPacket(RTPPacket&           packet,
+                                    const cardinal       bytesData,
+                                    const EncoderPacket& encoderPacket,
+                                    const cardinal       headerSizeTransport)
+{
+   synchronized();
+   if(!Pause) {
+      sendPacket(packet,bytesData,encoderPacket,headerSizeTransport);
+   }
+   unsynchronized();
+}
@@ -42,6 +42,10 @@
 #include "trafficshaper.h"
 #include "abstractqosdescription.h"
 #include "qosmanagerinterface.h"
+#include "roundtriptimeestimator.h"
+#include "statisticsslot.h"
+
+#include <vector>
 
 
 /**
@@ -136,6 +140,21 @@ class RTPSender : virtual public ManagedStreamInterface,
      */
    void updateQuality(const AbstractQoSDescription* aqd);
 
+   /**
+     * Implementation of ManagedStreamInterface's getRoundTripTime().
+     *
+     * @see ManagedStreamInterface#getRoundTripTime
+     */
+   cardinal getRoundTripTime(const card8 trafficClass);
+
+   /**
+     * Update passive round trip time estimation using a reception report
+     * block received from the remote side.
+     *
+     * @param report Reception report block.
+     */
+   void receptionReport(const RTCPReceptionReportBlock* report);
+
    /**
      * Implementation of ManagedStreamInterface's lock().
      *
@@ -219,18 +238,80 @@ class RTPSender : virtual public ManagedStreamInterface,
    inline void resetPacketsSent();
 
 
+   // ====== Layer flows ====================================================
+   /**
+     * Set flow of a quality layer. By default, all layers are sent to the
+     * flow given to init(); a layered multicast channel sends each layer
+     * to its own group instead.
+     *
+     * @param layer Layer number.
+     * @param flow Flow of the layer.
+     */
+   void setLayerFlow(const cardinal layer, const InternetFlow& flow);
+
+
+   // ====== Broadcast ======================================================
+   /**
+     * Add broadcast receiver. The receiver gets a copy of each packet sent
+     * by this sender, with the receiver's SSRC, sequence number and time
+     * stamp. It stops encoding frames by itself until it is removed again;
+     * its RTCP sender reports continue.
+     *
+     * @param receiver Receiver to be added.
+     */
+   void addBroadcastReceiver(RTPSender* receiver);
+
+   /**
+     * Remove broadcast receiver.
+     *
+     * @param receiver Receiver to be removed.
+     */
+   void removeBroadcastReceiver(RTPSender* receiver);
+
+   /**
+     * Check, if the sender is a broadcast receiver of another sender.
+     *
+     * @return true, if sender is a broadcast receiver; false otherwise.
+     */
+   inline bool isBroadcastReceiver() const;
+
+
+   // ====== Statistics =====================================================
+   /**
+     * Publish the sender's bitrate and the numbers of bytes, packets and
+     * payload bytes sent (and the traffic shapers' queue length) into
+     * given statistics slot. The values are updated once per second.
+     *
+     * @param statistics Statistics slot; NULL to stop publishing.
+     */
+   void setStatistics(StatisticsSlot* statistics);
+
+
    // ====== Private data ===================================================
    private:
    void timerEvent();
+   void updateStatistics(const card64 now);
    void updateFrameRate(const AbstractQoSDescription* aqd);
+   bool sendPacket(RTPPacket&           packet,
+                   const cardinal       bytesData,
+                   const EncoderPacket& encoderPacket,
+                   const cardinal       headerSizeTransport);
+   void sendBroadcastPacket(RTPPacket&           packet,
+                            const cardinal       bytesData,
+                            const EncoderPacket& encoderPacket,
+                            const cardinal       headerSizeTransport);
 
 
    private:
    EncoderInterface*    Encoder;
    Socket*              SenderSocket;
+   RTPSender*           BroadcastSource;
+   std::vector<RTPSender*> BroadcastReceivers;
 
    cardinal             FramesPerSecond;
-   cardinal             RenewCounter;
+   cardinal             ReportCounter;
+   cardinal             Layers;
+   cardinal             SenderReportLayer;
    cardinal             MaxPacketSize;
    card32               SSRC;
    card64               BytesSent;
@@ -245,10 +326,20 @@ class RTPSender : virtual public ManagedStreamInterface,
    bool                 Pause;
    bool                 TransmissionError;
 
+   StatisticsSlot*      Statistics;
+   cardinal             StatBitrate;
+   cardinal             StatBytesSent;
+   cardinal             StatPacketsSent;
+   cardinal             StatPayloadBytesSent;
+   cardinal             StatShaperQueueLength;
+   card64               StatLastBytesSent;
+   card64               StatLastUpdate;
+
    InternetFlow         Flow[RTPConstants::RTPMaxQualityLayers];
    card16               SequenceNumber[RTPConstants::RTPMaxQualityLayers];
 
-   QoSManagerInterface* QoSMgr;
+   QoSManagerInterface*   QoSMgr;
+   RoundTripTimeEstimator RTTEstimator;
    cardinal             Bandwidth[RTPConstants::RTPMaxQualityLayers];
    double               BufferDelay[RTPConstants::RTPMaxQualityLayers];
 
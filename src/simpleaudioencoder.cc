@@ -39,6 +39,7 @@
 
 // ###### Constructor #######################################################
 SimpleAudioEncoder::SimpleAudioEncoder(AudioReaderInterface* audioReader)
+   : Ladder(SimpleAudioPacket::calculateRequirements,1,1)
 {
    Source           = audioReader;
    FrameBufferPos   = 0;
@@ -141,6 +142,20 @@ void SimpleAudioEncoder::updateQuality(const AbstractQoSDescription* aqd)
 }
 
 
+// ###### Get byte rate limit ###############################################
+card64 SimpleAudioEncoder::getByteRateLimit() const
+{
+   return(ByteRateLimit);
+}
+
+
+// ###### Get network quality decrement #####################################
+cardinal SimpleAudioEncoder::getNetworkQualityDecrement() const
+{
+   return(NetworkQualityDecrement);
+}
+
+
 // ###### Check for new interval #############################################
 bool SimpleAudioEncoder::checkInterval(card64& time, bool& newRUList)
 {
@@ -161,17 +176,19 @@ bool SimpleAudioEncoder::prepareNextFrame(const cardinal headerSize,
    FrameBufferSize     = 0;
    FramePosition       = Source->getPosition();
    FrameMaxPosition    = Source->getMaxPosition();
-   const AudioQuality inputQuality(*Source);
-   FrameQualitySetting = SimpleAudioPacket::calculateQualityForLimits(
+   FrameQualitySetting = Ladder.getQualityForLimits(
                             (AudioQuality)*this,(AudioQuality)*Source,
-                            ByteRateLimit,NetworkQualityDecrement,
+                            &ByteRateLimit,NetworkQualityDecrement,
                             headerSize,maxPacketSize);
    FrameQualitySetting.setByteOrder(BIG_ENDIAN);
 
    // ====== Read frame from AudioReader ====================================
-   cardinal len = SimpleAudioPacket::calculateFrameSize(
-                      inputQuality.getBytesPerSecond(),
-                      SimpleAudioPacket::SimpleAudioFrameSize);
+   // The reader may deliver the frame in a quality closer to the frame's.
+   const AudioQuality inputQuality = Source->selectQuality(FrameQualitySetting);
+   cardinal len = getAlignedLength(inputQuality,inputQuality,
+                     SimpleAudioPacket::calculateFrameSize(
+                        inputQuality.getBytesPerSecond(),
+                        SimpleAudioPacket::SimpleAudioFrameSize));
    if((Source->getPosition() < Source->getMaxPosition()) && (Source->getNextBlock((void*)FrameBuffer,len) == len)) {
       // Check, if conversion is necessary
       if(inputQuality != FrameQualitySetting) {
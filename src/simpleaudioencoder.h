@@ -38,6 +38,7 @@
 #include "audioencoderinterface.h"
 #include "audioreaderinterface.h"
 #include "audioquality.h"
+#include "qualityladder.h"
 #include "audioquality.h"
 
 
@@ -153,6 +154,22 @@ class SimpleAudioEncoder : public AudioEncoderInterface,
    void updateQuality(const AbstractQoSDescription* aqd);
 
 
+   // ====== AudioEncoderInterface implementation ===========================
+   /**
+     * getByteRateLimit() implementation of AudioEncoderInterface.
+     *
+     * @see AudioEncoderInterface#getByteRateLimit
+     */
+   card64 getByteRateLimit() const;
+
+   /**
+     * getNetworkQualityDecrement() implementation of AudioEncoderInterface.
+     *
+     * @see AudioEncoderInterface#getNetworkQualityDecrement
+     */
+   cardinal getNetworkQualityDecrement() const;
+
+
    // ====== Private data ===================================================
    private:
    AudioReaderInterface* Source;
@@ -163,6 +180,7 @@ class SimpleAudioEncoder : public AudioEncoderInterface,
    card64       FramePosition;
    card64       FrameMaxPosition;
    AudioQuality FrameQualitySetting;
+   QualityLadder Ladder;
 
    integer      MediaInfoCounter;
 
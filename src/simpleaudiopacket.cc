@@ -70,6 +70,21 @@ void SimpleAudioPacket::translate()
 }
 
 
+// ###### Calculate byte rate requirements of quality #####################
+void SimpleAudioPacket::calculateRequirements(
+        const AudioQualityInterface& quality,
+        const cardinal               headerSize,
+        const cardinal               maxPacketSize,
+        card64*                      required)
+{
+   required[0] = calculateBytesPerSecond(quality.getBytesPerSecond(),
+                    SimpleAudioFramesPerSecond,maxPacketSize,
+                    sizeof(SimpleAudioPacket) + headerSize) +
+                 (SimpleAudioMediaInfoPacketsPerSecond *
+                    (sizeof(SimpleAudioPacket) + headerSize + sizeof(MediaInfo)));
+}
+
+
 // ###### Calculate encoder's quality #######################################
 AudioQuality SimpleAudioPacket::calculateQualityForLimits(
                                    const AudioQualityInterface& userSetting,
@@ -85,18 +100,11 @@ AudioQuality SimpleAudioPacket::calculateQualityForLimits(
    AudioQuality newSetting = networkQuality - inputQuality;
 
    // ====== Calculate new quality using byte rate limit ====================
-   card64 bps = calculateBytesPerSecond(newSetting.getBytesPerSecond(),
-                   SimpleAudioFramesPerSecond,maxPacketSize,
-                   sizeof(SimpleAudioPacket) + headerSize) +
-                (SimpleAudioMediaInfoPacketsPerSecond *
-                   (sizeof(SimpleAudioPacket) + headerSize + sizeof(MediaInfo)));
+   card64 bps;
+   calculateRequirements(newSetting,headerSize,maxPacketSize,&bps);
    while(bps > byteRateLimit) {
       newSetting--;
-      bps = calculateBytesPerSecond(newSetting.getBytesPerSecond(),
-               SimpleAudioFramesPerSecond,maxPacketSize,
-               sizeof(SimpleAudioPacket) + headerSize) +
-            (SimpleAudioMediaInfoPacketsPerSecond *
-               (sizeof(SimpleAudioPacket) + headerSize + sizeof(MediaInfo)));
+      calculateRequirements(newSetting,headerSize,maxPacketSize,&bps);
       if(newSetting.isLowest()) {
          break;
       }
@@ -114,6 +114,23 @@ struct SimpleAudioPacket
    static const cardinal SimpleAudioQualityLevels = AudioQuality::QualityLevels;
 
 
+   /**
+     * Calculate the byte rate requirement of given quality with given header
+     * size (eg. IP + UDP + RTP) and maximum packet size.
+     *
+     * @param quality Quality.
+     * @param headerSize Header size. SimpleAudioPacket size is added automatically.
+     * @param maxPacketSize Maximum packet size.
+     * @param required Address to store the requirement into.
+     *
+     * @see QualityLadder
+     */
+   static void calculateRequirements(const AudioQualityInterface& quality,
+                                     const cardinal               headerSize,
+                                     const cardinal               maxPacketSize,
+                                     card64*                      required);
+
+
    /**
      * Quality calculation for given user quality limited by input quality,
      * byte rate and network quality decrement with given header size
@@ -42,7 +42,7 @@
 // ###### Constructor #######################################################
 SourceStateInfo::SourceStateInfo()
    : SeqNumValidator(RTP_MIN_SEQUENTIAL,RTP_MAX_MISORDER,RTP_MAX_DROPOUT,RTP_SEQ_MOD),
-     Synchronizable("SourceStateInfo")
+     Synchronizable("SourceStateInfo",Synchronizable::LT_Adaptive)
 {
    reset();
 }
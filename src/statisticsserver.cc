@@ -0,0 +1,134 @@
+// ##########################################################################
+// ####                                                                  ####
+// ####                      RTP Audio Server Project                    ####
+// ####                    ============================                  ####
+// ####                                                                  ####
+// #### Statistics Server                                                ####
+// ####                                                                  ####
+// ####           Copyright (C) 1999-2026 by Thomas Dreibholz            ####
+// ####                                                                  ####
+// #### Contact:                                                         ####
+// ####    EMail: thomas.dreibholz@gmail.com                             ####
+// ####    WWW:   https://www.nntb.no/~dreibh/rtpaudio                   ####
+// ####                                                                  ####
+// #### ---------------------------------------------------------------- ####
+// ####                                                                  ####
+// #### This program is free software: you can redistribute it and/or    ####
+// #### modify it under the terms of the GNU General Public License as   ####
+// #### published by the Free Software Foundation, either version 3 of   ####
+// #### the License, or (at your option) any later version.              ####
+// ####                                                                  ####
+// #### This program is distributed in the hope that it will be useful,  ####
+// #### but WITHOUT ANY WARRANTY; without even the implied warranty of   ####
+// #### MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    ####
+// #### GNU General Public License for more details.                     ####
+// ####                                                                  ####
+// #### You should have received a copy of the GNU General Public        ####
+// #### License along with this program.  If not, see                    ####
+// #### <http://www.gnu.org/licenses/>.                                  ####
+// ####                                                                  ####
+// ##########################################################################
+
+
+#include "tdsystem.h"
+#include "statisticsserver.h"
+#include "statisticsslot.h"
+#include "lockprofiler.h"
+#include "tools.h"
+
+
+#include <sstream>
+#include <errno.h>
+#include <unistd.h>
+
+
+
+// ###### Constructor #######################################################
+StatisticsServer::StatisticsServer(const char* path)
+   : Thread("StatisticsServer"),
+     ServerSocket(Socket::Unix,Socket::Stream),
+     Path(path)
+{
+   Ready = false;
+   const UnixAddress address(String("unix:") + Path);
+   if((address.isValid()) && (ServerSocket.ready())) {
+      unlink(path);
+      if((ServerSocket.bind(address)) &&
+         (ServerSocket.listen(5))) {
+         Ready = true;
+      }
+   }
+}
+
+
+// ###### Destructor ########################################################
+StatisticsServer::~StatisticsServer()
+{
+   stop();
+   ServerSocket.close();
+   if(Ready) {
+      unlink(Path.getData());
+   }
+}
+
+
+// ###### Serve snapshots ###################################################
+void StatisticsServer::run()
+{
+   if(!Ready) {
+      return;
+   }
+   for(;;) {
+      Socket* client = ServerSocket.accept();
+      if(client == NULL) {
+         // Avoid busy looping, e.g. when running out of file descriptors.
+         delay(100000,true);
+         continue;
+      }
+
+      // ====== Send snapshot ===============================================
+      // A client not reading its snapshot must not block the server for
+      // more than ClientTimeout; the snapshot is truncated then, which the
+      // client recognizes by the missing terminator line.
+      const cardinal oldState = setCancelState(TCS_CancelDisabled);
+      std::ostringstream snapshot;
+      snapshot << "Statistics at " << getMicroTime() << " [us]:" << std::endl;
+      StatisticsSlot::snapshot(snapshot);
+#ifdef SYNCHRONIZABLE_PROFILING
+      LockProfiler::dump(snapshot);
+#endif
+      snapshot << "End of statistics." << std::endl;
+      const std::string text     = snapshot.str();
+      const card64      deadline = getMicroTime() + ClientTimeout;
+      size_t            written  = 0;
+      client->setBlockingMode(false);
+      while(written < text.length()) {
+         const ssize_t result = client->send(text.data() + written,
+                                             text.length() - written,
+                                             MSG_NOSIGNAL);
+         if(result > 0) {
+            written += (size_t)result;
+         }
+         else if((result == -EAGAIN) || (result == -EWOULDBLOCK) ||
+                 (result == -EINTR)) {
+            const card64 now = getMicroTime();
+            if(now >= deadline) {
+               break;
+            }
+            struct pollfd pfd;
+            pfd.fd      = client->getSystemSocketDescriptor();
+            pfd.events  = POLLOUT;
+            pfd.revents = 0;
+            const int timeout = (int)((deadline - now + 999) / 1000);
+            if((ext_poll(&pfd,1,timeout) <= 0) && (errno != EINTR)) {
+               break;
+            }
+         }
+         else {
+            break;
+         }
+      }
+      delete client;
+      setCancelState(oldState);
+   }
+}
@@ -0,0 +1,116 @@
+// ##########################################################################
+// ####                                                                  ####
+// ####                      RTP Audio Server Project                    ####
+// ####                    ============================                  ####
+// ####                                                                  ####
+// #### Statistics Server                                                ####
+// ####                                                                  ####
+// ####           Copyright (C) 1999-2026 by Thomas Dreibholz            ####
+// ####                                                                  ####
+// #### Contact:                                                         ####
+// ####    EMail: thomas.dreibholz@gmail.com                             ####
+// ####    WWW:   https://www.nntb.no/~dreibh/rtpaudio                   ####
+// ####                                                                  ####
+// #### ---------------------------------------------------------------- ####
+// ####                                                                  ####
+// #### This program is free software: you can redistribute it and/or    ####
+// #### modify it under the terms of the GNU General Public License as   ####
+// #### published by the Free Software Foundation, either version 3 of   ####
+// #### the License, or (at your option) any later version.              ####
+// ####                                                                  ####
+// #### This program is distributed in the hope that it will be useful,  ####
+// #### but WITHOUT ANY WARRANTY; without even the implied warranty of   ####
+// #### MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    ####
+// #### GNU General Public License for more details.                     ####
+// ####                                                                  ####
+// #### You should have received a copy of the GNU General Public        ####
+// #### License along with this program.  If not, see                    ####
+// #### <http://www.gnu.org/licenses/>.                                  ####
+// ####                                                                  ####
+// ##########################################################################
+
+
+#ifndef STATISTICSSERVER_H
+#define STATISTICSSERVER_H
+
+
+#include "tdsystem.h"
+#include "thread.h"
+#include "tdsocket.h"
+#include "unixaddress.h"
+
+
+
+/**
+  * This class serves snapshots of all published statistics slots on a
+  * Unix domain stream socket. Each connecting client gets one snapshot in
+  * text form, ended by the line "End of statistics.", then the connection
+  * is closed, e.g. "socat - UNIX-CONNECT:/tmp/rtpa-server.stats". A client
+  * not reading its snapshot within ClientTimeout gets a truncated one
+  * without the terminator line. The snapshot is only
+  * taken on request, so that the publishing components are not slowed
+  * down by the server. With SYNCHRONIZABLE_PROFILING, the LockProfiler
+  * statistics are appended.
+  *
+  * @short   Statistics Server
+  * @author  Thomas Dreibholz (thomas.dreibholz@gmail.com)
+  * @version 1.0
+  *
+  * @see StatisticsSlot
+  * @see LockProfiler
+  */
+class StatisticsServer : public Thread
+{
+   // ====== Constructor/Destructor =========================================
+   public:
+   /**
+     * Constructor. An existing socket file of the given name is replaced.
+     * The creation success can be checked using ready() method.
+     *
+     * @param path Path of the Unix domain socket.
+     */
+   StatisticsServer(const char* path);
+
+   /**
+     * Destructor. The socket file is removed.
+     */
+   ~StatisticsServer();
+
+
+   // ====== Status functions ===============================================
+   /**
+     * Check, if the socket has been created successfully.
+     *
+     * @return true, if socket is ready; false otherwise.
+     */
+   inline bool ready() const;
+
+   /**
+     * Get path of the Unix domain socket.
+     *
+     * @return Path.
+     */
+   inline const String& getPath() const;
+
+
+   // ====== Constants ======================================================
+   /**
+     * Maximum time in microseconds to send a snapshot to a client.
+     */
+   static const card64 ClientTimeout = 1000000;
+
+
+   // ====== Private data ===================================================
+   private:
+   void run();
+
+   Socket ServerSocket;
+   String Path;
+   bool   Ready;
+};
+
+
+#include "statisticsserver.icc"
+
+
+#endif
@@ -0,0 +1,221 @@
+// ##########################################################################
+// ####                                                                  ####
+// ####                      RTP Audio Server Project                    ####
+// ####                    ============================                  ####
+// ####                                                                  ####
+// #### Statistics Slot                                                  ####
+// ####                                                                  ####
+// ####           Copyright (C) 1999-2026 by Thomas Dreibholz            ####
+// ####                                                                  ####
+// #### Contact:                                                         ####
+// ####    EMail: thomas.dreibholz@gmail.com                             ####
+// ####    WWW:   https://www.nntb.no/~dreibh/rtpaudio                   ####
+// ####                                                                  ####
+// #### ---------------------------------------------------------------- ####
+// ####                                                                  ####
+// #### This program is free software: you can redistribute it and/or    ####
+// #### modify it under the terms of the GNU General Public License as   ####
+// #### published by the Free Software Foundation, either version 3 of   ####
+// #### the License, or (at your option) any later version.              ####
+// ####                                                                  ####
+// #### This program is distributed in the hope that it will be useful,  ####
+// #### but WITHOUT ANY WARRANTY; without even the implied warranty of   ####
+// #### MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    ####
+// #### GNU General Public License for more details.                     ####
+// ####                                                                  ####
+// #### You should have received a copy of the GNU General Public        ####
+// #### License along with this program.  If not, see                    ####
+// #### <http://www.gnu.org/licenses/>.                                  ####
+// ####                                                                  ####
+// ##########################################################################
+
+
+#include "tdsystem.h"
+#include "statisticsslot.h"
+
+
+#include <string.h>
+#include <iomanip>
+#include <vector>
+
+
+
+// ###### Static data #######################################################
+pthread_mutex_t StatisticsSlot::RegistryMutex = PTHREAD_MUTEX_INITIALIZER;
+StatisticsSlot* StatisticsSlot::SlotList      = NULL;
+
+
+// ###### Constructor #######################################################
+StatisticsSlot::StatisticsSlot()
+{
+   Prev       = NULL;
+   Next       = NULL;
+   Published  = false;
+   Name[0]    = 0x00;
+   Counters   = 0;
+   Histograms = 0;
+}
+
+
+// ###### Destructor ########################################################
+StatisticsSlot::~StatisticsSlot()
+{
+   withdraw();
+}
+
+
+// ###### Publish slot ######################################################
+void StatisticsSlot::publish(const char* name)
+{
+   pthread_mutex_lock(&RegistryMutex);
+   snprintf((char*)&Name,sizeof(Name),"%s",name);
+   if(!Published) {
+      Prev = NULL;
+      Next = SlotList;
+      if(SlotList != NULL) {
+         SlotList->Prev = this;
+      }
+      SlotList  = this;
+      Published = true;
+   }
+   pthread_mutex_unlock(&RegistryMutex);
+}
+
+
+// ###### Withdraw slot #####################################################
+void StatisticsSlot::withdraw()
+{
+   pthread_mutex_lock(&RegistryMutex);
+   if(Published) {
+      if(Prev != NULL) {
+         Prev->Next = Next;
+      }
+      else {
+         SlotList = Next;
+      }
+      if(Next != NULL) {
+         Next->Prev = Prev;
+      }
+      Prev      = NULL;
+      Next      = NULL;
+      Published = false;
+   }
+   pthread_mutex_unlock(&RegistryMutex);
+}
+
+
+// ###### Add counter #######################################################
+cardinal StatisticsSlot::addCounter(const char* name, const char* unit)
+{
+   pthread_mutex_lock(&RegistryMutex);
+   const cardinal counter = Counters;
+   if(counter < MaxCounters) {
+      Counter& c = CounterSet[counter];
+      snprintf((char*)&c.Name,sizeof(c.Name),"%s",name);
+      snprintf((char*)&c.Unit,sizeof(c.Unit),"%s",unit);
+      c.Value.store(0);
+      Counters++;
+   }
+   pthread_mutex_unlock(&RegistryMutex);
+   return(counter);
+}
+
+
+// ###### Add histogram #####################################################
+cardinal StatisticsSlot::addHistogram(const char* name, const char* unit)
+{
+   pthread_mutex_lock(&RegistryMutex);
+   const cardinal histogram = Histograms;
+   if(histogram < MaxHistograms) {
+      Histogram& h = HistogramSet[histogram];
+      snprintf((char*)&h.Name,sizeof(h.Name),"%s",name);
+      snprintf((char*)&h.Unit,sizeof(h.Unit),"%s",unit);
+      for(cardinal i = 0;i < HistogramBuckets;i++) {
+         h.Bucket[i].store(0);
+      }
+      h.Count.store(0);
+      h.Sum.store(0);
+      h.Max.store(0);
+      Histograms++;
+   }
+   pthread_mutex_unlock(&RegistryMutex);
+   return(histogram);
+}
+
+
+// ###### Copy slot values (registry lock has to be held) ###################
+void StatisticsSlot::copy(SlotValues& values) const
+{
+   memcpy((char*)&values.Name,(const char*)&Name,sizeof(values.Name));
+   values.Counters   = Counters;
+   values.Histograms = Histograms;
+   for(cardinal i = 0;i < Counters;i++) {
+      const Counter& c  = CounterSet[i];
+      CounterValues& cv = values.CounterSet[i];
+      memcpy((char*)&cv.Name,(const char*)&c.Name,sizeof(cv.Name));
+      memcpy((char*)&cv.Unit,(const char*)&c.Unit,sizeof(cv.Unit));
+      cv.Value = c.Value.load(std::memory_order_relaxed);
+   }
+   for(cardinal i = 0;i < Histograms;i++) {
+      const Histogram& h  = HistogramSet[i];
+      HistogramValues& hv = values.HistogramSet[i];
+      memcpy((char*)&hv.Name,(const char*)&h.Name,sizeof(hv.Name));
+      memcpy((char*)&hv.Unit,(const char*)&h.Unit,sizeof(hv.Unit));
+      for(cardinal j = 0;j < HistogramBuckets;j++) {
+         hv.Bucket[j] = h.Bucket[j].load(std::memory_order_relaxed);
+      }
+      hv.Count = h.Count.load(std::memory_order_relaxed);
+      hv.Sum   = h.Sum.load(std::memory_order_relaxed);
+      hv.Max   = h.Max.load(std::memory_order_relaxed);
+   }
+}
+
+
+// ###### Print slot values ################################################
+void StatisticsSlot::print(std::ostream& os, const SlotValues& values)
+{
+   os << values.Name << ":" << std::endl;
+   for(cardinal i = 0;i < values.Counters;i++) {
+      const CounterValues& c = values.CounterSet[i];
+      os << "   " << std::setw(24) << std::left << c.Name << std::right
+         << " " << c.Value;
+      if(c.Unit[0] != 0x00) {
+         os << " " << c.Unit;
+      }
+      os << std::endl;
+   }
+   for(cardinal i = 0;i < values.Histograms;i++) {
+      const HistogramValues& h = values.HistogramSet[i];
+      os << "   " << std::setw(24) << std::left << h.Name << std::right
+         << " count " << h.Count
+         << ", mean " << ((h.Count > 0) ? (h.Sum / h.Count) : 0)
+         << ", max "  << h.Max;
+      if(h.Unit[0] != 0x00) {
+         os << " " << h.Unit;
+      }
+      for(cardinal j = 0;j < HistogramBuckets;j++) {
+         if(h.Bucket[j] > 0) {
+            os << " " << ((j > 0) ? ((card64)1 << j) : 0) << "+:" << h.Bucket[j];
+         }
+      }
+      os << std::endl;
+   }
+}
+
+
+// ###### Print all published slots #########################################
+void StatisticsSlot::snapshot(std::ostream& os)
+{
+   std::vector<SlotValues> slots;
+   pthread_mutex_lock(&RegistryMutex);
+   for(const StatisticsSlot* slot = SlotList;slot != NULL;slot = slot->Next) {
+      slots.resize(slots.size() + 1);
+      slot->copy(slots.back());
+   }
+   pthread_mutex_unlock(&RegistryMutex);
+
+   for(std::vector<SlotValues>::const_iterator iterator = slots.begin();
+       iterator != slots.end();iterator++) {
+      print(os,*iterator);
+   }
+}
@@ -0,0 +1,221 @@
+// ##########################################################################
+// ####                                                                  ####
+// ####                      RTP Audio Server Project                    ####
+// ####                    ============================                  ####
+// ####                                                                  ####
+// #### Statistics Slot                                                  ####
+// ####                                                                  ####
+// ####           Copyright (C) 1999-2026 by Thomas Dreibholz            ####
+// ####                                                                  ####
+// #### Contact:                                                         ####
+// ####    EMail: thomas.dreibholz@gmail.com                             ####
+// ####    WWW:   https://www.nntb.no/~dreibh/rtpaudio                   ####
+// ####                                                                  ####
+// #### ---------------------------------------------------------------- ####
+// ####                                                                  ####
+// #### This program is free software: you can redistribute it and/or    ####
+// #### modify it under the terms of the GNU General Public License as   ####
+// #### published by the Free Software Foundation, either version 3 of   ####
+// #### the License, or (at your option) any later version.              ####
+// ####                                                                  ####
+// #### This program is distributed in the hope that it will be useful,  ####
+// #### but WITHOUT ANY WARRANTY; without even the implied warranty of   ####
+// #### MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    ####
+// #### GNU General Public License for more details.                     ####
+// ####                                                                  ####
+// #### You should have received a copy of the GNU General Public        ####
+// #### License along with this program.  If not, see                    ####
+// #### <http://www.gnu.org/licenses/>.                                  ####
+// ####                                                                  ####
+// ##########################################################################
+
+
+#ifndef STATISTICSSLOT_H
+#define STATISTICSSLOT_H
+
+
+#include "tdsystem.h"
+
+
+#include <pthread.h>
+#include <atomic>
+
+
+
+/**
+  * This class is a set of named counters and histograms published by a
+  * component, e.g. by the sender of a server's user. Updates are relaxed
+  * atomic stores without any locking, so that each value may only be
+  * updated by one thread at a time (e.g. the component's own thread or a
+  * thread holding the component's lock). Published slots are read on
+  * demand by snapshot(), e.g. for StatisticsServer.
+  *
+  * @short   Statistics Slot
+  * @author  Thomas Dreibholz (thomas.dreibholz@gmail.com)
+  * @version 1.0
+  *
+  * @see StatisticsServer
+  */
+class StatisticsSlot
+{
+   // ====== Constructor/Destructor =========================================
+   public:
+   /**
+     * Constructor. The slot is not published yet.
+     */
+   StatisticsSlot();
+
+   /**
+     * Destructor. The slot is withdrawn, if published.
+     */
+   ~StatisticsSlot();
+
+
+   // ====== Publication ====================================================
+   /**
+     * Publish slot, i.e. include it into snapshots.
+     *
+     * @param name Slot name (e.g. "User $12345678").
+     */
+   void publish(const char* name);
+
+   /**
+     * Withdraw slot from snapshots.
+     */
+   void withdraw();
+
+
+   // ====== Value definitions ==============================================
+   /**
+     * Add a counter. Counters are updated by add() or set().
+     *
+     * @param name Counter name.
+     * @param unit Unit to be printed (e.g. "bit/s").
+     * @return Counter number.
+     */
+   cardinal addCounter(const char* name, const char* unit = "");
+
+   /**
+     * Add a histogram. Bucket i of a histogram counts the values in
+     * [2^i, 2^(i+1)); bucket 0 also counts the value 0.
+     *
+     * @param name Histogram name.
+     * @param unit Unit of the recorded values (e.g. "us").
+     * @return Histogram number.
+     */
+   cardinal addHistogram(const char* name, const char* unit = "");
+
+
+   // ====== Updates ========================================================
+   /**
+     * Add to counter.
+     *
+     * @param counter Counter number.
+     * @param value Value to add.
+     */
+   inline void add(const cardinal counter, const card64 value = 1);
+
+   /**
+     * Set counter, e.g. for a current rate or queue length.
+     *
+     * @param counter Counter number.
+     * @param value New value.
+     */
+   inline void set(const cardinal counter, const card64 value);
+
+   /**
+     * Record value in histogram.
+     *
+     * @param histogram Histogram number.
+     * @param value Value.
+     */
+   inline void record(const cardinal histogram, const card64 value);
+
+
+   // ====== Snapshots ======================================================
+   /**
+     * Print all published slots. The values are copied under the registry
+     * lock and printed after releasing it, so that a slow output stream
+     * does not block publishing or withdrawing slots.
+     *
+     * @param os Output stream.
+     */
+   static void snapshot(std::ostream& os);
+
+
+   // ====== Constants ======================================================
+   /**
+     * Maximum number of counters per slot. Further counters are ignored.
+     */
+   static const cardinal MaxCounters = 16;
+
+   /**
+     * Maximum number of histograms per slot. Further histograms are ignored.
+     */
+   static const cardinal MaxHistograms = 4;
+
+   /**
+     * Number of buckets per histogram.
+     */
+   static const cardinal HistogramBuckets = 24;
+
+
+   // ====== Private data ===================================================
+   private:
+   struct Counter {
+      char                Name[32];
+      char                Unit[12];
+      std::atomic<card64> Value;
+   };
+   struct Histogram {
+      char                Name[32];
+      char                Unit[12];
+      std::atomic<card64> Bucket[HistogramBuckets];
+      std::atomic<card64> Count;
+      std::atomic<card64> Sum;
+      std::atomic<card64> Max;
+   };
+
+   struct CounterValues {
+      char   Name[32];
+      char   Unit[12];
+      card64 Value;
+   };
+   struct HistogramValues {
+      char   Name[32];
+      char   Unit[12];
+      card64 Bucket[HistogramBuckets];
+      card64 Count;
+      card64 Sum;
+      card64 Max;
+   };
+   struct SlotValues {
+      char            Name[64];
+      cardinal        Counters;
+      cardinal        Histograms;
+      CounterValues   CounterSet[MaxCounters];
+      HistogramValues HistogramSet[MaxHistograms];
+   };
+
+   inline static void store(std::atomic<card64>& value, const card64 newValue);
+   void copy(SlotValues& values) const;
+   static void print(std::ostream& os, const SlotValues& values);
+
+   static pthread_mutex_t RegistryMutex;
+   static StatisticsSlot* SlotList;
+
+   StatisticsSlot*        Prev;
+   StatisticsSlot*        Next;
+   bool                   Published;
+   char                   Name[64];
+   cardinal               Counters;
+   cardinal               Histograms;
+   Counter                CounterSet[MaxCounters];
+   Histogram              HistogramSet[MaxHistograms];
+};
+
+
+#include "statisticsslot.icc"
+
+
+#endif
@@ -43,23 +43,25 @@
 // ###### Constructor #######################################################
 Synchronizable::Synchronizable(const char* name, const bool recursive)
 {
-   pthread_mutexattr_t mutexattr;
-   pthread_mutexattr_init(&mutexattr);
    Recursive = recursive;
-#ifndef NO_RECURSIVE_MUTEX
-   if(Recursive) {
-      // Initialize mutex for synchronization; mutextype has to be set to
-      // PTHREAD_MUTEX_RECURSIVE to allow nested calls of synchronized() and
-      // unsynchronized()!
-      pthread_mutexattr_settype(&mutexattr,PTHREAD_MUTEX_RECURSIVE);
-   }
-#else
-   // Keep track of recursion, if recursive mutexes are not supported.
-   RecursionLevel = 0;
-   Owner          = 0;
+   Type      = (recursive) ? LT_Recursive : LT_Normal;
+   initMutex();
+#ifdef SYNCHRONIZABLE_PROFILING
+   ProfileAcquireTime = 0;
+#endif
+   setName(name);
+}
+
+
+// ###### Constructor #######################################################
+Synchronizable::Synchronizable(const char* name, const LockType type)
+{
+   Recursive = (type == LT_Recursive);
+   Type      = type;
+   initMutex();
+#ifdef SYNCHRONIZABLE_PROFILING
+   ProfileAcquireTime = 0;
 #endif
-   pthread_mutex_init(&Mutex,&mutexattr);
-   pthread_mutexattr_destroy(&mutexattr);
    setName(name);
 }
 
@@ -75,16 +77,35 @@ Synchronizable::~Synchronizable()
 void Synchronizable::resynchronize()
 {
    pthread_mutex_destroy(&Mutex);
+   initMutex();
+}
+
+
+// ###### Initialize mutex ##################################################
+void Synchronizable::initMutex()
+{
    pthread_mutexattr_t mutexattr;
    pthread_mutexattr_init(&mutexattr);
 #ifndef NO_RECURSIVE_MUTEX
-   if(Recursive) {
+   if(Type == LT_Recursive) {
+      // Initialize mutex for synchronization; mutextype has to be set to
+      // PTHREAD_MUTEX_RECURSIVE to allow nested calls of synchronized() and
+      // unsynchronized()!
       pthread_mutexattr_settype(&mutexattr,PTHREAD_MUTEX_RECURSIVE);
    }
 #else
+   // Keep track of recursion, if recursive mutexes are not supported.
    RecursionLevel = 0;
    Owner          = 0;
+#endif
+#ifdef PTHREAD_ADAPTIVE_MUTEX_INITIALIZER_NP
+   if(Type == LT_Adaptive) {
+      pthread_mutexattr_settype(&mutexattr,PTHREAD_MUTEX_ADAPTIVE_NP);
+   }
 #endif
    pthread_mutex_init(&Mutex,&mutexattr);
    pthread_mutexattr_destroy(&mutexattr);
+#ifdef SYNCHRONIZABLE_PROFILING
+   ProfileDepth = 0;
+#endif
 }
@@ -56,6 +56,17 @@
 #endif
 #endif
 
+// Lock profiling (CMake option USE_LOCK_PROFILING) is based on recursive
+// pthread mutexes.
+#ifdef SYNCHRONIZABLE_PROFILING
+#ifdef NO_RECURSIVE_MUTEX
+#warning Lock profiling requires recursive pthread mutexes; disabled!
+#undef SYNCHRONIZABLE_PROFILING
+#else
+#include "lockprofiler.h"
+#endif
+#endif
+
 
 /**
   * This class realizes synchronized access to a thread's data by other threads.
@@ -65,6 +76,9 @@
   * IMPORTANT: Do *not* use synchronized()/unsynchronized() within async signal
   * handlers. This may cause deadlocks. See PThread's pthread_mutex_lock man-page,
   * section "Async Signal Safety" for more information!
+  * The mutex is recursive by default. Classes without nested
+  * synchronized() calls may choose a faster non-recursive lock type at
+  * construction (see LockType).
   *
   * @short   Synchronizable
   * @author  Thomas Dreibholz (thomas.dreibholz@gmail.com)
@@ -73,8 +87,31 @@
   */
 class Synchronizable
 {
-   // ====== Constructor/Destructor =========================================
+   // ====== Lock types =====================================================
    public:
+   /**
+     * Lock types. Only LT_Recursive allows nested synchronized() calls of
+     * the same thread.
+     * LT_Normal: Plain non-recursive pthread mutex.
+     * LT_Adaptive: Non-recursive mutex spinning briefly before sleeping
+     *              (PTHREAD_MUTEX_ADAPTIVE_NP; LT_Normal, if unsupported).
+     * LT_SpinPark: Non-recursive mutex, tried SpinCount times before
+     *              blocking. For very short critical sections.
+     */
+   enum LockType {
+      LT_Recursive = 0,
+      LT_Normal    = 1,
+      LT_Adaptive  = 2,
+      LT_SpinPark  = 3
+   };
+
+   /**
+     * Number of lock attempts of LT_SpinPark before blocking.
+     */
+   static const cardinal SpinCount = 100;
+
+
+   // ====== Constructor/Destructor =========================================
    /**
      * Constructor.
      *
@@ -84,6 +121,14 @@ class Synchronizable
    Synchronizable(const char* name      = "Synchronizable",
                   const bool  recursive = true);
 
+   /**
+     * Constructor for given lock type.
+     *
+     * @param name Name.
+     * @param type Lock type.
+     */
+   Synchronizable(const char* name, const LockType type);
+
    /**
      * Destructor.
      */
@@ -150,6 +195,13 @@ class Synchronizable
      */
    inline void setName(const char* name);
 
+   /**
+     * Get lock type.
+     *
+     * @return Lock type.
+     */
+   inline LockType getLockType() const;
+
 
    // ====== Protected data =================================================
    protected:
@@ -159,7 +211,20 @@ class Synchronizable
    pthread_t       Owner;
 #endif
    bool            Recursive;
+   LockType        Type;
    char            MutexName[64];
+
+   void initMutex();
+   inline void lockMutex();
+
+#ifdef SYNCHRONIZABLE_PROFILING
+   cardinal        ProfileSlot;
+   cardinal        ProfileDepth;
+   card64          ProfileAcquireTime;
+
+   inline void profileAcquired();
+   inline void profileReleased();
+#endif
 };
 
 
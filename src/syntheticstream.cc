@@ -0,0 +1,488 @@
+// ##########################################################################
+// ####                                                                  ####
+// ####                   Master Thesis Implementation                   ####
+// ####  Management of Layered Variable Bitrate Multimedia Streams over  ####
+// ####                 DiffServ with A Priori Knowledge                 ####
+// ####                                                                  ####
+// #### ================================================================ ####
+// ####                                                                  ####
+// ####                                                                  ####
+// #### Synthetic Stream                                                 ####
+// ####                                                                  ####
+// ####           Copyright (C) 1999-2026 by Thomas Dreibholz            ####
+// ####                                                                  ####
+// #### Contact:                                                         ####
+// ####    EMail: thomas.dreibholz@gmail.com                             ####
+// ####    WWW:   https://www.nntb.no/~dreibh/rtpaudio                   ####
+// ####                                                                  ####
+// #### ---------------------------------------------------------------- ####
+// ####                                                                  ####
+// #### This program is free software: you can redistribute it and/or    ####
+// #### modify it under the terms of the GNU General Public License as   ####
+// #### published by the Free Software Foundation, either version 3 of   ####
+// #### the License, or (at your option) any later version.              ####
+// ####                                                                  ####
+// #### This program is distributed in the hope that it will be useful,  ####
+// #### but WITHOUT ANY WARRANTY; without even the implied warranty of   ####
+// #### MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    ####
+// #### GNU General Public License for more details.                     ####
+// ####                                                                  ####
+// #### You should have received a copy of the GNU General Public        ####
+// #### License along with this program.  If not, see                    ####
+// #### <http://www.gnu.org/licenses/>.                                  ####
+// ####                                                                  ####
+// ##########################################################################
+
+
+#include "tdsystem.h"
+#include "syntheticstream.h"
+
+
+
+// ###### Reset profile #####################################################
+void SyntheticStreamProfile::reset()
+{
+   FrameRate           = 25.0;
+   Layers              = 1;
+   RUPoints            = 16;
+   FrameSizeStep       = 4;
+   UtilizationExponent = 0.5;
+   MaxBufferDelay      = 10;
+   MaxTransferDelay    = 1000000.0;
+   MaxLossRate         = 0.1;
+   MaxJitter           = 250000.0;
+   StreamPriority      = 0;
+   SessionPriority     = 0;
+   for(cardinal i = 0;i < RTPConstants::RTPMaxQualityLayers;i++) {
+      MinFrameSize[i] = 8192 / 25;
+      MaxFrameSize[i] = 32768 / 25;
+   }
+}
+
+
+
+// ##########################################################################
+// #### SyntheticLayerDescription                                        ####
+// ##########################################################################
+
+
+// ###### Constructor #######################################################
+SyntheticLayerDescription::SyntheticLayerDescription(
+   const SyntheticStreamProfile& profile,
+   const cardinal                layer)
+{
+   MinFrameSize        = profile.MinFrameSize[layer];
+   MaxFrameSize        = std::max(profile.MaxFrameSize[layer],MinFrameSize);
+   FrameSizeStep       = std::max(profile.FrameSizeStep,(cardinal)1);
+   UtilizationExponent = profile.UtilizationExponent;
+   initLayer(28, 1500,
+             profile.MaxTransferDelay, profile.MaxBufferDelay,
+             profile.MaxLossRate, profile.MaxJitter,
+             (layer == 0) ? LF_BaseLayer : LF_ExtensionLayer);
+}
+
+
+// ###### Destructor ########################################################
+SyntheticLayerDescription::~SyntheticLayerDescription()
+{
+}
+
+
+// ###### Get frame size scalability class ##################################
+const char* SyntheticLayerDescription::getFrameSizeScalabilityClass() const
+{
+   return("Synthetic");
+}
+
+
+// ###### Check, if frame size is scalable ##################################
+bool SyntheticLayerDescription::isFrameSizeScalable() const
+{
+   return(MaxFrameSize > MinFrameSize);
+}
+
+
+// ###### Check, if frame size is variable bitrate ##########################
+bool SyntheticLayerDescription::isVariableBitrate() const
+{
+   return(false);
+}
+
+
+// ###### Get minimum payload frame size ####################################
+cardinal SyntheticLayerDescription::getMinPayloadFrameSizeForDelay(
+            const double   frameRate,
+            const cardinal bufferDelay) const
+{
+   return(MinFrameSize);
+}
+
+
+// ###### Get maximum payload frame size ####################################
+cardinal SyntheticLayerDescription::getMaxPayloadFrameSizeForDelay(
+            const double   frameRate,
+            const cardinal bufferDelay) const
+{
+   return(MaxFrameSize);
+}
+
+
+// ###### Get maximum frame count ###########################################
+cardinal SyntheticLayerDescription::getMaxFrameCountForDelay(
+            const double   frameRate,
+            const cardinal bufferDelay) const
+{
+   return(std::max(bufferDelay,(cardinal)1));
+}
+
+
+// ###### Check, if payload frame size is valid #############################
+bool SyntheticLayerDescription::isValidPayloadFrameSize(
+        const double   frameRate,
+        const cardinal bufferDelay,
+        const cardinal frameSize) const
+{
+   return((frameSize >= MinFrameSize) &&
+          (frameSize <= MaxFrameSize) &&
+          (((frameSize - MinFrameSize) % FrameSizeStep) == 0));
+}
+
+
+// ###### Get nearest lower valid payload frame size ########################
+cardinal SyntheticLayerDescription::getNearestValidPayloadFrameSize(
+            const double   frameRate,
+            const cardinal bufferDelay,
+            const cardinal frameSize) const
+{
+   if(frameSize <= MinFrameSize) {
+      return(MinFrameSize);
+   }
+   const cardinal size = std::min(frameSize,MaxFrameSize);
+   return(size - ((size - MinFrameSize) % FrameSizeStep));
+}
+
+
+// ###### Get next higher valid payload frame size ##########################
+cardinal SyntheticLayerDescription::getNextPayloadFrameSizeForDelayAndSize(
+            const double   frameRate,
+            const cardinal bufferDelay,
+            const cardinal frameSize) const
+{
+   const cardinal size = getNearestValidPayloadFrameSize(frameRate,bufferDelay,frameSize);
+   return(std::min(size + FrameSizeStep,MaxFrameSize));
+}
+
+
+// ###### Get next lower valid payload frame size ###########################
+cardinal SyntheticLayerDescription::getPrevPayloadFrameSizeForDelayAndSize(
+            const double   frameRate,
+            const cardinal bufferDelay,
+            const cardinal frameSize) const
+{
+   const cardinal size = getNearestValidPayloadFrameSize(frameRate,bufferDelay,frameSize);
+   if(size >= MinFrameSize + FrameSizeStep) {
+      return(size - FrameSizeStep);
+   }
+   return(MinFrameSize);
+}
+
+
+// ###### Get payload frame size scale factor ###############################
+double SyntheticLayerDescription::getPayloadFrameSizeScaleFactorForDelayAndSize(
+          const double   frameRate,
+          const cardinal bufferDelay,
+          const cardinal frameSize) const
+{
+   if(MaxFrameSize <= MinFrameSize) {
+      return(1.0);
+   }
+   const cardinal size = std::max(std::min(frameSize,MaxFrameSize),MinFrameSize);
+   return((double)(size - MinFrameSize) / (double)(MaxFrameSize - MinFrameSize));
+}
+
+
+// ###### Get payload frame size utilization ################################
+double SyntheticLayerDescription::getPayloadFrameSizeUtilizationForDelayAndSize(
+          const double   frameRate,
+          const cardinal bufferDelay,
+          const cardinal frameSize) const
+{
+   // Utilization must be > 0 for the minimum frame size!
+   const double scaleFactor =
+      getPayloadFrameSizeScaleFactorForDelayAndSize(frameRate,bufferDelay,frameSize);
+   return(std::max(0.001,pow(scaleFactor,UtilizationExponent)));
+}
+
+
+// ###### Get frame size utilization weight #################################
+double SyntheticLayerDescription::getFrameSizeUtilizationWeight(
+          const double frameRate) const
+{
+   return(1.0);
+}
+
+
+// ###### Get maximum buffer delay ##########################################
+cardinal SyntheticLayerDescription::getMaxBufferDelay(const double frameRate) const
+{
+   return(std::max(MaxBufferDelay,(cardinal)1));
+}
+
+
+// ###### Get next higher buffer delay ######################################
+cardinal SyntheticLayerDescription::getNextBufferDelayForDelay(
+            const double   frameRate,
+            const cardinal bufferDelay) const
+{
+   return(std::min(bufferDelay + 1,getMaxBufferDelay(frameRate)));
+}
+
+
+// ###### Get next lower buffer delay #######################################
+cardinal SyntheticLayerDescription::getPrevBufferDelayForDelay(
+            const double   frameRate,
+            const cardinal bufferDelay) const
+{
+   return((bufferDelay > 1) ? (bufferDelay - 1) : 1);
+}
+
+
+
+// ##########################################################################
+// #### SyntheticQoSDescription                                          ####
+// ##########################################################################
+
+
+// ###### Constructor #######################################################
+SyntheticQoSDescription::SyntheticQoSDescription(
+   const SyntheticStreamProfile& profile)
+{
+   ConstantFrameRate = profile.FrameRate;
+   RUPoints          = std::max(profile.RUPoints,(cardinal)1);
+   Layers            = std::min(std::max(profile.Layers,(cardinal)1),
+                                RTPConstants::RTPMaxQualityLayers);
+   for(cardinal i = 0;i < RTPConstants::RTPMaxQualityLayers;i++) {
+      Layer[i] = (i < Layers) ? new SyntheticLayerDescription(profile,i) : NULL;
+   }
+   initDescription(ConstantFrameRate);
+   setStreamPriority(profile.StreamPriority);
+   setSessionPriority(profile.SessionPriority);
+}
+
+
+// ###### Destructor ########################################################
+SyntheticQoSDescription::~SyntheticQoSDescription()
+{
+   for(cardinal i = 0;i < RTPConstants::RTPMaxQualityLayers;i++) {
+      if(Layer[i] != NULL) {
+         delete Layer[i];
+         Layer[i] = NULL;
+      }
+   }
+}
+
+
+// ###### Update description ################################################
+void SyntheticQoSDescription::updateDescription(const cardinal pktHeaderSize,
+                                                const cardinal pktMaxSize)
+{
+}
+
+
+// ###### Get number of layers ##############################################
+cardinal SyntheticQoSDescription::getLayers() const
+{
+   return(Layers);
+}
+
+
+// ###### Get layer #########################################################
+AbstractLayerDescription* SyntheticQoSDescription::getLayer(const cardinal layer) const
+{
+   if(layer < Layers) {
+      return(Layer[layer]);
+   }
+   return(NULL);
+}
+
+
+// ###### Get resource/utilization list #####################################
+// The points are equidistant in overall scale; the layers are filled up
+// one after another, i.e. layer i+1 only gets bandwidth when layer i has
+// reached its maximum frame size.
+cardinal SyntheticQoSDescription::getPrecomputedResourceUtilizationList(
+            ResourceUtilizationPoint* rup,
+            const card64              bwThreshold,
+            const double              utThreshold,
+            const cardinal            maxPoints) const
+{
+   const cardinal points = std::min(RUPoints,maxPoints);
+   cardinal       count  = 0;
+   for(cardinal i = 0;i < points;i++) {
+      const double scale = (points > 1) ? ((double)i / (double)(points - 1)) : 1.0;
+
+      rup[count].reset();
+      rup[count].FrameRate = ConstantFrameRate;
+      rup[count].Layers    = Layers;
+      card64 bandwidth[Layers];
+      for(cardinal j = 0;j < Layers;j++) {
+         const SyntheticLayerDescription* sld = Layer[j];
+         const double layerScale =
+            std::max(0.0,std::min(1.0,(scale * (double)Layers) - (double)j));
+         cardinal frameSize = 0;
+         if((j == 0) || (layerScale > 0.0)) {
+            const cardinal minFrameSize = sld->getMinPayloadFrameSizeForDelay(ConstantFrameRate,1);
+            const cardinal maxFrameSize = sld->getMaxPayloadFrameSizeForDelay(ConstantFrameRate,1);
+            frameSize = sld->getNearestValidPayloadFrameSize(
+                           ConstantFrameRate, 1,
+                           minFrameSize + (cardinal)floor(layerScale * (double)(maxFrameSize - minFrameSize)));
+         }
+         const cardinal rawFrameSize = sld->payloadToRaw(ConstantFrameRate,frameSize,1);
+         bandwidth[j] = sld->frameSizeToBandwidth(ConstantFrameRate,rawFrameSize);
+
+         BandwidthInfo& bi    = rup[count].LayerBandwidthInfo[j];
+         bi.BytesPerSecond    = bandwidth[j];
+         bi.PacketsPerSecond  = sld->frameSizeToPacketRate(ConstantFrameRate,rawFrameSize);
+         bi.BufferDelay       = 1;
+         bi.MaxTransferDelay  = sld->getMaxTransferDelay();
+         bi.MaxLossRate       = sld->getMaxLossRate();
+         bi.MaxJitter         = sld->getMaxJitter();
+         rup[count].Bandwidth += bandwidth[j];
+      }
+      rup[count].Utilization =
+         calculateUtilizationForLayerBandwidths(ConstantFrameRate,Layers,(card64*)&bandwidth);
+      if(rup[count].Utilization >= 0.0) {
+         count++;
+      }
+   }
+   return(count);
+}
+
+
+// ###### Get frame rate scalability class ##################################
+const char* SyntheticQoSDescription::getFrameRateScalabilityClass() const
+{
+   return("Synthetic");
+}
+
+
+// ###### Check, if frame rate is scalable ##################################
+bool SyntheticQoSDescription::isFrameRateScalable() const
+{
+   return(false);
+}
+
+
+// ###### Get minimum frame rate ############################################
+double SyntheticQoSDescription::getMinFrameRate() const
+{
+   return(ConstantFrameRate);
+}
+
+
+// ###### Get maximum frame rate ############################################
+double SyntheticQoSDescription::getMaxFrameRate() const
+{
+   return(ConstantFrameRate);
+}
+
+
+// ###### Check, if frame rate is valid #####################################
+bool SyntheticQoSDescription::isValidFrameRate(const double frameRate) const
+{
+   return(frameRate == ConstantFrameRate);
+}
+
+
+// ###### Get nearest valid frame rate ######################################
+double SyntheticQoSDescription::getNearestValidFrameRate(const double frameRate) const
+{
+   return(ConstantFrameRate);
+}
+
+
+// ###### Get next higher frame rate ########################################
+double SyntheticQoSDescription::getNextFrameRateForRate(const double frameRate) const
+{
+   return(ConstantFrameRate);
+}
+
+
+// ###### Get next lower frame rate #########################################
+double SyntheticQoSDescription::getPrevFrameRateForRate(const double frameRate) const
+{
+   return(ConstantFrameRate);
+}
+
+
+// ###### Get frame rate scale factor #######################################
+double SyntheticQoSDescription::getFrameRateScaleFactorForRate(const double frameRate) const
+{
+   return(1.0);
+}
+
+
+// ###### Get frame rate utilization ########################################
+double SyntheticQoSDescription::getFrameRateUtilizationForRate(const double frameRate) const
+{
+   return(1.0);
+}
+
+
+// ###### Get frame rate utilization weight #################################
+double SyntheticQoSDescription::getFrameRateUtilizationWeight(const double frameRate) const
+{
+   return(0.0);
+}
+
+
+
+// ##########################################################################
+// #### SyntheticStream                                                  ####
+// ##########################################################################
+
+
+// ###### Constructor #######################################################
+SyntheticStream::SyntheticStream(const SyntheticStreamProfile& profile)
+{
+   Profile        = profile;
+   QualityUpdates = 0;
+   Bandwidth      = 0;
+}
+
+
+// ###### Destructor ########################################################
+SyntheticStream::~SyntheticStream()
+{
+}
+
+
+// ###### Get QoS description ###############################################
+AbstractQoSDescription* SyntheticStream::getQoSDescription(const card64 offset)
+{
+   // The QoS description is owned by the caller!
+   return(new SyntheticQoSDescription(Profile));
+}
+
+
+// ###### Update quality ####################################################
+void SyntheticStream::updateQuality(const AbstractQoSDescription* aqd)
+{
+   Bandwidth = 0;
+   for(cardinal i = 0;i < aqd->getLayers();i++) {
+      Bandwidth += aqd->getLayer(i)->getBandwidth();
+   }
+   QualityUpdates++;
+}
+
+
+// ###### Lock stream #######################################################
+void SyntheticStream::lock()
+{
+}
+
+
+// ###### Unlock stream #####################################################
+void SyntheticStream::unlock()
+{
+}
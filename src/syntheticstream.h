@@ -0,0 +1,520 @@
+// ##########################################################################
+// ####                                                                  ####
+// ####                   Master Thesis Implementation                   ####
+// ####  Management of Layered Variable Bitrate Multimedia Streams over  ####
+// ####                 DiffServ with A Priori Knowledge                 ####
+// ####                                                                  ####
+// #### ================================================================ ####
+// ####                                                                  ####
+// ####                                                                  ####
+// #### Synthetic Stream                                                 ####
+// ####                                                                  ####
+// ####           Copyright (C) 1999-2026 by Thomas Dreibholz            ####
+// ####                                                                  ####
+// #### Contact:                                                         ####
+// ####    EMail: thomas.dreibholz@gmail.com                             ####
+// ####    WWW:   https://www.nntb.no/~dreibh/rtpaudio                   ####
+// ####                                                                  ####
+// #### ---------------------------------------------------------------- ####
+// ####                                                                  ####
+// #### This program is free software: you can redistribute it and/or    ####
+// #### modify it under the terms of the GNU General Public License as   ####
+// #### published by the Free Software Foundation, either version 3 of   ####
+// #### the License, or (at your option) any later version.              ####
+// ####                                                                  ####
+// #### This program is distributed in the hope that it will be useful,  ####
+// #### but WITHOUT ANY WARRANTY; without even the implied warranty of   ####
+// #### MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    ####
+// #### GNU General Public License for more details.                     ####
+// ####                                                                  ####
+// #### You should have received a copy of the GNU General Public        ####
+// #### License along with this program.  If not, see                    ####
+// #### <http://www.gnu.org/licenses/>.                                  ####
+// ####                                                                  ####
+// ##########################################################################
+
+
+#ifndef SYNTHETICSTREAM_H
+#define SYNTHETICSTREAM_H
+
+
+#include "tdsystem.h"
+#include "managedstreaminterface.h"
+#include "abstractqosdescription.h"
+#include "abstractlayerdescription.h"
+
+
+/**
+  * This structure describes the layer and resource/utilization profile
+  * of a synthetic stream.
+  *
+  * @short   Synthetic Stream Profile
+  * @author  Thomas Dreibholz (thomas.dreibholz@gmail.com)
+  * @version 1.0
+*/
+struct SyntheticStreamProfile
+{
+   /**
+     * Reset profile to defaults (one 8 KiB/s - 32 KiB/s layer at 25 fps).
+     */
+   void reset();
+
+   /**
+     * Frame rate.
+     */
+   double FrameRate;
+
+   /**
+     * Number of layers.
+     */
+   cardinal Layers;
+
+   /**
+     * Number of resource/utilization points.
+     */
+   cardinal RUPoints;
+
+   /**
+     * Minimum payload frame size of each layer.
+     */
+   cardinal MinFrameSize[RTPConstants::RTPMaxQualityLayers];
+
+   /**
+     * Maximum payload frame size of each layer.
+     */
+   cardinal MaxFrameSize[RTPConstants::RTPMaxQualityLayers];
+
+   /**
+     * Payload frame size granularity.
+     */
+   cardinal FrameSizeStep;
+
+   /**
+     * Utilization exponent: utilization = scaleFactor^exponent.
+     */
+   double UtilizationExponent;
+
+   /**
+     * Maximum buffer delay (in frames).
+     */
+   cardinal MaxBufferDelay;
+
+   /**
+     * Maximum transfer delay in microseconds.
+     */
+   double MaxTransferDelay;
+
+   /**
+     * Maximum loss rate.
+     */
+   double MaxLossRate;
+
+   /**
+     * Maximum jitter.
+     */
+   double MaxJitter;
+
+   /**
+     * Stream priority.
+     */
+   int8 StreamPriority;
+
+   /**
+     * Session priority.
+     */
+   int8 SessionPriority;
+};
+
+
+
+/**
+  * This class is a constant bitrate layer description with a linearly
+  * scalable frame size, to be used for simulation.
+  *
+  * @short   Synthetic Layer Description
+  * @author  Thomas Dreibholz (thomas.dreibholz@gmail.com)
+  * @version 1.0
+*/
+class SyntheticLayerDescription : public AbstractLayerDescription
+{
+   // ====== Constructor/Destructor =========================================
+   public:
+   /**
+     * Constructor.
+     *
+     * @param profile Stream profile.
+     * @param layer Layer number.
+     */
+   SyntheticLayerDescription(const SyntheticStreamProfile& profile,
+                             const cardinal                layer);
+
+   /**
+     * Destructor.
+     */
+   ~SyntheticLayerDescription();
+
+
+   // ====== FrameSizeScalabilityInterface implementation ===================
+   /**
+     * getFrameSizeScalabilityClass() implementation of FrameSizeScalabilityInterface.
+     *
+     * @see FrameSizeScalabilityInterface#getFrameSizeScalabilityClass
+     */
+   const char* getFrameSizeScalabilityClass() const;
+
+   /**
+     * isFrameSizeScalable() implementation of FrameSizeScalabilityInterface.
+     *
+     * @see FrameSizeScalabilityInterface#isFrameSizeScalable
+     */
+   bool isFrameSizeScalable() const;
+
+   /**
+     * isVariableBitrate() implementation of FrameSizeScalabilityInterface.
+     *
+     * @see FrameSizeScalabilityInterface#isVariableBitrate
+     */
+   bool isVariableBitrate() const;
+
+   /**
+     * getMinPayloadFrameSizeForDelay() implementation of FrameSizeScalabilityInterface.
+     *
+     * @see FrameSizeScalabilityInterface#getMinPayloadFrameSizeForDelay
+     */
+   cardinal getMinPayloadFrameSizeForDelay(const double   frameRate,
+                                           const cardinal bufferDelay) const;
+
+   /**
+     * getMaxPayloadFrameSizeForDelay() implementation of FrameSizeScalabilityInterface.
+     *
+     * @see FrameSizeScalabilityInterface#getMaxPayloadFrameSizeForDelay
+     */
+   cardinal getMaxPayloadFrameSizeForDelay(const double   frameRate,
+                                           const cardinal bufferDelay) const;
+
+   /**
+     * getMaxFrameCountForDelay() implementation of FrameSizeScalabilityInterface.
+     *
+     * @see FrameSizeScalabilityInterface#getMaxFrameCountForDelay
+     */
+   cardinal getMaxFrameCountForDelay(const double   frameRate,
+                                     const cardinal bufferDelay) const;
+
+   /**
+     * isValidPayloadFrameSize() implementation of FrameSizeScalabilityInterface.
+     *
+     * @see FrameSizeScalabilityInterface#isValidPayloadFrameSize
+     */
+   bool isValidPayloadFrameSize(const double   frameRate,
+                                const cardinal bufferDelay,
+                                const cardinal frameSize) const;
+
+   /**
+     * getNearestValidPayloadFrameSize() implementation of FrameSizeScalabilityInterface.
+     *
+     * @see FrameSizeScalabilityInterface#getNearestValidPayloadFrameSize
+     */
+   cardinal getNearestValidPayloadFrameSize(const double   frameRate,
+                                            const cardinal bufferDelay,
+                                            const cardinal frameSize) const;
+
+   /**
+     * getNextPayloadFrameSizeForDelayAndSize() implementation of FrameSizeScalabilityInterface.
+     *
+     * @see FrameSizeScalabilityInterface#getNextPayloadFrameSizeForDelayAndSize
+     */
+   cardinal getNextPayloadFrameSizeForDelayAndSize(const double   frameRate,
+                                                   const cardinal bufferDelay,
+                                                   const cardinal frameSize) const;
+
+   /**
+     * getPrevPayloadFrameSizeForDelayAndSize() implementation of FrameSizeScalabilityInterface.
+     *
+     * @see FrameSizeScalabilityInterface#getPrevPayloadFrameSizeForDelayAndSize
+     */
+   cardinal getPrevPayloadFrameSizeForDelayAndSize(const double   frameRate,
+                                                   const cardinal bufferDelay,
+                                                   const cardinal frameSize) const;
+
+   /**
+     * getPayloadFrameSizeScaleFactorForDelayAndSize() implementation of FrameSizeScalabilityInterface.
+     *
+     * @see FrameSizeScalabilityInterface#getPayloadFrameSizeScaleFactorForDelayAndSize
+     */
+   double getPayloadFrameSizeScaleFactorForDelayAndSize(const double   frameRate,
+                                                        const cardinal bufferDelay,
+                                                        const cardinal frameSize) const;
+
+   /**
+     * getPayloadFrameSizeUtilizationForDelayAndSize() implementation of FrameSizeScalabilityInterface.
+     *
+     * @see FrameSizeScalabilityInterface#getPayloadFrameSizeUtilizationForDelayAndSize
+     */
+   double getPayloadFrameSizeUtilizationForDelayAndSize(const double   frameRate,
+                                                        const cardinal bufferDelay,
+                                                        const cardinal frameSize) const;
+
+   /**
+     * getFrameSizeUtilizationWeight() implementation of FrameSizeScalabilityInterface.
+     *
+     * @see FrameSizeScalabilityInterface#getFrameSizeUtilizationWeight
+     */
+   double getFrameSizeUtilizationWeight(const double frameRate) const;
+
+   /**
+     * getMaxBufferDelay() implementation of FrameSizeScalabilityInterface.
+     *
+     * @see FrameSizeScalabilityInterface#getMaxBufferDelay
+     */
+   cardinal getMaxBufferDelay(const double frameRate) const;
+
+   /**
+     * getNextBufferDelayForDelay() implementation of FrameSizeScalabilityInterface.
+     *
+     * @see FrameSizeScalabilityInterface#getNextBufferDelayForDelay
+     */
+   cardinal getNextBufferDelayForDelay(const double   frameRate,
+                                       const cardinal bufferDelay) const;
+
+   /**
+     * getPrevBufferDelayForDelay() implementation of FrameSizeScalabilityInterface.
+     *
+     * @see FrameSizeScalabilityInterface#getPrevBufferDelayForDelay
+     */
+   cardinal getPrevBufferDelayForDelay(const double   frameRate,
+                                       const cardinal bufferDelay) const;
+
+
+   // ====== Private data ===================================================
+   private:
+   cardinal MinFrameSize;
+   cardinal MaxFrameSize;
+   cardinal FrameSizeStep;
+   double   UtilizationExponent;
+};
+
+
+
+/**
+  * This class is a QoS description with fixed frame rate and synthetic
+  * layers, to be used for simulation.
+  *
+  * @short   Synthetic QoS Description
+  * @author  Thomas Dreibholz (thomas.dreibholz@gmail.com)
+  * @version 1.0
+*/
+class SyntheticQoSDescription : public AbstractQoSDescription
+{
+   // ====== Constructor/Destructor =========================================
+   public:
+   /**
+     * Constructor.
+     *
+     * @param profile Stream profile.
+     */
+   SyntheticQoSDescription(const SyntheticStreamProfile& profile);
+
+   /**
+     * Destructor.
+     */
+   ~SyntheticQoSDescription();
+
+
+   // ====== AbstractQoSDescription implementation ==========================
+   /**
+     * updateDescription() implementation of AbstractQoSDescription.
+     *
+     * @see AbstractQoSDescription#updateDescription
+     */
+   void updateDescription(const cardinal pktHeaderSize,
+                          const cardinal pktMaxSize);
+
+   /**
+     * getLayers() implementation of AbstractQoSDescription.
+     *
+     * @see AbstractQoSDescription#getLayers
+     */
+   cardinal getLayers() const;
+
+   /**
+     * getLayer() implementation of AbstractQoSDescription.
+     *
+     * @see AbstractQoSDescription#getLayer
+     */
+   AbstractLayerDescription* getLayer(const cardinal layer) const;
+
+   /**
+     * getPrecomputedResourceUtilizationList() implementation of AbstractQoSDescription.
+     *
+     * @see AbstractQoSDescription#getPrecomputedResourceUtilizationList
+     */
+   cardinal getPrecomputedResourceUtilizationList(
+               ResourceUtilizationPoint* rup,
+               const card64              bwThreshold,
+               const double              utThreshold,
+               const cardinal            maxPoints) const;
+
+
+   // ====== FrameRateScalabilityInterface implementation ===================
+   /**
+     * getFrameRateScalabilityClass() implementation of FrameRateScalabilityInterface.
+     *
+     * @see FrameRateScalabilityInterface#getFrameRateScalabilityClass
+     */
+   const char* getFrameRateScalabilityClass() const;
+
+   /**
+     * isFrameRateScalable() implementation of FrameRateScalabilityInterface.
+     *
+     * @see FrameRateScalabilityInterface#isFrameRateScalable
+     */
+   bool isFrameRateScalable() const;
+
+   /**
+     * getMinFrameRate() implementation of FrameRateScalabilityInterface.
+     *
+     * @see FrameRateScalabilityInterface#getMinFrameRate
+     */
+   double getMinFrameRate() const;
+
+   /**
+     * getMaxFrameRate() implementation of FrameRateScalabilityInterface.
+     *
+     * @see FrameRateScalabilityInterface#getMaxFrameRate
+     */
+   double getMaxFrameRate() const;
+
+   /**
+     * isValidFrameRate() implementation of FrameRateScalabilityInterface.
+     *
+     * @see FrameRateScalabilityInterface#isValidFrameRate
+     */
+   bool isValidFrameRate(const double frameRate) const;
+
+   /**
+     * getNearestValidFrameRate() implementation of FrameRateScalabilityInterface.
+     *
+     * @see FrameRateScalabilityInterface#getNearestValidFrameRate
+     */
+   double getNearestValidFrameRate(const double frameRate) const;
+
+   /**
+     * getNextFrameRateForRate() implementation of FrameRateScalabilityInterface.
+     *
+     * @see FrameRateScalabilityInterface#getNextFrameRateForRate
+     */
+   double getNextFrameRateForRate(const double frameRate) const;
+
+   /**
+     * getPrevFrameRateForRate() implementation of FrameRateScalabilityInterface.
+     *
+     * @see FrameRateScalabilityInterface#getPrevFrameRateForRate
+     */
+   double getPrevFrameRateForRate(const double frameRate) const;
+
+   /**
+     * getFrameRateScaleFactorForRate() implementation of FrameRateScalabilityInterface.
+     *
+     * @see FrameRateScalabilityInterface#getFrameRateScaleFactorForRate
+     */
+   double getFrameRateScaleFactorForRate(const double frameRate) const;
+
+   /**
+     * getFrameRateUtilizationForRate() implementation of FrameRateScalabilityInterface.
+     *
+     * @see FrameRateScalabilityInterface#getFrameRateUtilizationForRate
+     */
+   double getFrameRateUtilizationForRate(const double frameRate) const;
+
+   /**
+     * getFrameRateUtilizationWeight() implementation of FrameRateScalabilityInterface.
+     *
+     * @see FrameRateScalabilityInterface#getFrameRateUtilizationWeight
+     */
+   double getFrameRateUtilizationWeight(const double frameRate) const;
+
+
+   // ====== Private data ===================================================
+   private:
+   SyntheticLayerDescription* Layer[RTPConstants::RTPMaxQualityLayers];
+   cardinal                   Layers;
+   cardinal                   RUPoints;
+   double                     ConstantFrameRate;
+};
+
+
+
+/**
+  * This class is a managed stream without encoder and network transport,
+  * which only provides a SyntheticQoSDescription to the QoS manager.
+  *
+  * @short   Synthetic Stream
+  * @author  Thomas Dreibholz (thomas.dreibholz@gmail.com)
+  * @version 1.0
+*/
+class SyntheticStream : virtual public ManagedStreamInterface
+{
+   // ====== Constructor/Destructor =========================================
+   public:
+   /**
+     * Constructor.
+     *
+     * @param profile Stream profile.
+     */
+   SyntheticStream(const SyntheticStreamProfile& profile);
+
+   /**
+     * Destructor.
+     */
+   ~SyntheticStream();
+
+
+   // ====== ManagedStreamInterface implementation ==========================
+   /**
+     * getQoSDescription() implementation of ManagedStreamInterface.
+     *
+     * @see ManagedStreamInterface#getQoSDescription
+     */
+   AbstractQoSDescription* getQoSDescription(const card64 offset);
+
+   /**
+     * updateQuality() implementation of ManagedStreamInterface.
+     *
+     * @see ManagedStreamInterface#updateQuality
+     */
+   void updateQuality(const AbstractQoSDescription* aqd);
+
+   /**
+     * lock() implementation of ManagedStreamInterface.
+     *
+     * @see ManagedStreamInterface#lock
+     */
+   void lock();
+
+   /**
+     * unlock() implementation of ManagedStreamInterface.
+     *
+     * @see ManagedStreamInterface#unlock
+     */
+   void unlock();
+
+
+   // ====== Statistics =====================================================
+   /**
+     * Number of updateQuality() calls.
+     */
+   card64 QualityUpdates;
+
+   /**
+     * Total bandwidth of last quality update.
+     */
+   card64 Bandwidth;
+
+
+   // ====== Private data ===================================================
+   private:
+   SyntheticStreamProfile Profile;
+};
+
+
+#endif
@@ -882,6 +882,41 @@ ssize_t Socket::sendMsg(const struct msghdr* msg,
                         const integer        flags,
                         const card8          trafficClass)
 {
+#if (SYSTEM == OS_Linux) && defined(IPV6_TCLASS)
+   // ====== Set traffic class by ancillary data ============================
+   // Unlike changing the socket's TOS option for each packet, this also
+   // works when several threads share the socket.
+   if((trafficClass != 0x00) && (Protocol != IPPROTO_SCTP) && (msg->msg_name != NULL) &&
+      (msg->msg_controllen + CMSG_SPACE(sizeof(int)) <= 256)) {
+      const sockaddr_in6* destination = (const sockaddr_in6*)msg->msg_name;
+      const bool          ipv6        = (destination->sin6_family == AF_INET6) &&
+                                           !IN6_IS_ADDR_V4MAPPED(&destination->sin6_addr);
+      union {
+         char    buffer[256];
+         cmsghdr align;
+      } control;
+      msghdr message = *msg;
+      if(msg->msg_controllen > 0) {
+         memcpy((char*)&control.buffer,msg->msg_control,msg->msg_controllen);
+      }
+      cmsghdr* cmsg = (cmsghdr*)&control.buffer[CMSG_ALIGN(msg->msg_controllen)];
+      cmsg->cmsg_len   = CMSG_LEN(sizeof(int));
+      cmsg->cmsg_level = ipv6 ? IPPROTO_IPV6 : IPPROTO_IP;
+      cmsg->cmsg_type  = ipv6 ? IPV6_TCLASS  : IP_TOS;
+      const int value  = (int)trafficClass;
+      memcpy(CMSG_DATA(cmsg),&value,sizeof(value));
+      message.msg_control    = (char*)&control.buffer;
+      message.msg_controllen = CMSG_ALIGN(msg->msg_controllen) + CMSG_SPACE(sizeof(int));
+
+      ssize_t result = ext_sendmsg(SocketDescriptor,&message,(int)flags);
+      if(result < 0) {
+         LastError = errno;
+         result    = -LastError;
+      }
+      return(result);
+   }
+#endif
+
    if(trafficClass != 0x00) {
       setTypeOfService(trafficClass);
    }
@@ -984,7 +1019,7 @@ bool Socket::renewFlow(InternetFlow&  flow,
                        const cardinal linger)
 {
 #if (SYSTEM == OS_Linux)
-   if((InternetAddress::UseIPv6 == false) || ((SendFlow & IPV6_FLOWINFO_FLOWLABEL) == 0)) {
+   if((InternetAddress::UseIPv6 == false) || (flow.getFlowLabel() == 0)) {
       return(true);
    }
 
@@ -1197,7 +1232,7 @@ bool Socket::multicastMembership(const SocketAddress& address,
          }
          return(setSocketOption(IPPROTO_IP,
                                 add ? IP_ADD_MEMBERSHIP : IP_DROP_MEMBERSHIP,
-                                &mreq,sizeof(mreq)));
+                                &mreq,sizeof(mreq)) == 0);
       }
    }
    else if(Family == AF_INET6) {
@@ -1218,7 +1253,7 @@ bool Socket::multicastMembership(const SocketAddress& address,
          }
          return(setSocketOption(IPPROTO_IPV6,
                                 add ? IPV6_JOIN_GROUP : IPV6_LEAVE_GROUP,
-                                &mreq,sizeof(mreq)));
+                                &mreq,sizeof(mreq)) == 0);
       }
    }
    else {
@@ -1321,6 +1356,76 @@ bool Socket::setMulticastTTL(const card8 ttl)
 }
 
 
+// ###### Set multicast interface ###########################################
+bool Socket::setMulticastInterface(const char* interface)
+{
+   if(Family == AF_INET) {
+      in_addr addr;
+      if(interface != NULL) {
+         ifreq ifr;
+         strncpy(ifr.ifr_name,interface,sizeof(ifr.ifr_name) - 1);
+         ifr.ifr_name[sizeof(ifr.ifr_name) - 1] = 0x00;
+         if(ioctl(SIOCGIFADDR,&ifr) != 0) {
+#ifndef DISABLE_WARNINGS
+            std::cerr << "ERROR: Socket::setMulticastInterface() - Unable to get interface address!" << std::endl;
+#endif
+            return(false);
+         }
+         addr = ((sockaddr_in*)&ifr.ifr_addr)->sin_addr;
+      }
+      else {
+         addr.s_addr = htonl(INADDR_ANY);
+      }
+      return(setSocketOption(IPPROTO_IP,IP_MULTICAST_IF,&addr,sizeof(addr)) == 0);
+   }
+   else if(Family == AF_INET6) {
+      unsigned int index = 0;
+      if(interface != NULL) {
+         index = if_nametoindex(interface);
+         if(index == 0) {
+#ifndef DISABLE_WARNINGS
+            std::cerr << "ERROR: Socket::setMulticastInterface() - Unable to get interface index!" << std::endl;
+#endif
+            return(false);
+         }
+      }
+      return(setSocketOption(IPPROTO_IPV6,IPV6_MULTICAST_IF,&index,sizeof(index)) == 0);
+   }
+   else {
+#ifndef DISABLE_WARNINGS
+      std::cerr << "ERROR: Socket::setMulticastInterface() - Multicast is not supported for this socket type!" << std::endl;
+#endif
+   }
+   return(false);
+}
+
+
+// ###### Set multicast all mode ############################################
+bool Socket::setMulticastAll(const bool on)
+{
+   const int value = (on ? 1 : 0);
+   if(Family == AF_INET) {
+#ifdef IP_MULTICAST_ALL
+      return(setSocketOption(IPPROTO_IP,IP_MULTICAST_ALL,&value,sizeof(value)) == 0);
+#else
+      return(on);
+#endif
+   }
+   else if(Family == AF_INET6) {
+#ifdef IPV6_MULTICAST_ALL
+      return(setSocketOption(IPPROTO_IPV6,IPV6_MULTICAST_ALL,&value,sizeof(value)) == 0);
+#else
+      return(on);
+#endif
+   }
+   else {
+#ifndef DISABLE_WARNINGS
+      std::cerr << "ERROR: Socket::setMulticastAll() - Multicast is not supported for this socket type!" << std::endl;
+#endif
+   }
+   return(false);
+}
+
 // ###### Set IPv4 type of service field ####################################
 bool Socket::setTypeOfService(const card8 trafficClass)
 {
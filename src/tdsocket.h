@@ -453,7 +453,8 @@ O     * Bind socket to one or more given addresses. If no addresses are given,
      * @param msg Message.
      * @param flags Flags.
      * @param trafficClass Traffic class for packet.
-     * @return Result of sendmsg() call.
+     * @return Number of bytes sent or negative error code (-errno). Use this
+     *         instead of getLastError() on sockets shared between threads.
      */
    ssize_t sendMsg(const struct msghdr* msg,
                    const integer        flags,
@@ -624,6 +625,25 @@ O     * Bind socket to one or more given addresses. If no addresses are given,
      */
    bool setMulticastTTL(const card8 ttl);
 
+   /**
+     * Set outgoing interface for multicast packets.
+     *
+     * @param interface Interface name (NULL for default interface).
+     * @return true for success; false otherwise.
+     */
+   bool setMulticastInterface(const char* interface);
+
+   /**
+     * Set multicast all mode. If disabled, the socket only receives packets
+     * of the groups it has joined itself, not of groups joined by other
+     * sockets bound to the same port. Where the system always behaves this
+     * way, disabling succeeds without doing anything.
+     *
+     * @param on true to enable, false to disable.
+     * @return true for success; false otherwise.
+     */
+   bool setMulticastAll(const bool on);
+
 
    // ====== IPv6 flow functions ============================================
    /**
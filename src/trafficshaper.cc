@@ -46,6 +46,7 @@ TrafficShaperSingleton TrafficShaper::Singleton;
 
 // ###### Constructor #######################################################
 TrafficShaper::TrafficShaper()
+   : Synchronizable("TrafficShaper",Synchronizable::LT_Adaptive)
 {
    init(NULL);
 }
@@ -53,6 +54,7 @@ TrafficShaper::TrafficShaper()
 
 // ###### Constructor #######################################################
 TrafficShaper::TrafficShaper(Socket* socket)
+   : Synchronizable("TrafficShaper",Synchronizable::LT_Adaptive)
 {
    init(socket);
 }
@@ -82,8 +84,14 @@ TrafficShaper::~TrafficShaper()
 void TrafficShaper::flush()
 {
    synchronized();
+   flushQueue();
+   unsynchronized();
+}
+
 
-   // ====== Flush buffer ===================================================
+// ###### Flush buffer (lock has to be held) ################################
+void TrafficShaper::flushQueue()
+{
    std::deque<TrafficShaperPacket>::iterator iterator = Queue.begin();
    while(iterator != Queue.end()) {
       const TrafficShaperPacket& packet = *iterator;
@@ -92,8 +100,6 @@ void TrafficShaper::flush()
       iterator = Queue.begin();
    }
    SendTimeStamp = getMicroTime();
-
-   unsynchronized();
 }
 
 
@@ -213,7 +219,7 @@ ssize_t TrafficShaper::addPacket(const void*    data,
 #endif
 
       // ====== Flush buffer ================================================
-      flush();
+      flushQueue();
       unsynchronized();
 
       delete packet.Data;
@@ -264,7 +270,7 @@ bool TrafficShaper::refreshBuffer(const card8 trafficClass,
          std::cerr << "WARNING: TrafficShaper::refreshBuffer() - Flush necessary!"
               << std::endl;
 #endif
-         flush();
+         flushQueue();
          flushed = true;
          break;
       }
@@ -196,6 +196,13 @@ class TrafficShaper : public Synchronizable
      */
    inline cardinal getLastSeqNum();
 
+   /**
+     * Get number of packets waiting in the queue.
+     *
+     * @return Number of packets.
+     */
+   inline cardinal getQueueLength();
+
 
    // ====== I/O functions ==================================================
    /**
@@ -251,6 +258,7 @@ class TrafficShaper : public Synchronizable
    // ====== Private data ===================================================
    private:
    void sendAll();
+   void flushQueue();
    ssize_t addPacket(const void*    data,
                      const cardinal bytes,
                      const cardinal seqNum,
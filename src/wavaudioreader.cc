@@ -32,18 +32,96 @@
 
 #include "tdsystem.h"
 #include "wavaudioreader.h"
+#include "soundfilemapping.h"
+
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_CONVERSION_SIMD
+#include <immintrin.h>
+#endif
+
+
+// Minimum size of a read-ahead request and how far read-ahead reaches
+static const card64 ReadAheadStep   = 256 * 1024;
+static const card64 ReadAheadWindow = 1024 * 1024;
+
+// Format tags and the PCM sub-format GUID of WAVE_FORMAT_EXTENSIBLE
+static const card16 WaveFormatPCM        = 0x0001;
+static const card16 WaveFormatExtensible = 0xfffe;
+static const card8  WaveSubFormatPCM[16] = {
+   0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00,
+   0x80, 0x00, 0x00, 0xaa, 0x00, 0x38, 0x9b, 0x71
+};
+
+
+// ###### Convert 24 bit samples to 16 bit ##################################
+// Little endian 24 bit samples become 16 bit by dropping their low byte.
+static void convert24To16(const card8* input, card8* output, cardinal samples)
+{
+   while(samples > 0) {
+      output[0] = input[1];
+      output[1] = input[2];
+      input  += 3;
+      output += 2;
+      samples--;
+   }
+}
+
+
+#ifdef HAVE_CONVERSION_SIMD
+// ###### Convert 24 bit samples to 16 bit (SSSE3) ##########################
+__attribute__((target("ssse3")))
+static void convert24To16SSSE3(const card8* input, card8* output, cardinal samples)
+{
+   // Each load covers 4 samples (12 bytes) plus 4 bytes of the next one.
+   // The last load of a round reaches 4 bytes beyond the round's 48 bytes,
+   // so a round needs 2 samples more than it converts.
+   const __m128i shuffle = _mm_setr_epi8(1, 2, 4, 5, 7, 8, 10, 11,
+                                         -1, -1, -1, -1, -1, -1, -1, -1);
+   while(samples >= 18) {
+      const __m128i a = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)input),        shuffle);
+      const __m128i b = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(input + 12)), shuffle);
+      const __m128i c = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(input + 24)), shuffle);
+      const __m128i d = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(input + 36)), shuffle);
+      _mm_storeu_si128((__m128i*)output,        _mm_unpacklo_epi64(a, b));
+      _mm_storeu_si128((__m128i*)(output + 16), _mm_unpacklo_epi64(c, d));
+      input   += 48;
+      output  += 32;
+      samples -= 16;
+   }
+   convert24To16(input, output, samples);
+}
+#endif
+
+
+// ###### Convert 24 bit samples to 16 bit (best available version) #########
+static void convertSamples(const card8* input, card8* output, const cardinal samples)
+{
+#ifdef HAVE_CONVERSION_SIMD
+   static const bool useSSSE3 = __builtin_cpu_supports("ssse3");
+   if(useSSSE3) {
+      convert24To16SSSE3(input, output, samples);
+      return;
+   }
+#endif
+   convert24To16(input, output, samples);
+}
 
 
 // ###### Constructor #######################################################
 WavAudioReader::WavAudioReader(const char* name)
    : AudioQuality(0,0,0,LITTLE_ENDIAN)
 {
-   Error         = ME_NoMedia;
-   StartPosition = 0;
-   EndPosition   = 0;
-   MaxPosition   = 0;
-   Position      = 0;
-   InputFD       = NULL;
+   Error             = ME_NoMedia;
+   SampleBytes       = 0;
+   BytesPerSecond    = 0;
+   StartPosition     = 0;
+   EndPosition       = 0;
+   MaxPosition       = 0;
+   Position          = 0;
+   ReadAheadPosition = 0;
+   CheckedPosition   = 0;
+   Mapping           = NULL;
    if(name != NULL) openMedia(name);
 }
 
@@ -58,15 +136,20 @@ WavAudioReader::~WavAudioReader()
 // ###### Close file ########################################################
 void WavAudioReader::closeMedia()
 {
-   if(InputFD != NULL) {
-      fclose(InputFD);
-      InputFD = NULL;
+   if(Mapping != NULL) {
+      Soundfilemapping::detach(Mapping);
+      Mapping = NULL;
    }
-   Error         = ME_NoMedia;
-   StartPosition = 0;
-   EndPosition   = 0;
-   MaxPosition   = 0;
-   Position      = 0;
+   Chunks.clear();
+   Error             = ME_NoMedia;
+   SampleBytes       = 0;
+   BytesPerSecond    = 0;
+   StartPosition     = 0;
+   EndPosition       = 0;
+   MaxPosition       = 0;
+   Position          = 0;
+   ReadAheadPosition = 0;
+   CheckedPosition   = 0;
    setSamplingRate(0);
    setBits(0);
    setChannels(0);
@@ -79,65 +162,142 @@ bool WavAudioReader::openMedia(const char* name)
    // ###### Open file ######################################################
    closeMedia();
    Error = ME_BadMedia;
-   InputFD = fopen(name,"r");
-   if(InputFD == NULL) {
+   // The file is memory mapped and shared with other readers of the same file.
+   Mapping = Soundfilemapping::attach(name);
+   if(Mapping == NULL) {
       std::cerr << "WARNING: Unable to open input file <" << name << ">!" << std::endl;
       return(false);
    }
 
-   // ###### Read RIFF-WAVE-Header ##########################################
+   // ###### Find format and data chunks ####################################
+   if(!indexChunks()) {
+      return(false);
+   }
+   const ChunkIndexEntry* formatChunk = findChunk("fmt ");
+   const ChunkIndexEntry* dataChunk   = findChunk("data");
+   if((formatChunk == NULL) || (dataChunk == NULL) ||
+      (formatChunk->Length < sizeof(WAVE_Format))) {
+      std::cerr << "WavAudioReader::openMedia() - Missing chunks in file " << name
+                << "!" << std::endl;
+      return(false);
+   }
+
+   // ###### Check format ###################################################
+   memcpy((void*)&Format,Mapping->getdata() + formatChunk->Offset,sizeof(WAVE_Format));
+   card16 formatTag = Format.FormatTag;
+   if((formatTag == WaveFormatExtensible) &&
+      (formatChunk->Length >= sizeof(WAVE_FormatExtensible))) {
+      WAVE_FormatExtensible extensible;
+      memcpy((void*)&extensible,Mapping->getdata() + formatChunk->Offset,
+             sizeof(WAVE_FormatExtensible));
+      if(memcmp((const void*)&extensible.SubFormat,(const void*)&WaveSubFormatPCM,
+                sizeof(WaveSubFormatPCM)) == 0) {
+         formatTag = WaveFormatPCM;
+      }
+   }
+   SampleBytes = (Format.Channels > 0) ? (Format.BlockAlign / Format.Channels) : 0;
+   if((formatTag != WaveFormatPCM) || (Format.SamplesPerSec == 0) ||
+      (SampleBytes < 1) || (SampleBytes > 3) ||
+      (Format.BlockAlign != SampleBytes * Format.Channels)) {
+      std::cerr << "WavAudioReader::openMedia() - Bad format in file " << name
+                << "!" << std::endl;
+      return(false);
+   }
+
+   // 24 bit samples are delivered as 16 bit samples.
+   setSamplingRate((card16)std::min(Format.SamplesPerSec,(card32)0xffff));
+   setBits((SampleBytes == 1) ? 8 : 16);
+   setChannels(Format.Channels);
+   BytesPerSecond = (card64)Format.SamplesPerSec * (card64)Format.BlockAlign;
+
+   StartPosition = dataChunk->Offset;
+   MaxPosition   = dataChunk->Length - (dataChunk->Length % Format.BlockAlign);
+   EndPosition   = StartPosition + MaxPosition;
+
+   ReadAheadPosition = StartPosition;
+   CheckedPosition   = StartPosition;
+   readAhead();
+   Error = ME_NoError;
+   return(true);
+}
+
+
+// ###### Index RIFF chunks #################################################
+bool WavAudioReader::indexChunks()
+{
+   const card8* data = Mapping->getdata();
+   const card64 size = (card64)Mapping->getsize();
+
    RIFF_Header header;
-   size_t result = fread((void *)&header,sizeof(RIFF_Header),1,InputFD);
-   if((result != 1) || strncmp(header.RIFF,"RIFF",4) || strncmp(header.FormatID,"WAVE",4)) {
+   if(size < sizeof(RIFF_Header)) {
+      return(false);
+   }
+   memcpy((void*)&header,data,sizeof(RIFF_Header));
+   if(strncmp(header.RIFF,"RIFF",4) || strncmp(header.FormatID,"WAVE",4)) {
       return(false);
    }
 
-   // ###### Read RIFF Chunks ###############################################
-   RIFF_Chunk chunk;
-   while(getChunk(chunk)) {
-      if(!(strncmp(chunk.ID,"data",4))) {
-         StartPosition = ftell(InputFD);
-         EndPosition   = chunk.Length;
-         MaxPosition   = EndPosition - StartPosition;
+   card64 position = sizeof(RIFF_Header);
+   while(position + sizeof(RIFF_Chunk) <= size) {
+      RIFF_Chunk chunk;
+      memcpy((void*)&chunk,data + position,sizeof(RIFF_Chunk));
 
-         setSamplingRate(Format.SamplesPerSec);
-         setBits((8 * Format.AvgBytesPerSec) / (Format.SamplesPerSec * Format.Channels));
-         setChannels(Format.Channels);
+      // A truncated last chunk ends with the file.
+      ChunkIndexEntry entry;
+      memcpy((void*)&entry.ID,(const void*)&chunk.ID,4);
+      entry.Offset = position + sizeof(RIFF_Chunk);
+      entry.Length = std::min((card64)chunk.Length,size - entry.Offset);
+      Chunks.push_back(entry);
 
-         if((getBits() != 8) && (getBits() != 16)) {
-            std::cerr << "WavAudioReader::openMedia() - Bad format in file " << name
-                 << "!" << std::endl;
-            return(false);
-         }
+      // Chunks are padded to an even length.
+      position = entry.Offset + (card64)chunk.Length + (card64)(chunk.Length & 1);
+   }
+   return(true);
+}
 
-         Error = ME_NoError;
-         return(true);
-      }
-      else if(!(strncmp(chunk.ID,"fmt ",4))) {
-         result = fread((void*)&Format,sizeof(WAVE_Format),1,InputFD);
-         if(result != 1) {
-            return(false);
-         }
-         if(chunk.Length > sizeof(WAVE_Format)) {
-            fseek(InputFD,chunk.Length - sizeof(WAVE_Format),SEEK_CUR);
-         }
-      }
-      else {
-         fseek(InputFD,chunk.Length,SEEK_CUR);
+
+// ###### Find indexed chunk ################################################
+const WavAudioReader::ChunkIndexEntry* WavAudioReader::findChunk(const char* id) const
+{
+   for(std::vector<ChunkIndexEntry>::const_iterator iterator = Chunks.begin();
+       iterator != Chunks.end();iterator++) {
+      if(strncmp(iterator->ID,id,4) == 0) {
+         return(&(*iterator));
       }
    }
-   return(false);
+   return(NULL);
 }
 
 
-// ###### Read WAV chunk ####################################################
-bool WavAudioReader::getChunk(RIFF_Chunk& chunk) {
-   int32 result = fread((void *)&chunk,sizeof(RIFF_Chunk),1,InputFD);
-   if(result != 1) {
-      std::cerr << "WavAudioReader::getChunk() - read error!" << std::endl;
-      return(false);
+// ###### Request read-ahead of upcoming samples ###########################
+void WavAudioReader::readAhead()
+{
+   const card64 offset = StartPosition + Position;
+   if(ReadAheadPosition + ReadAheadStep < offset + ReadAheadWindow) {
+      const card64 from = std::max(ReadAheadPosition,offset);
+      Mapping->readahead(from,offset + ReadAheadWindow - from);
+      ReadAheadPosition = offset + ReadAheadWindow;
+   }
+}
+
+
+// ###### Check upcoming samples for truncation ############################
+// Accessing the mapping beyond the end of a file truncated meanwhile raises
+// SIGBUS. So the file is checked right before reading leaves the checked
+// range, for the bytes to be read, and a truncated file ends where it has
+// been cut.
+void WavAudioReader::checkWindow(const card64 length)
+{
+   const card64 offset = StartPosition + Position;
+   const card64 window = std::min(length,MaxPosition - Position);
+   if(offset + window > CheckedPosition) {
+      const card64 available = Mapping->available(offset,window);
+      CheckedPosition = offset + available;
+      if(available < window) {
+         MaxPosition = Position + available - (available % Format.BlockAlign);
+         EndPosition = StartPosition + MaxPosition;
+      }
    }
-   return(true);
 }
 
 
@@ -151,9 +311,8 @@ bool WavAudioReader::ready() const
 // ###### Get maximum position ##############################################
 card64 WavAudioReader::getMaxPosition() const
 {
-   const cardinal bps = getBytesPerSecond();
-   if(bps > 0)
-      return( ((MaxPosition * 1000) / (card64)bps) * (PositionStepsPerSecond / 1000) ) ;
+   if(BytesPerSecond > 0)
+      return( ((MaxPosition * 1000) / BytesPerSecond) * (PositionStepsPerSecond / 1000) ) ;
    else
       return(0);
 }
@@ -181,9 +340,8 @@ MediaError WavAudioReader::getErrorCode() const
 // ###### Get position ######################################################
 card64 WavAudioReader::getPosition() const
 {
-   const cardinal bps = getBytesPerSecond();
-   if(bps > 0)
-      return( ((Position * 1000) / (card64)bps) * (PositionStepsPerSecond / 1000) ) ;
+   if(BytesPerSecond > 0)
+      return( ((Position * 1000) / BytesPerSecond) * (PositionStepsPerSecond / 1000) ) ;
    else
       return(0);
 }
@@ -192,37 +350,77 @@ card64 WavAudioReader::getPosition() const
 // ###### Set position ######################################################
 void WavAudioReader::setPosition(const card64 position)
 {
-   if((InputFD != NULL) && (Error < ME_UnrecoverableError)) {
-      Position = ((position / (PositionStepsPerSecond / 1000)) * getBytesPerSecond()) / 1000;
+   if((Mapping != NULL) && (Error < ME_UnrecoverableError)) {
+      Position = ((position / (PositionStepsPerSecond / 1000)) * BytesPerSecond) / 1000;
+      Position = std::min(Position,MaxPosition);
 
       // Avoid misaligned position!
-      Position -= (Position % 4);
+      Position -= (Position % Format.BlockAlign);
 
-      fseek(InputFD,Position + StartPosition,SEEK_SET);
+      ReadAheadPosition = StartPosition + Position;
+      CheckedPosition   = StartPosition + Position;
+      readAhead();
+      if(Error == ME_EOF) {
+         Error = ME_NoError;
+      }
    }
 }
 
 
-// ###### Read block from file ##############################################
-cardinal WavAudioReader::getNextBlock(void* buffer, const cardinal blockSize)
+// ###### Get view of next block in mapped file #############################
+const void* WavAudioReader::getNextBlockView(const cardinal blockSize)
 {
-   if((InputFD != NULL) && (Error < ME_UnrecoverableError)) {
+   if((Mapping != NULL) && (Error < ME_UnrecoverableError) && (SampleBytes <= 2)) {
+      if((blockSize % Format.BlockAlign) != 0) {
+         std::cerr << "WARNING: WavAudioReader::getNextBlockView() - Unaligned blockSize value "
+              << blockSize << "!" << std::endl;
+         return(NULL);
+      }
+      checkWindow(blockSize);
       if(Position + blockSize <= MaxPosition) {
-         if((blockSize % (getBitsPerSample() / 8)) != 0) {
-            std::cerr << "WARNING: WavAudioReader::getNextBlock() - Unaligned blockSize value "
-                 << blockSize << "!" << std::endl;
-            return(0);
-         }
-         int32 result = fread((void *)buffer,blockSize,1,InputFD);
-         if(result == 1) {
-            Position += blockSize;
-            return(blockSize);
-         }
-         std::cerr << "WARNING: WavAudioReader::getNextBlock() - Read error!" << std::endl;
+         const card8* data = Mapping->getdata() + StartPosition + Position;
+         Position += blockSize;
+         readAhead();
+         return((const void*)data);
       }
       else {
          Error = ME_EOF;
       }
    }
+   return(NULL);
+}
+
+
+// ###### Read block from file ##############################################
+cardinal WavAudioReader::getNextBlock(void* buffer, const cardinal blockSize)
+{
+   if((Mapping != NULL) && (Error < ME_UnrecoverableError)) {
+      const cardinal outputAlign = getBitsPerSample() / 8;
+      if((blockSize % outputAlign) != 0) {
+         std::cerr << "WARNING: WavAudioReader::getNextBlock() - Unaligned blockSize value "
+              << blockSize << "!" << std::endl;
+         return(0);
+      }
+
+      // At the end of the file, the remaining samples are delivered.
+      checkWindow(((card64)blockSize / outputAlign) * Format.BlockAlign);
+      const card64 frames = std::min((card64)(blockSize / outputAlign),
+                                     (MaxPosition - Position) / Format.BlockAlign);
+      if(frames < blockSize / outputAlign) {
+         Error = ME_EOF;
+      }
+
+      const card8* data = Mapping->getdata() + StartPosition + Position;
+      if(SampleBytes <= 2) {
+         memcpy(buffer,data,frames * Format.BlockAlign);
+      }
+      else {
+         // 24 bit samples are converted to 16 bit.
+         convertSamples(data,(card8*)buffer,frames * Format.Channels);
+      }
+      Position += frames * Format.BlockAlign;
+      readAhead();
+      return((cardinal)(frames * outputAlign));
+   }
    return(0);
 }
@@ -38,9 +38,17 @@
 #include "audioreaderinterface.h"
 #include "audioquality.h"
 
+#include <vector>
+
+
+class Soundfilemapping;
+
 
 /**
-  * This class is a reader for WAV audio files.
+  * This class is a reader for WAV audio files. The file's chunks are
+  * indexed once when opening it. 8 and 16 bit PCM data is served directly
+  * from the memory-mapped data chunk, 24 bit PCM data is converted to
+  * 16 bit while reading.
   *
   * @short   WAV Audio Reader
   * @author  Thomas Dreibholz (thomas.dreibholz@gmail.com)
@@ -129,6 +137,15 @@ class WavAudioReader : virtual public AudioReaderInterface,
      */
    cardinal getNextBlock(void* buffer, const cardinal blockSize);
 
+   /**
+     * getNextBlockView() implementation of AudioReaderInterface.
+     * A view is available for 8 and 16 bit PCM data, which is delivered
+     * as stored in the file.
+     *
+     * @see AudioReaderInterface#getNextBlockView
+     */
+   const void* getNextBlockView(const cardinal blockSize);
+
 
    // ====== Private data ===================================================
    private:
@@ -147,19 +164,40 @@ class WavAudioReader : virtual public AudioReaderInterface,
       card32 SamplesPerSec;
       card32 AvgBytesPerSec;
       card16 BlockAlign;
+      card16 BitsPerSample;
+   };
+   struct WAVE_FormatExtensible {
+      WAVE_Format Format;
+      card16      ExtensionSize;
+      card16      ValidBitsPerSample;
+      card32      ChannelMask;
+      card8       SubFormat[16];
+   };
+   struct ChunkIndexEntry {
+      char   ID[4];
+      card64 Offset;
+      card64 Length;
    };
 
 
-   bool getChunk(RIFF_Chunk& chunk);
-
-
-   MediaError  Error;
-   FILE*       InputFD;
-   WAVE_Format Format;
-   card64      StartPosition;
-   card64      EndPosition;
-   card64      Position;
-   card64      MaxPosition;
+   bool indexChunks();
+   const ChunkIndexEntry* findChunk(const char* id) const;
+   void readAhead();
+   void checkWindow(const card64 length);
+
+
+   MediaError                   Error;
+   Soundfilemapping*            Mapping;
+   std::vector<ChunkIndexEntry> Chunks;
+   WAVE_Format                  Format;
+   cardinal                     SampleBytes;
+   card64                       BytesPerSecond;
+   card64                       ReadAheadPosition;
+   card64                       CheckedPosition;
+   card64                       StartPosition;
+   card64                       EndPosition;
+   card64                       Position;
+   card64                       MaxPosition;
 };
 
 